@@ -0,0 +1,145 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Compares allocation counts and teardown time of heap allocated trees against
+// arena allocated ones.
+//
+//   YGArenaBenchmark [nodeCount]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "YGBenchmarkSupport.h"
+
+static size_t gAllocationCount = 0;
+
+static void *YGCountingMalloc(size_t size) {
+  gAllocationCount++;
+  return malloc(size);
+}
+
+static void *YGCountingCalloc(size_t count, size_t size) {
+  gAllocationCount++;
+  return calloc(count, size);
+}
+
+static void *YGCountingRealloc(void *ptr, size_t size) {
+  gAllocationCount++;
+  return realloc(ptr, size);
+}
+
+static void YGCountingFree(void *ptr) { free(ptr); }
+
+// Builds a tree of roughly `count` nodes where every container has `fanout`
+// children. A fanout equal to the node count gives a single wide row.
+static YGNodeRef YGBuildTree(const YGConfigRef config, const YGArenaRef arena,
+                             const uint32_t count, const uint32_t fanout) {
+  const YGNodeRef root = YGNodeNewInArena(arena, config);
+  YGNodeRef *queue = malloc(sizeof(YGNodeRef) * count);
+  uint32_t head = 0;
+  uint32_t tail = 0;
+  uint32_t created = 1;
+  queue[tail++] = root;
+  while (created < count) {
+    const YGNodeRef parent = queue[head++];
+    for (uint32_t i = 0; i < fanout && created < count; i++, created++) {
+      const YGNodeRef child = YGNodeNewInArena(arena, config);
+      YGNodeStyleSetFlexGrow(child, 1);
+      YGNodeStyleSetMargin(child, YGEdgeAll, 2);
+      YGNodeInsertChild(parent, child, YGNodeGetChildCount(parent));
+      queue[tail++] = child;
+    }
+  }
+  free(queue);
+  YGNodeCalculateLayout(root, 1000, 1000, YGDirectionLTR);
+  return root;
+}
+
+// The teardown YGNodeFreeRecursive used to do: unlink the first child until
+// the list is empty, shifting the remaining children every time.
+static void YGLegacyFreeRecursive(const YGNodeRef root) {
+  while (YGNodeGetChildCount(root) > 0) {
+    const YGNodeRef child = YGNodeGetChild(root, 0);
+    YGNodeRemoveChild(root, child);
+    YGLegacyFreeRecursive(child);
+  }
+  YGNodeFree(root);
+}
+
+typedef enum YGTeardown {
+  YGTeardownLegacy,
+  YGTeardownRecursive,
+  YGTeardownArena,
+} YGTeardown;
+
+static const char *YGTeardownToString(const YGTeardown teardown) {
+  switch (teardown) {
+    case YGTeardownLegacy:
+      return "legacy-free";
+    case YGTeardownRecursive:
+      return "free-recursive";
+    case YGTeardownArena:
+      return "arena";
+  }
+  return "unknown";
+}
+
+static void YGRunScenario(const char *name, const uint32_t count,
+                          const uint32_t fanout, const YGTeardown teardown) {
+  gAllocationCount = 0;
+  const YGArenaRef arena = teardown == YGTeardownArena ? YGArenaNew(0) : NULL;
+  const YGConfigRef config =
+      arena != NULL ? YGConfigNewInArena(arena) : YGConfigNew();
+
+  const double buildStart = YGNow();
+  const YGNodeRef root = YGBuildTree(config, arena, count, fanout);
+  const double buildTime = YGNow() - buildStart;
+  const size_t allocations = gAllocationCount;
+
+  const double teardownStart = YGNow();
+  switch (teardown) {
+    case YGTeardownLegacy:
+      YGLegacyFreeRecursive(root);
+      YGConfigFree(config);
+      break;
+    case YGTeardownRecursive:
+      YGNodeFreeRecursive(root);
+      YGConfigFree(config);
+      break;
+    case YGTeardownArena:
+      YGArenaFree(arena);
+      break;
+  }
+  const double teardownTime = YGNow() - teardownStart;
+
+  if (YGNodeGetInstanceCount() != 0) {
+    fprintf(stderr, "%s leaked %d nodes\n", name, YGNodeGetInstanceCount());
+    exit(EXIT_FAILURE);
+  }
+
+  printf("%-6s %-15s nodes=%-7u allocations=%-7zu build=%8.3fms "
+         "teardown=%8.3fms\n",
+         name, YGTeardownToString(teardown), count, allocations, buildTime,
+         teardownTime);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 10000;
+  YGSetMemoryFuncs(&YGCountingMalloc, &YGCountingCalloc, &YGCountingRealloc,
+                   &YGCountingFree);
+
+  for (YGTeardown teardown = YGTeardownLegacy; teardown <= YGTeardownArena;
+       teardown++) {
+    YGRunScenario("deep", count, 4, teardown);
+  }
+  for (YGTeardown teardown = YGTeardownLegacy; teardown <= YGTeardownArena;
+       teardown++) {
+    YGRunScenario("wide", count, count, teardown);
+  }
+}
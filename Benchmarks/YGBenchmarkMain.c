@@ -0,0 +1,22 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "YGBenchmarkSupport.h"
+
+int main(int argc, char *argv[]) {
+  YGRunBenchmark(argc, argv);
+  if (YGNodeGetInstanceCount() != 0) {
+    fprintf(stderr, "leaked %d nodes\n", YGNodeGetInstanceCount());
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include "YGBenchmarkSupport.h"
+
+#include <stdio.h>
+#include <time.h>
+
+double YGNow(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+bool YGCheck(const bool condition, const char *what) {
+  if (!condition) {
+    fprintf(stderr, "failed: %s\n", what);
+  }
+  return condition;
+}
+
+YGSize YGMeasureTextOfWidth(const float textWidth, const float lineHeight,
+                            const float width, const YGMeasureMode widthMode,
+                            const float height,
+                            const YGMeasureMode heightMode) {
+  const float maxWidth =
+      widthMode == YGMeasureModeUndefined ? textWidth : width;
+  const float lines = maxWidth > 0 && textWidth > maxWidth
+                          ? (float)(int)(textWidth / maxWidth + 0.999f)
+                          : 1;
+  const float textHeight = lines * lineHeight;
+  return (YGSize){
+      .width = textWidth < maxWidth ? textWidth : maxWidth,
+      .height = heightMode == YGMeasureModeExactly ||
+                        (heightMode == YGMeasureModeAtMost &&
+                         height < textHeight)
+                    ? height
+                    : textHeight,
+  };
+}
+
+YGSize YGMeasureText(YGNodeRef node, float width, YGMeasureMode widthMode,
+                     float height, YGMeasureMode heightMode) {
+  const float length = (float)(uintptr_t)YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(7 * length, 16, width, widthMode, height,
+                              heightMode);
+}
+
+void YGAppendChild(const YGNodeRef parent, const YGNodeRef child) {
+  YGNodeInsertChild(parent, child, YGNodeGetChildCount(parent));
+}
+
+uint32_t YGCountNodes(const YGNodeRef node) {
+  uint32_t count = 1;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    count += YGCountNodes(YGNodeGetChild(node, i));
+  }
+  return count;
+}
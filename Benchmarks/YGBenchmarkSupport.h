@@ -0,0 +1,47 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Fixtures shared by the benchmarks and their tests.
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Yoga.h"
+
+// Milliseconds on a monotonic clock.
+double YGNow(void);
+
+// Reports `what` as failed unless `condition` holds, and returns `condition`.
+bool YGCheck(const bool condition, const char *what);
+
+// The size of a text that is `textWidth` wide on a single line, wrapped into
+// lines of `lineHeight` to fit the width it is given.
+YGSize YGMeasureTextOfWidth(const float textWidth, const float lineHeight,
+                            const float width, const YGMeasureMode widthMode,
+                            const float height, const YGMeasureMode heightMode);
+
+// Measures a text node whose context is its length in characters, at 7 points
+// a character and 16 a line.
+YGSize YGMeasureText(YGNodeRef node, float width, YGMeasureMode widthMode,
+                     float height, YGMeasureMode heightMode);
+
+void YGAppendChild(const YGNodeRef parent, const YGNodeRef child);
+
+uint32_t YGCountNodes(const YGNodeRef node);
+
+// Runs the benchmark with its command line. Every benchmark defines it and
+// gets a main() that also checks that it freed all of its nodes.
+void YGRunBenchmark(int argc, char *argv[]);
+
+// Runs the checks of a benchmark on small trees and returns whether all of
+// them passed. The benchmarks that define it get a test executable of their
+// own.
+bool YGRunChecks(void);
@@ -0,0 +1,260 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Sizes the cells of a list, each a tree of its own, by laying them out and by
+// only measuring them, and reports the time per node of each. The test checks
+// that a cell is measured at the size it is laid out at, also after an edit,
+// and that measuring it leaves its last layout as it was.
+//
+//   YGCalculateSizeBenchmark [cellCount] [passes]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFunc(text, YGMeasureText);
+  return text;
+}
+
+// A cell of the list: an avatar, a column of texts and a badge. The padding of
+// the texts is a percentage, so that it depends on the width the cell gets.
+static YGNodeRef YGBuildCell(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef cell = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(cell, YGFlexDirectionRow);
+  YGNodeStyleSetAlignItems(cell, (YGAlign)(YGAlignFlexStart + index % 4));
+  YGNodeStyleSetPadding(cell, YGEdgeHorizontal, 16);
+  YGNodeStyleSetPadding(cell, YGEdgeVertical, 8 + index % 3);
+  if (index % 11 == 0) {
+    YGNodeStyleSetDirection(cell, YGDirectionRTL);
+  }
+  if (index % 5 == 0) {
+    YGNodeStyleSetMinHeight(cell, 72);
+  }
+
+  const YGNodeRef avatar = YGNodeNewWithConfig(config);
+  YGNodeStyleSetWidth(avatar, 40);
+  YGNodeStyleSetHeight(avatar, 40);
+  YGNodeStyleSetMargin(avatar, YGEdgeEnd, 12);
+  YGAppendChild(cell, avatar);
+
+  const YGNodeRef texts = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexShrink(texts, 1);
+  YGNodeStyleSetPaddingPercent(texts, YGEdgeEnd, 4);
+  YGAppendChild(texts, YGNewText(config, 8 + index % 12));
+  const YGNodeRef body = YGNewText(config, 20 + (index * 37) % 90);
+  YGNodeStyleSetMargin(body, YGEdgeTop, 4);
+  YGAppendChild(texts, body);
+  YGAppendChild(cell, texts);
+
+  const YGNodeRef badge = YGNodeNewWithConfig(config);
+  YGNodeStyleSetPadding(badge, YGEdgeAll, 4);
+  YGNodeStyleSetMargin(badge, YGEdgeStart, 8);
+  YGAppendChild(badge, YGNewText(config, 1 + index % 3));
+  YGAppendChild(cell, badge);
+  return cell;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[7] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetRight(node),
+      YGNodeLayoutGetBottom(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+      YGNodeLayoutGetPadding(node, YGEdgeRight),
+  };
+  uint32_t bits[7];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 7; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  hash = (hash ^ YGNodeLayoutGetHadOverflow(node)) * 1099511628211ull;
+  hash = (hash ^ YGNodeLayoutGetDirection(node)) * 1099511628211ull;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+static void YGLayoutCell(const YGNodeRef cell, const float width,
+                         const float height) {
+  YGNodeCalculateLayout(cell, width, height, YGNodeStyleGetDirection(cell));
+}
+
+// Measures the cell at `width` and lays out the reference at the same width,
+// and returns whether both got the same size.
+static bool YGSizeLikeLayout(const YGNodeRef cell, const YGNodeRef reference,
+                             const float width) {
+  const YGMeasureMode widthMode = YGFloatIsUndefined(width)
+                                      ? YGMeasureModeUndefined
+                                      : YGMeasureModeExactly;
+  const YGSize size = YGNodeCalculateSize(cell, width, widthMode, YGUndefined,
+                                          YGMeasureModeUndefined);
+  YGLayoutCell(reference, width, YGUndefined);
+  return size.width == YGNodeLayoutGetWidth(reference) &&
+         size.height == YGNodeLayoutGetHeight(reference);
+}
+
+// Makes the body of both cells `length` characters long.
+static void YGEditBody(const YGNodeRef cell, const YGNodeRef reference,
+                       const uint32_t length) {
+  const YGNodeRef cells[2] = {cell, reference};
+  for (uint32_t i = 0; i < 2; i++) {
+    const YGNodeRef body = YGNodeGetChild(YGNodeGetChild(cells[i], 1), 1);
+    YGNodeSetContext(body, (void *)(uintptr_t)length);
+    YGNodeMarkDirty(body);
+  }
+}
+
+static bool YGCheckCell(const YGNodeRef cell, const YGNodeRef reference,
+                        const uint32_t index) {
+  bool ok = true;
+  YGLayoutCell(cell, 375, YGUndefined);
+  const uint64_t committed = YGHashLayout(cell, 0);
+
+  ok &= YGCheck(YGSizeLikeLayout(cell, reference, 320),
+                "measure a cell at the size it is laid out at");
+  ok &= YGCheck(YGSizeLikeLayout(cell, reference, YGUndefined),
+                "measure a cell at its intrinsic size");
+  ok &= YGCheck(YGHashLayout(cell, 0) == committed,
+                "keep the layout of a measured cell");
+
+  // The cell is still laid out at the width it had, by its layout cache.
+  YGLayoutStats stats;
+  YGNodeCalculateLayoutWithStats(cell, 375, YGUndefined,
+                                 YGNodeStyleGetDirection(cell), &stats);
+  ok &= YGCheck(stats.nodesVisited == 1 && YGHashLayout(cell, 0) == committed,
+                "lay out a measured cell again from its cache");
+  YGLayoutCell(cell, 320, YGUndefined);
+  YGLayoutCell(reference, 320, YGUndefined);
+  ok &= YGCheck(YGHashLayout(cell, 0) == YGHashLayout(reference, 0),
+                "lay out a measured cell at the size it was measured at");
+
+  // An edit is measured before it is laid out.
+  const uint64_t edited = YGHashLayout(cell, 0);
+  YGEditBody(cell, reference, 4 + (index * 53) % 120);
+  ok &= YGCheck(YGSizeLikeLayout(cell, reference, 320),
+                "measure an edited cell at the size it is laid out at");
+  ok &= YGCheck(YGHashLayout(cell, 0) == edited,
+                "keep the layout of an edited cell until it is laid out");
+  YGLayoutCell(cell, 320, YGUndefined);
+  ok &= YGCheck(YGHashLayout(cell, 0) == YGHashLayout(reference, 0),
+                "lay out an edited cell after measuring it");
+  return ok;
+}
+
+// Sizes are compared as they are computed, before rounding.
+static YGConfigRef YGNewUnroundedConfig(void) {
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetPointScaleFactor(config, 0);
+  return config;
+}
+
+// Every pass is at a new width, so that neither cache answers it. The passes
+// alternate between laying out and measuring so that both see the same state
+// of the machine, and the best of each is kept. Returns the height of the list
+// as it was measured in the last pass.
+static float YGRunPasses(YGNodeRef *const cells, YGNodeRef *const references,
+                         const uint32_t cellCount, const uint32_t passes,
+                         double *const layoutTime, double *const sizeTime) {
+  float height = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    const float width = 375 - (float)i;
+    double start = YGNow();
+    for (uint32_t j = 0; j < cellCount; j++) {
+      YGLayoutCell(references[j], width, YGUndefined);
+    }
+    const double layoutPass = YGNow() - start;
+    start = YGNow();
+    height = 0;
+    for (uint32_t j = 0; j < cellCount; j++) {
+      height += YGNodeCalculateSize(cells[j], width, YGMeasureModeExactly,
+                                    YGUndefined, YGMeasureModeUndefined)
+                    .height;
+    }
+    const double sizePass = YGNow() - start;
+    *layoutTime = i == 0 || layoutPass < *layoutTime ? layoutPass : *layoutTime;
+    *sizeTime = i == 0 || sizePass < *sizeTime ? sizePass : *sizeTime;
+  }
+  return height;
+}
+
+static void YGFreeCells(YGNodeRef *const cells, YGNodeRef *const references,
+                        const uint32_t cellCount) {
+  for (uint32_t i = 0; i < cellCount; i++) {
+    YGNodeFreeRecursive(cells[i]);
+    YGNodeFreeRecursive(references[i]);
+  }
+  free(cells);
+  free(references);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t cellCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 10;
+  const YGConfigRef config = YGNewUnroundedConfig();
+
+  YGNodeRef *const cells = malloc(sizeof(YGNodeRef) * cellCount);
+  YGNodeRef *const references = malloc(sizeof(YGNodeRef) * cellCount);
+  uint32_t nodeCount = 0;
+  for (uint32_t i = 0; i < cellCount; i++) {
+    cells[i] = YGBuildCell(config, i);
+    references[i] = YGBuildCell(config, i);
+    nodeCount += YGCountNodes(cells[i]);
+  }
+
+  double layoutTime = 0;
+  double sizeTime = 0;
+  YGRunPasses(cells, references, cellCount, passes, &layoutTime, &sizeTime);
+  printf("cells=%u nodes=%u layout=%.1fns/node size=%.1fns/node (%.2fx)\n",
+         cellCount, nodeCount, layoutTime * 1e6 / nodeCount,
+         sizeTime * 1e6 / nodeCount, layoutTime / sizeTime);
+
+  YGFreeCells(cells, references, cellCount);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t cellCount = 200;
+  const YGConfigRef config = YGNewUnroundedConfig();
+  bool ok = true;
+
+  YGNodeRef *const cells = malloc(sizeof(YGNodeRef) * cellCount);
+  YGNodeRef *const references = malloc(sizeof(YGNodeRef) * cellCount);
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < cellCount; i++) {
+    cells[i] = YGBuildCell(config, i);
+    references[i] = YGBuildCell(config, i);
+    mismatches += YGCheckCell(cells[i], references[i], i) ? 0 : 1;
+  }
+  ok &= YGCheck(mismatches == 0, "size the cells like their layout");
+
+  double layoutTime = 0;
+  double sizeTime = 0;
+  const float height =
+      YGRunPasses(cells, references, cellCount, 4, &layoutTime, &sizeTime);
+  float layoutHeight = 0;
+  for (uint32_t i = 0; i < cellCount; i++) {
+    layoutHeight += YGNodeLayoutGetHeight(references[i]);
+  }
+  ok &= YGCheck(height == layoutHeight,
+                "size the list like its layout at a new width");
+
+  YGFreeCells(cells, references, cellCount);
+  YGConfigFree(config);
+  return ok;
+}
@@ -0,0 +1,264 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Measures tree build and layout throughput for the fanouts typical of view
+// hierarchies, where most containers have a handful of children, and the cost
+// of editing the child list of a single very wide container.
+//
+//   YGChildListBenchmark [nodeCount]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "YGBenchmarkSupport.h"
+
+static size_t gAllocationCount = 0;
+
+static void *YGCountingMalloc(size_t size) {
+  gAllocationCount++;
+  return malloc(size);
+}
+
+static void *YGCountingCalloc(size_t count, size_t size) {
+  gAllocationCount++;
+  return calloc(count, size);
+}
+
+static void *YGCountingRealloc(void *ptr, size_t size) {
+  gAllocationCount++;
+  return realloc(ptr, size);
+}
+
+static void YGCountingFree(void *ptr) { free(ptr); }
+
+// Builds a tree of `count` nodes where every container has `fanout` children,
+// appending them one at a time as a view hierarchy would.
+static YGNodeRef YGBuildTree(const YGConfigRef config, const uint32_t count,
+                             const uint32_t fanout) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeRef *queue = malloc(sizeof(YGNodeRef) * count);
+  uint32_t head = 0;
+  uint32_t tail = 0;
+  uint32_t created = 1;
+  queue[tail++] = root;
+  while (created < count) {
+    const YGNodeRef parent = queue[head++];
+    for (uint32_t i = 0; i < fanout && created < count; i++, created++) {
+      const YGNodeRef child = YGNodeNewWithConfig(config);
+      if (created % 2 == 0) {
+        YGNodeStyleSetFlexDirection(child, YGFlexDirectionRow);
+      } else {
+        YGNodeStyleSetHeight(child, 10);
+      }
+      YGNodeInsertChild(parent, child, YGNodeGetChildCount(parent));
+      queue[tail++] = child;
+    }
+  }
+  free(queue);
+  return root;
+}
+
+static void YGRunScenario(const uint32_t count, const uint32_t fanout) {
+  const uint32_t passes = 10;
+  const YGConfigRef config = YGConfigNew();
+  double buildTime = 0;
+  double layoutTime = 0;
+  size_t allocations = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    gAllocationCount = 0;
+    const double buildStart = YGNow();
+    const YGNodeRef root = YGBuildTree(config, count, fanout);
+    const double build = YGNow() - buildStart;
+    allocations = gAllocationCount;
+
+    const double layoutStart = YGNow();
+    YGNodeCalculateLayout(root, 1000, 1000, YGDirectionLTR);
+    const double layout = YGNow() - layoutStart;
+
+    buildTime = i == 0 || build < buildTime ? build : buildTime;
+    layoutTime = i == 0 || layout < layoutTime ? layout : layoutTime;
+    YGNodeFreeRecursive(root);
+  }
+  YGConfigFree(config);
+
+  if (YGNodeGetInstanceCount() != 0) {
+    fprintf(stderr, "fanout %u leaked %d nodes\n", fanout,
+            YGNodeGetInstanceCount());
+    exit(EXIT_FAILURE);
+  }
+
+  // Best of all passes, so the numbers reflect a warm allocator.
+  printf("fanout=%-3u nodes=%-7u allocations/node=%.2f build=%.1fns/node "
+         "layout=%.1fns/node\n",
+         fanout, count, (double)allocations / count, buildTime * 1e6 / count,
+         layoutTime * 1e6 / count);
+}
+
+typedef enum YGEdit {
+  YGEditAppend,
+  YGEditPrepend,
+  YGEditRemoveLast,
+  YGEditRemoveFirst,
+  YGEditMoveDown,
+  YGEditInsertAll,
+  YGEditRemoveAll,
+} YGEdit;
+
+static const char *YGEditToString(const YGEdit edit) {
+  switch (edit) {
+    case YGEditAppend:
+      return "append";
+    case YGEditPrepend:
+      return "prepend";
+    case YGEditRemoveLast:
+      return "remove-last";
+    case YGEditRemoveFirst:
+      return "remove-first";
+    case YGEditMoveDown:
+      return "move-down";
+    case YGEditInsertAll:
+      return "insert-children";
+    case YGEditRemoveAll:
+      return "remove-children";
+  }
+  return "unknown";
+}
+
+// A container holding the children `edit` starts from.
+static YGNodeRef YGNewParent(const YGNodeRef *nodes, const uint32_t count,
+                             const YGEdit edit) {
+  const YGNodeRef parent = YGNodeNew();
+  const bool startsFull = edit == YGEditRemoveLast ||
+                          edit == YGEditRemoveFirst ||
+                          edit == YGEditMoveDown ||
+                          edit == YGEditRemoveAll;
+  if (startsFull) {
+    YGNodeInsertChildren(parent, nodes, count, 0);
+  }
+  return parent;
+}
+
+static void YGFreeParent(const YGNodeRef parent) {
+  YGNodeRemoveAllChildren(parent);
+  YGNodeFree(parent);
+}
+
+// Applies `edit` to every child of a container, one child per call except for
+// the bulk variants.
+static void YGApplyEdit(const YGNodeRef parent, const YGNodeRef *nodes,
+                        const uint32_t count, const YGEdit edit) {
+  switch (edit) {
+    case YGEditAppend:
+      for (uint32_t i = 0; i < count; i++) {
+        YGNodeInsertChild(parent, nodes[i], i);
+      }
+      break;
+    case YGEditPrepend:
+      for (uint32_t i = 0; i < count; i++) {
+        YGNodeInsertChild(parent, nodes[i], 0);
+      }
+      break;
+    case YGEditRemoveLast:
+      for (uint32_t i = count; i > 0; i--) {
+        YGNodeRemoveChild(parent, nodes[i - 1]);
+      }
+      break;
+    case YGEditRemoveFirst:
+      for (uint32_t i = 0; i < count; i++) {
+        YGNodeRemoveChild(parent, nodes[i]);
+      }
+      break;
+    case YGEditMoveDown:
+      // Walks the first child down to the end one slot at a time, as a drag
+      // and drop reorder would.
+      for (uint32_t i = 0; i + 1 < count; i++) {
+        YGNodeMoveChild(parent, i, i + 1);
+      }
+      break;
+    case YGEditInsertAll:
+      YGNodeInsertChildren(parent, nodes, count, 0);
+      break;
+    case YGEditRemoveAll:
+      YGNodeRemoveChildren(parent, 0, count);
+      break;
+  }
+}
+
+// Applies `edit` to every child of a container and reports the time per child.
+static void YGRunEdit(const YGNodeRef *nodes, const uint32_t count,
+                      const YGEdit edit) {
+  const YGNodeRef parent = YGNewParent(nodes, count, edit);
+  const double start = YGNow();
+  YGApplyEdit(parent, nodes, count, edit);
+  const double time = YGNow() - start;
+  YGFreeParent(parent);
+
+  printf("edit=%-18s children=%-7u %.1fns/child\n", YGEditToString(edit), count,
+         time * 1e6 / count);
+}
+
+static bool YGCheckEdit(const YGNodeRef *nodes, const uint32_t count,
+                        const YGEdit edit) {
+  const YGNodeRef parent = YGNewParent(nodes, count, edit);
+  YGApplyEdit(parent, nodes, count, edit);
+  const uint32_t expectedCount =
+      edit == YGEditAppend || edit == YGEditPrepend ||
+              edit == YGEditMoveDown || edit == YGEditInsertAll
+          ? count
+          : 0;
+  const YGNodeRef expectedLast = edit == YGEditPrepend || edit == YGEditMoveDown
+                                    ? nodes[0]
+                                    : nodes[count - 1];
+  const bool ok = YGNodeGetChildCount(parent) == expectedCount &&
+                  (expectedCount == 0 ||
+                   YGNodeGetChild(parent, count - 1) == expectedLast);
+  YGFreeParent(parent);
+  return YGCheck(ok, YGEditToString(edit));
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 10000;
+  YGSetMemoryFuncs(&YGCountingMalloc, &YGCountingCalloc, &YGCountingRealloc,
+                   &YGCountingFree);
+
+  const uint32_t fanouts[] = {2, 3, 4, 8, 16};
+  for (uint32_t i = 0; i < sizeof(fanouts) / sizeof(fanouts[0]); i++) {
+    YGRunScenario(count, fanouts[i]);
+  }
+
+  YGNodeRef *nodes = malloc(sizeof(YGNodeRef) * count);
+  for (uint32_t i = 0; i < count; i++) {
+    nodes[i] = YGNodeNew();
+  }
+  for (YGEdit edit = YGEditAppend; edit <= YGEditRemoveAll; edit++) {
+    YGRunEdit(nodes, count, edit);
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    YGNodeFree(nodes[i]);
+  }
+  free(nodes);
+}
+
+bool YGRunChecks(void) {
+  // Wide enough for the children to spill out of the node.
+  YGNodeRef nodes[500];
+  const uint32_t count = sizeof(nodes) / sizeof(nodes[0]);
+  for (uint32_t i = 0; i < count; i++) {
+    nodes[i] = YGNodeNew();
+  }
+  bool ok = true;
+  for (YGEdit edit = YGEditAppend; edit <= YGEditRemoveAll; edit++) {
+    ok &= YGCheckEdit(nodes, count, edit);
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    YGNodeFree(nodes[i]);
+  }
+  return ok;
+}
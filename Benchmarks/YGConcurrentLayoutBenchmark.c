@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out independent trees from several threads at once and checks every
+// result against a single threaded reference. Build with
+// -DYOGA_SANITIZE_THREAD=ON to run it under ThreadSanitizer.
+//
+//   YGConcurrentLayoutBenchmark [threadCount] [treesPerThread] [nodeCount]
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+// Trees come in a few shapes so that threads work on different inputs.
+#define YG_TREE_VARIANTS 8
+
+typedef struct YGWorker {
+  pthread_t thread;
+  uint32_t index;
+  uint32_t treeCount;
+  uint32_t nodeCount;
+  const uint64_t *expectedHashes;
+  uint32_t mismatches;
+} YGWorker;
+
+static YGSize YGMeasureLabel(YGNodeRef node, float width,
+                             YGMeasureMode widthMode, float height,
+                             YGMeasureMode heightMode) {
+  const float textWidth = 40 + 10 * (float)(uintptr_t)YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(textWidth, 16, width, widthMode, height,
+                              heightMode);
+}
+
+static YGNodeRef YGBuildTree(const YGConfigRef config, const uint32_t count,
+                             const uint32_t variant) {
+  const uint32_t fanout = 2 + variant % 4;
+  YGNodeRef *nodes = malloc(sizeof(YGNodeRef) * count);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef node = YGNodeNewWithConfig(config);
+    if ((i + variant) % 2 == 0) {
+      YGNodeStyleSetFlexDirection(node, YGFlexDirectionRow);
+    }
+    if ((i + variant) % 3 == 0) {
+      YGNodeStyleSetFlexGrow(node, 1);
+    }
+    if ((i * variant) % 5 == 1) {
+      YGNodeStyleSetPadding(node, YGEdgeAll, (float)variant);
+    }
+    if (i > 0) {
+      const YGNodeRef parent = nodes[(i - 1) / fanout];
+      YGNodeInsertChild(parent, node, YGNodeGetChildCount(parent));
+    }
+    if (i * fanout + 1 >= count) {
+      YGNodeSetContext(node, (void *)(uintptr_t)(i % 7));
+      YGNodeSetMeasureFunc(node, YGMeasureLabel);
+    }
+    nodes[i] = node;
+  }
+  const YGNodeRef root = nodes[0];
+  free(nodes);
+  return root;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[4] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[4];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 4; i++) {
+    // FNV-1a over the bit patterns, so any difference shows.
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+// Lays a tree out at a few widths, so later passes hit the caches filled by
+// earlier ones, and hashes every result.
+static uint64_t YGLayoutAndHash(const YGNodeRef root) {
+  const float widths[] = {320, 375, 320, 414};
+  uint64_t hash = 14695981039346656037ull;
+  for (uint32_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+    YGNodeCalculateLayout(root, widths[i], YGUndefined, YGDirectionLTR);
+    hash = YGHashLayout(root, hash);
+  }
+  return hash;
+}
+
+static void *YGRunWorker(void *arg) {
+  YGWorker *const worker = arg;
+  for (uint32_t i = 0; i < worker->treeCount; i++) {
+    const uint32_t variant = (worker->index + i) % YG_TREE_VARIANTS;
+    // Configs are created and freed concurrently too, to exercise the
+    // instance counters.
+    const YGConfigRef config = YGConfigNew();
+    const YGNodeRef root = YGBuildTree(config, worker->nodeCount, variant);
+    if (YGLayoutAndHash(root) != worker->expectedHashes[variant]) {
+      worker->mismatches++;
+    }
+    YGNodeFreeRecursive(root);
+    YGConfigFree(config);
+  }
+  return NULL;
+}
+
+// Lays out `treeCount` trees on each of `threadCount` threads and returns how
+// many of them came out different from the single threaded reference.
+static uint32_t YGRunThreads(const uint32_t threadCount,
+                             const uint32_t treeCount,
+                             const uint32_t nodeCount) {
+  uint64_t expectedHashes[YG_TREE_VARIANTS];
+  const YGConfigRef config = YGConfigNew();
+  for (uint32_t variant = 0; variant < YG_TREE_VARIANTS; variant++) {
+    const YGNodeRef root = YGBuildTree(config, nodeCount, variant);
+    expectedHashes[variant] = YGLayoutAndHash(root);
+    YGNodeFreeRecursive(root);
+  }
+  YGConfigFree(config);
+
+  YGWorker *workers = calloc(threadCount, sizeof(YGWorker));
+  for (uint32_t i = 0; i < threadCount; i++) {
+    workers[i].index = i;
+    workers[i].treeCount = treeCount;
+    workers[i].nodeCount = nodeCount;
+    workers[i].expectedHashes = expectedHashes;
+    if (pthread_create(&workers[i].thread, NULL, YGRunWorker, &workers[i]) !=
+        0) {
+      fprintf(stderr, "could not start thread %u\n", i);
+      exit(EXIT_FAILURE);
+    }
+  }
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < threadCount; i++) {
+    pthread_join(workers[i].thread, NULL);
+    mismatches += workers[i].mismatches;
+  }
+  free(workers);
+  return mismatches;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t threadCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 8;
+  const uint32_t treeCount = argc > 2 ? (uint32_t)atoi(argv[2]) : 50;
+  const uint32_t nodeCount = argc > 3 ? (uint32_t)atoi(argv[3]) : 1000;
+
+  const double start = YGNow();
+  const uint32_t mismatches = YGRunThreads(threadCount, treeCount, nodeCount);
+  const double time = YGNow() - start;
+
+  printf("threads=%u trees=%u nodes/tree=%u time=%.1fms trees/s=%.0f "
+         "mismatches=%u\n",
+         threadCount, threadCount * treeCount, nodeCount, time,
+         threadCount * treeCount / (time / 1e3), mismatches);
+}
+
+bool YGRunChecks(void) {
+  bool ok = YGCheck(YGRunThreads(4, 10, 200) == 0,
+                    "lay out trees on several threads like on one");
+  ok &= YGCheck(YGConfigGetInstanceCount() == 0,
+                "free the configs of every thread");
+  return ok;
+}
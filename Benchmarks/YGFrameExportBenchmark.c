@@ -0,0 +1,298 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out a feed of text cells at 3x with float and with fixed point
+// rounding, and reports the time of each, the frames each puts on other pixels
+// than rounding in double would, and the time of reading the frames back as
+// floats, as 26.6 fixed point and as whole pixels. The test checks that fixed
+// point rounding matches double, and the exported frames the layout.
+//
+//   YGFrameExportBenchmark [cellCount] [passes]
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+// Glyphs and lines off the pixel grid, so that the rounding has work to do.
+static YGSize YGMeasureFractionalText(YGNodeRef node, float width,
+                                      YGMeasureMode widthMode, float height,
+                                      YGMeasureMode heightMode) {
+  const float textWidth = 6.6f * (float)(uintptr_t)YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(textWidth, 15.3f, width, widthMode, height,
+                              heightMode);
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFunc(text, YGMeasureFractionalText);
+  YGNodeStyleSetFlexShrink(text, 1);
+  return text;
+}
+
+static YGNodeRef YGBuildFeed(const YGConfigRef config, const uint32_t count) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef cell = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(cell, YGFlexDirectionRow);
+    YGNodeStyleSetPadding(cell, YGEdgeAll, 10.5f);
+    const YGNodeRef avatar = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidth(avatar, 40);
+    YGNodeStyleSetHeight(avatar, 40);
+    YGNodeStyleSetMargin(avatar, YGEdgeRight, 7.3f);
+    YGAppendChild(cell, avatar);
+    const YGNodeRef content = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(content, 1);
+    YGNodeStyleSetFlexShrink(content, 1);
+    YGAppendChild(content, YGNewText(config, 10 + i % 20));
+    YGAppendChild(content, YGNewText(config, 40 + (i * 37) % 300));
+    YGAppendChild(cell, content);
+    YGAppendChild(root, cell);
+  }
+  return root;
+}
+
+static uint32_t YGGetFloatFrames(const YGNodeRef node, float frames[],
+                                 uint32_t index) {
+  float *const frame = frames + (size_t)index * 4;
+  frame[0] = YGNodeLayoutGetLeft(node);
+  frame[1] = YGNodeLayoutGetTop(node);
+  frame[2] = YGNodeLayoutGetWidth(node);
+  frame[3] = YGNodeLayoutGetHeight(node);
+  index++;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    index = YGGetFloatFrames(YGNodeGetChild(node, i), frames, index);
+  }
+  return index;
+}
+
+static double YGSnap(const double value, const bool isText) {
+  // The rounding pass leaves values within 0.0001 of a pixel on it.
+  return isText ? floor(value + 0.0001) : floor(value + 0.5);
+}
+
+// Rounds the unrounded layout of the subtree to pixels like the rounding pass,
+// in double.
+static uint32_t YGRoundInDouble(const YGNodeRef node, const double scale,
+                                const double absoluteLeft,
+                                const double absoluteTop, int16_t frames[],
+                                uint32_t index) {
+  const bool isText = YGNodeGetMeasureFunc(node) != NULL;
+  const double left = YGNodeLayoutGetLeft(node) * scale;
+  const double top = YGNodeLayoutGetTop(node) * scale;
+  const double width = YGNodeLayoutGetWidth(node) * scale;
+  const double height = YGNodeLayoutGetHeight(node) * scale;
+  const double nodeLeft = absoluteLeft + left;
+  const double nodeTop = absoluteTop + top;
+  double right = nodeLeft + width;
+  double bottom = nodeTop + height;
+  if (isText) {
+    // Text is rounded up unless its size is on the grid.
+    const double widthFraction = width - floor(width);
+    const double heightFraction = height - floor(height);
+    right = widthFraction > 0.0001 && widthFraction < 0.9999
+                ? ceil(right - 0.0001)
+                : YGSnap(right, true);
+    bottom = heightFraction > 0.0001 && heightFraction < 0.9999
+                 ? ceil(bottom - 0.0001)
+                 : YGSnap(bottom, true);
+  } else {
+    right = YGSnap(right, false);
+    bottom = YGSnap(bottom, false);
+  }
+  int16_t *const frame = frames + (size_t)index * 4;
+  const double values[4] = {
+      YGSnap(left, isText),
+      YGSnap(top, isText),
+      right - YGSnap(nodeLeft, isText),
+      bottom - YGSnap(nodeTop, isText),
+  };
+  for (uint32_t i = 0; i < 4; i++) {
+    frame[i] = (int16_t)(values[i] > INT16_MAX ? INT16_MAX : values[i]);
+  }
+  index++;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    index = YGRoundInDouble(YGNodeGetChild(node, i), scale, nodeLeft, nodeTop,
+                            frames, index);
+  }
+  return index;
+}
+
+static uint32_t YGCountDifferences(const int16_t a[], const int16_t b[],
+                                   const uint32_t count) {
+  uint32_t differences = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    differences += a[i] != b[i];
+  }
+  return differences;
+}
+
+// Returns the best time of laying out a new feed, in milliseconds, and the
+// frames of the last one in pixels.
+static double YGTimeLayout(const YGConfigRef config, const uint32_t count,
+                           const uint32_t passes, int16_t pixels[]) {
+  double best = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    const YGNodeRef root = YGBuildFeed(config, count);
+    const double start = YGNow();
+    YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+    const double time = YGNow() - start;
+    best = i == 0 || time < best ? time : best;
+    if (i == passes - 1) {
+      YGNodeGetPixelFrames(root, pixels, UINT32_MAX);
+    }
+    YGNodeFreeRecursive(root);
+  }
+  return best;
+}
+
+// Rounds the exact layout of a feed of `count` cells to pixels in double.
+static void YGRoundFeedInDouble(const uint32_t count, const float scale,
+                                int16_t frames[]) {
+  // Rounding doesn't change the layout, only the frames read back.
+  const YGConfigRef unrounded = YGConfigNew();
+  YGConfigSetPointScaleFactor(unrounded, 0);
+  const YGNodeRef exact = YGBuildFeed(unrounded, count);
+  YGNodeCalculateLayout(exact, 375, YGUndefined, YGDirectionLTR);
+  YGRoundInDouble(exact, scale, 0, 0, frames, 0);
+  YGNodeFreeRecursive(exact);
+  YGConfigFree(unrounded);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 5;
+  const uint32_t nodeCount = 1 + count * 5;
+  const float scale = 3;
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetPointScaleFactor(config, scale);
+  const YGConfigRef fixed = YGConfigNew();
+  YGConfigSetPointScaleFactor(fixed, scale);
+  YGConfigSetFixedPointRounding(fixed, true);
+
+  int16_t *const expected = malloc(sizeof(int16_t) * 4 * nodeCount);
+  int16_t *const rounded = malloc(sizeof(int16_t) * 4 * nodeCount);
+  int16_t *const pixels = malloc(sizeof(int16_t) * 4 * nodeCount);
+  int32_t *const fixedPoint = malloc(sizeof(int32_t) * 4 * nodeCount);
+  float *const floats = malloc(sizeof(float) * 4 * nodeCount);
+
+  YGRoundFeedInDouble(count, scale, expected);
+  const double floatTime = YGTimeLayout(config, count, passes, rounded);
+  // Far down the feed, the float sums of the positions drift off the exact
+  // ones by more than the rounding margin of some edges.
+  const uint32_t floatDifferences =
+      YGCountDifferences(expected, rounded, 4 * nodeCount);
+  const double fixedTime = YGTimeLayout(fixed, count, passes, rounded);
+
+  const YGNodeRef root = YGBuildFeed(fixed, count);
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  double floatExport = 0;
+  double fixedExport = 0;
+  double pixelExport = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    double start = YGNow();
+    YGGetFloatFrames(root, floats, 0);
+    const double floatPass = YGNow() - start;
+    start = YGNow();
+    YGNodeGetFixedPointFrames(root, fixedPoint, nodeCount);
+    const double fixedPass = YGNow() - start;
+    start = YGNow();
+    YGNodeGetPixelFrames(root, pixels, nodeCount);
+    const double pixelPass = YGNow() - start;
+    floatExport = i == 0 || floatPass < floatExport ? floatPass : floatExport;
+    fixedExport = i == 0 || fixedPass < fixedExport ? fixedPass : fixedExport;
+    pixelExport = i == 0 || pixelPass < pixelExport ? pixelPass : pixelExport;
+  }
+  YGNodeFreeRecursive(root);
+
+  printf("nodes=%u float=%.3fms (%u values off) fixed=%.3fms export "
+         "float=%.3fms (%zu bytes) 26.6=%.3fms (%zu bytes) pixels=%.3fms "
+         "(%zu bytes)\n",
+         nodeCount, floatTime, floatDifferences, fixedTime, floatExport,
+         sizeof(float) * 4 * nodeCount, fixedExport,
+         sizeof(int32_t) * 4 * nodeCount, pixelExport,
+         sizeof(int16_t) * 4 * nodeCount);
+
+  free(floats);
+  free(fixedPoint);
+  free(pixels);
+  free(rounded);
+  free(expected);
+  YGConfigFree(fixed);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  // Long enough for the float sums of the positions to drift.
+  const uint32_t count = 2000;
+  const uint32_t nodeCount = 1 + count * 5;
+  const float scale = 3;
+  const YGConfigRef fixed = YGConfigNew();
+  YGConfigSetPointScaleFactor(fixed, scale);
+  YGConfigSetFixedPointRounding(fixed, true);
+  bool ok = true;
+
+  int16_t *const expected = malloc(sizeof(int16_t) * 4 * nodeCount);
+  int16_t *const pixels = malloc(sizeof(int16_t) * 4 * nodeCount);
+  int32_t *const fixedPoint = malloc(sizeof(int32_t) * 4 * nodeCount);
+  float *const floats = malloc(sizeof(float) * 4 * nodeCount);
+
+  YGRoundFeedInDouble(count, scale, expected);
+  YGTimeLayout(fixed, count, 1, pixels);
+  ok &= YGCheck(YGCountDifferences(expected, pixels, 4 * nodeCount) == 0,
+                "round like double in fixed point");
+
+  const YGNodeRef root = YGBuildFeed(fixed, count);
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  YGGetFloatFrames(root, floats, 0);
+  ok &= YGCheck(YGNodeGetFixedPointFrames(root, fixedPoint, nodeCount) ==
+                    nodeCount,
+                "export every fixed point frame");
+  ok &= YGCheck(YGNodeGetPixelFrames(root, pixels, nodeCount) == nodeCount,
+                "export every pixel frame");
+  bool matches = true;
+  for (uint32_t i = 0; i < 4 * nodeCount; i++) {
+    const float value = floats[i] * scale;
+    const long pixel = lroundf(value);
+    matches &= fixedPoint[i] == (int32_t)lroundf(value * 64) &&
+               fixedPoint[i] % 64 == 0 &&
+               pixels[i] == (pixel > INT16_MAX ? INT16_MAX : pixel);
+  }
+  ok &= YGCheck(matches, "export the frames on the pixel grid");
+
+  // Only the frames that fit are written.
+  pixels[4] = -1;
+  ok &= YGCheck(YGNodeGetPixelFrames(root, pixels, 1) == nodeCount &&
+                    pixels[4] == -1,
+                "stop at the capacity");
+  YGNodeFreeRecursive(root);
+
+  // Negative positions round to the nearest pixel.
+  const YGNodeRef shifted = YGNodeNewWithConfig(fixed);
+  YGNodeStyleSetWidth(shifted, 10);
+  YGNodeStyleSetHeight(shifted, 10);
+  YGNodeStyleSetMargin(shifted, YGEdgeLeft, -1.9f / scale);
+  YGNodeCalculateLayout(shifted, 100, 100, YGDirectionLTR);
+  ok &= YGCheck(YGNodeLayoutGetLeft(shifted) * scale == -2,
+                "round a negative position to the nearest pixel");
+  YGNodeFreeRecursive(shifted);
+
+  free(floats);
+  free(fixedPoint);
+  free(pixels);
+  free(expected);
+  YGConfigFree(fixed);
+  return ok;
+}
@@ -0,0 +1,438 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// The layout benchmark suite. Lays out synthetic trees shaped like the ones
+// that stress the engine and prints, as JSON, the time per node, the
+// allocations and the cache hit rates of each. Every scenario builds its tree,
+// lays it out once, then `passes` more times after invalidating it: all of it
+// through a new root width, or a single leaf for "incremental". The sweeps
+// grow the child count of one container and the depth of one chain, so that
+// any cost growing faster than the tree shows up as a growing time per node.
+//
+//   YGLayoutBenchmark [scale] [passes]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "YGBenchmarkSupport.h"
+
+static size_t gAllocationCount = 0;
+
+static void *YGCountingMalloc(size_t size) {
+  gAllocationCount++;
+  return malloc(size);
+}
+
+static void *YGCountingCalloc(size_t count, size_t size) {
+  gAllocationCount++;
+  return calloc(count, size);
+}
+
+static void *YGCountingRealloc(void *ptr, size_t size) {
+  gAllocationCount++;
+  return realloc(ptr, size);
+}
+
+static void YGCountingFree(void *ptr) { free(ptr); }
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFunc(text, YGMeasureText);
+  YGNodeStyleSetFlexShrink(text, 1);
+  return text;
+}
+
+// Chains nested `depth` levels deep.
+static YGNodeRef YGBuildDeep(const YGConfigRef config, const uint32_t scale) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+  for (uint32_t i = 0; i < 4 * scale; i++) {
+    YGNodeRef parent = root;
+    for (uint32_t depth = 0; depth < 50; depth++) {
+      const YGNodeRef node = YGNodeNewWithConfig(config);
+      YGNodeStyleSetPadding(node, YGEdgeAll, 1);
+      YGNodeStyleSetFlexGrow(node, 1);
+      YGNodeStyleSetFlexDirection(node, depth % 2 == 0 ? YGFlexDirectionColumn
+                                                       : YGFlexDirectionRow);
+      YGAppendChild(parent, node);
+      parent = node;
+    }
+    YGAppendChild(parent, YGNewText(config, 5 + i % 7));
+  }
+  return root;
+}
+
+// One row of flexible children.
+static YGNodeRef YGBuildWide(const YGConfigRef config, const uint32_t scale) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+  for (uint32_t i = 0; i < 500 * scale; i++) {
+    const YGNodeRef child = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(child, 1 + (float)(i % 3));
+    YGNodeStyleSetFlexShrink(child, 1);
+    YGNodeStyleSetFlexBasis(child, 10 + (float)(i % 5));
+    YGNodeStyleSetMinWidth(child, 1);
+    YGNodeStyleSetHeight(child, 20);
+    YGAppendChild(root, child);
+  }
+  return root;
+}
+
+// Sections of wrapping cells, each with an image and a caption.
+static YGNodeRef YGBuildWrap(const YGConfigRef config, const uint32_t scale) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < 10; i++) {
+    const YGNodeRef section = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(section, YGFlexDirectionRow);
+    YGNodeStyleSetFlexWrap(section, YGWrapWrap);
+    YGNodeStyleSetAlignContent(section, YGAlignFlexStart);
+    for (uint32_t j = 0; j < 20 * scale; j++) {
+      const YGNodeRef cell = YGNodeNewWithConfig(config);
+      YGNodeStyleSetWidth(cell, 60 + (float)((i + j) % 4) * 15);
+      YGNodeStyleSetMargin(cell, YGEdgeAll, 4);
+      YGNodeStyleSetFlexGrow(cell, 1);
+      const YGNodeRef image = YGNodeNewWithConfig(config);
+      YGNodeStyleSetAspectRatio(image, 1);
+      YGAppendChild(cell, image);
+      YGAppendChild(cell, YGNewText(config, 4 + j % 13));
+      YGAppendChild(section, cell);
+    }
+    YGAppendChild(root, section);
+  }
+  return root;
+}
+
+// A feed of posts: an avatar next to a title, a body and a footer.
+static YGNodeRef YGBuildText(const YGConfigRef config, const uint32_t scale) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < 100 * scale; i++) {
+    const YGNodeRef post = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(post, YGFlexDirectionRow);
+    YGNodeStyleSetPadding(post, YGEdgeAll, 8);
+    const YGNodeRef avatar = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidth(avatar, 40);
+    YGNodeStyleSetHeight(avatar, 40);
+    YGAppendChild(post, avatar);
+    const YGNodeRef content = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(content, 1);
+    YGNodeStyleSetFlexShrink(content, 1);
+    YGNodeStyleSetMargin(content, YGEdgeLeft, 8);
+    YGAppendChild(content, YGNewText(config, 10 + i % 20));
+    YGAppendChild(content, YGNewText(config, 40 + (i * 37) % 300));
+    const YGNodeRef footer = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(footer, YGFlexDirectionRow);
+    YGNodeStyleSetJustifyContent(footer, YGJustifySpaceBetween);
+    YGAppendChild(footer, YGNewText(config, 6));
+    YGAppendChild(footer, YGNewText(config, 3 + i % 5));
+    YGAppendChild(content, footer);
+    YGAppendChild(post, content);
+    YGAppendChild(root, post);
+  }
+  return root;
+}
+
+// Cards covered by absolutely positioned overlays: a badge in a corner, a
+// dimming layer over the whole card and a progress bar along the bottom.
+static YGNodeRef YGBuildAbsolute(const YGConfigRef config,
+                                 const uint32_t scale) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+  YGNodeStyleSetFlexWrap(root, YGWrapWrap);
+  for (uint32_t i = 0; i < 100 * scale; i++) {
+    const YGNodeRef card = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidthPercent(card, 25);
+    YGNodeStyleSetPadding(card, YGEdgeAll, 6);
+    YGAppendChild(card, YGNewText(config, 8 + i % 30));
+    const YGNodeRef badge = YGNodeNewWithConfig(config);
+    YGNodeStyleSetPositionType(badge, YGPositionTypeAbsolute);
+    YGNodeStyleSetPosition(badge, YGEdgeTop, -4);
+    YGNodeStyleSetPosition(badge, YGEdgeRight, -4);
+    YGAppendChild(badge, YGNewText(config, 2));
+    YGAppendChild(card, badge);
+    const YGNodeRef dimming = YGNodeNewWithConfig(config);
+    YGNodeStyleSetPositionType(dimming, YGPositionTypeAbsolute);
+    YGNodeStyleSetPosition(dimming, YGEdgeAll, 0);
+    YGAppendChild(card, dimming);
+    const YGNodeRef progress = YGNodeNewWithConfig(config);
+    YGNodeStyleSetPositionType(progress, YGPositionTypeAbsolute);
+    YGNodeStyleSetPosition(progress, YGEdgeLeft, 0);
+    YGNodeStyleSetPosition(progress, YGEdgeBottom, 0);
+    YGNodeStyleSetWidthPercent(progress, (float)(i % 100));
+    YGNodeStyleSetHeight(progress, 2);
+    YGAppendChild(card, progress);
+    YGAppendChild(root, card);
+  }
+  return root;
+}
+
+// Forms whose fields are sized and spaced in percentages of the form.
+static YGNodeRef YGBuildPercentage(const YGConfigRef config,
+                                   const uint32_t scale) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeStyleSetPaddingPercent(root, YGEdgeHorizontal, 5);
+  for (uint32_t i = 0; i < 60 * scale; i++) {
+    const YGNodeRef field = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(field, YGFlexDirectionRow);
+    YGNodeStyleSetMarginPercent(field, YGEdgeVertical, 1);
+    YGNodeStyleSetPaddingPercent(field, YGEdgeAll, 2);
+    const YGNodeRef label = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidthPercent(label, 30);
+    YGNodeStyleSetMaxWidthPercent(label, 40);
+    YGAppendChild(label, YGNewText(config, 6 + i % 12));
+    YGAppendChild(field, label);
+    const YGNodeRef input = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(input, 1);
+    YGNodeStyleSetMinWidthPercent(input, 20);
+    YGNodeStyleSetMarginPercent(input, YGEdgeLeft, 3);
+    YGNodeStyleSetHeightPercent(input, 100);
+    YGAppendChild(field, input);
+    const YGNodeRef hint = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidthPercent(hint, 15);
+    YGNodeStyleSetPaddingPercent(hint, YGEdgeLeft, 1);
+    YGAppendChild(field, hint);
+    YGAppendChild(root, field);
+  }
+  return root;
+}
+
+// A new root width relays out the whole tree.
+static void YGResizeRoot(const YGNodeRef root, const uint32_t pass) {
+  YGNodeStyleSetWidth(root, 1000 + (float)pass);
+}
+
+// Dirties one text of the feed, a different one every pass.
+static void YGDirtyLeaf(const YGNodeRef root, const uint32_t pass) {
+  YGNodeRef node = root;
+  for (uint32_t level = 0; YGNodeGetChildCount(node) > 0; level++) {
+    const uint32_t childCount = YGNodeGetChildCount(node);
+    node = YGNodeGetChild(node, (pass * 7919 + level) % childCount);
+  }
+  if (YGNodeGetMeasureFunc(node) != NULL) {
+    YGNodeMarkDirty(node);
+  } else {
+    YGNodeStyleSetWidth(node, 40 + (float)(pass % 2));
+  }
+}
+
+typedef struct YGScenario {
+  const char *name;
+  YGNodeRef (*build)(const YGConfigRef config, const uint32_t scale);
+  // Called before every timed pass.
+  void (*invalidate)(const YGNodeRef root, const uint32_t pass);
+} YGScenario;
+
+static double YGRatio(const uint64_t part, const uint64_t total) {
+  return total > 0 ? (double)part / total : 0;
+}
+
+static void YGRunScenario(const YGScenario *scenario, const uint32_t scale,
+                          const uint32_t passes, const bool first) {
+  const YGConfigRef config = YGConfigNew();
+  gAllocationCount = 0;
+  const double buildStart = YGNow();
+  const YGNodeRef root = scenario->build(config, scale);
+  const double buildTime = YGNow() - buildStart;
+  const size_t buildAllocations = gAllocationCount;
+  const uint32_t nodes = YGCountNodes(root);
+
+  YGResizeRoot(root, 0);
+  gAllocationCount = 0;
+  const double firstStart = YGNow();
+  YGNodeCalculateLayout(root, YGUndefined, YGUndefined, YGDirectionLTR);
+  const double firstTime = YGNow() - firstStart;
+  const size_t firstAllocations = gAllocationCount;
+
+  YGLayoutStats total = {0};
+  double best = 0;
+  double sum = 0;
+  gAllocationCount = 0;
+  for (uint32_t pass = 1; pass <= passes; pass++) {
+    scenario->invalidate(root, pass);
+    YGLayoutStats stats;
+    const double start = YGNow();
+    YGNodeCalculateLayoutWithStats(root, YGUndefined, YGUndefined,
+                                   YGDirectionLTR, &stats);
+    const double time = YGNow() - start;
+    best = pass == 1 || time < best ? time : best;
+    sum += time;
+    total.nodesVisited += stats.nodesVisited;
+    total.cachedLayoutHits += stats.cachedLayoutHits;
+    total.cachedLayoutMisses += stats.cachedLayoutMisses;
+    total.cachedMeasurementHits += stats.cachedMeasurementHits;
+    total.cachedMeasurementMisses += stats.cachedMeasurementMisses;
+    total.measureFuncCalls += stats.measureFuncCalls;
+  }
+  const size_t passAllocations = gAllocationCount;
+
+  const double freeStart = YGNow();
+  YGNodeFreeRecursive(root);
+  const double freeTime = YGNow() - freeStart;
+  YGConfigFree(config);
+
+  printf("%s\n    {\"name\": \"%s\", \"nodes\": %u, "
+         "\"buildNsPerNode\": %.1f, \"buildAllocationsPerNode\": %.2f, "
+         "\"firstLayoutNsPerNode\": %.1f, \"firstLayoutAllocations\": %zu, "
+         "\"layoutNsPerNode\": %.1f, \"meanLayoutNsPerNode\": %.1f, "
+         "\"allocationsPerLayout\": %.1f, \"nodesVisitedPerLayout\": %.1f, "
+         "\"measureCallsPerLayout\": %.1f, \"layoutCacheHitRate\": %.3f, "
+         "\"measurementCacheHitRate\": %.3f, \"freeNsPerNode\": %.1f}",
+         first ? "" : ",", scenario->name, nodes, buildTime / nodes,
+         YGRatio(buildAllocations, nodes), firstTime / nodes, firstAllocations,
+         best / nodes, sum / passes / nodes,
+         YGRatio(passAllocations, passes),
+         YGRatio(total.nodesVisited, passes),
+         YGRatio(total.measureFuncCalls, passes),
+         YGRatio(total.cachedLayoutHits,
+                 total.cachedLayoutHits + total.cachedLayoutMisses),
+         YGRatio(total.cachedMeasurementHits,
+                 total.cachedMeasurementHits + total.cachedMeasurementMisses),
+         freeTime / nodes);
+}
+
+static YGNodeRef YGNewItem(const YGConfigRef config) {
+  const YGNodeRef item = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexGrow(item, 1);
+  YGNodeStyleSetHeight(item, 10);
+  return item;
+}
+
+// Edits of one container with `count` children, in ns per child.
+static void YGRunChildSweep(const uint32_t count, const bool first) {
+  const YGConfigRef config = YGConfigNew();
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(root, YGFlexDirectionRow);
+  YGNodeStyleSetWidth(root, 1000);
+
+  double start = YGNow();
+  for (uint32_t i = 0; i < count; i++) {
+    YGAppendChild(root, YGNewItem(config));
+  }
+  const double append = YGNow() - start;
+
+  start = YGNow();
+  YGNodeCalculateLayout(root, YGUndefined, YGUndefined, YGDirectionLTR);
+  const double layout = YGNow() - start;
+
+  // Removes each child from the middle of those left, then from the end.
+  start = YGNow();
+  for (uint32_t left = count; left > count / 2; left--) {
+    const YGNodeRef child = YGNodeGetChild(root, left / 2);
+    YGNodeRemoveChild(root, child);
+    YGNodeFree(child);
+  }
+  for (uint32_t left = YGNodeGetChildCount(root); left > 0; left--) {
+    const YGNodeRef child = YGNodeGetChild(root, left - 1);
+    YGNodeRemoveChild(root, child);
+    YGNodeFree(child);
+  }
+  const double remove = YGNow() - start;
+
+  start = YGNow();
+  for (uint32_t i = 0; i < count; i++) {
+    YGNodeInsertChild(root, YGNewItem(config), 0);
+  }
+  const double prepend = YGNow() - start;
+
+  start = YGNow();
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef child = YGNodeGetChild(root, 0);
+    YGNodeRemoveChild(root, child);
+    YGNodeFree(child);
+  }
+  const double removeFirst = YGNow() - start;
+
+  for (uint32_t i = 0; i < count; i++) {
+    YGAppendChild(root, YGNewItem(config));
+  }
+  start = YGNow();
+  YGNodeFreeRecursive(root);
+  const double freeTime = YGNow() - start;
+  YGConfigFree(config);
+
+  printf("%s\n      {\"children\": %u, \"appendNsPerChild\": %.1f, "
+         "\"prependNsPerChild\": %.1f, \"removeNsPerChild\": %.1f, "
+         "\"removeFirstNsPerChild\": %.1f, \"layoutNsPerChild\": %.1f, "
+         "\"freeRecursiveNsPerChild\": %.1f}",
+         first ? "" : ",", count, append / count, prepend / count,
+         remove / count, removeFirst / count, layout / count,
+         freeTime / count);
+}
+
+// A chain `depth` levels deep, ending in a text, in ns per level.
+static void YGRunDepthSweep(const uint32_t depth, const bool first) {
+  const YGConfigRef config = YGConfigNew();
+  double start = YGNow();
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeRef parent = root;
+  for (uint32_t i = 1; i < depth; i++) {
+    const YGNodeRef node = YGNodeNewWithConfig(config);
+    YGNodeStyleSetPadding(node, YGEdgeLeft, 1);
+    YGAppendChild(parent, node);
+    parent = node;
+  }
+  const YGNodeRef leaf = YGNewText(config, 12);
+  YGAppendChild(parent, leaf);
+  const double build = YGNow() - start;
+
+  start = YGNow();
+  YGNodeCalculateLayout(root, 1000, YGUndefined, YGDirectionLTR);
+  const double layout = YGNow() - start;
+
+  // Dirtying the leaf dirties the whole chain above it.
+  YGNodeMarkDirty(leaf);
+  start = YGNow();
+  YGNodeCalculateLayout(root, 1000, YGUndefined, YGDirectionLTR);
+  const double relayout = YGNow() - start;
+
+  start = YGNow();
+  YGNodeFreeRecursive(root);
+  const double freeTime = YGNow() - start;
+  YGConfigFree(config);
+
+  printf("%s\n      {\"depth\": %u, \"buildNsPerLevel\": %.1f, "
+         "\"layoutNsPerLevel\": %.1f, \"leafRelayoutNsPerLevel\": %.1f, "
+         "\"freeRecursiveNsPerLevel\": %.1f}",
+         first ? "" : ",", depth, build / (depth + 1), layout / (depth + 1),
+         relayout / (depth + 1), freeTime / (depth + 1));
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t scale = argc > 1 ? (uint32_t)atoi(argv[1]) : 4;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 20;
+  YGSetMemoryFuncs(&YGCountingMalloc, &YGCountingCalloc, &YGCountingRealloc,
+                   &YGCountingFree);
+
+  const YGScenario scenarios[] = {
+      {"deep", &YGBuildDeep, &YGResizeRoot},
+      {"wide", &YGBuildWide, &YGResizeRoot},
+      {"wrap", &YGBuildWrap, &YGResizeRoot},
+      {"text", &YGBuildText, &YGResizeRoot},
+      {"absolute", &YGBuildAbsolute, &YGResizeRoot},
+      {"percentage", &YGBuildPercentage, &YGResizeRoot},
+      {"incremental", &YGBuildText, &YGDirtyLeaf},
+  };
+  printf("{\n  \"scale\": %u,\n  \"passes\": %u,\n  \"scenarios\": [", scale,
+         passes);
+  for (uint32_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+    YGRunScenario(&scenarios[i], scale, passes, i == 0);
+  }
+
+  printf("\n  ],\n  \"sweeps\": {\n    \"children\": [");
+  for (uint32_t count = 256, i = 0; i < 5; count *= 4, i++) {
+    YGRunChildSweep(count * scale, i == 0);
+  }
+  // Layout recurses once per level, so the chain stays within a thread stack.
+  printf("\n    ],\n    \"depth\": [");
+  for (uint32_t depth = 16, i = 0; i < 4; depth *= 4, i++) {
+    YGRunDepthSweep(depth, i == 0);
+  }
+  printf("\n    ]\n  }\n}\n");
+}
@@ -0,0 +1,343 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Edits one label of a feed at a time and applies the new layout to a view
+// per node, from the recorded layout changes and by walking the whole tree,
+// and reports the changes per edit and the time per edit of each. The test
+// checks that the views updated from the changes end up with the frames of
+// their nodes, also after edits that hide a row, remove one or go through
+// relayout boundaries, that an edit that keeps the size of its label only
+// changes a few frames, and that freeing an arena drops the changes of its
+// nodes.
+//
+//   YGLayoutChangeBenchmark [rowCount] [edits]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+// What a renderer keeps for a node: the frame it shows, and the length of its
+// text for labels.
+typedef struct YGView {
+  YGFrame frame;
+  uint32_t length;
+} YGView;
+
+static YGSize YGMeasureLabel(YGNodeRef node, float width,
+                             YGMeasureMode widthMode, float height,
+                             YGMeasureMode heightMode) {
+  const YGView *const view = YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(7 * (float)view->length, 16.5f, width, widthMode,
+                              height, heightMode);
+}
+
+static YGNodeRef YGNewView(const YGConfigRef config) {
+  const YGNodeRef node = YGNodeNewWithConfig(config);
+  YGNodeSetContext(node, calloc(1, sizeof(YGView)));
+  return node;
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNewView(config);
+  ((YGView *)YGNodeGetContext(text))->length = length;
+  YGNodeSetMeasureFunc(text, YGMeasureLabel);
+  return text;
+}
+
+static void YGFreeViews(const YGNodeRef node) {
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    YGFreeViews(YGNodeGetChild(node, i));
+  }
+  free(YGNodeGetContext(node));
+}
+
+// A row of the feed: an avatar, a column of a title and a body, and a badge.
+// Every third row has a fixed height.
+static YGNodeRef YGBuildRow(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef row = YGNewView(config);
+  YGNodeStyleSetFlexDirection(row, YGFlexDirectionRow);
+  YGNodeStyleSetPadding(row, YGEdgeAll, 10.5f);
+  YGNodeStyleSetWidth(row, 375);
+  if (index % 3 == 0) {
+    YGNodeStyleSetHeight(row, 96);
+  }
+
+  const YGNodeRef avatar = YGNewView(config);
+  YGNodeStyleSetWidth(avatar, 40);
+  YGNodeStyleSetHeight(avatar, 40);
+  YGNodeStyleSetMargin(avatar, YGEdgeEnd, 12);
+  YGAppendChild(row, avatar);
+
+  const YGNodeRef texts = YGNewView(config);
+  YGNodeStyleSetFlexShrink(texts, 1);
+  YGNodeStyleSetAlignItems(texts, YGAlignFlexStart);
+  YGAppendChild(texts, YGNewText(config, 8 + index % 12));
+  const YGNodeRef body = YGNewText(config, 20 + (index * 37) % 60);
+  YGNodeStyleSetMargin(body, YGEdgeTop, 4);
+  YGAppendChild(texts, body);
+  YGAppendChild(row, texts);
+
+  const YGNodeRef badge = YGNewView(config);
+  YGNodeStyleSetPadding(badge, YGEdgeAll, 4);
+  YGNodeStyleSetMargin(badge, YGEdgeStart, 8);
+  YGAppendChild(badge, YGNewText(config, 1 + index % 3));
+  YGAppendChild(row, badge);
+  return row;
+}
+
+static YGNodeRef YGBuildFeed(const YGConfigRef config,
+                             const uint32_t rowCount) {
+  const YGNodeRef feed = YGNewView(config);
+  for (uint32_t i = 0; i < rowCount; i++) {
+    YGAppendChild(feed, YGBuildRow(config, i));
+  }
+  return feed;
+}
+
+static YGFrame YGNodeGetFrame(const YGNodeRef node) {
+  return (YGFrame){
+      .left = YGNodeLayoutGetLeft(node),
+      .top = YGNodeLayoutGetTop(node),
+      .width = YGNodeLayoutGetWidth(node),
+      .height = YGNodeLayoutGetHeight(node),
+  };
+}
+
+static bool YGFramesEqual(const YGFrame a, const YGFrame b) {
+  return a.left == b.left && a.top == b.top && a.width == b.width &&
+         a.height == b.height;
+}
+
+// Sets the frame of every view whose node changed, and returns the number of
+// changes, which it clears.
+static uint32_t YGApplyChanges(const YGConfigRef config) {
+  uint32_t count = 0;
+  const YGLayoutChange *const changes =
+      YGConfigGetLayoutChanges(config, &count);
+  for (uint32_t i = 0; i < count; i++) {
+    YGView *const view = YGNodeGetContext(changes[i].node);
+    view->frame = changes[i].newFrame;
+  }
+  YGConfigClearLayoutChanges(config);
+  return count;
+}
+
+// What a renderer does without the changes: compares the frame of every view
+// with that of its node.
+static uint32_t YGApplyTree(const YGNodeRef node) {
+  YGView *const view = YGNodeGetContext(node);
+  const YGFrame frame = YGNodeGetFrame(node);
+  uint32_t count = 0;
+  if (!YGFramesEqual(view->frame, frame)) {
+    view->frame = frame;
+    count++;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    count += YGApplyTree(YGNodeGetChild(node, i));
+  }
+  return count;
+}
+
+// Whether every view shows the frame of its node.
+static bool YGViewsMatch(const YGNodeRef node) {
+  const YGView *const view = YGNodeGetContext(node);
+  if (!YGFramesEqual(view->frame, YGNodeGetFrame(node))) {
+    return false;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    if (!YGViewsMatch(YGNodeGetChild(node, i))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static YGNodeRef YGTitleAt(const YGNodeRef feed, const uint32_t row) {
+  return YGNodeGetChild(YGNodeGetChild(YGNodeGetChild(feed, row), 1), 0);
+}
+
+// The title of the first row of a fixed height from `row` on.
+static YGNodeRef YGFixedTitleFrom(const YGNodeRef feed, uint32_t row) {
+  while (YGNodeStyleGetHeight(YGNodeGetChild(feed, row)).unit != YGUnitPoint) {
+    row++;
+  }
+  return YGTitleAt(feed, row);
+}
+
+static void YGSetText(const YGNodeRef text, const uint32_t length) {
+  ((YGView *)YGNodeGetContext(text))->length = length;
+  YGNodeMarkDirty(text);
+}
+
+static bool YGCheckEdits(const YGNodeRef feed, const YGConfigRef config,
+                         const uint32_t rowCount) {
+  bool ok = true;
+
+  // A title of a fixed height row that keeps its size moves nothing else.
+  YGSetText(YGFixedTitleFrom(feed, 3), 9);
+  YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+  const uint32_t changes = YGApplyChanges(config);
+  ok &= YGCheck(changes == 1 && YGViewsMatch(feed),
+                "change the frame of a label alone");
+
+  // A body growing by a line moves the rows below.
+  const YGNodeRef body =
+      YGNodeGetChild(YGNodeGetChild(YGNodeGetChild(feed, 1), 1), 1);
+  YGSetText(body, 200);
+  YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+  ok &= YGCheck(YGApplyChanges(config) >= rowCount - 2 && YGViewsMatch(feed),
+                "change the frames of the rows below a grown label");
+
+  // Hidden rows are zeroed out, down to their labels, and shown again.
+  const YGNodeRef hidden = YGNodeGetChild(feed, 2);
+  for (uint32_t i = 0; i < 2; i++) {
+    YGNodeStyleSetDisplay(hidden, i == 0 ? YGDisplayNone : YGDisplayFlex);
+    YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+    YGApplyChanges(config);
+    ok &= YGCheck(YGViewsMatch(feed), "change the frames of a hidden row");
+  }
+
+  // Rows edited twice, then removed and freed before their changes are
+  // applied. The entries of the first are taken out before the second is.
+  for (uint32_t i = 0; i < 2; i++) {
+    const YGNodeRef removed = YGNodeGetChild(feed, 4);
+    for (uint32_t length = 30; length <= 90; length += 60) {
+      YGSetText(YGTitleAt(feed, 4), length);
+      YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+    }
+    YGNodeRemoveChild(feed, removed);
+    YGFreeViews(removed);
+    YGNodeFreeRecursive(removed);
+    YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+    uint32_t count;
+    YGConfigGetLayoutChanges(config, &count);
+  }
+  YGApplyChanges(config);
+  ok &= YGCheck(YGViewsMatch(feed), "drop the changes of freed rows");
+
+  // A fixed height row is a relayout boundary.
+  YGConfigSetUseRelayoutBoundaries(config, true);
+  YGNodeCalculateLayout(feed, 320, YGUndefined, YGDirectionLTR);
+  YGApplyChanges(config);
+  YGSetText(YGFixedTitleFrom(feed, 6), 14);
+  YGNodeCalculateDirtyLayouts(feed);
+  ok &= YGCheck(YGApplyChanges(config) == 1 && YGViewsMatch(feed),
+                "change the frame of a label within a relayout boundary");
+  YGConfigSetUseRelayoutBoundaries(config, false);
+
+  // The roots of a batch record their changes too.
+  const YGSize constraints = {.width = 375, .height = YGUndefined};
+  YGNodeCalculateLayoutBatch(&feed, &constraints, 1, NULL);
+  YGApplyChanges(config);
+  ok &= YGCheck(YGViewsMatch(feed), "change the frames of a batch");
+  return ok;
+}
+
+static YGConfigRef YGNewFeedConfig(void) {
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetPointScaleFactor(config, 2);
+  YGConfigSetRecordLayoutChanges(config, true);
+  return config;
+}
+
+// Edits the title of a fixed height row at a time, and applies the layout
+// from the changes, or by walking the tree with the changes thrown away.
+// Returns the number of frames changed.
+static uint64_t YGEditTitles(const YGNodeRef feed, const YGConfigRef config,
+                             const uint32_t rowCount, const uint32_t edits,
+                             double *const changesTime,
+                             double *const treeTime) {
+  uint64_t changeCount = 0;
+  for (uint32_t i = 0; i < edits; i++) {
+    YGSetText(YGFixedTitleFrom(feed, (i * 7) % (rowCount - 8)), 6 + i % 7);
+    YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+    if (i % 2 == 0) {
+      const double start = YGNow();
+      changeCount += YGApplyChanges(config);
+      *changesTime += YGNow() - start;
+    } else {
+      YGConfigClearLayoutChanges(config);
+      const double start = YGNow();
+      changeCount += YGApplyTree(feed);
+      *treeTime += YGNow() - start;
+    }
+  }
+  return changeCount;
+}
+
+static void YGFreeFeed(const YGNodeRef feed, const YGConfigRef config) {
+  YGFreeViews(feed);
+  YGNodeFreeRecursive(feed);
+  YGConfigFree(config);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t rowCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 1000;
+  const uint32_t edits = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+  const YGConfigRef config = YGNewFeedConfig();
+
+  const YGNodeRef feed = YGBuildFeed(config, rowCount);
+  YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+  const uint32_t nodeCount = YGCountNodes(feed);
+  YGApplyChanges(config);
+
+  double changesTime = 0;
+  double treeTime = 0;
+  const uint64_t changeCount =
+      YGEditTitles(feed, config, rowCount, edits, &changesTime, &treeTime);
+  printf("nodes=%u changes=%.1f/edit tree=%.2fus/edit changes=%.2fus/edit "
+         "(%.0fx)\n",
+         nodeCount, (double)changeCount / edits, treeTime * 1e3 / (edits / 2),
+         changesTime * 1e3 / (edits - edits / 2), treeTime / changesTime);
+
+  YGFreeFeed(feed, config);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t rowCount = 100;
+  const YGConfigRef config = YGNewFeedConfig();
+  bool ok = true;
+
+  const YGNodeRef feed = YGBuildFeed(config, rowCount);
+  YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+  ok &= YGCheck(YGApplyChanges(config) == YGCountNodes(feed) &&
+                    YGViewsMatch(feed),
+                "change the frame of every node laid out first");
+  ok &= YGCheck(YGCheckEdits(feed, config, rowCount), "apply the edits");
+
+  double changesTime = 0;
+  double treeTime = 0;
+  YGEditTitles(feed, config, rowCount, 40, &changesTime, &treeTime);
+  ok &= YGCheck(YGViewsMatch(feed), "apply the edited titles");
+
+  // Rows allocated in an arena but laid out with the config of the feed. Their
+  // changes go away with the arena, before they are applied.
+  const YGArenaRef arena = YGArenaNew(0);
+  const YGNodeRef list = YGNodeNewInArena(arena, config);
+  for (uint32_t i = 0; i < 4; i++) {
+    const YGNodeRef row = YGNodeNewInArena(arena, config);
+    YGNodeStyleSetHeight(row, 40);
+    YGAppendChild(list, row);
+  }
+  YGNodeCalculateLayout(list, 375, YGUndefined, YGDirectionLTR);
+  YGArenaFree(arena);
+  YGSetText(YGTitleAt(feed, 0), 30);
+  YGNodeCalculateLayout(feed, 375, YGUndefined, YGDirectionLTR);
+  ok &= YGCheck(YGApplyChanges(config) > 0 && YGViewsMatch(feed),
+                "drop the changes of the nodes of a freed arena");
+
+  YGFreeFeed(feed, config);
+  return ok;
+}
@@ -0,0 +1,262 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out a corpus of random trees with the flex line loops specialized per
+// container and with the generic ones, and reports the time per node of each.
+// The trees mix rows and columns, reversed and wrapping lines, absolute and
+// hidden children, auto margins, aspect ratios and baselines. The test checks
+// that every tree lays out to the same frames both ways, also after an edit.
+//
+//   YGLayoutKernelBenchmark [treeCount] [passes]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+static uint32_t YGRandom(uint32_t *const seed, const uint32_t bound) {
+  *seed = *seed * 1103515245 + 12345;
+  return (*seed >> 16) % bound;
+}
+
+static bool YGChance(uint32_t *const seed, const uint32_t percent) {
+  return YGRandom(seed, 100) < percent;
+}
+
+static float YGTextBaseline(YGNodeRef node, float width, float height) {
+  (void)node;
+  (void)width;
+  (void)height;
+  return 12;
+}
+
+static void YGSetRandomStyle(const YGNodeRef node, uint32_t *const seed) {
+  if (YGChance(seed, 50)) {
+    YGNodeStyleSetFlexDirection(node, (YGFlexDirection)YGRandom(seed, 4));
+  }
+  if (YGChance(seed, 20)) {
+    YGNodeStyleSetFlexWrap(node, (YGWrap)YGRandom(seed, 3));
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetJustifyContent(node, (YGJustify)YGRandom(seed, 5));
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetAlignItems(node, (YGAlign)YGRandom(seed, 6));
+  }
+  if (YGChance(seed, 15)) {
+    YGNodeStyleSetAlignSelf(node, (YGAlign)YGRandom(seed, 6));
+  }
+  if (YGChance(seed, 15)) {
+    YGNodeStyleSetAlignContent(node, (YGAlign)YGRandom(seed, 8));
+  }
+  if (YGChance(seed, 8)) {
+    YGNodeStyleSetPositionType(node, YGPositionTypeAbsolute);
+    YGNodeStyleSetPosition(node, (YGEdge)YGRandom(seed, 4), YGRandom(seed, 40));
+  }
+  if (YGChance(seed, 4)) {
+    YGNodeStyleSetDisplay(node, YGDisplayNone);
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetFlexGrow(node, YGRandom(seed, 3));
+  }
+  if (YGChance(seed, 20)) {
+    YGNodeStyleSetFlexShrink(node, YGRandom(seed, 3));
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetWidth(node, 10 + YGRandom(seed, 150));
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetHeight(node, 10 + YGRandom(seed, 150));
+  }
+  if (YGChance(seed, 10)) {
+    YGNodeStyleSetMinWidth(node, YGRandom(seed, 60));
+  }
+  if (YGChance(seed, 10)) {
+    YGNodeStyleSetMaxHeight(node, 40 + YGRandom(seed, 200));
+  }
+  if (YGChance(seed, 6)) {
+    YGNodeStyleSetAspectRatio(node, 0.5f + YGRandom(seed, 20) / 8.0f);
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetPadding(node, (YGEdge)YGRandom(seed, YGEdgeCount),
+                          YGRandom(seed, 16));
+  }
+  if (YGChance(seed, 30)) {
+    YGNodeStyleSetMargin(node, (YGEdge)YGRandom(seed, YGEdgeCount),
+                         YGRandom(seed, 16));
+  }
+  if (YGChance(seed, 8)) {
+    YGNodeStyleSetMarginAuto(node, (YGEdge)YGRandom(seed, YGEdgeCount));
+  }
+}
+
+static YGNodeRef YGBuildTree(const YGConfigRef config, uint32_t *const seed,
+                             const uint32_t depth) {
+  const YGNodeRef node = YGNodeNewWithConfig(config);
+  YGSetRandomStyle(node, seed);
+  const uint32_t childCount = depth == 0 ? 0 : YGRandom(seed, 7);
+  if (childCount == 0) {
+    YGNodeSetContext(node, (void *)(uintptr_t)(1 + YGRandom(seed, 40)));
+    YGNodeSetMeasureFunc(node, YGMeasureText);
+    if (YGChance(seed, 30)) {
+      YGNodeSetBaselineFunc(node, YGTextBaseline);
+    }
+  }
+  for (uint32_t i = 0; i < childCount; i++) {
+    YGNodeInsertChild(node, YGBuildTree(config, seed, depth - 1), i);
+  }
+  return node;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[6] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetRight(node),
+      YGNodeLayoutGetBottom(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[6];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 6; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  hash = (hash ^ YGNodeLayoutGetHadOverflow(node)) * 1099511628211ull;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+// Lays out every tree at `width`, which differs from the last pass so that
+// all of it is laid out again, and returns the time in milliseconds.
+static double YGTimeCorpus(YGNodeRef *const trees, const uint32_t treeCount,
+                           const float width) {
+  const double start = YGNow();
+  for (uint32_t i = 0; i < treeCount; i++) {
+    YGNodeCalculateLayout(trees[i], width, YGUndefined, YGDirectionLTR);
+  }
+  return YGNow() - start;
+}
+
+// Builds tree `index` of the corpus with the specialized and with the generic
+// loops, lays both out, edits the style of the first child, which may change
+// the variant of the root, and lays them out again. Returns whether both came
+// out the same every time.
+static bool YGBuildPair(const YGConfigRef config, const YGConfigRef generic,
+                        const uint32_t index, YGNodeRef *const tree,
+                        YGNodeRef *const reference) {
+  uint32_t seed = index + 1;
+  const YGNodeRef a = YGBuildTree(config, &seed, 2 + index % 4);
+  seed = index + 1;
+  const YGNodeRef b = YGBuildTree(generic, &seed, 2 + index % 4);
+  *tree = a;
+  *reference = b;
+
+  const YGDirection direction =
+      index % 3 == 0 ? YGDirectionRTL : YGDirectionLTR;
+  const float height = index % 2 == 0 ? YGUndefined : 480;
+  YGNodeCalculateLayout(a, 375, height, direction);
+  YGNodeCalculateLayout(b, 375, height, direction);
+  bool same = YGHashLayout(a, 0) == YGHashLayout(b, 0);
+  if (YGNodeGetChildCount(a) > 0) {
+    seed = index + 7;
+    YGSetRandomStyle(YGNodeGetChild(a, 0), &seed);
+    seed = index + 7;
+    YGSetRandomStyle(YGNodeGetChild(b, 0), &seed);
+    YGNodeStyleSetFlexWrap(a, YGWrapWrap);
+    YGNodeStyleSetFlexWrap(b, YGWrapWrap);
+    YGNodeCalculateLayout(a, 320, height, direction);
+    YGNodeCalculateLayout(b, 320, height, direction);
+    same &= YGHashLayout(a, 0) == YGHashLayout(b, 0);
+  }
+  return same;
+}
+
+static void YGFreeCorpus(YGNodeRef *const trees, const uint32_t treeCount) {
+  for (uint32_t i = 0; i < treeCount; i++) {
+    YGNodeFreeRecursive(trees[i]);
+  }
+  free(trees);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t treeCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 10;
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef generic = YGConfigNew();
+  YGConfigSetUseGenericLayoutKernels(generic, true);
+
+  YGNodeRef *const trees = malloc(sizeof(YGNodeRef) * treeCount);
+  YGNodeRef *const references = malloc(sizeof(YGNodeRef) * treeCount);
+  uint32_t nodeCount = 0;
+  for (uint32_t i = 0; i < treeCount; i++) {
+    YGBuildPair(config, generic, i, &trees[i], &references[i]);
+    nodeCount += YGCountNodes(trees[i]);
+  }
+
+  // The passes alternate between the two corpora so that both see the same
+  // state of the machine, and the best of each is kept.
+  double genericTime = 0;
+  double specializedTime = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    const float width = i % 2 == 0 ? 360 : 375;
+    const double genericPass = YGTimeCorpus(references, treeCount, width);
+    const double specializedPass = YGTimeCorpus(trees, treeCount, width);
+    genericTime =
+        i == 0 || genericPass < genericTime ? genericPass : genericTime;
+    specializedTime =
+        i == 0 || specializedPass < specializedTime ? specializedPass
+                                                   : specializedTime;
+  }
+
+  printf("trees=%u nodes=%u generic=%.1fns/node specialized=%.1fns/node "
+         "(%.2fx)\n",
+         treeCount, nodeCount, genericTime * 1e6 / nodeCount,
+         specializedTime * 1e6 / nodeCount, genericTime / specializedTime);
+
+  YGFreeCorpus(trees, treeCount);
+  YGFreeCorpus(references, treeCount);
+  YGConfigFree(generic);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t treeCount = 500;
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef generic = YGConfigNew();
+  YGConfigSetUseGenericLayoutKernels(generic, true);
+
+  YGNodeRef *const trees = malloc(sizeof(YGNodeRef) * treeCount);
+  YGNodeRef *const references = malloc(sizeof(YGNodeRef) * treeCount);
+  uint32_t mismatches = 0;
+  for (uint32_t i = 0; i < treeCount; i++) {
+    mismatches +=
+        YGBuildPair(config, generic, i, &trees[i], &references[i]) ? 0 : 1;
+  }
+  bool ok =
+      YGCheck(mismatches == 0, "lay out the corpus like the generic loops");
+
+  YGTimeCorpus(references, treeCount, 360);
+  YGTimeCorpus(trees, treeCount, 360);
+  for (uint32_t i = 0; i < treeCount; i++) {
+    ok &= YGCheck(YGHashLayout(trees[i], 0) == YGHashLayout(references[i], 0),
+                  "lay out the corpus like the generic loops at a new width");
+  }
+
+  YGFreeCorpus(trees, treeCount);
+  YGFreeCorpus(references, treeCount);
+  YGConfigFree(generic);
+  YGConfigFree(config);
+  return ok;
+}
@@ -0,0 +1,242 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Rebuilds a feed of text cells every frame, the way a reconciler recreates
+// its nodes, and compares the measure calls and layout time without a measure
+// cache against caches of different budgets. The threaded scenario lays the
+// cells out with YGNodeCalculateLayoutBatch, sharing one cache. The test checks
+// every frame against the layout of the same feed without a cache.
+//
+//   YGMeasureCacheBenchmark [cellCount] [frameCount]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+// Distinct strings shown by the feed. Cells pick from them, so consecutive
+// frames show mostly the same content.
+#define YG_STRING_COUNT 512
+
+static char gStrings[YG_STRING_COUNT][160];
+static uint64_t gFingerprints[YG_STRING_COUNT];
+static int32_t gMeasureCount = 0;
+
+// Advance of a glyph after kerning against the previous one. Stands in for the
+// work of shaping, which dominates real text measurement.
+static float YGGlyphAdvance(const char c, const char previous) {
+  uint32_t state = (uint32_t)(uint8_t)c << 8 | (uint8_t)previous;
+  for (uint32_t i = 0; i < 64; i++) {
+    state = state * 1664525 + 1013904223;
+  }
+  return 6 + (float)(c % 5) + (state >> 30) * 0.25f;
+}
+
+// Lays the string out in lines of glyphs.
+static YGSize YGMeasureGlyphs(YGNodeRef node, float width,
+                              YGMeasureMode widthMode, float height,
+                              YGMeasureMode heightMode) {
+  __atomic_add_fetch(&gMeasureCount, 1, __ATOMIC_RELAXED);
+  const char *const string = gStrings[(uintptr_t)YGNodeGetContext(node)];
+  const float maxWidth = widthMode == YGMeasureModeUndefined ? 1e9f : width;
+  float lineWidth = 0;
+  float widest = 0;
+  uint32_t lines = 1;
+  char previous = ' ';
+  for (const char *c = string; *c != '\0'; previous = *c++) {
+    const float advance = YGGlyphAdvance(*c, previous);
+    if (lineWidth + advance > maxWidth && lineWidth > 0) {
+      lines++;
+      lineWidth = 0;
+    }
+    lineWidth += advance;
+    widest = lineWidth > widest ? lineWidth : widest;
+  }
+  return (YGSize){
+      .width = widest,
+      .height = heightMode == YGMeasureModeExactly ? height : 16.0f * lines,
+  };
+}
+
+static void YGMakeStrings(void) {
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < YG_STRING_COUNT; i++) {
+    seed = seed * 1103515245 + 12345;
+    const uint32_t length = 20 + (seed >> 16) % 120;
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t j = 0; j < length; j++) {
+      seed = seed * 1103515245 + 12345;
+      gStrings[i][j] = (seed >> 16) % 6 == 0 ? ' ' : 'a' + (seed >> 16) % 26;
+      hash = (hash ^ (uint8_t)gStrings[i][j]) * 1099511628211ull;
+    }
+    gStrings[i][length] = '\0';
+    gFingerprints[i] = hash;
+  }
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t string) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)string);
+  YGNodeSetMeasureFunc(text, YGMeasureGlyphs);
+  YGNodeSetMeasureFingerprint(text, gFingerprints[string]);
+  YGNodeStyleSetFlexShrink(text, 1);
+  return text;
+}
+
+// An avatar next to a title, a body and a timestamp.
+static YGNodeRef YGBuildCell(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef cell = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(cell, YGFlexDirectionRow);
+  YGNodeStyleSetPadding(cell, YGEdgeAll, 12);
+  const YGNodeRef avatar = YGNodeNewWithConfig(config);
+  YGNodeStyleSetWidth(avatar, 40);
+  YGNodeStyleSetHeight(avatar, 40);
+  YGNodeStyleSetMargin(avatar, YGEdgeRight, 8);
+  YGAppendChild(cell, avatar);
+  const YGNodeRef content = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexGrow(content, 1);
+  YGNodeStyleSetFlexShrink(content, 1);
+  YGAppendChild(content, YGNewText(config, index % 64));
+  YGAppendChild(content, YGNewText(config, (index * 7) % YG_STRING_COUNT));
+  YGAppendChild(cell, content);
+  const YGNodeRef time = YGNewText(config, index % 12);
+  YGNodeStyleSetAlignSelf(time, YGAlignFlexStart);
+  YGAppendChild(cell, time);
+  return cell;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[4] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[4];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 4; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+// Lays out the cells of one frame, scrolled by `frame` cells, and returns the
+// hash of their layouts. The cells are freed again.
+static uint64_t YGLayoutFrame(const YGConfigRef config, const uint32_t count,
+                              const uint32_t frame, const YGThreadPoolRef pool,
+                              double *const time) {
+  YGNodeRef *const cells = malloc(sizeof(YGNodeRef) * count);
+  YGSize *const constraints = malloc(sizeof(YGSize) * count);
+  for (uint32_t i = 0; i < count; i++) {
+    cells[i] = YGBuildCell(config, frame + i);
+    constraints[i] = (YGSize){.width = 375, .height = YGUndefined};
+  }
+  const double start = YGNow();
+  YGNodeCalculateLayoutBatch(cells, constraints, count, pool);
+  *time += YGNow() - start;
+
+  uint64_t hash = 14695981039346656037ull;
+  for (uint32_t i = 0; i < count; i++) {
+    hash = YGHashLayout(cells[i], hash);
+    YGNodeFreeRecursive(cells[i]);
+  }
+  free(cells);
+  free(constraints);
+  return hash;
+}
+
+static void YGRunScenario(const char *name, const uint32_t count,
+                          const uint32_t frames, const size_t budget,
+                          const uint32_t threadCount) {
+  const YGConfigRef config = YGConfigNew();
+  const YGMeasureCacheRef cache = budget > 0 ? YGMeasureCacheNew(budget) : NULL;
+  YGConfigSetMeasureCache(config, cache);
+  const YGThreadPoolRef pool =
+      threadCount > 1 ? YGThreadPoolNew(threadCount - 1) : NULL;
+
+  const int32_t before = gMeasureCount;
+  double time = 0;
+  for (uint32_t frame = 0; frame < frames; frame++) {
+    YGLayoutFrame(config, count, frame, pool, &time);
+  }
+  const int32_t measureCount = gMeasureCount - before;
+
+  printf("%-8s budget=%-8zu threads=%-2u measures/frame=%8.1f "
+         "time/frame=%7.3fms",
+         name, budget, threadCount, (double)measureCount / frames,
+         time / frames);
+  if (cache != NULL) {
+    const YGMeasureCacheStats stats = YGMeasureCacheGetStats(cache);
+    printf(" hit-rate=%5.1f%% entries=%u/%u evictions=%llu",
+           100.0 * stats.hits / (stats.hits + stats.misses), stats.count,
+           stats.capacity, (unsigned long long)stats.evictions);
+    YGMeasureCacheFree(cache);
+  }
+  printf("\n");
+
+  if (pool != NULL) {
+    YGThreadPoolFree(pool);
+  }
+  YGConfigFree(config);
+}
+
+// Returns whether every frame laid out with a cache of `budget` is the same as
+// without a cache.
+static bool YGCheckScenario(const uint32_t count, const uint32_t frames,
+                            const size_t budget, const uint32_t threadCount) {
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef referenceConfig = YGConfigNew();
+  const YGMeasureCacheRef cache = YGMeasureCacheNew(budget);
+  YGConfigSetMeasureCache(config, cache);
+  const YGThreadPoolRef pool =
+      threadCount > 1 ? YGThreadPoolNew(threadCount - 1) : NULL;
+
+  bool same = true;
+  double time = 0;
+  for (uint32_t frame = 0; frame < frames; frame++) {
+    same &= YGLayoutFrame(config, count, frame, pool, &time) ==
+            YGLayoutFrame(referenceConfig, count, frame, NULL, &time);
+  }
+
+  YGMeasureCacheFree(cache);
+  if (pool != NULL) {
+    YGThreadPoolFree(pool);
+  }
+  YGConfigFree(config);
+  YGConfigFree(referenceConfig);
+  return same;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 500;
+  const uint32_t frames = argc > 2 ? (uint32_t)atoi(argv[2]) : 20;
+  YGMakeStrings();
+
+  YGRunScenario("uncached", count, frames, 0, 1);
+  // Too small for the working set, so entries keep getting evicted.
+  YGRunScenario("small", count, frames, 16 * 1024, 1);
+  YGRunScenario("large", count, frames, 1024 * 1024, 1);
+  YGRunScenario("threaded", count, frames, 1024 * 1024, 4);
+}
+
+bool YGRunChecks(void) {
+  YGMakeStrings();
+  bool ok = YGCheck(YGCheckScenario(200, 5, 16 * 1024, 1),
+                    "lay out like without a cache while evicting");
+  ok &= YGCheck(YGCheckScenario(200, 5, 1024 * 1024, 1),
+                "lay out like without a cache");
+  ok &= YGCheck(YGCheckScenario(200, 5, 1024 * 1024, 4),
+                "lay out like without a cache on several threads");
+  return ok;
+}
@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out nested flex-wrap grids of text, where every level measures its
+// children under several constraints, and reports how the per-node
+// measurement caches hold up for different limits of
+// YGConfigSetMaxCachedMeasurements.
+//
+//   YGMeasurementCacheBenchmark [depth] [passes]
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "YGBenchmarkSupport.h"
+
+static uint64_t gMeasureCount = 0;
+
+static YGSize YGMeasureCaption(YGNodeRef node, float width,
+                               YGMeasureMode widthMode, float height,
+                               YGMeasureMode heightMode) {
+  gMeasureCount++;
+  const float textWidth = 30 + 9 * (float)(uintptr_t)YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(textWidth, 16, width, widthMode, height,
+                              heightMode);
+}
+
+// A wrapping row of cards, each holding a caption and, above the last level,
+// another wrapping row. Cards grow, shrink and have a min width, so every
+// level measures its children at their basis, flexed and stretched sizes.
+static YGNodeRef YGBuildGrid(const YGConfigRef config, const uint32_t depth,
+                             const uint32_t seed) {
+  const YGNodeRef grid = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(grid, YGFlexDirectionRow);
+  YGNodeStyleSetFlexWrap(grid, YGWrapWrap);
+  YGNodeStyleSetAlignItems(grid, YGAlignStretch);
+  for (uint32_t i = 0; i < 3; i++) {
+    const YGNodeRef card = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(card, 1);
+    YGNodeStyleSetFlexShrink(card, 1);
+    YGNodeStyleSetMinWidth(card, 40);
+    YGNodeStyleSetPadding(card, YGEdgeAll, 3);
+    const YGNodeRef caption = YGNodeNewWithConfig(config);
+    YGNodeSetContext(caption, (void *)(uintptr_t)((seed + i) % 11));
+    YGNodeSetMeasureFunc(caption, YGMeasureCaption);
+    YGAppendChild(card, caption);
+    if (depth > 1) {
+      YGAppendChild(card, YGBuildGrid(config, depth - 1, seed * 3 + i));
+    }
+    YGAppendChild(grid, card);
+  }
+  return grid;
+}
+
+static void YGRunScenario(const uint32_t depth, const uint32_t passes,
+                          const uint32_t limit) {
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetMaxCachedMeasurements(config, limit);
+  const YGNodeRef root = YGBuildGrid(config, depth, 1);
+
+  gMeasureCount = 0;
+  double best = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    // A new width every pass invalidates the whole tree.
+    YGNodeStyleSetWidth(root, 300 + 7 * (float)i);
+    const double start = YGNow();
+    YGNodeCalculateLayout(root, YGUndefined, YGUndefined, YGDirectionLTR);
+    const double time = YGNow() - start;
+    best = i == 0 || time < best ? time : best;
+  }
+
+  const YGLayoutStats stats = YGConfigGetLayoutStats(config);
+  const uint64_t lookups =
+      stats.cachedMeasurementHits + stats.cachedMeasurementMisses;
+  printf("depth=%-2u limit=%-3u measures/pass=%9.1f hit-rate=%5.1f%% "
+         "evictions/pass=%9.1f best=%8.3fms\n",
+         depth, limit, (double)gMeasureCount / passes,
+         lookups > 0 ? 100.0 * stats.cachedMeasurementHits / lookups : 0.0,
+         (double)stats.cachedMeasurementEvictions / passes, best);
+
+  YGNodeFreeRecursive(root);
+  YGConfigFree(config);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t maxDepth = argc > 1 ? (uint32_t)atoi(argv[1]) : 6;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 5;
+
+  for (uint32_t depth = 2; depth <= maxDepth; depth += 2) {
+    const uint32_t limits[] = {4, 16, 64};
+    for (uint32_t i = 0; i < sizeof(limits) / sizeof(limits[0]); i++) {
+      YGRunScenario(depth, passes, limits[i]);
+    }
+  }
+}
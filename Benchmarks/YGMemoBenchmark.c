@@ -0,0 +1,217 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out lists of identical skeleton rows of growing length with and without
+// subtree memoization, and reports the time per row of each. The test checks
+// that the memoized lists lay out to the same frames, also after a row is
+// edited, at a new width and on a thread pool.
+//
+//   YGMemoBenchmark [maxRowCount] [passes]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+static YGSize YGMeasureShapedText(YGNodeRef node, float width,
+                                  YGMeasureMode widthMode, float height,
+                                  YGMeasureMode heightMode) {
+  // Stands in for shaping the text, which dominates real measurement.
+  volatile uint32_t state = (uint32_t)(uintptr_t)YGNodeGetContext(node);
+  for (uint32_t i = 0; i < 500; i++) {
+    state = state * 1664525 + 1013904223;
+  }
+  return YGMeasureText(node, width, widthMode, height, heightMode);
+}
+
+static void YGSetText(const YGNodeRef text, const uint32_t length) {
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFingerprint(text, 0x9E3779B97F4A7C15ull * (length + 1));
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetMeasureFunc(text, YGMeasureShapedText);
+  YGSetText(text, length);
+  YGNodeStyleSetFlexShrink(text, 1);
+  return text;
+}
+
+// The placeholder rows of a feed that is still loading.
+static YGNodeRef YGBuildList(const YGConfigRef config, const uint32_t count) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef row = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(row, YGFlexDirectionRow);
+    YGNodeStyleSetPadding(row, YGEdgeAll, 12);
+    const YGNodeRef avatar = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidth(avatar, 40);
+    YGNodeStyleSetHeight(avatar, 40);
+    YGNodeStyleSetMargin(avatar, YGEdgeRight, 8);
+    YGAppendChild(row, avatar);
+    const YGNodeRef content = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(content, 1);
+    YGNodeStyleSetFlexShrink(content, 1);
+    YGAppendChild(content, YGNewText(config, 24));
+    YGAppendChild(content, YGNewText(config, 90));
+    YGAppendChild(row, content);
+    YGAppendChild(root, row);
+  }
+  return root;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[4] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[4];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 4; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+// Returns the best time of laying out a new list, in milliseconds.
+static double YGTimeList(const YGConfigRef config, const uint32_t count,
+                         const uint32_t passes, YGLayoutStats *const stats) {
+  double best = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    const YGNodeRef root = YGBuildList(config, count);
+    const double start = YGNow();
+    YGNodeCalculateLayoutWithStats(root, 375, YGUndefined, YGDirectionLTR,
+                                   stats);
+    const double time = YGNow() - start;
+    best = i == 0 || time < best ? time : best;
+    YGNodeFreeRecursive(root);
+  }
+  return best;
+}
+
+// Returns the hash of the layout of a new list.
+static uint64_t YGLayoutList(const YGConfigRef config, const uint32_t count,
+                             YGLayoutStats *const stats) {
+  const YGNodeRef root = YGBuildList(config, count);
+  YGNodeCalculateLayoutWithStats(root, 375, YGUndefined, YGDirectionLTR,
+                                 stats);
+  const uint64_t hash = YGHashLayout(root, 0);
+  YGNodeFreeRecursive(root);
+  return hash;
+}
+
+static YGNodeRef YGBodyAt(const YGNodeRef list, const uint32_t row) {
+  return YGNodeGetChild(YGNodeGetChild(YGNodeGetChild(list, row), 1), 1);
+}
+
+// Edits a row and changes the width of a laid out list, and compares every
+// layout with that of a list laid out without memoization.
+static bool YGCheckRelayout(const YGConfigRef config,
+                            const YGConfigRef memoized, const uint32_t count) {
+  const YGNodeRef expected = YGBuildList(config, count);
+  const YGNodeRef root = YGBuildList(memoized, count);
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  bool ok = true;
+
+  const uint32_t row = count / 2;
+  YGSetText(YGBodyAt(root, row), 300);
+  YGNodeMarkDirty(YGBodyAt(root, row));
+  YGSetText(YGBodyAt(expected, row), 300);
+  YGLayoutStats stats;
+  YGNodeCalculateLayoutWithStats(root, 375, YGUndefined, YGDirectionLTR,
+                                 &stats);
+  YGNodeCalculateLayout(expected, 375, YGUndefined, YGDirectionLTR);
+  ok &= YGCheck(YGHashLayout(root, 0) == YGHashLayout(expected, 0),
+                "lay out an edited row");
+  ok &= YGCheck(stats.memoizedSubtrees == 0,
+                "not copy the edited row into the others");
+
+  YGNodeCalculateLayoutWithStats(root, 320, YGUndefined, YGDirectionLTR,
+                                 &stats);
+  YGNodeCalculateLayout(expected, 320, YGUndefined, YGDirectionLTR);
+  ok &= YGCheck(YGHashLayout(root, 0) == YGHashLayout(expected, 0),
+                "lay out at a new width");
+  ok &= YGCheck(count < 3 || stats.memoizedSubtrees > 0,
+                "copy the rows at a new width");
+
+  YGNodeFreeRecursive(root);
+  YGNodeFreeRecursive(expected);
+  return ok;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t maxCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 4000;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 5;
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef memoized = YGConfigNew();
+  YGConfigSetSubtreeMemoization(memoized, true);
+
+  for (uint32_t count = maxCount / 8 > 0 ? maxCount / 8 : 1; count <= maxCount;
+       count *= 2) {
+    YGLayoutStats stats;
+    const double plain = YGTimeList(config, count, passes, &stats);
+    const uint64_t measures = stats.measureFuncCalls;
+    const double memo = YGTimeList(memoized, count, passes, &stats);
+    printf("rows=%-6u plain=%7.3fms (%6.2fus/row) memoized=%7.3fms "
+           "(%6.2fus/row) measures=%llu/%llu copied=%llu nodes\n",
+           count, plain, plain * 1e3 / count, memo, memo * 1e3 / count,
+           (unsigned long long)stats.measureFuncCalls,
+           (unsigned long long)measures,
+           (unsigned long long)stats.memoizedNodes);
+  }
+
+  YGConfigFree(memoized);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef memoized = YGConfigNew();
+  YGConfigSetSubtreeMemoization(memoized, true);
+  bool ok = true;
+
+  for (uint32_t count = 1; count <= 64; count *= 4) {
+    YGLayoutStats stats;
+    const uint64_t expected = YGLayoutList(config, count, &stats);
+    ok &= YGCheck(YGLayoutList(memoized, count, &stats) == expected,
+                  "lay out the rows the same");
+    ok &= YGCheck(count < 2 || stats.memoizedSubtrees > 0, "copy the rows");
+  }
+
+  ok &= YGCheckRelayout(config, memoized, 8);
+
+  // Rows laid out on the pool copy from those of their own subtree only.
+  const YGThreadPoolRef pool = YGThreadPoolNew(3);
+  if (pool != NULL) {
+    const uint32_t count = 32;
+    const YGNodeRef expected = YGBuildList(config, count);
+    YGNodeCalculateLayout(expected, 375, YGUndefined, YGDirectionLTR);
+    YGConfigSetParallelism(memoized, pool);
+    const YGNodeRef root = YGBuildList(memoized, count);
+    YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+    ok &= YGCheck(YGHashLayout(root, 0) == YGHashLayout(expected, 0),
+                  "lay out the rows the same on a pool");
+    YGNodeFreeRecursive(root);
+    YGNodeFreeRecursive(expected);
+    YGConfigSetParallelism(memoized, NULL);
+    YGThreadPoolFree(pool);
+  }
+
+  YGConfigFree(memoized);
+  YGConfigFree(config);
+  return ok;
+}
@@ -0,0 +1,193 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Reports the memory held per node after a full layout and, where the kernel
+// exposes hardware counters, the data cache misses of repeated layout passes.
+//
+//   YGNodeFootprintBenchmark [nodeCount]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "YGBenchmarkSupport.h"
+
+// Every allocation is prefixed with its size so frees can be accounted for.
+#define YG_HEADER_SIZE 16
+
+static size_t gLiveBytes = 0;
+
+static void *YGTrackingMalloc(size_t size) {
+  char *block = malloc(size + YG_HEADER_SIZE);
+  *(size_t *)block = size;
+  gLiveBytes += size;
+  return block + YG_HEADER_SIZE;
+}
+
+static void *YGTrackingCalloc(size_t count, size_t size) {
+  void *ptr = YGTrackingMalloc(count * size);
+  memset(ptr, 0, count * size);
+  return ptr;
+}
+
+static void YGTrackingFree(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  char *block = (char *)ptr - YG_HEADER_SIZE;
+  gLiveBytes -= *(size_t *)block;
+  free(block);
+}
+
+static void *YGTrackingRealloc(void *ptr, size_t size) {
+  if (ptr == NULL) {
+    return YGTrackingMalloc(size);
+  }
+  char *block = (char *)ptr - YG_HEADER_SIZE;
+  gLiveBytes -= *(size_t *)block;
+  block = realloc(block, size + YG_HEADER_SIZE);
+  *(size_t *)block = size;
+  gLiveBytes += size;
+  return block + YG_HEADER_SIZE;
+}
+
+// A tree shaped like a typical screen: stacks of rows whose leaves are text.
+static YGNodeRef YGBuildTree(const YGConfigRef config, const uint32_t count) {
+  const uint32_t fanout = 4;
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeRef *queue = malloc(sizeof(YGNodeRef) * count);
+  uint32_t head = 0;
+  uint32_t tail = 0;
+  uint32_t created = 1;
+  queue[tail++] = root;
+  while (created < count) {
+    const YGNodeRef parent = queue[head++];
+    for (uint32_t i = 0; i < fanout && created < count; i++, created++) {
+      const YGNodeRef child = YGNodeNewWithConfig(config);
+      if (created % 2 == 0) {
+        YGNodeStyleSetFlexDirection(child, YGFlexDirectionRow);
+      }
+      if (created % 5 == 0) {
+        YGNodeStyleSetPadding(child, YGEdgeAll, 8);
+      }
+      YGNodeInsertChild(parent, child, i);
+      queue[tail++] = child;
+    }
+  }
+  // The nodes that did not get children are the leaves.
+  for (uint32_t i = head; i < tail; i++) {
+    if (YGNodeGetChildCount(queue[i]) == 0) {
+      YGNodeSetContext(queue[i], (void *)(uintptr_t)17);
+      YGNodeSetMeasureFunc(queue[i], YGMeasureText);
+    }
+  }
+  free(queue);
+  return root;
+}
+
+#ifdef __linux__
+static int YGOpenCacheMissCounter(const uint64_t cache) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HW_CACHE;
+  attr.config = cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void YGStartCounter(const int fd) {
+  if (fd >= 0) {
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+static void YGPrintCounter(const char *name, const int fd) {
+  long long value = 0;
+  if (fd < 0) {
+    printf(" %s=n/a", name);
+    return;
+  }
+  ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  if (read(fd, &value, sizeof(value)) != sizeof(value)) {
+    printf(" %s=n/a", name);
+    return;
+  }
+  printf(" %s=%lld", name, value);
+  close(fd);
+}
+#endif
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 10000;
+  YGSetMemoryFuncs(&YGTrackingMalloc, &YGTrackingCalloc, &YGTrackingRealloc,
+                   &YGTrackingFree);
+
+  const YGConfigRef config = YGConfigNew();
+  const YGNodeRef root = YGBuildTree(config, count);
+  const size_t builtBytes = gLiveBytes;
+
+  // The first pass allocates whatever the layout needs.
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  const size_t laidOutBytes = gLiveBytes;
+
+  // Relayout at alternating widths so every pass traverses the whole tree.
+  const uint32_t passes = 20;
+#ifdef __linux__
+  const int l1 = YGOpenCacheMissCounter(PERF_COUNT_HW_CACHE_L1D);
+  const int ll = YGOpenCacheMissCounter(PERF_COUNT_HW_CACHE_LL);
+  YGStartCounter(l1);
+  YGStartCounter(ll);
+#endif
+  double layoutTime = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    YGNodeStyleSetWidth(root, i % 2 == 0 ? 320 : 340);
+    const double start = YGNow();
+    YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+    const double time = YGNow() - start;
+    layoutTime = i == 0 || time < layoutTime ? time : layoutTime;
+  }
+
+  printf("nodes=%u bytes/node built=%.1f laid-out=%.1f best-layout=%.3fms",
+         count, (double)builtBytes / count, (double)laidOutBytes / count,
+         layoutTime);
+#ifdef __linux__
+  // Totals over all passes.
+  YGPrintCounter("l1d-misses", l1);
+  YGPrintCounter("llc-misses", ll);
+#endif
+  printf("\n");
+
+  YGNodeFreeRecursive(root);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  YGSetMemoryFuncs(&YGTrackingMalloc, &YGTrackingCalloc, &YGTrackingRealloc,
+                   &YGTrackingFree);
+  const YGConfigRef config = YGConfigNew();
+  const YGNodeRef root = YGBuildTree(config, 500);
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  YGNodeStyleSetWidth(root, 320);
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  YGNodeFreeRecursive(root);
+  YGConfigFree(config);
+  return YGCheck(gLiveBytes == 0, "free everything a laid out tree holds");
+}
@@ -0,0 +1,407 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Measures the speedup of laying out one tree on a YGThreadPool against the
+// serial layout, for growing thread counts. The cells scenario does the same
+// for many small roots laid out with YGNodeCalculateLayoutBatch. The test
+// checks that every parallel layout is identical to the serial one.
+//
+//   YGParallelLayoutBenchmark [maxThreadCount] [nodeCount]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "YGBenchmarkSupport.h"
+
+static YGSize YGMeasureLabel(YGNodeRef node, float width,
+                             YGMeasureMode widthMode, float height,
+                             YGMeasureMode heightMode) {
+  const float textWidth = 40 + 10 * (float)(uintptr_t)YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(textWidth, 16, width, widthMode, height,
+                              heightMode);
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)(index % 7));
+  YGNodeSetMeasureFunc(text, YGMeasureLabel);
+  return text;
+}
+
+// A dashboard: rows of widgets sharing the width, each a title over a list of
+// icon and label items. Returns roughly `count` nodes.
+static YGNodeRef YGBuildWideTree(const YGConfigRef config,
+                                 const uint32_t count) {
+  const uint32_t widgetsPerRow = 4;
+  const uint32_t itemsPerWidget = 12;
+  const uint32_t nodesPerWidget = 3 + itemsPerWidget * 3;
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  YGNodeStyleSetPadding(root, YGEdgeAll, 16);
+  YGNodeRef row = NULL;
+  for (uint32_t i = 0; (i + 1) * nodesPerWidget < count; i++) {
+    if (i % widgetsPerRow == 0) {
+      row = YGNodeNewWithConfig(config);
+      YGNodeStyleSetFlexDirection(row, YGFlexDirectionRow);
+      YGNodeStyleSetMargin(row, YGEdgeBottom, 16);
+      YGAppendChild(root, row);
+    }
+    const YGNodeRef widget = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(widget, 1);
+    YGNodeStyleSetFlexBasis(widget, 0);
+    YGNodeStyleSetPadding(widget, YGEdgeAll, 8);
+    YGNodeStyleSetMargin(widget, YGEdgeHorizontal, 8);
+    YGAppendChild(row, widget);
+    YGAppendChild(widget, YGNewText(config, i));
+
+    const YGNodeRef list = YGNodeNewWithConfig(config);
+    YGAppendChild(widget, list);
+    for (uint32_t j = 0; j < itemsPerWidget; j++) {
+      const YGNodeRef item = YGNodeNewWithConfig(config);
+      YGNodeStyleSetFlexDirection(item, YGFlexDirectionRow);
+      YGNodeStyleSetAlignItems(item, YGAlignCenter);
+      const YGNodeRef icon = YGNodeNewWithConfig(config);
+      YGNodeStyleSetWidth(icon, 16);
+      YGNodeStyleSetHeight(icon, 16);
+      YGNodeStyleSetMargin(icon, YGEdgeRight, 4);
+      YGAppendChild(item, icon);
+      const YGNodeRef label = YGNewText(config, i + j);
+      YGNodeStyleSetFlexShrink(label, 1);
+      YGAppendChild(item, label);
+      YGAppendChild(list, item);
+    }
+  }
+  return root;
+}
+
+// Panels split in two over and over, alternating direction, down to a text.
+static YGNodeRef YGBuildDeepPanel(const YGConfigRef config,
+                                  const uint32_t count, const uint32_t depth) {
+  if (count < 3) {
+    return YGNewText(config, depth);
+  }
+  const YGNodeRef panel = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexGrow(panel, 1);
+  YGNodeStyleSetFlexBasis(panel, 0);
+  YGNodeStyleSetPadding(panel, YGEdgeAll, 2);
+  if (depth % 2 == 0) {
+    YGNodeStyleSetFlexDirection(panel, YGFlexDirectionRow);
+  }
+  YGAppendChild(panel, YGBuildDeepPanel(config, (count - 1) / 2, depth + 1));
+  YGAppendChild(panel, YGBuildDeepPanel(config, (count - 1) / 2, depth + 1));
+  return panel;
+}
+
+static YGNodeRef YGBuildDeepTree(const YGConfigRef config,
+                                 const uint32_t count) {
+  const YGNodeRef root = YGBuildDeepPanel(config, count, 0);
+  YGNodeStyleSetHeight(root, 2000);
+  return root;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[5] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+      YGNodeLayoutGetHadOverflow(node),
+  };
+  uint32_t bits[5];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 5; i++) {
+    // FNV-1a over the bit patterns, so any difference shows.
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+static bool YGLayoutStatsEqual(const YGLayoutStats *const a,
+                               const YGLayoutStats *const b) {
+  return a->nodesVisited == b->nodesVisited &&
+         a->layoutCalls == b->layoutCalls &&
+         a->measureCalls == b->measureCalls &&
+         a->cachedLayoutHits == b->cachedLayoutHits &&
+         a->cachedLayoutMisses == b->cachedLayoutMisses &&
+         a->cachedMeasurementHits == b->cachedMeasurementHits &&
+         a->cachedMeasurementMisses == b->cachedMeasurementMisses &&
+         a->cachedMeasurementEvictions == b->cachedMeasurementEvictions &&
+         a->measureFuncCalls == b->measureFuncCalls &&
+         a->nodesRounded == b->nodesRounded && a->maxDepth == b->maxDepth;
+}
+
+typedef YGNodeRef (*YGBuildFunc)(const YGConfigRef config,
+                                 const uint32_t count);
+
+typedef struct YGScenario {
+  uint32_t nodeCount;
+  // The pool of the run is set on its config.
+  YGConfigRef config;
+  YGNodeRef root;
+  uint32_t pass;
+} YGScenario;
+
+static YGScenario YGNewScenario(const YGBuildFunc build, const uint32_t count) {
+  YGScenario scenario = {.pass = 0};
+  scenario.config = YGConfigNew();
+  scenario.root = build(scenario.config, count);
+  scenario.nodeCount = YGCountNodes(scenario.root);
+  return scenario;
+}
+
+static void YGFreeScenario(const YGScenario *const scenario) {
+  YGNodeFreeRecursive(scenario->root);
+  YGConfigFree(scenario->config);
+}
+
+// Lays out the next pass, at alternating widths so that every pass traverses
+// the whole tree.
+static void YGLayoutPass(YGScenario *const scenario,
+                         YGLayoutStats *const stats) {
+  const float width = scenario->pass++ % 2 == 0 ? 1280 : 1024;
+  YGNodeCalculateLayoutWithStats(scenario->root, width, YGUndefined,
+                                 YGDirectionLTR, stats);
+}
+
+// Relayouts the tree on `pool` and returns the best time. Runs share one tree
+// so that they all see the same memory layout.
+static double YGRunLayout(YGScenario *const scenario,
+                          const YGThreadPoolRef pool) {
+  const uint32_t passes = 10;
+  double best = 0;
+  YGConfigSetParallelism(scenario->config, pool);
+  for (uint32_t i = 0; i < passes; i++) {
+    YGLayoutStats stats;
+    const double start = YGNow();
+    YGLayoutPass(scenario, &stats);
+    const double time = YGNow() - start;
+    best = i == 0 || time < best ? time : best;
+  }
+  YGConfigSetParallelism(scenario->config, NULL);
+  return best;
+}
+
+static void YGRunScenario(const char *name, const YGBuildFunc build,
+                          const uint32_t count, const uint32_t maxThreadCount) {
+  YGScenario scenario = YGNewScenario(build, count);
+  const double serialTime = YGRunLayout(&scenario, NULL);
+  printf("%-5s nodes=%-7u threads=serial time=%8.3fms ns/node=%7.1f\n", name,
+         scenario.nodeCount, serialTime, serialTime * 1e6 / scenario.nodeCount);
+
+  for (uint32_t threadCount = 1; threadCount <= maxThreadCount;
+       threadCount *= 2) {
+    // The calling thread lays out subtrees too.
+    const YGThreadPoolRef pool = YGThreadPoolNew(threadCount - 1);
+    if (pool == NULL) {
+      printf("%-5s thread pools are not supported\n", name);
+      break;
+    }
+    const double time = YGRunLayout(&scenario, pool);
+    YGThreadPoolFree(pool);
+    printf("%-5s nodes=%-7u threads=%-6u time=%8.3fms ns/node=%7.1f "
+           "speedup=%.2fx\n",
+           name, scenario.nodeCount, threadCount, time,
+           time * 1e6 / scenario.nodeCount, serialTime / time);
+  }
+  YGFreeScenario(&scenario);
+}
+
+// Lays out a tree on pools of growing size and a reference serially, and
+// returns whether every pass came out the same for both.
+static bool YGCheckScenario(const YGBuildFunc build, const uint32_t count) {
+  YGScenario scenario = YGNewScenario(build, count);
+  YGScenario reference = YGNewScenario(build, count);
+  bool same = true;
+  for (uint32_t threadCount = 1; threadCount <= 4; threadCount *= 2) {
+    const YGThreadPoolRef pool = YGThreadPoolNew(threadCount - 1);
+    if (pool == NULL) {
+      break;
+    }
+    YGConfigSetParallelism(scenario.config, pool);
+    for (uint32_t i = 0; i < 4; i++) {
+      YGLayoutStats stats;
+      YGLayoutStats referenceStats;
+      YGLayoutPass(&scenario, &stats);
+      YGLayoutPass(&reference, &referenceStats);
+      const uint64_t seed = 14695981039346656037ull;
+      // The subtrees laid out on other threads count towards the stats too.
+      same &= YGHashLayout(scenario.root, seed) ==
+                  YGHashLayout(reference.root, seed) &&
+              YGLayoutStatsEqual(&stats, &referenceStats);
+    }
+    YGConfigSetParallelism(scenario.config, NULL);
+    YGThreadPoolFree(pool);
+  }
+  YGFreeScenario(&scenario);
+  YGFreeScenario(&reference);
+  return same;
+}
+
+// A list cell: an avatar next to a title and a body text, and a badge.
+static YGNodeRef YGBuildCell(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef cell = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(cell, YGFlexDirectionRow);
+  YGNodeStyleSetPadding(cell, YGEdgeAll, 12);
+  const YGNodeRef avatar = YGNodeNewWithConfig(config);
+  YGNodeStyleSetWidth(avatar, 40);
+  YGNodeStyleSetHeight(avatar, 40);
+  YGNodeStyleSetMargin(avatar, YGEdgeRight, 8);
+  YGAppendChild(cell, avatar);
+  const YGNodeRef content = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexGrow(content, 1);
+  YGNodeStyleSetFlexShrink(content, 1);
+  YGAppendChild(content, YGNewText(config, index));
+  for (uint32_t i = 0; i < index % 4; i++) {
+    YGAppendChild(content, YGNewText(config, index + i + 1));
+  }
+  YGAppendChild(cell, content);
+  const YGNodeRef badge = YGNewText(config, index / 3);
+  YGNodeStyleSetAlignSelf(badge, YGAlignCenter);
+  YGAppendChild(cell, badge);
+  return cell;
+}
+
+// Lays out the cells at `width`, in a batch on `pool`, or with plain
+// YGNodeCalculateLayout calls when it is NULL.
+static void YGLayoutCells(YGNodeRef *const cells, YGSize *const constraints,
+                          const uint32_t count, const float width,
+                          const YGThreadPoolRef pool) {
+  if (pool != NULL) {
+    for (uint32_t i = 0; i < count; i++) {
+      constraints[i] = (YGSize){.width = width, .height = YGUndefined};
+    }
+    YGNodeCalculateLayoutBatch(cells, constraints, count, pool);
+  } else {
+    for (uint32_t i = 0; i < count; i++) {
+      YGNodeCalculateLayout(cells[i], width, YGUndefined, YGDirectionLTR);
+    }
+  }
+}
+
+// Lays out cells at alternating widths and returns the best time.
+static double YGRunCellLayout(YGNodeRef *const cells,
+                              YGSize *const constraints, const uint32_t count,
+                              const YGThreadPoolRef pool) {
+  const uint32_t passes = 10;
+  double best = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    const double start = YGNow();
+    YGLayoutCells(cells, constraints, count, i % 2 == 0 ? 375 : 414, pool);
+    const double time = YGNow() - start;
+    best = i == 0 || time < best ? time : best;
+  }
+  return best;
+}
+
+static void YGRunCellScenario(const uint32_t nodeCount,
+                              const uint32_t maxThreadCount) {
+  const YGConfigRef config = YGConfigNew();
+  const uint32_t count = nodeCount / 8 > 0 ? nodeCount / 8 : 1;
+  YGNodeRef *const cells = malloc(sizeof(YGNodeRef) * count);
+  YGSize *const constraints = malloc(sizeof(YGSize) * count);
+  uint32_t cellNodeCount = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    cells[i] = YGBuildCell(config, i);
+    cellNodeCount += YGCountNodes(cells[i]);
+  }
+
+  const double serialTime = YGRunCellLayout(cells, constraints, count, NULL);
+  printf("cells roots=%-7u threads=serial time=%8.3fms ns/node=%7.1f\n", count,
+         serialTime, serialTime * 1e6 / cellNodeCount);
+
+  for (uint32_t threadCount = 1; threadCount <= maxThreadCount;
+       threadCount *= 2) {
+    const YGThreadPoolRef pool = YGThreadPoolNew(threadCount - 1);
+    if (pool == NULL) {
+      printf("cells thread pools are not supported\n");
+      break;
+    }
+    const double time = YGRunCellLayout(cells, constraints, count, pool);
+    YGThreadPoolFree(pool);
+    printf("cells roots=%-7u threads=%-6u time=%8.3fms ns/node=%7.1f "
+           "speedup=%.2fx\n",
+           count, threadCount, time, time * 1e6 / cellNodeCount,
+           serialTime / time);
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    YGNodeFreeRecursive(cells[i]);
+  }
+  free(cells);
+  free(constraints);
+  YGConfigFree(config);
+}
+
+// Lays out cells in batches on pools of growing size and references one by
+// one, and returns whether every pass came out the same for both.
+static bool YGCheckCells(const uint32_t count) {
+  const YGConfigRef config = YGConfigNew();
+  YGNodeRef *const cells = malloc(sizeof(YGNodeRef) * count);
+  YGNodeRef *const references = malloc(sizeof(YGNodeRef) * count);
+  YGSize *const constraints = malloc(sizeof(YGSize) * count);
+  for (uint32_t i = 0; i < count; i++) {
+    cells[i] = YGBuildCell(config, i);
+    references[i] = YGBuildCell(config, i);
+  }
+
+  bool same = true;
+  for (uint32_t threadCount = 1; threadCount <= 4; threadCount *= 2) {
+    const YGThreadPoolRef pool = YGThreadPoolNew(threadCount - 1);
+    if (pool == NULL) {
+      break;
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+      const float width = i % 2 == 0 ? 375 : 414;
+      YGLayoutCells(cells, constraints, count, width, pool);
+      YGLayoutCells(references, constraints, count, width, NULL);
+      for (uint32_t j = 0; j < count; j++) {
+        const uint64_t seed = 14695981039346656037ull;
+        same &=
+            YGHashLayout(cells[j], seed) == YGHashLayout(references[j], seed);
+      }
+    }
+    YGThreadPoolFree(pool);
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    YGNodeFreeRecursive(cells[i]);
+    YGNodeFreeRecursive(references[i]);
+  }
+  free(cells);
+  free(references);
+  free(constraints);
+  YGConfigFree(config);
+  return same;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  const uint32_t maxThreadCount =
+      argc > 1 ? (uint32_t)atoi(argv[1]) : (uint32_t)(cores > 0 ? cores : 1);
+  const uint32_t count = argc > 2 ? (uint32_t)atoi(argv[2]) : 100000;
+
+  printf("cores=%ld\n", cores);
+  YGRunScenario("wide", &YGBuildWideTree, count, maxThreadCount);
+  YGRunScenario("deep", &YGBuildDeepTree, count, maxThreadCount);
+  YGRunCellScenario(count, maxThreadCount);
+}
+
+bool YGRunChecks(void) {
+  bool ok = YGCheck(YGCheckScenario(&YGBuildWideTree, 2000),
+                    "lay out a wide tree in parallel like serially");
+  ok &= YGCheck(YGCheckScenario(&YGBuildDeepTree, 2000),
+                "lay out a deep tree in parallel like serially");
+  ok &= YGCheck(YGCheckCells(250), "lay out a batch of cells like one by one");
+  return ok;
+}
@@ -0,0 +1,199 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Keeps a history of revisions of a sectioned list, each a clone of the last
+// with the text of one row edited, and reports the time and the number of
+// nodes cloned per revision. The test checks that every revision lays out like
+// a list edited in place, and that the older revisions keep their frames.
+//
+//   YGPersistentTreeBenchmark [sectionCount] [revisionCount]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+#define YG_ROWS_PER_SECTION 16
+
+static void YGSetText(const YGNodeRef text, const uint32_t length) {
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFingerprint(text, 0x9E3779B97F4A7C15ull * (length + 1));
+  YGNodeMarkDirty(text);
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetMeasureFunc(text, YGMeasureText);
+  YGSetText(text, length);
+  YGNodeStyleSetFlexShrink(text, 1);
+  return text;
+}
+
+static YGNodeRef YGBuildList(const YGConfigRef config,
+                             const uint32_t sectionCount) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < sectionCount; i++) {
+    const YGNodeRef section = YGNodeNewWithConfig(config);
+    YGNodeStyleSetPadding(section, YGEdgeTop, 24);
+    for (uint32_t j = 0; j < YG_ROWS_PER_SECTION; j++) {
+      const YGNodeRef row = YGNodeNewWithConfig(config);
+      YGNodeStyleSetFlexDirection(row, YGFlexDirectionRow);
+      YGNodeStyleSetPadding(row, YGEdgeAll, 12);
+      const YGNodeRef avatar = YGNodeNewWithConfig(config);
+      YGNodeStyleSetWidth(avatar, 40);
+      YGNodeStyleSetHeight(avatar, 40);
+      YGNodeStyleSetMargin(avatar, YGEdgeRight, 8);
+      YGAppendChild(row, avatar);
+      const YGNodeRef content = YGNodeNewWithConfig(config);
+      YGNodeStyleSetFlexGrow(content, 1);
+      YGNodeStyleSetFlexShrink(content, 1);
+      YGAppendChild(content, YGNewText(config, 10 + (i + j) % 20));
+      YGAppendChild(content, YGNewText(config, 40 + (i * 37 + j) % 300));
+      YGAppendChild(row, content);
+      YGAppendChild(section, row);
+    }
+    YGAppendChild(root, section);
+  }
+  return root;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[4] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[4];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 4; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+static uint64_t gClonedCount;
+static bool gClonesValid = true;
+
+static void YGNodesCloned(YGNodeRef parent, const YGNodeRef oldNodes[],
+                          const YGNodeRef newNodes[],
+                          const uint32_t childIndices[], uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    gClonesValid &= YGNodeGetChild(parent, childIndices[i]) == newNodes[i] &&
+                    YGNodeGetParent(newNodes[i]) == parent &&
+                    oldNodes[i] != newNodes[i];
+  }
+  gClonedCount += count;
+}
+
+// Makes revision `i` of `list`, where the body of one row gets a new length,
+// and lays it out. A clone has the path to the row cloned first.
+static void YGEditList(const YGNodeRef list, const uint32_t i,
+                       const uint32_t sectionCount, const bool isClone) {
+  const uint32_t path[4] = {(i * 7) % sectionCount,
+                            (i * 5) % YG_ROWS_PER_SECTION, 1, 1};
+  YGNodeRef text = list;
+  for (uint32_t j = 0; j < 4; j++) {
+    text = isClone ? YGNodeGetMutableChild(text, path[j])
+                   : YGNodeGetChild(text, path[j]);
+  }
+  YGSetText(text, 10 + (i * 53) % 400);
+  YGNodeCalculateLayout(list, 375, YGUndefined, YGDirectionLTR);
+}
+
+// The revisions own the nodes they cloned, and share the rest with the
+// revisions before them.
+static void YGFreeRevisions(YGNodeRef *const revisions, const uint32_t last) {
+  for (uint32_t i = last + 1; i-- > 0;) {
+    YGNodeFreeRecursive(revisions[i]);
+  }
+  free(revisions);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t sectionCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 64;
+  const uint32_t revisionCount = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+  const uint32_t nodeCount = 1 + sectionCount * (1 + YG_ROWS_PER_SECTION * 5);
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetNodesClonedFunc(config, YGNodesCloned);
+
+  YGNodeRef *const revisions = malloc(sizeof(YGNodeRef) * (revisionCount + 1));
+  revisions[0] = YGBuildList(config, sectionCount);
+  const YGNodeRef inPlace = YGBuildList(config, sectionCount);
+  YGNodeCalculateLayout(revisions[0], 375, YGUndefined, YGDirectionLTR);
+  YGNodeCalculateLayout(inPlace, 375, YGUndefined, YGDirectionLTR);
+
+  double time = 0;
+  double inPlaceTime = 0;
+  for (uint32_t i = 1; i <= revisionCount; i++) {
+    double start = YGNow();
+    revisions[i] = YGNodeClone(revisions[i - 1]);
+    YGEditList(revisions[i], i, sectionCount, true);
+    time += YGNow() - start;
+
+    start = YGNow();
+    YGEditList(inPlace, i, sectionCount, false);
+    inPlaceTime += YGNow() - start;
+  }
+
+  printf("nodes=%u revisions=%u revision=%.3fms in-place=%.3fms "
+         "cloned=%llu/revision\n",
+         nodeCount, revisionCount, time / revisionCount,
+         inPlaceTime / revisionCount,
+         (unsigned long long)(gClonedCount / revisionCount));
+
+  YGFreeRevisions(revisions, revisionCount);
+  YGNodeFreeRecursive(inPlace);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t sectionCount = 16;
+  const uint32_t revisionCount = 50;
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetNodesClonedFunc(config, YGNodesCloned);
+  bool ok = true;
+
+  YGNodeRef *const revisions = malloc(sizeof(YGNodeRef) * (revisionCount + 1));
+  revisions[0] = YGBuildList(config, sectionCount);
+  const YGNodeRef expected = YGBuildList(config, sectionCount);
+  YGNodeCalculateLayout(revisions[0], 375, YGUndefined, YGDirectionLTR);
+  YGNodeCalculateLayout(expected, 375, YGUndefined, YGDirectionLTR);
+  const uint64_t firstHash = YGHashLayout(revisions[0], 0);
+
+  uint32_t last = 0;
+  for (uint32_t i = 1; i <= revisionCount && ok; i++) {
+    revisions[i] = YGNodeClone(revisions[i - 1]);
+    YGEditList(revisions[i], i, sectionCount, true);
+    last = i;
+    YGEditList(expected, i, sectionCount, false);
+    ok = YGCheck(YGHashLayout(revisions[i], 0) == YGHashLayout(expected, 0),
+                 "lay out a revision like the list edited in place");
+  }
+
+  ok &= YGCheck(YGHashLayout(revisions[0], 0) == firstHash,
+                "keep the frames of the first revision");
+  ok &= YGCheck(gClonesValid, "report the clones in their parents");
+  // The layout writes to the sections and to the rows of the edited section,
+  // the other rows are shared with the last revision.
+  ok &= YGCheck(gClonedCount / revisionCount <=
+                    sectionCount + YG_ROWS_PER_SECTION * 5,
+                "clone the edited section only");
+
+  YGFreeRevisions(revisions, last);
+  YGNodeFreeRecursive(expected);
+  YGConfigFree(config);
+  return ok;
+}
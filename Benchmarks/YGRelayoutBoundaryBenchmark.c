@@ -0,0 +1,457 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Edits one label deep in a screen of cards and lays out what changed, with
+// the relayout boundaries of the fixed size cards and with the whole ancestor
+// chain, and reports the time and the nodes visited per edit of each. The test
+// checks that both lay out to the same frames, also for edits that resize a
+// card, make it overflow or reach the root, for cards aligned on their
+// baselines, for clones of edited cards laid out on the threads of a pool, and
+// that freeing an arena takes its cards out of the dirty roots of a config.
+//
+// Rounding skips the subtrees an edit didn't reach, which keep the layout they
+// were rounded to, so the screen only uses quarter points and edits that move
+// cards by whole pixels. Both ways then round every card alike.
+//
+//   YGRelayoutBoundaryBenchmark [cardCount] [edits]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFunc(text, YGMeasureText);
+  return text;
+}
+
+// A card of the screen: a thumbnail of a fixed size with a caption, and a
+// column of a title and a body. Most cards have a fixed size too, every fifth
+// grows with its body.
+static YGNodeRef YGBuildCard(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef card = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(card, YGFlexDirectionRow);
+  YGNodeStyleSetPadding(card, YGEdgeAll, 8.25f);
+  YGNodeStyleSetMargin(card, YGEdgeBottom, 6);
+  YGNodeStyleSetWidth(card, 330.5f);
+  if (index % 5 != 0) {
+    YGNodeStyleSetHeight(card, 96 + index % 3);
+  }
+
+  const YGNodeRef thumbnail = YGNodeNewWithConfig(config);
+  YGNodeStyleSetWidth(thumbnail, 64);
+  YGNodeStyleSetHeight(thumbnail, 64);
+  YGNodeStyleSetJustifyContent(thumbnail, YGJustifyFlexEnd);
+  YGNodeStyleSetMargin(thumbnail, YGEdgeEnd, 10.5f);
+  YGAppendChild(thumbnail, YGNewText(config, 3 + index % 5));
+  YGAppendChild(card, thumbnail);
+
+  const YGNodeRef texts = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexShrink(texts, 1);
+  YGAppendChild(texts, YGNewText(config, 10 + index % 9));
+  const YGNodeRef body = YGNewText(config, 30 + (index * 37) % 50);
+  YGNodeStyleSetMargin(body, YGEdgeTop, 3.25f);
+  YGAppendChild(texts, body);
+  YGAppendChild(card, texts);
+  return card;
+}
+
+// A header, a list of cards in sections, and a row of cards aligned on their
+// baselines, which content decides.
+static YGNodeRef YGBuildScreen(const YGConfigRef config,
+                               const uint32_t cardCount) {
+  const YGNodeRef screen = YGNodeNewWithConfig(config);
+  YGNodeStyleSetPadding(screen, YGEdgeHorizontal, 12.25f);
+
+  const YGNodeRef header = YGNodeNewWithConfig(config);
+  YGNodeStyleSetPadding(header, YGEdgeAll, 10);
+  YGAppendChild(header, YGNewText(config, 12));
+  YGAppendChild(screen, header);
+
+  const YGNodeRef list = YGNodeNewWithConfig(config);
+  YGNodeRef section = NULL;
+  for (uint32_t i = 0; i < cardCount; i++) {
+    if (i % 10 == 0) {
+      section = YGNodeNewWithConfig(config);
+      YGNodeStyleSetPadding(section, YGEdgeVertical, 4.25f);
+      YGAppendChild(list, section);
+    }
+    YGAppendChild(section, YGBuildCard(config, i));
+  }
+  YGAppendChild(screen, list);
+
+  const YGNodeRef baselines = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(baselines, YGFlexDirectionRow);
+  YGNodeStyleSetAlignItems(baselines, YGAlignBaseline);
+  for (uint32_t i = 0; i < 2; i++) {
+    const YGNodeRef card = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidth(card, 120);
+    YGNodeStyleSetHeight(card, 48);
+    YGAppendChild(card, YGNewText(config, 4 + i));
+    YGAppendChild(baselines, card);
+  }
+  YGAppendChild(screen, baselines);
+  return screen;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[6] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetRight(node),
+      YGNodeLayoutGetBottom(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[6];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 6; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  hash = (hash ^ YGNodeLayoutGetHadOverflow(node)) * 1099511628211ull;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+// Follows the child indexes in `path`, ending with -1.
+static YGNodeRef YGNodeAt(YGNodeRef node, const int32_t *path) {
+  for (; *path >= 0; path++) {
+    node = YGNodeGetChild(node, (uint32_t)*path);
+  }
+  return node;
+}
+
+static void YGSetText(const YGNodeRef text, const uint32_t length) {
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeMarkDirty(text);
+}
+
+// Lays out the edits made to both screens, the screen with its dirty layouts
+// and the reference from its root, and adds the nodes each visited.
+static bool YGLayoutBoth(const YGNodeRef screen, const YGNodeRef reference,
+                         const YGConfigRef config,
+                         const YGConfigRef referenceConfig,
+                         uint64_t *const screenVisits,
+                         uint64_t *const referenceVisits) {
+  YGConfigResetLayoutStats(config);
+  YGConfigResetLayoutStats(referenceConfig);
+  YGNodeCalculateDirtyLayouts(screen);
+  YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+  *screenVisits += YGConfigGetLayoutStats(config).nodesVisited;
+  *referenceVisits += YGConfigGetLayoutStats(referenceConfig).nodesVisited;
+  return YGHashLayout(screen, 0) == YGHashLayout(reference, 0);
+}
+
+static bool YGCheckEdits(const YGNodeRef screen, const YGNodeRef reference,
+                         const YGConfigRef config,
+                         const YGConfigRef referenceConfig) {
+  uint64_t screenVisits = 0;
+  uint64_t referenceVisits = 0;
+  bool ok = true;
+
+  // The body of the second card of the fourth section, and its card.
+  const int32_t body[] = {1, 3, 1, 1, 1, -1};
+  const int32_t cardPath[] = {1, 3, 1, -1};
+  YGSetText(YGNodeAt(screen, body), 90);
+  YGSetText(YGNodeAt(reference, body), 90);
+  ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                             &screenVisits, &referenceVisits),
+                "lay out an edit in a card like its ancestors");
+  ok &= YGCheck(screenVisits < 16 && referenceVisits > screenVisits,
+                "stop the edit at the card");
+
+  // The caption of the thumbnail, a boundary within the card.
+  const int32_t caption[] = {1, 3, 1, 0, 0, -1};
+  YGSetText(YGNodeAt(screen, caption), 11);
+  YGSetText(YGNodeAt(reference, caption), 11);
+  ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                             &screenVisits, &referenceVisits),
+                "lay out an edit in a thumbnail like its ancestors");
+
+  // A card that grows with its content, which the edit goes past.
+  const int32_t growingBody[] = {1, 2, 0, 1, 1, -1};
+  YGSetText(YGNodeAt(screen, growingBody), 120);
+  YGSetText(YGNodeAt(reference, growingBody), 120);
+  ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                             &screenVisits, &referenceVisits),
+                "lay out an edit in a growing card like its ancestors");
+
+  // Resizes the card itself, which its parent has to place again.
+  YGNodeStyleSetHeight(YGNodeAt(screen, cardPath), 140);
+  YGNodeStyleSetHeight(YGNodeAt(reference, cardPath), 140);
+  YGSetText(YGNodeAt(screen, body), 20);
+  YGSetText(YGNodeAt(reference, body), 20);
+  ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                             &screenVisits, &referenceVisits),
+                "lay out a resized card like its ancestors");
+
+  // A thumbnail too wide for its card makes it overflow, and then not.
+  const int32_t thumbnail[] = {1, 3, 1, 0, -1};
+  for (uint32_t i = 0; i < 2; i++) {
+    const float width = i == 0 ? 400 : 64;
+    YGNodeStyleSetWidth(YGNodeAt(screen, thumbnail), width);
+    YGNodeStyleSetWidth(YGNodeAt(reference, thumbnail), width);
+    ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                               &screenVisits, &referenceVisits),
+                  "lay out an overflowing card like its ancestors");
+  }
+
+  // The cards aligned on their baselines aren't boundaries.
+  const int32_t baseline[] = {2, 1, 0, -1};
+  YGSetText(YGNodeAt(screen, baseline), 40);
+  YGSetText(YGNodeAt(reference, baseline), 40);
+  ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                             &screenVisits, &referenceVisits),
+                "lay out an edit in a baseline aligned card");
+
+  // An edited card that is removed before the layout, then freed.
+  const int32_t removed[] = {1, 5, 2, -1};
+  const int32_t removedBody[] = {1, 5, 2, 1, 1, -1};
+  YGSetText(YGNodeAt(screen, removedBody), 7);
+  YGSetText(YGNodeAt(reference, removedBody), 7);
+  const YGNodeRef card = YGNodeAt(screen, removed);
+  const YGNodeRef referenceCard = YGNodeAt(reference, removed);
+  YGNodeRemoveChild(YGNodeGetParent(card), card);
+  YGNodeRemoveChild(YGNodeGetParent(referenceCard), referenceCard);
+  YGNodeFreeRecursive(card);
+  YGNodeFreeRecursive(referenceCard);
+  ok &= YGCheck(YGLayoutBoth(screen, reference, config, referenceConfig,
+                             &screenVisits, &referenceVisits),
+                "lay out the screen without a removed card");
+
+  // YGNodeCalculateLayout lays out the dirty roots too.
+  YGSetText(YGNodeAt(screen, body), 64);
+  YGSetText(YGNodeAt(reference, body), 64);
+  YGNodeCalculateLayout(screen, 375, 812, YGDirectionLTR);
+  YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+  ok &= YGCheck(YGHashLayout(screen, 0) == YGHashLayout(reference, 0),
+                "lay out the dirty roots with the root");
+  return ok;
+}
+
+// Edits cards of a screen, then lays out clones of it in a batch, on the
+// threads of a pool. The clones of the edited cards are dirty roots too, made
+// by the threads that lay out the clones of their sections.
+static bool YGCheckClones(const uint32_t cardCount) {
+  const YGThreadPoolRef pool = YGThreadPoolNew(4);
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef referenceConfig = YGConfigNew();
+  YGConfigSetUseRelayoutBoundaries(config, true);
+  // Cards that a pass doesn't visit keep their rounding when their section
+  // moves, so the layouts are compared before rounding.
+  YGConfigSetPointScaleFactor(config, 0);
+  YGConfigSetPointScaleFactor(referenceConfig, 0);
+  const YGNodeRef screen = YGBuildScreen(config, cardCount);
+  const YGNodeRef reference = YGBuildScreen(referenceConfig, cardCount);
+  YGNodeCalculateLayout(screen, 375, 812, YGDirectionLTR);
+  YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+
+  for (uint32_t i = 0; i < cardCount / 10; i++) {
+    const int32_t body[] = {1, (int32_t)i, (int32_t)(i % 9), 1, 1, -1};
+    YGSetText(YGNodeAt(screen, body), 12 + i % 40);
+    YGSetText(YGNodeAt(reference, body), 12 + i % 40);
+  }
+  YGNodeRef clones[8];
+  YGSize constraints[8];
+  for (uint32_t i = 0; i < 8; i++) {
+    clones[i] = YGNodeClone(screen);
+    constraints[i] = (YGSize){.width = 360, .height = 812};
+  }
+  const YGNodeRef referenceClone = YGNodeClone(reference);
+  YGNodeCalculateLayoutBatch(clones, constraints, 8, pool);
+  YGNodeCalculateLayout(referenceClone, 360, 812, YGDirectionLTR);
+  bool ok = true;
+  for (uint32_t i = 0; i < 8; i++) {
+    ok &= YGHashLayout(clones[i], 0) == YGHashLayout(referenceClone, 0);
+    YGNodeFreeRecursive(clones[i]);
+  }
+  ok = YGCheck(ok, "lay out clones of edited cards in a batch");
+  YGNodeFreeRecursive(referenceClone);
+
+  YGNodeCalculateDirtyLayouts(screen);
+  YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+  ok &= YGCheck(YGHashLayout(screen, 0) == YGHashLayout(reference, 0),
+                "lay out edited cards after clones of them");
+
+  YGNodeFreeRecursive(screen);
+  YGNodeFreeRecursive(reference);
+  YGConfigFree(config);
+  YGConfigFree(referenceConfig);
+  YGThreadPoolFree(pool);
+  return ok;
+}
+
+// Edits a card of a screen allocated in an arena but laid out with a config
+// outside it, and frees the arena with the card still in the dirty roots of
+// the config. The next layout of the config must not visit the card.
+static bool YGCheckArena(void) {
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef referenceConfig = YGConfigNew();
+  YGConfigSetUseRelayoutBoundaries(config, true);
+  YGConfigSetUseRelayoutBoundaries(referenceConfig, true);
+  const YGArenaRef arena = YGArenaNew(0);
+  const YGNodeRef screen = YGNodeNewInArena(arena, config);
+  for (uint32_t i = 0; i < 4; i++) {
+    const YGNodeRef card = YGNodeNewInArena(arena, config);
+    YGNodeStyleSetWidth(card, 330);
+    YGNodeStyleSetHeight(card, 96);
+    const YGNodeRef title = YGNodeNewInArena(arena, config);
+    YGNodeSetContext(title, (void *)(uintptr_t)12);
+    YGNodeSetMeasureFunc(title, YGMeasureText);
+    YGAppendChild(card, title);
+    YGAppendChild(screen, card);
+  }
+  YGNodeCalculateLayout(screen, 375, 812, YGDirectionLTR);
+  YGSetText(YGNodeGetChild(YGNodeGetChild(screen, 1), 0), 40);
+  YGArenaFree(arena);
+
+  const YGNodeRef card = YGBuildCard(config, 1);
+  const YGNodeRef reference = YGBuildCard(referenceConfig, 1);
+  YGLayoutStats stats;
+  YGLayoutStats referenceStats;
+  YGNodeCalculateLayoutWithStats(card, 375, 812, YGDirectionLTR, &stats);
+  YGNodeCalculateLayoutWithStats(reference, 375, 812, YGDirectionLTR,
+                                 &referenceStats);
+  const bool ok =
+      YGCheck(stats.nodesVisited == referenceStats.nodesVisited &&
+                  YGHashLayout(card, 0) == YGHashLayout(reference, 0),
+              "drop the dirty roots of a freed arena");
+
+  YGNodeFreeRecursive(card);
+  YGNodeFreeRecursive(reference);
+  YGConfigFree(config);
+  YGConfigFree(referenceConfig);
+  return ok;
+}
+
+typedef struct YGEditTotals {
+  double boundaryTime;
+  double ancestorTime;
+  uint64_t boundaryVisits;
+  uint64_t ancestorVisits;
+} YGEditTotals;
+
+// The configs of a screen with relayout boundaries and of its reference,
+// rounding in float in the first round and in fixed point in the second.
+static void YGNewConfigs(const uint32_t round, YGConfigRef *const config,
+                         YGConfigRef *const referenceConfig) {
+  *config = YGConfigNew();
+  *referenceConfig = YGConfigNew();
+  YGConfigSetUseRelayoutBoundaries(*config, true);
+  YGConfigSetPointScaleFactor(*config, 2);
+  YGConfigSetPointScaleFactor(*referenceConfig, 2);
+  YGConfigSetFixedPointRounding(*config, round == 1);
+  YGConfigSetFixedPointRounding(*referenceConfig, round == 1);
+}
+
+// Edits the title of a card at a time, which is laid out before the next
+// edit. The two screens alternate so that both see the same state of the
+// machine. Sections have 9 cards or more.
+static void YGEditTitles(const YGNodeRef screen, const YGNodeRef reference,
+                         const YGConfigRef config,
+                         const YGConfigRef referenceConfig,
+                         const uint32_t cardCount, const uint32_t edits,
+                         YGEditTotals *const totals) {
+  for (uint32_t i = 0; i < edits; i++) {
+    const int32_t title[] = {1, (int32_t)((i * 7) % (cardCount / 10)),
+                             (int32_t)((i * 4) % 9), 1, 0, -1};
+    const uint32_t length = 8 + i % 13;
+    const YGNodeRef referenceTitle = YGNodeAt(reference, title);
+    const YGNodeRef screenTitle = YGNodeAt(screen, title);
+
+    YGConfigResetLayoutStats(referenceConfig);
+    double start = YGNow();
+    YGSetText(referenceTitle, length);
+    YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+    totals->ancestorTime += YGNow() - start;
+    totals->ancestorVisits +=
+        YGConfigGetLayoutStats(referenceConfig).nodesVisited;
+
+    YGConfigResetLayoutStats(config);
+    start = YGNow();
+    YGSetText(screenTitle, length);
+    YGNodeCalculateDirtyLayouts(screen);
+    totals->boundaryTime += YGNow() - start;
+    totals->boundaryVisits += YGConfigGetLayoutStats(config).nodesVisited;
+  }
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t cardCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 500;
+  const uint32_t edits = argc > 2 ? (uint32_t)atoi(argv[2]) : 200;
+  YGEditTotals totals = {0};
+  uint32_t nodeCount = 0;
+
+  for (uint32_t round = 0; round < 2; round++) {
+    YGConfigRef config;
+    YGConfigRef referenceConfig;
+    YGNewConfigs(round, &config, &referenceConfig);
+    const YGNodeRef screen = YGBuildScreen(config, cardCount);
+    const YGNodeRef reference = YGBuildScreen(referenceConfig, cardCount);
+    nodeCount = YGCountNodes(screen);
+    YGNodeCalculateLayout(screen, 375, 812, YGDirectionLTR);
+    YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+    YGEditTitles(screen, reference, config, referenceConfig, cardCount, edits,
+                 &totals);
+
+    YGNodeFreeRecursive(screen);
+    YGNodeFreeRecursive(reference);
+    YGConfigFree(config);
+    YGConfigFree(referenceConfig);
+  }
+
+  const uint32_t editCount = 2 * edits;
+  printf("nodes=%u ancestors=%.2fus/edit (%.1f visits) "
+         "boundaries=%.2fus/edit (%.1f visits) (%.2fx)\n",
+         nodeCount, totals.ancestorTime * 1e3 / editCount,
+         (double)totals.ancestorVisits / editCount,
+         totals.boundaryTime * 1e3 / editCount,
+         (double)totals.boundaryVisits / editCount,
+         totals.ancestorTime / totals.boundaryTime);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t cardCount = 60;
+  bool ok = true;
+  for (uint32_t round = 0; round < 2; round++) {
+    YGConfigRef config;
+    YGConfigRef referenceConfig;
+    YGNewConfigs(round, &config, &referenceConfig);
+    const YGNodeRef screen = YGBuildScreen(config, cardCount);
+    const YGNodeRef reference = YGBuildScreen(referenceConfig, cardCount);
+    YGNodeCalculateLayout(screen, 375, 812, YGDirectionLTR);
+    YGNodeCalculateLayout(reference, 375, 812, YGDirectionLTR);
+    ok &= YGCheck(YGHashLayout(screen, 0) == YGHashLayout(reference, 0),
+                  "lay out the screen like the reference");
+    ok &= YGCheck(YGCheckEdits(screen, reference, config, referenceConfig),
+                  round == 0 ? "lay out the edits rounded in float"
+                             : "lay out the edits rounded in fixed point");
+
+    YGEditTotals totals = {0};
+    YGEditTitles(screen, reference, config, referenceConfig, cardCount, 40,
+                 &totals);
+    ok &= YGCheck(YGHashLayout(screen, 0) == YGHashLayout(reference, 0),
+                  "lay out the edited titles like the reference");
+
+    YGNodeFreeRecursive(screen);
+    YGNodeFreeRecursive(reference);
+    YGConfigFree(config);
+    YGConfigFree(referenceConfig);
+  }
+  ok &= YGCheckClones(cardCount);
+  ok &= YGCheckArena();
+  return ok;
+}
@@ -0,0 +1,192 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out a feed made of stacks only, rows and columns of children that
+// neither grow nor shrink, with their single pass and through the flex lines,
+// and reports the time per node of each. The test checks that both lay out to
+// the same frames, also after edits that make a stack flexible and plain again.
+//
+//   YGSimpleStackBenchmark [rowCount] [passes]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFunc(text, YGMeasureText);
+  return text;
+}
+
+// A row of the feed: an avatar, a column of texts and a badge, in one of a few
+// alignments and directions.
+static YGNodeRef YGBuildRow(const YGConfigRef config, const uint32_t index) {
+  const YGNodeRef row = YGNodeNewWithConfig(config);
+  YGNodeStyleSetFlexDirection(
+      row, index % 7 == 0 ? YGFlexDirectionRowReverse : YGFlexDirectionRow);
+  YGNodeStyleSetAlignItems(row, (YGAlign)(YGAlignFlexStart + index % 4));
+  YGNodeStyleSetPadding(row, YGEdgeHorizontal, 16);
+  YGNodeStyleSetPadding(row, YGEdgeVertical, 8 + index % 3);
+  YGNodeStyleSetBorder(row, YGEdgeBottom, 1);
+  if (index % 5 == 0) {
+    YGNodeStyleSetMinHeight(row, 72);
+  }
+
+  const YGNodeRef avatar = YGNodeNewWithConfig(config);
+  YGNodeStyleSetWidth(avatar, 40);
+  YGNodeStyleSetHeight(avatar, 40);
+  YGNodeStyleSetMargin(avatar, YGEdgeEnd, 12);
+  YGAppendChild(row, avatar);
+
+  const YGNodeRef texts = YGNodeNewWithConfig(config);
+  YGNodeStyleSetMaxWidth(texts, 260);
+  YGAppendChild(texts, YGNewText(config, 8 + index % 12));
+  const YGNodeRef body = YGNewText(config, 20 + (index * 37) % 60);
+  YGNodeStyleSetMargin(body, YGEdgeTop, 4);
+  YGAppendChild(texts, body);
+  if (index % 3 == 0) {
+    YGNodeStyleSetAlignSelf(texts, YGAlignCenter);
+  }
+  YGAppendChild(row, texts);
+
+  const YGNodeRef badge = YGNodeNewWithConfig(config);
+  YGNodeStyleSetPadding(badge, YGEdgeAll, 4);
+  YGNodeStyleSetMargin(badge, YGEdgeStart, 8);
+  YGAppendChild(badge, YGNewText(config, 1 + index % 3));
+  YGAppendChild(row, badge);
+  return row;
+}
+
+static YGNodeRef YGBuildFeed(const YGConfigRef config,
+                             const uint32_t rowCount) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < rowCount; i++) {
+    YGAppendChild(root, YGBuildRow(config, i));
+  }
+  return root;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[6] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetRight(node),
+      YGNodeLayoutGetBottom(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[6];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 6; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  hash = (hash ^ YGNodeLayoutGetHadOverflow(node)) * 1099511628211ull;
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+static bool YGLayoutBoth(const YGNodeRef feed, const YGNodeRef reference,
+                         const float width, const float height,
+                         const YGDirection direction) {
+  YGNodeCalculateLayout(feed, width, height, direction);
+  YGNodeCalculateLayout(reference, width, height, direction);
+  return YGHashLayout(feed, 0) == YGHashLayout(reference, 0);
+}
+
+// Applies the same edit to the row at `index` of both feeds.
+static void YGEditRow(const YGNodeRef feed, const YGNodeRef reference,
+                      const uint32_t index, const float flexGrow) {
+  YGNodeStyleSetFlexGrow(YGNodeGetChild(YGNodeGetChild(feed, index), 1),
+                         flexGrow);
+  YGNodeStyleSetFlexGrow(YGNodeGetChild(YGNodeGetChild(reference, index), 1),
+                         flexGrow);
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t rowCount = argc > 1 ? (uint32_t)atoi(argv[1]) : 2000;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 10;
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef generic = YGConfigNew();
+  YGConfigSetUseGenericLayoutKernels(generic, true);
+
+  const YGNodeRef feed = YGBuildFeed(config, rowCount);
+  const YGNodeRef reference = YGBuildFeed(generic, rowCount);
+  const uint32_t nodeCount = YGCountNodes(feed);
+  YGLayoutBoth(feed, reference, 360, YGUndefined, YGDirectionLTR);
+
+  // The passes alternate between the two feeds so that both see the same
+  // state of the machine, and the best of each is kept.
+  double genericTime = 0;
+  double stackTime = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    const float width = i % 2 == 0 ? 375 : 360;
+    double start = YGNow();
+    YGNodeCalculateLayout(reference, width, YGUndefined, YGDirectionLTR);
+    const double genericPass = YGNow() - start;
+    start = YGNow();
+    YGNodeCalculateLayout(feed, width, YGUndefined, YGDirectionLTR);
+    const double stackPass = YGNow() - start;
+    genericTime =
+        i == 0 || genericPass < genericTime ? genericPass : genericTime;
+    stackTime = i == 0 || stackPass < stackTime ? stackPass : stackTime;
+  }
+
+  printf("nodes=%u flex-lines=%.1fns/node stacks=%.1fns/node (%.2fx)\n",
+         nodeCount, genericTime * 1e6 / nodeCount, stackTime * 1e6 / nodeCount,
+         genericTime / stackTime);
+
+  YGNodeFreeRecursive(feed);
+  YGNodeFreeRecursive(reference);
+  YGConfigFree(generic);
+  YGConfigFree(config);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t rowCount = 200;
+  const YGConfigRef config = YGConfigNew();
+  const YGConfigRef generic = YGConfigNew();
+  YGConfigSetUseGenericLayoutKernels(generic, true);
+  bool ok = true;
+
+  const YGNodeRef feed = YGBuildFeed(config, rowCount);
+  const YGNodeRef reference = YGBuildFeed(generic, rowCount);
+
+  ok &= YGCheck(YGLayoutBoth(feed, reference, 375, YGUndefined, YGDirectionLTR),
+                "lay out the feed like the flex lines");
+  ok &= YGCheck(YGLayoutBoth(feed, reference, 320, 640, YGDirectionRTL),
+                "lay out the feed like the flex lines right to left");
+
+  // A growing text column makes its row flexible, and it becomes a stack
+  // again once the edit is undone.
+  for (uint32_t i = 0; i < rowCount; i += 97) {
+    YGEditRow(feed, reference, i, 1);
+  }
+  ok &= YGCheck(YGLayoutBoth(feed, reference, 375, YGUndefined, YGDirectionLTR),
+                "lay out the flexible rows like the flex lines");
+  for (uint32_t i = 0; i < rowCount; i += 97) {
+    YGEditRow(feed, reference, i, 0);
+  }
+  ok &= YGCheck(YGLayoutBoth(feed, reference, 360, YGUndefined, YGDirectionLTR),
+                "lay out the rows made plain again like the flex lines");
+  ok &= YGCheck(YGLayoutBoth(feed, reference, 375, YGUndefined, YGDirectionLTR),
+                "lay out the feed like the flex lines at a new width");
+
+  YGNodeFreeRecursive(feed);
+  YGNodeFreeRecursive(reference);
+  YGConfigFree(generic);
+  YGConfigFree(config);
+  return ok;
+}
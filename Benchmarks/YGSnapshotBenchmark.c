@@ -0,0 +1,209 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Snapshots a laid out feed of text cells, rebuilds the feed as the next
+// launch would and compares laying it out from scratch with restoring the
+// snapshot first. The test checks that the restored feed lays out to the same
+// frames, at the same width and at a new one, and that snapshots of a different
+// feed are rejected.
+//
+//   YGSnapshotBenchmark [cellCount]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+static YGSize YGMeasureShapedText(YGNodeRef node, float width,
+                                  YGMeasureMode widthMode, float height,
+                                  YGMeasureMode heightMode) {
+  // Stands in for shaping the text, which dominates real measurement.
+  volatile uint32_t state = (uint32_t)(uintptr_t)YGNodeGetContext(node);
+  for (uint32_t i = 0; i < 2000; i++) {
+    state = state * 1664525 + 1013904223;
+  }
+  return YGMeasureText(node, width, widthMode, height, heightMode);
+}
+
+static YGNodeRef YGNewText(const YGConfigRef config, const uint32_t length) {
+  const YGNodeRef text = YGNodeNewWithConfig(config);
+  YGNodeSetContext(text, (void *)(uintptr_t)length);
+  YGNodeSetMeasureFunc(text, YGMeasureShapedText);
+  YGNodeSetMeasureFingerprint(text, 0x9E3779B97F4A7C15ull * (length + 1));
+  YGNodeStyleSetFlexShrink(text, 1);
+  return text;
+}
+
+// `seed` changes the text of the first cell.
+static YGNodeRef YGBuildFeed(const YGConfigRef config, const uint32_t count,
+                             const uint32_t seed) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef cell = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(cell, YGFlexDirectionRow);
+    YGNodeStyleSetPadding(cell, YGEdgeAll, 12);
+    const YGNodeRef avatar = YGNodeNewWithConfig(config);
+    YGNodeStyleSetWidth(avatar, 40);
+    YGNodeStyleSetHeight(avatar, 40);
+    YGNodeStyleSetMargin(avatar, YGEdgeRight, 8);
+    YGAppendChild(cell, avatar);
+    const YGNodeRef content = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexGrow(content, 1);
+    YGNodeStyleSetFlexShrink(content, 1);
+    YGAppendChild(content, YGNewText(config, 10 + (i + seed) % 20));
+    YGAppendChild(content, YGNewText(config, 40 + (i * 37) % 300));
+    YGAppendChild(cell, content);
+    YGAppendChild(root, cell);
+  }
+  return root;
+}
+
+static uint64_t YGHashLayout(const YGNodeRef node, uint64_t hash) {
+  const float values[4] = {
+      YGNodeLayoutGetLeft(node),
+      YGNodeLayoutGetTop(node),
+      YGNodeLayoutGetWidth(node),
+      YGNodeLayoutGetHeight(node),
+  };
+  uint32_t bits[4];
+  memcpy(bits, values, sizeof(bits));
+  for (uint32_t i = 0; i < 4; i++) {
+    hash = (hash ^ bits[i]) * 1099511628211ull;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    hash = YGHashLayout(YGNodeGetChild(node, i), hash);
+  }
+  return hash;
+}
+
+// Restores the snapshot in `file` onto a feed built with `seed`.
+static bool YGRestoreFeed(const YGConfigRef config, FILE *file,
+                          const uint32_t count, const uint32_t seed) {
+  const YGNodeRef root = YGBuildFeed(config, count, seed);
+  rewind(file);
+  const bool restored = YGNodeRestoreSnapshot(root, file);
+  YGNodeFreeRecursive(root);
+  return restored;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 200;
+  const YGConfigRef config = YGConfigNew();
+  FILE *const file = tmpfile();
+  if (file == NULL) {
+    fprintf(stderr, "could not open a temporary file\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // The previous launch.
+  const YGNodeRef first = YGBuildFeed(config, count, 0);
+  double start = YGNow();
+  YGNodeCalculateLayout(first, 375, YGUndefined, YGDirectionLTR);
+  const double coldTime = YGNow() - start;
+  start = YGNow();
+  YGNodeSerializeSnapshot(first, file);
+  const double serializeTime = YGNow() - start;
+  const long size = ftell(file);
+  YGNodeFreeRecursive(first);
+
+  // The next one.
+  const YGNodeRef root = YGBuildFeed(config, count, 0);
+  rewind(file);
+  start = YGNow();
+  YGNodeRestoreSnapshot(root, file);
+  const double restoreTime = YGNow() - start;
+  start = YGNow();
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  const double warmTime = YGNow() - start;
+  YGLayoutStats stats;
+  YGNodeCalculateLayoutWithStats(root, 320, YGUndefined, YGDirectionLTR,
+                                 &stats);
+  YGNodeFreeRecursive(root);
+  fclose(file);
+  YGConfigFree(config);
+
+  printf("cells=%u bytes=%ld cold=%.3fms serialize=%.3fms restore=%.3fms "
+         "warm=%.3fms relayout-measures=%llu\n",
+         count, size, coldTime, serializeTime, restoreTime, warmTime,
+         (unsigned long long)stats.measureFuncCalls);
+}
+
+bool YGRunChecks(void) {
+  const uint32_t count = 50;
+  const YGConfigRef config = YGConfigNew();
+  FILE *const file = tmpfile();
+  bool ok = YGCheck(file != NULL, "open a temporary file");
+  if (!ok) {
+    YGConfigFree(config);
+    return false;
+  }
+
+  const YGNodeRef first = YGBuildFeed(config, count, 0);
+  YGNodeCalculateLayout(first, 375, YGUndefined, YGDirectionLTR);
+  const uint64_t coldHash = YGHashLayout(first, 0);
+  ok &= YGCheck(YGNodeSerializeSnapshot(first, file), "serialize");
+  const long size = ftell(file);
+  YGNodeStyleSetWidth(first, 320);
+  ok &= YGCheck(!YGNodeSerializeSnapshot(first, file),
+                "refuse to serialize a dirty tree");
+  YGNodeFreeRecursive(first);
+
+  const YGNodeRef root = YGBuildFeed(config, count, 0);
+  rewind(file);
+  ok &= YGCheck(YGNodeRestoreSnapshot(root, file), "restore");
+  YGLayoutStats stats;
+  YGNodeCalculateLayoutWithStats(root, 375, YGUndefined, YGDirectionLTR,
+                                 &stats);
+  ok &= YGCheck(stats.nodesVisited == 1 && stats.cachedLayoutHits == 1,
+                "answer the first layout from the cache");
+  ok &= YGCheck(YGHashLayout(root, 0) == coldHash, "restore the same layout");
+
+  // The restored caches must not change the layout at another width.
+  const YGNodeRef fresh = YGBuildFeed(config, count, 0);
+  YGNodeCalculateLayout(fresh, 320, YGUndefined, YGDirectionLTR);
+  YGNodeCalculateLayout(root, 320, YGUndefined, YGDirectionLTR);
+  ok &= YGCheck(YGHashLayout(root, 0) == YGHashLayout(fresh, 0),
+                "relayout the restored tree like a fresh one");
+  YGNodeFreeRecursive(fresh);
+  YGNodeFreeRecursive(root);
+
+  // Snapshots of other content, styles or versions don't apply.
+  ok &= YGCheck(!YGRestoreFeed(config, file, count, 1),
+                "reject a snapshot of other text");
+  ok &= YGCheck(!YGRestoreFeed(config, file, count + 1, 0),
+                "reject a snapshot of another tree");
+  const YGNodeRef styled = YGBuildFeed(config, count, 0);
+  YGNodeStyleSetPadding(YGNodeGetChild(styled, count - 1), YGEdgeTop, 13);
+  rewind(file);
+  ok &= YGCheck(!YGNodeRestoreSnapshot(styled, file),
+                "reject a snapshot of other styles");
+  YGNodeFreeRecursive(styled);
+  const YGConfigRef scaled = YGConfigNew();
+  YGConfigSetPointScaleFactor(scaled, 3);
+  ok &= YGCheck(!YGRestoreFeed(scaled, file, count, 0),
+                "reject a snapshot taken at another scale");
+  YGConfigFree(scaled);
+  FILE *const truncated = tmpfile();
+  if (truncated != NULL) {
+    uint8_t *const bytes = malloc((size_t)size);
+    rewind(file);
+    const size_t read = fread(bytes, 1, (size_t)size, file);
+    fwrite(bytes, 1, read - 1, truncated);
+    free(bytes);
+    ok &= YGCheck(!YGRestoreFeed(config, truncated, count, 0),
+                  "reject a truncated snapshot");
+    fclose(truncated);
+  }
+  fclose(file);
+  YGConfigFree(config);
+  return ok;
+}
@@ -0,0 +1,23 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "YGBenchmarkSupport.h"
+
+int main(void) {
+  const bool ok = YGRunChecks();
+  if (YGNodeGetInstanceCount() != 0) {
+    fprintf(stderr, "leaked %d nodes\n", YGNodeGetInstanceCount());
+    return EXIT_FAILURE;
+  }
+  printf("%s\n", ok ? "ok" : "BROKEN");
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
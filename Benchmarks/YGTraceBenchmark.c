@@ -0,0 +1,230 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Lays out rows of baseline aligned text serially and on a thread pool,
+// without an event handler, with one that checks the events and with a
+// Chrome trace sink, and reports what tracing costs. The test checks that the
+// events nest on every thread and match the stats of the layouts.
+//
+//   YGTraceBenchmark [rowCount] [passes] [trace.json]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+#define YG_MAX_THREADS 64
+#define YG_MAX_NESTING 256
+
+// Open begin events of each thread, indexed by YGEvent.thread. Only the
+// thread itself touches its stack.
+typedef struct YGEventStack {
+  YGEventType types[YG_MAX_NESTING];
+  uint32_t count;
+} YGEventStack;
+
+static YGEventStack gStacks[YG_MAX_THREADS];
+static uint64_t gCounts[YGEventTypeCount];
+static uint64_t gDeferredCount = 0;
+static uint32_t gErrors = 0;
+
+static void YGCheckEvent(const YGConfigRef config, const YGEvent *event,
+                         void *context) {
+  (void)config;
+  (void)context;
+  __atomic_add_fetch(&gCounts[event->type], 1, __ATOMIC_RELAXED);
+  if (event->thread == 0 || event->thread >= YG_MAX_THREADS) {
+    __atomic_add_fetch(&gErrors, 1, __ATOMIC_RELAXED);
+    return;
+  }
+  YGEventStack *const stack = &gStacks[event->thread];
+  // Begin events have even types, each followed by its end.
+  if (event->type % 2 == 0) {
+    if (event->type == YGEventTypeNodeLayoutBegin &&
+        strcmp(event->reason, "deferred") == 0) {
+      __atomic_add_fetch(&gDeferredCount, 1, __ATOMIC_RELAXED);
+    }
+    if (stack->count < YG_MAX_NESTING) {
+      stack->types[stack->count] = event->type;
+    }
+    stack->count++;
+  } else if (stack->count == 0 ||
+             (stack->count <= YG_MAX_NESTING &&
+              stack->types[stack->count - 1] != event->type - 1)) {
+    __atomic_add_fetch(&gErrors, 1, __ATOMIC_RELAXED);
+  } else {
+    stack->count--;
+  }
+}
+
+static YGSize YGMeasureLabel(YGNodeRef node, float width,
+                             YGMeasureMode widthMode, float height,
+                             YGMeasureMode heightMode) {
+  const float textWidth = 20 + 7 * (float)(uintptr_t)YGNodeGetContext(node);
+  return YGMeasureTextOfWidth(textWidth, 16, width, widthMode, height,
+                              heightMode);
+}
+
+static float YGTextBaseline(YGNodeRef node, const float width,
+                            const float height) {
+  (void)node;
+  (void)width;
+  return height - 4;
+}
+
+// Rows of an exact size, so that a pool lays them out in parallel.
+static YGNodeRef YGBuildTree(const YGConfigRef config, const uint32_t rows) {
+  const YGNodeRef root = YGNodeNewWithConfig(config);
+  for (uint32_t i = 0; i < rows; i++) {
+    const YGNodeRef row = YGNodeNewWithConfig(config);
+    YGNodeStyleSetFlexDirection(row, YGFlexDirectionRow);
+    YGNodeStyleSetFlexWrap(row, YGWrapWrap);
+    YGNodeStyleSetAlignItems(row, YGAlignBaseline);
+    YGNodeStyleSetHeight(row, 200);
+    for (uint32_t j = 0; j < 40; j++) {
+      const YGNodeRef item = YGNodeNewWithConfig(config);
+      YGNodeStyleSetPadding(item, YGEdgeAll, (float)(j % 3));
+      const YGNodeRef text = YGNodeNewWithConfig(config);
+      YGNodeSetContext(text, (void *)(uintptr_t)((i + j) % 9));
+      YGNodeSetMeasureFunc(text, YGMeasureLabel);
+      YGNodeSetBaselineFunc(text, YGTextBaseline);
+      YGAppendChild(item, text);
+      YGAppendChild(row, item);
+    }
+    YGAppendChild(root, row);
+  }
+  return root;
+}
+
+// Returns the best time of a pass, in milliseconds.
+static double YGRunPasses(const YGNodeRef root, const uint32_t passes,
+                          YGLayoutStats *const stats) {
+  memset(stats, 0, sizeof(YGLayoutStats));
+  double best = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    // A new width every pass invalidates the whole tree.
+    YGNodeStyleSetWidth(root, 600 + 13 * (float)(i % 7));
+    YGLayoutStats pass;
+    const double start = YGNow();
+    YGNodeCalculateLayoutWithStats(root, YGUndefined, YGUndefined,
+                                   YGDirectionLTR, &pass);
+    const double time = YGNow() - start;
+    best = i == 0 || time < best ? time : best;
+    stats->nodesVisited += pass.nodesVisited;
+    stats->measureFuncCalls += pass.measureFuncCalls;
+  }
+  return best;
+}
+
+static void YGResetEvents(void) {
+  memset(gStacks, 0, sizeof(gStacks));
+  memset(gCounts, 0, sizeof(gCounts));
+  gDeferredCount = 0;
+  gErrors = 0;
+}
+
+// Returns the number of errors in the events YGCheckEvent saw since they were
+// reset, for `passes` layouts with `stats`.
+static uint32_t YGCountEventErrors(const uint32_t passes,
+                                   const YGLayoutStats *const stats) {
+  uint32_t errors = gErrors;
+  for (uint32_t i = 0; i < YG_MAX_THREADS; i++) {
+    errors += gStacks[i].count;
+  }
+  for (uint32_t type = 0; type < YGEventTypeCount; type += 2) {
+    errors += gCounts[type] != gCounts[type + 1];
+  }
+  errors += gCounts[YGEventTypeLayoutBegin] != passes;
+  errors += gCounts[YGEventTypeNodeLayoutBegin] - gDeferredCount !=
+            stats->nodesVisited;
+  errors += gCounts[YGEventTypeMeasureBegin] != stats->measureFuncCalls;
+  errors += gCounts[YGEventTypeBaselineBegin] == 0;
+  return errors;
+}
+
+static void YGRunScenario(const uint32_t rows, const uint32_t passes,
+                          const YGThreadPoolRef pool,
+                          const YGTraceSinkRef sink) {
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetParallelism(config, pool);
+  const YGNodeRef root = YGBuildTree(config, rows);
+  const char *const name = pool != NULL ? "parallel" : "serial";
+
+  YGLayoutStats stats;
+  const double untraced = YGRunPasses(root, passes, &stats);
+
+  YGResetEvents();
+  YGConfigSetEventHandler(config, YGCheckEvent, NULL);
+  const double checked = YGRunPasses(root, passes, &stats);
+
+  YGConfigSetEventHandler(config, YGTraceSinkHandleEvent, sink);
+  const double written = YGRunPasses(root, passes, &stats);
+  YGConfigSetEventHandler(config, NULL, NULL);
+
+  printf("%-8s events/pass=%8.1f deferred/pass=%5.1f untraced=%7.3fms "
+         "checked=%7.3fms trace=%7.3fms\n",
+         name,
+         (double)(gCounts[YGEventTypeNodeLayoutBegin] +
+                  gCounts[YGEventTypeMeasureBegin] +
+                  gCounts[YGEventTypeBaselineBegin]) *
+             2 / passes,
+         (double)gDeferredCount / passes, untraced, checked, written);
+
+  YGNodeFreeRecursive(root);
+  YGConfigFree(config);
+}
+
+// Returns whether the events of laying out the rows on `pool` are consistent.
+static bool YGCheckScenario(const uint32_t rows, const uint32_t passes,
+                            const YGThreadPoolRef pool) {
+  const YGConfigRef config = YGConfigNew();
+  YGConfigSetParallelism(config, pool);
+  const YGNodeRef root = YGBuildTree(config, rows);
+  YGResetEvents();
+  YGConfigSetEventHandler(config, YGCheckEvent, NULL);
+  YGLayoutStats stats;
+  YGRunPasses(root, passes, &stats);
+  const uint32_t errors = YGCountEventErrors(passes, &stats);
+  YGNodeFreeRecursive(root);
+  YGConfigFree(config);
+  return errors == 0;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t rows = argc > 1 ? (uint32_t)atoi(argv[1]) : 40;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 10;
+  FILE *const trace = argc > 3 ? fopen(argv[3], "w") : tmpfile();
+  if (trace == NULL) {
+    fprintf(stderr, "could not open the trace file\n");
+    exit(EXIT_FAILURE);
+  }
+
+  // Both scenarios go to the same trace.
+  const YGTraceSinkRef sink = YGTraceSinkNew(trace);
+  YGRunScenario(rows, passes, NULL, sink);
+  const YGThreadPoolRef pool = YGThreadPoolNew(3);
+  if (pool != NULL) {
+    YGRunScenario(rows, passes, pool, sink);
+    YGThreadPoolFree(pool);
+  }
+  YGTraceSinkFree(sink);
+  fclose(trace);
+}
+
+bool YGRunChecks(void) {
+  bool ok = YGCheck(YGCheckScenario(8, 3, NULL), "nest the events of a layout");
+  const YGThreadPoolRef pool = YGThreadPoolNew(3);
+  if (pool != NULL) {
+    ok &= YGCheck(YGCheckScenario(8, 3, pool),
+                  "nest the events of a parallel layout on every thread");
+    YGThreadPoolFree(pool);
+  }
+  return ok;
+}
@@ -0,0 +1,400 @@
+/**
+ * Copyright (c) 2014-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+
+// Compares a YGTree against the same hierarchy built from individually
+// allocated nodes: build, first layout, full relayout, relayout after editing
+// a leaf and deep copy times, and the memory held per node. The test checks
+// that both lay out the same on trees of different shapes and styles, also
+// after edits and once copied.
+//
+//   YGTreeBenchmark [nodeCount] [passes]
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "YGBenchmarkSupport.h"
+
+// Every allocation is prefixed with its size so frees can be accounted for.
+#define YG_HEADER_SIZE 16
+
+static size_t gLiveBytes = 0;
+
+static void *YGTrackingMalloc(size_t size) {
+  char *block = malloc(size + YG_HEADER_SIZE);
+  *(size_t *)block = size;
+  gLiveBytes += size;
+  return block + YG_HEADER_SIZE;
+}
+
+static void *YGTrackingCalloc(size_t count, size_t size) {
+  void *ptr = YGTrackingMalloc(count * size);
+  memset(ptr, 0, count * size);
+  return ptr;
+}
+
+static void YGTrackingFree(void *ptr) {
+  if (ptr == NULL) {
+    return;
+  }
+  char *block = (char *)ptr - YG_HEADER_SIZE;
+  gLiveBytes -= *(size_t *)block;
+  free(block);
+}
+
+static void *YGTrackingRealloc(void *ptr, size_t size) {
+  if (ptr == NULL) {
+    return YGTrackingMalloc(size);
+  }
+  char *block = (char *)ptr - YG_HEADER_SIZE;
+  gLiveBytes -= *(size_t *)block;
+  block = realloc(block, size + YG_HEADER_SIZE);
+  *(size_t *)block = size;
+  gLiveBytes += size;
+  return block + YG_HEADER_SIZE;
+}
+
+// Nodes are numbered breadth first, which is the order of the handles of the
+// tree, and each has `fanout` children until there are `count` of them.
+static uint32_t YGParentIndex(const uint32_t index, const uint32_t fanout) {
+  return (index - 1) / fanout;
+}
+
+static bool YGIsLeaf(const uint32_t index, const uint32_t count,
+                     const uint32_t fanout) {
+  return index * fanout + 1 >= count;
+}
+
+// Both trees get the same styles, keyed by the index of the node. `seed`
+// varies them from one check to the next.
+static void YGApplyStyle(const YGNodeRef node, const uint32_t index,
+                         const uint32_t count, const uint32_t fanout,
+                         const uint32_t seed) {
+  const uint32_t key = index + seed;
+  if (YGIsLeaf(index, count, fanout)) {
+    YGNodeSetContext(node, (void *)(uintptr_t)(4 + (key * 37) % 60));
+    YGNodeSetMeasureFunc(node, YGMeasureText);
+  } else if (key % 2 == 0) {
+    YGNodeStyleSetFlexDirection(node, YGFlexDirectionRow);
+    if (key % 4 == 0) {
+      YGNodeStyleSetFlexWrap(node, YGWrapWrap);
+      YGNodeStyleSetAlignContent(node, YGAlignSpaceBetween);
+    } else {
+      YGNodeStyleSetAlignItems(node, YGAlignBaseline);
+    }
+  } else {
+    YGNodeStyleSetJustifyContent(node, (YGJustify)(key % 5));
+  }
+  if (key % 3 == 0) {
+    YGNodeStyleSetFlexGrow(node, 1);
+  }
+  if (key % 5 == 0) {
+    YGNodeStyleSetPadding(node, YGEdgeAll, 4);
+  }
+  if (key % 7 == 0) {
+    YGNodeStyleSetMargin(node, YGEdgeStart, 2);
+    YGNodeStyleSetMargin(node, YGEdgeTop, 3);
+  }
+  if (index > 0 && key % 13 == 0) {
+    YGNodeStyleSetPositionType(node, YGPositionTypeAbsolute);
+    YGNodeStyleSetPosition(node, YGEdgeEnd, 6);
+    YGNodeStyleSetPosition(node, YGEdgeTop, 10);
+  }
+}
+
+// Builds the pointer tree and returns its nodes by index.
+static YGNodeRef *YGBuildPointerTree(const YGConfigRef config,
+                                     const uint32_t count,
+                                     const uint32_t fanout,
+                                     const uint32_t seed) {
+  YGNodeRef *const nodes = malloc(sizeof(YGNodeRef) * count);
+  for (uint32_t i = 0; i < count; i++) {
+    nodes[i] = YGNodeNewWithConfig(config);
+    YGApplyStyle(nodes[i], i, count, fanout, seed);
+    if (i > 0) {
+      YGAppendChild(nodes[YGParentIndex(i, fanout)], nodes[i]);
+    }
+  }
+  return nodes;
+}
+
+static YGTreeRef YGBuildTree(const YGConfigRef config, const uint32_t count,
+                             const uint32_t fanout, const uint32_t seed) {
+  const YGTreeRef tree = YGTreeNew(config);
+  YGTreeReserve(tree, count);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeHandle handle = YGTreeAppendNode(
+        tree, i > 0 ? YGParentIndex(i, fanout) : YGNodeHandleNone);
+    YGApplyStyle(YGTreeGetNode(tree, handle), i, count, fanout, seed);
+  }
+  return tree;
+}
+
+// Deep copy of a pointer tree, the closest equivalent of YGTreeCopy.
+static YGNodeRef YGCopyPointerTree(const YGNodeRef node) {
+  const YGNodeRef copy = YGNodeClone(node);
+  YGNodeRemoveAllChildren(copy);
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  for (uint32_t i = 0; i < childCount; i++) {
+    YGAppendChild(copy, YGCopyPointerTree(YGNodeGetChild(node, i)));
+  }
+  return copy;
+}
+
+static bool YGSameLayout(const YGNodeRef a, const YGNodeRef b) {
+  const float layoutA[6] = {
+      YGNodeLayoutGetLeft(a),  YGNodeLayoutGetTop(a),
+      YGNodeLayoutGetRight(a), YGNodeLayoutGetBottom(a),
+      YGNodeLayoutGetWidth(a), YGNodeLayoutGetHeight(a),
+  };
+  const float layoutB[6] = {
+      YGNodeLayoutGetLeft(b),  YGNodeLayoutGetTop(b),
+      YGNodeLayoutGetRight(b), YGNodeLayoutGetBottom(b),
+      YGNodeLayoutGetWidth(b), YGNodeLayoutGetHeight(b),
+  };
+  return memcmp(layoutA, layoutB, sizeof(layoutA)) == 0;
+}
+
+// Walks the tree through its topology columns, and the pointer tree alongside.
+static bool YGSameLayouts(const YGNodeRef node, const YGTreeRef tree,
+                          const YGNodeHandle handle) {
+  if (!YGSameLayout(node, YGTreeGetNode(tree, handle))) {
+    return false;
+  }
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  YGNodeHandle child = YGTreeGetFirstChild(tree, handle);
+  for (uint32_t i = 0; i < childCount; i++) {
+    if (child == YGNodeHandleNone ||
+        !YGSameLayouts(YGNodeGetChild(node, i), tree, child)) {
+      return false;
+    }
+    child = YGTreeGetNextSibling(tree, child);
+  }
+  return child == YGNodeHandleNone;
+}
+
+// Checks that the nodes of the tree are linked like those of the pointer tree.
+static bool YGSameShape(YGNodeRef *const nodes, const YGTreeRef tree) {
+  const uint32_t count = YGTreeGetNodeCount(tree);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef node = YGTreeGetNode(tree, i);
+    const YGNodeRef parent = YGNodeGetParent(node);
+    const YGNodeHandle parentHandle = YGTreeGetParent(tree, i);
+    if (YGTreeGetNodeHandle(tree, node) != i ||
+        YGNodeGetChildCount(node) != YGNodeGetChildCount(nodes[i]) ||
+        (parent == NULL ? parentHandle != YGNodeHandleNone
+                        : parent != YGTreeGetNode(tree, parentHandle))) {
+      return false;
+    }
+    const uint32_t childCount = YGNodeGetChildCount(node);
+    if (childCount > 0 &&
+        YGNodeGetParent(YGNodeGetChild(node, childCount - 1)) != node) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Makes the text of leaf `index` `length` characters long in both trees.
+static void YGEditText(YGNodeRef *const nodes, const YGTreeRef tree,
+                       const uint32_t index, const uint32_t length) {
+  const YGNodeRef leaves[2] = {nodes[index], YGTreeGetNode(tree, index)};
+  for (uint32_t i = 0; i < 2; i++) {
+    YGNodeSetContext(leaves[i], (void *)(uintptr_t)length);
+    YGNodeMarkDirty(leaves[i]);
+  }
+}
+
+static void YGFreePointerTree(YGNodeRef *const nodes) {
+  YGNodeFreeRecursive(nodes[0]);
+  free(nodes);
+}
+
+static bool YGCheckShape(const YGConfigRef config, const uint32_t count,
+                         const uint32_t fanout, const uint32_t seed) {
+  bool ok = true;
+  YGNodeRef *const nodes = YGBuildPointerTree(config, count, fanout, seed);
+  const YGTreeRef tree = YGBuildTree(config, count, fanout, seed);
+  const YGNodeRef root = nodes[0];
+  const YGNodeRef treeRoot = YGTreeGetNode(tree, 0);
+  ok &= YGCheck(YGSameShape(nodes, tree), "link the nodes of a tree");
+
+  const YGDirection direction = seed % 2 == 0 ? YGDirectionLTR : YGDirectionRTL;
+  YGNodeCalculateLayout(root, 375, YGUndefined, direction);
+  YGTreeCalculateLayout(tree, 375, YGUndefined, direction);
+  ok &= YGCheck(YGSameLayouts(root, tree, 0), "lay out a tree");
+
+  // An edit deep down dirties the ancestors through the parent column.
+  const uint32_t leaf = count - 1;
+  YGEditText(nodes, tree, leaf, 90);
+  const YGNodeHandle parent = YGTreeGetParent(tree, leaf);
+  ok &= YGCheck(YGNodeIsDirty(treeRoot) &&
+                    (parent == YGNodeHandleNone ||
+                     YGNodeIsDirty(YGTreeGetNode(tree, parent))),
+                "dirty the ancestors of an edited node of a tree");
+  YGNodeCalculateLayout(root, 375, YGUndefined, direction);
+  YGTreeCalculateLayout(tree, 375, YGUndefined, direction);
+  ok &= YGCheck(!YGNodeIsDirty(treeRoot) && YGSameLayouts(root, tree, 0),
+                "lay out a tree after editing a leaf");
+
+  YGNodeStyleSetWidth(root, 300);
+  YGNodeStyleSetWidth(treeRoot, 300);
+  YGNodeStyleSetPadding(nodes[count / 2], YGEdgeLeft, 9);
+  YGNodeStyleSetPadding(YGTreeGetNode(tree, count / 2), YGEdgeLeft, 9);
+  YGNodeCalculateLayout(root, 375, YGUndefined, direction);
+  YGTreeCalculateLayout(tree, 375, YGUndefined, direction);
+  ok &= YGCheck(YGSameLayouts(root, tree, 0),
+                "lay out a tree after editing its styles");
+
+  // A copy of a tree keeps the layout caches of the tree, where the deep copy
+  // of a pointer tree is dirty, so each copy is laid out against the original
+  // of the other, which leaves the copied one as it was.
+  const YGNodeRef rootCopy = YGCopyPointerTree(root);
+  const YGTreeRef treeCopy = YGTreeCopy(tree);
+  ok &= YGCheck(YGSameLayouts(rootCopy, treeCopy, 0), "copy a tree");
+  YGNodeStyleSetWidth(root, 250);
+  YGNodeStyleSetWidth(YGTreeGetNode(treeCopy, 0), 250);
+  YGNodeCalculateLayout(root, 375, YGUndefined, direction);
+  YGTreeCalculateLayout(treeCopy, 375, YGUndefined, direction);
+  ok &= YGCheck(YGSameLayouts(root, treeCopy, 0) &&
+                    YGNodeLayoutGetWidth(YGTreeGetNode(treeCopy, 0)) == 250,
+                "lay out a copy of a tree");
+  ok &= YGCheck(YGSameLayouts(rootCopy, tree, 0) &&
+                    YGNodeLayoutGetWidth(treeRoot) == 300,
+                "keep the layout of a copied tree");
+
+  YGNodeFreeRecursive(rootCopy);
+  YGTreeFree(treeCopy);
+  YGFreePointerTree(nodes);
+  YGTreeFree(tree);
+  return ok;
+}
+
+bool YGRunChecks(void) {
+  const YGConfigRef config = YGConfigNew();
+  bool ok = true;
+  uint32_t mismatches = 0;
+  // Includes trees of more than one chunk of nodes.
+  const uint32_t counts[] = {1, 2, 7, 40, 300, 1100};
+  for (uint32_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++) {
+    for (uint32_t fanout = 1; fanout <= 5; fanout++) {
+      for (uint32_t seed = 0; seed < 4; seed++) {
+        mismatches += YGCheckShape(config, counts[i], fanout, seed) ? 0 : 1;
+      }
+    }
+  }
+  ok &= YGCheck(mismatches == 0, "lay out trees like pointer trees");
+
+  // Web defaults apply to the nodes of a tree as to any other.
+  const YGConfigRef webConfig = YGConfigNew();
+  YGConfigSetUseWebDefaults(webConfig, true);
+  ok &= YGCheckShape(webConfig, 40, 3, 1);
+  YGConfigFree(webConfig);
+
+  YGConfigFree(config);
+  return ok;
+}
+
+static void YGPrintResult(const char *name, const uint32_t count,
+                          const size_t bytes, const double build,
+                          const double layout, const double relayout,
+                          const double edit, const double copy) {
+  printf("%-8s nodes=%-7u bytes/node=%.1f build=%.1fns/node "
+         "layout=%.1fns/node relayout=%.1fns/node edit=%.1fus "
+         "copy=%.1fns/node\n",
+         name, count, (double)bytes / count, build * 1e6 / count,
+         layout * 1e6 / count, relayout * 1e6 / count, edit * 1e3,
+         copy * 1e6 / count);
+}
+
+static double YGMin(const uint32_t pass, const double time,
+                    const double best) {
+  return pass == 0 || time < best ? time : best;
+}
+
+void YGRunBenchmark(int argc, char *argv[]) {
+  const uint32_t count = argc > 1 ? (uint32_t)atoi(argv[1]) : 10000;
+  const uint32_t passes = argc > 2 ? (uint32_t)atoi(argv[2]) : 20;
+  const uint32_t fanout = 4;
+  YGSetMemoryFuncs(&YGTrackingMalloc, &YGTrackingCalloc, &YGTrackingRealloc,
+                   &YGTrackingFree);
+  const YGConfigRef config = YGConfigNew();
+
+  size_t bytes = gLiveBytes;
+  double start = YGNow();
+  YGNodeRef *const nodes = YGBuildPointerTree(config, count, fanout, 0);
+  const double pointerBuild = YGNow() - start;
+  const YGNodeRef root = nodes[0];
+  start = YGNow();
+  YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+  const double pointerLayout = YGNow() - start;
+  const size_t pointerBytes = gLiveBytes - bytes;
+
+  bytes = gLiveBytes;
+  start = YGNow();
+  const YGTreeRef tree = YGBuildTree(config, count, fanout, 0);
+  const double treeBuild = YGNow() - start;
+  start = YGNow();
+  YGTreeCalculateLayout(tree, 375, YGUndefined, YGDirectionLTR);
+  const double treeLayout = YGNow() - start;
+  const size_t treeBytes = gLiveBytes - bytes;
+
+  // Relayout at alternating widths so every pass traverses the whole tree,
+  // then after editing a leaf, which only lays out its ancestors again.
+  double pointerRelayout = 0;
+  double treeRelayout = 0;
+  double pointerEdit = 0;
+  double treeEdit = 0;
+  const YGNodeRef treeRoot = YGTreeGetNode(tree, 0);
+  for (uint32_t i = 0; i < passes; i++) {
+    const float width = i % 2 == 0 ? 320 : 340;
+    YGNodeStyleSetWidth(root, width);
+    start = YGNow();
+    YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+    pointerRelayout = YGMin(i, YGNow() - start, pointerRelayout);
+    YGNodeStyleSetWidth(treeRoot, width);
+    start = YGNow();
+    YGTreeCalculateLayout(tree, 375, YGUndefined, YGDirectionLTR);
+    treeRelayout = YGMin(i, YGNow() - start, treeRelayout);
+
+    YGEditText(nodes, tree, count - 1 - i % fanout, 10 + i % 40);
+    start = YGNow();
+    YGNodeCalculateLayout(root, 375, YGUndefined, YGDirectionLTR);
+    pointerEdit = YGMin(i, YGNow() - start, pointerEdit);
+    start = YGNow();
+    YGTreeCalculateLayout(tree, 375, YGUndefined, YGDirectionLTR);
+    treeEdit = YGMin(i, YGNow() - start, treeEdit);
+  }
+
+  double pointerCopy = 0;
+  double treeCopy = 0;
+  for (uint32_t i = 0; i < passes; i++) {
+    start = YGNow();
+    const YGNodeRef rootCopy = YGCopyPointerTree(root);
+    pointerCopy = YGMin(i, YGNow() - start, pointerCopy);
+    start = YGNow();
+    const YGTreeRef copy = YGTreeCopy(tree);
+    treeCopy = YGMin(i, YGNow() - start, treeCopy);
+    YGNodeFreeRecursive(rootCopy);
+    YGTreeFree(copy);
+  }
+
+  YGPrintResult("pointer", count, pointerBytes, pointerBuild, pointerLayout,
+                pointerRelayout, pointerEdit, pointerCopy);
+  YGPrintResult("tree", count, treeBytes, treeBuild, treeLayout, treeRelayout,
+                treeEdit, treeCopy);
+  if (!YGSameLayouts(root, tree, 0)) {
+    fprintf(stderr, "tree and pointer layouts differ\n");
+  }
+
+  YGFreePointerTree(nodes);
+  YGTreeFree(tree);
+  YGConfigFree(config);
+}
@@ -75,6 +75,8 @@
   YG_VALUE_EDGE_PROPERTY(lowercased_name, capitalized_name, capitalized_name, YGEdgeAll)
 
 static YGConfigRef globalConfig;
+// Shared by all views, so labels recreated with the same text aren't measured again.
+static YGMeasureCacheRef globalMeasureCache;
 
 @interface YGLayout ()
 
@@ -91,6 +93,8 @@ static YGConfigRef globalConfig;
 + (void)initialize {
   globalConfig = YGConfigNew();
   YGConfigSetExperimentalFeatureEnabled(globalConfig, YGExperimentalFeatureWebFlexBasis, true);
+  globalMeasureCache = YGMeasureCacheNew(512 * 1024);
+  YGConfigSetMeasureCache(globalConfig, globalMeasureCache);
 }
 
 - (instancetype)initWithView:(UIView *)view {
@@ -227,11 +231,26 @@ YG_PROPERTY(CGFloat, aspectRatio, AspectRatio)
 }
 
 - (CGSize)intrinsicSize {
-  const CGSize constrainedSize = {
-      .width = YGUndefined,
-      .height = YGUndefined,
+  NSAssert([NSThread isMainThread], @"Yoga calculation must be done on main.");
+  YGAttachNodesFromViewHierachy(self.view);
+  const YGNodeRef node = self.node;
+  // Only measures, the frames are left to the next layout.
+  const YGSize size = YGNodeCalculateSize(node, YGUndefined, YGMeasureModeUndefined, YGUndefined,
+                                          YGMeasureModeUndefined);
+  const float scale = YGConfigGetPointScaleFactor(globalConfig);
+  if (scale == 0) {
+    return (CGSize){
+        .width = size.width,
+        .height = size.height,
+    };
+  }
+  // Rounded like the frame of a root laid out at that size: to the nearest pixel, or up for text
+  // so that it isn't cut.
+  const bool isText = YGNodeGetNodeType(node) == YGNodeTypeText;
+  return (CGSize){
+      .width = YGRoundValueToPixelGrid(size.width, scale, isText, false),
+      .height = YGRoundValueToPixelGrid(size.height, scale, isText, false),
   };
-  return [self calculateLayoutWithSize:constrainedSize];
 }
 
 #pragma mark - Private
@@ -278,6 +297,89 @@ static CGFloat YGSanitizeMeasurement(CGFloat constrainedSize, CGFloat measuredSi
   return result;
 }
 
+static inline uint64_t YGHashCombine(const uint64_t hash, const uint64_t value) {
+  return (hash ^ value) * 1099511628211ull;
+}
+
+static inline uint64_t YGHashCombineFloat(const uint64_t hash, const double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return YGHashCombine(hash, bits);
+}
+
+// Attributes whose values compare by content, so that their hash tells whether the text measures
+// the same. Others, attachments for instance, may change without their hash changing.
+static NSSet<NSString *> *YGFingerprintedAttributes(void) {
+  static NSSet<NSString *> *attributes;
+  static dispatch_once_t onceToken;
+  dispatch_once(&onceToken, ^{
+    attributes = [NSSet setWithArray:@[
+      NSFontAttributeName, NSParagraphStyleAttributeName, NSKernAttributeName,
+      NSBaselineOffsetAttributeName, NSStrokeWidthAttributeName, NSObliquenessAttributeName,
+      NSExpansionAttributeName, NSLigatureAttributeName, NSUnderlineStyleAttributeName,
+      NSStrikethroughStyleAttributeName, NSForegroundColorAttributeName,
+      NSBackgroundColorAttributeName, NSUnderlineColorAttributeName,
+      NSStrikethroughColorAttributeName, NSStrokeColorAttributeName
+    ]];
+  });
+  return attributes;
+}
+
+// Everything -sizeThatFits: of a label depends on. Other views, and labels with attributes the
+// fingerprint can't tell apart, are always measured.
+static uint64_t YGViewMeasureFingerprint(UIView *const view) {
+  if (![view isKindOfClass:[UILabel class]]) {
+    return 0;
+  }
+  UILabel *const label = (UILabel *)view;
+  NSAttributedString *const text = label.attributedText;
+  NSString *const string = text.string;
+  const NSUInteger length = string.length;
+
+  __block uint64_t hash = 14695981039346656037ull;
+  hash = YGHashCombine(hash, (uint64_t)(uintptr_t)[label class]);
+  hash = YGHashCombine(hash, (uint64_t)label.numberOfLines);
+  hash = YGHashCombine(hash, (uint64_t)label.lineBreakMode);
+  hash = YGHashCombine(hash, (uint64_t)label.font.hash);
+  hash = YGHashCombine(hash, (uint64_t)label.adjustsFontSizeToFitWidth);
+  hash = YGHashCombineFloat(hash, label.minimumScaleFactor);
+  hash = YGHashCombine(hash, (uint64_t)label.baselineAdjustment);
+  hash = YGHashCombine(hash, (uint64_t)label.allowsDefaultTighteningForTruncation);
+  hash = YGHashCombineFloat(hash, label.preferredMaxLayoutWidth);
+  // -[NSString hash] only looks at the ends of long strings.
+  unichar characters[64];
+  for (NSUInteger location = 0; location < length; location += 64) {
+    const NSRange range = NSMakeRange(location, MIN((NSUInteger)64, length - location));
+    [string getCharacters:characters range:range];
+    for (NSUInteger i = 0; i < range.length; i++) {
+      hash = YGHashCombine(hash, characters[i]);
+    }
+  }
+  NSSet<NSString *> *const fingerprinted = YGFingerprintedAttributes();
+  __block BOOL unknownAttribute = NO;
+  [text enumerateAttributesInRange:NSMakeRange(0, length)
+                           options:0
+                        usingBlock:^(NSDictionary<NSString *, id> *attributes, NSRange range,
+                                     BOOL *stop) {
+                          hash = YGHashCombine(hash, range.location);
+                          hash = YGHashCombine(hash, range.length);
+                          for (NSString *key in attributes) {
+                            if (![fingerprinted containsObject:key]) {
+                              unknownAttribute = YES;
+                              *stop = YES;
+                              return;
+                            }
+                            // Keys are enumerated in no particular order.
+                            hash ^= YGHashCombine(key.hash, [attributes[key] hash]);
+                          }
+                          hash = YGHashCombine(hash, attributes.count);
+                        }];
+  if (unknownAttribute) {
+    return 0;
+  }
+  return hash != 0 ? hash : 1;
+}
+
 static BOOL YGNodeHasExactSameChildren(const YGNodeRef node, NSArray<UIView *> *subviews) {
   if (YGNodeGetChildCount(node) != subviews.count) {
     return false;
@@ -297,6 +399,7 @@ static void YGAttachNodesFromViewHierachy(UIView *const view) {
   if (yoga.isLeaf) {
     YGRemoveAllChildren(node);
     YGNodeSetMeasureFunc(node, YGMeasureView);
+    YGNodeSetMeasureFingerprint(node, YGViewMeasureFingerprint(view));
   } else {
     YGNodeSetMeasureFunc(node, nil);
     NSMutableArray<UIView *> *subviewsToInclude =
@@ -308,9 +411,13 @@ static void YGAttachNodesFromViewHierachy(UIView *const view) {
     }
     if (!YGNodeHasExactSameChildren(node, subviewsToInclude)) {
       YGRemoveAllChildren(node);
-      for (int i = 0; i < subviewsToInclude.count; i++) {
-        YGNodeInsertChild(node, subviewsToInclude[i].yoga.node, i);
+      const NSUInteger count = subviewsToInclude.count;
+      YGNodeRef *children = (YGNodeRef *)malloc(sizeof(YGNodeRef) * count);
+      for (NSUInteger i = 0; i < count; i++) {
+        children[i] = subviewsToInclude[i].yoga.node;
       }
+      YGNodeInsertChildren(node, children, (uint32_t)count, 0);
+      free(children);
     }
     for (UIView *const subview in subviewsToInclude) {
       YGAttachNodesFromViewHierachy(subview);
@@ -322,9 +429,7 @@ static void YGRemoveAllChildren(const YGNodeRef node) {
   if (node == nil) {
     return;
   }
-  while (YGNodeGetChildCount(node) > 0) {
-    YGNodeRemoveChild(node, YGNodeGetChild(node, YGNodeGetChildCount(node) - 1));
-  }
+  YGNodeRemoveAllChildren(node);
 }
 
 static CGFloat YGRoundPixelValue(CGFloat value) {
@@ -336,23 +441,17 @@ static CGFloat YGRoundPixelValue(CGFloat value) {
   return roundf(value * scale) / scale;
 }
 
-static void YGApplyLayoutToViewHierarchy(UIView *view, BOOL preserveOrigin) {
-  NSCAssert([NSThread isMainThread], @"Framesetting should only be done on the main thread.");
-  const YGLayout *yoga = view.yoga;
-  if (!yoga.isIncludedInLayout) {
-    return;
-  }
-  YGNodeRef node = yoga.node;
+// Setting the frame of a view lays it out again, so it is only set when it changed.
+static void YGApplyFrameToView(UIView *view, const YGFrame frame, const CGPoint origin) {
   const CGPoint topLeft = {
-      YGNodeLayoutGetLeft(node),
-      YGNodeLayoutGetTop(node),
+      frame.left,
+      frame.top,
   };
   const CGPoint bottomRight = {
-      topLeft.x + YGNodeLayoutGetWidth(node),
-      topLeft.y + YGNodeLayoutGetHeight(node),
+      topLeft.x + frame.width,
+      topLeft.y + frame.height,
   };
-  const CGPoint origin = preserveOrigin ? view.frame.origin : CGPointZero;
-  view.frame = (CGRect){
+  const CGRect rect = {
       .origin =
           {
               .x = YGRoundPixelValue(topLeft.x + origin.x),
@@ -364,6 +463,28 @@ static void YGApplyLayoutToViewHierarchy(UIView *view, BOOL preserveOrigin) {
               .height = YGRoundPixelValue(bottomRight.y) - YGRoundPixelValue(topLeft.y),
           },
   };
+  if (!CGRectEqualToRect(view.frame, rect)) {
+    view.frame = rect;
+  }
+}
+
+// Walks the whole subtree rather than the layout changes, which the views of every YGLayout share
+// a config for, see YGLayoutChange in Yoga.h.
+static void YGApplyLayoutToViewHierarchy(UIView *view, BOOL preserveOrigin) {
+  NSCAssert([NSThread isMainThread], @"Framesetting should only be done on the main thread.");
+  const YGLayout *yoga = view.yoga;
+  if (!yoga.isIncludedInLayout) {
+    return;
+  }
+  const YGNodeRef node = yoga.node;
+  YGApplyFrameToView(view,
+                     (YGFrame){
+                         .left = YGNodeLayoutGetLeft(node),
+                         .top = YGNodeLayoutGetTop(node),
+                         .width = YGNodeLayoutGetWidth(node),
+                         .height = YGNodeLayoutGetHeight(node),
+                     },
+                     preserveOrigin ? view.frame.origin : CGPointZero);
   if (!yoga.isLeaf) {
     for (NSUInteger i = 0; i < view.subviews.count; i++) {
       YGApplyLayoutToViewHierarchy(view.subviews[i], NO);
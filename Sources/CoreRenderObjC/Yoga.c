@@ -9,8 +9,19 @@
 
 #include "Yoga.h"
 
+#include <stddef.h>
 #include <string.h>
 
+// A multiply-add fused into one instruction rounds once instead of twice, so
+// the flex line loops would give other bits in their scalar tail than in their
+// vector lanes, and than the layout has always given. Contraction is off for
+// the whole file; GCC ignores the pragma and is built with -ffp-contract=off.
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
 #ifdef _MSC_VER
 #include <float.h>
 #ifndef isnan
@@ -29,119 +40,498 @@ __forceinline const float fmaxf(const float a, const float b) {
 #endif
 #endif
 
+// Instance counters and the layout generation are shared by every thread that
+// creates nodes or calculates layouts.
+#if defined(__GNUC__) || defined(__clang__)
+#define YGAtomicAdd(ptr, value) __atomic_add_fetch(ptr, value, __ATOMIC_RELAXED)
+#define YGAtomicLoad(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define YGAtomicAdd64(ptr, value) YGAtomicAdd(ptr, value)
+#define YGAtomicLoad64(ptr) YGAtomicLoad(ptr)
+#define YGAtomicStore(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+#define YGAtomicStore64(ptr, value) YGAtomicStore(ptr, value)
+#define YGAtomicCompareExchange(ptr, expected, value)                      \
+  __atomic_compare_exchange_n(ptr, expected, value, false, __ATOMIC_RELAXED, \
+                              __ATOMIC_RELAXED)
+#else
+#include <intrin.h>
+#define YGAtomicAdd(ptr, value)                                     \
+  (_InterlockedExchangeAdd((volatile long *)(ptr), (long)(value)) + \
+   (value))
+#define YGAtomicLoad(ptr) (*(volatile const int32_t *)(ptr))
+#define YGAtomicAdd64(ptr, value) \
+  _InterlockedExchangeAdd64((volatile __int64 *)(ptr), (__int64)(value))
+#define YGAtomicLoad64(ptr) (*(volatile const uint64_t *)(ptr))
+#define YGAtomicStore(ptr, value) (*(volatile uint32_t *)(ptr) = (value))
+#define YGAtomicStore64(ptr, value) (*(volatile uint64_t *)(ptr) = (value))
+#define YGAtomicCompareExchange(ptr, expected, value)                \
+  YGAtomicCompareExchangeLong((volatile long *)(ptr), (long *)(expected), \
+                              (long)(value))
+static inline bool YGAtomicCompareExchangeLong(volatile long *ptr,
+                                               long *expected,
+                                               const long value) {
+  const long previous = _InterlockedCompareExchange(ptr, value, *expected);
+  if (previous == *expected) {
+    return true;
+  }
+  *expected = previous;
+  return false;
+}
+#endif
+
+// Parallel layout runs on POSIX threads. Elsewhere YGThreadPoolNew returns NULL
+// and layout stays on the calling thread.
+#if !defined(_WIN32)
+#define YG_THREAD_POOL 1
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Timestamps of traced events come from a monotonic clock.
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#define YG_THREAD_LOCAL __declspec(thread)
+#else
+#define YG_THREAD_LOCAL _Thread_local
+#endif
+
+// Flexible lengths and pixel grid rounding use the widest vector unit the
+// target is compiled for, and plain C everywhere else.
+#if defined(__AVX__)
+#define YG_SIMD_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define YG_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define YG_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
 typedef struct YGCachedMeasurement {
   float availableWidth;
   float availableHeight;
-  YGMeasureMode widthMeasureMode;
-  YGMeasureMode heightMeasureMode;
+  // The available size rounded to the pixel grid of keyScale when the entry
+  // was stored, so that lookups at the same scale don't round it again.
+  float roundedWidth;
+  float roundedHeight;
+  float keyScale;
 
   float computedWidth;
   float computedHeight;
+  uint8_t widthMeasureMode;
+  uint8_t heightMeasureMode;
+  // Set when the entry is used, cleared when the clock hand passes over it.
+  bool referenced;
 } YGCachedMeasurement;
 
-// This value was chosen based on empiracle data. Even the most complicated
-// layouts should not require more than 16 entries to fit within the cache.
+// The default limit of YGConfigSetMaxCachedMeasurements. This value was chosen
+// based on empiracle data. Even the most complicated layouts should not require
+// more than 16 entries to fit within the cache.
 #define YG_MAX_CACHED_RESULT_COUNT 16
 
-typedef struct YGLayout {
-  float position[4];
-  float dimensions[2];
+// Most nodes are measured once or twice per layout, so the cache starts small
+// and doubles up to the limit of the config.
+#define YG_INITIAL_CACHED_RESULT_COUNT 2
+
+// Measurements are only cached for nodes that get measured, so the entries
+// live in a block that is allocated on first use. Once the cache is full, the
+// clock hand looks for an entry that was not used since it last passed, and
+// the new measurement replaces it.
+typedef struct YGMeasurementCache {
+  uint32_t count;
+  uint32_t capacity;
+  uint32_t hand;
+  YGCachedMeasurement cachedMeasurements[];
+} YGMeasurementCache;
+
+static inline size_t YGMeasurementCacheSize(const uint32_t capacity) {
+  return sizeof(YGMeasurementCache) + sizeof(YGCachedMeasurement) * capacity;
+}
+
+static inline void YGMeasurementCacheClear(YGMeasurementCache *const cache) {
+  cache->count = 0;
+  cache->hand = 0;
+}
+
+// Resolved margin, border and padding. Allocated only for nodes where one of
+// them is not zero.
+typedef struct YGLayoutEdges {
   float margin[6];
   float border[6];
   float padding[6];
+} YGLayoutEdges;
+
+// What a node was last laid out with, so that it can be laid out again on its
+// own, see YGNodeCalculateDirtyLayouts. Allocated only for configs that use
+// relayout boundaries, for roots, for nodes of a fixed size and for nodes with
+// children, which the subtrees below are rounded from.
+typedef struct YGRelayoutState {
+  float availableWidth;
+  float availableHeight;
+  float parentWidth;
+  float parentHeight;
+  // Exactly in both axes when the parent gave the node its size. Cleared when
+  // the layout of the node is reset or copied from another node.
+  uint8_t widthMeasureMode;
+  uint8_t heightMeasureMode;
+  // Set when an ancestor used the baseline of the node, which depends on its
+  // content, since the node was last laid out.
+  bool baselineQueried;
+  // Whether the node is in the dirty roots of its config, and where.
+  bool isDirtyRoot;
+  uint32_t dirtyRootIndex;
+  // Whether left and top hold the unrounded position of the node when it was
+  // last rounded.
+  bool isRounded;
+  float left;
+  float top;
+} YGRelayoutState;
+
+typedef struct YGLayout {
+  float dimensions[2];
   YGDirection direction;
 
   uint32_t computedFlexBasisGeneration;
   float computedFlexBasis;
   bool hadOverflow;
+  // Size of the subtree, capped at YG_PARALLEL_MIN_SUBTREE_SIZE. Counted again
+  // whenever the node is dirty.
+  uint8_t subtreeSizeHint;
+  // See YGNodeStructureHash and YGNodeRecordEdit. Only kept up to date for
+  // nodes of configs that memoize subtrees.
+  uint64_t structureHash;
+  uint64_t history;
 
   // Instead of recomputing the entire layout every single time, we
   // cache some information to break early when nothing changed
   uint32_t generationCount;
+  // The last generation the parent set the position of the node in, which it
+  // does whenever it is laid out rather than only measured, or hides the node.
+  uint32_t positionGenerationCount;
   YGDirection lastParentDirection;
 
-  uint32_t nextCachedMeasurementsIndex;
-  YGCachedMeasurement cachedMeasurements[YG_MAX_CACHED_RESULT_COUNT];
-  float measuredDimensions[2];
-
   YGCachedMeasurement cachedLayout;
+
+  YGMeasurementCache *measurementCache;
+  YGLayoutEdges *edges;
+  YGRelayoutState *relayout;
 } YGLayout;
 
+typedef enum YGEdgeProperty {
+  YGEdgePropertyMargin,
+  YGEdgePropertyPosition,
+  YGEdgePropertyPadding,
+  YGEdgePropertyBorder,
+  YGEdgePropertyCount,
+} YGEdgeProperty;
+
 typedef struct YGStyle {
-  YGDirection direction;
-  YGFlexDirection flexDirection;
-  YGJustify justifyContent;
-  YGAlign alignContent;
-  YGAlign alignItems;
-  YGAlign alignSelf;
-  YGPositionType positionType;
-  YGWrap flexWrap;
-  YGOverflow overflow;
-  YGDisplay display;
+  // Enums are stored in a byte each.
+  uint8_t direction;
+  uint8_t flexDirection;
+  uint8_t justifyContent;
+  uint8_t alignContent;
+  uint8_t alignItems;
+  uint8_t alignSelf;
+  uint8_t positionType;
+  uint8_t flexWrap;
+  uint8_t overflow;
+  uint8_t display;
   float flex;
   float flexGrow;
   float flexShrink;
   YGValue flexBasis;
-  YGValue margin[YGEdgeCount];
-  YGValue position[YGEdgeCount];
-  YGValue padding[YGEdgeCount];
-  YGValue border[YGEdgeCount];
   YGValue dimensions[2];
   YGValue minDimensions[2];
   YGValue maxDimensions[2];
 
   // Yoga specific properties, not compatible with flexbox specification
   float aspectRatio;
+
+  // Margin, position, padding and border. Bit `edge` of edgeMasks[property] is
+  // set when that edge has a unit other than YGUnitUndefined; all other edges
+  // read as YGValueUndefined. The units of the set edges are packed two bits
+  // per edge into edgeUnits, and their values are stored contiguously in
+  // edgeValues, ordered by property and then by edge. The values of a property
+  // start at edgeValueOffsets[property].
+  uint16_t edgeMasks[YGEdgePropertyCount];
+  uint32_t edgeUnits[YGEdgePropertyCount];
+  uint8_t edgeValueOffsets[YGEdgePropertyCount];
+  uint8_t edgeValueCount;
+
+  // Storage, not style. Must come last, see YGNodeCopyStyle.
+  uint8_t edgeValueCapacity;
+  float *edgeValues;
 } YGStyle;
 
 typedef struct YGConfig {
   bool experimentalFeatures[YGExperimentalFeatureCount + 1];
   bool useWebDefaults;
   bool useLegacyStretchBehaviour;
+  bool fixedPointRounding;
   float pointScaleFactor;
   YGLogger logger;
   YGNodeClonedFunc cloneNodeCallback;
+  YGNodesClonedFunc nodesClonedCallback;
   void *context;
+  YGArenaRef arena;
+  bool printTree;
+  bool printChanges;
+  bool printSkips;
+  YGThreadPoolRef pool;
+  YGMeasureCacheRef measureCache;
+  uint32_t maxCachedMeasurements;
+  YGEventHandler eventHandler;
+  void *eventContext;
+  bool memoizeSubtrees;
+  bool useGenericLayoutKernels;
+  bool useRelayoutBoundaries;
+  YGLayoutStats stats;
+  // Relayout boundaries edited since they were last laid out, in no order.
+  YGNodeRef *dirtyRoots;
+  uint32_t dirtyRootCount;
+  uint32_t dirtyRootCapacity;
+  // The arenas whose nodes got dirty roots or layout changes in a config
+  // outside them, which take the entries out when they are reset or freed.
+  YGArenaRef *nodeArenas;
+  uint32_t nodeArenaCount;
+  uint32_t nodeArenaCapacity;
+  bool recordLayoutChanges;
+  YGLayoutChange *layoutChanges;
+  // For each entry, the index of the one before it of the same node, or
+  // UINT32_MAX. The entries of a node freed or reset are dropped by setting
+  // their node to NULL, and compacted by YGConfigGetLayoutChanges.
+  uint32_t *previousLayoutChanges;
+  uint32_t layoutChangeCount;
+  uint32_t layoutChangeCapacity;
+  uint32_t droppedLayoutChangeCount;
 } YGConfig;
 
-typedef struct YGNode {
-  YGStyle style;
-  YGLayout layout;
-  uint32_t lineIndex;
+// Most nodes have a handful of children, so the first few are stored in the
+// node itself. Larger child lists spill to the heap (or the node's arena).
+#define YG_INLINE_CHILD_COUNT 4
 
-  YGNodeRef parent;
-  YGNodeListRef children;
+// The list is a gap buffer: the unused capacity sits at gapStart rather than at
+// the end, so runs of edits at the same position (appends, prepends, removing
+// from either end) don't shift the rest of the list. Moving the gap costs the
+// distance it travels.
+typedef struct YGChildList {
+  // Points to inlineItems until the list outgrows them.
+  YGNodeRef *items;
+  uint32_t count;
+  uint32_t capacity;
+  uint32_t gapStart;
+  YGNodeRef inlineItems[YG_INLINE_CHILD_COUNT];
+} YGChildList;
+
+static inline YGNodeRef YGChildListGet(const YGChildList *const list,
+                                       const uint32_t index) {
+  return list->items[index < list->gapStart
+                         ? index
+                         : index + list->capacity - list->count];
+}
+
+static inline void YGChildListInit(YGChildList *const list);
+static void YGChildListCopy(YGChildList *const list,
+                            const YGChildList *const from,
+                            const YGArenaRef arena);
+static void YGChildListFree(YGChildList *const list, const YGArenaRef arena);
+static void YGChildListReserve(YGChildList *const list, const YGArenaRef arena,
+                               const uint32_t capacity);
+static void YGChildListInsert(YGChildList *const list, const YGArenaRef arena,
+                              const YGNodeRef node, const uint32_t index);
+static inline void YGChildListReplace(YGChildList *const list,
+                                      const uint32_t index,
+                                      const YGNodeRef newNode);
+static inline void YGChildListRemoveAll(YGChildList *const list);
+static YGNodeRef YGChildListRemove(YGChildList *const list,
+                                   const uint32_t index);
+static void YGChildListRemoveRange(YGChildList *const list,
+                                   const uint32_t index, const uint32_t count);
+static YGNodeRef YGChildListDelete(YGChildList *const list,
+                                   const YGNodeRef node);
+static uint32_t YGChildListIndexOf(const YGChildList *const list,
+                                   const YGNodeRef node);
+
+#define YG_SIMPLE_STACK_UNKNOWN 0
+#define YG_SIMPLE_STACK_YES 1
+#define YG_SIMPLE_STACK_NO 2
+
+// The frame of the last layout change recorded for a node, and the index of
+// that change in the layout changes of its config.
+typedef struct YGRecordedFrame {
+  YGFrame frame;
+  uint32_t changeIndex;
+} YGRecordedFrame;
 
+typedef struct YGNode {
+  // Fields read on every visit of the layout algorithm come first.
+  // The tree the node is in, or NULL. The parent, children, style, measured
+  // dimensions and position of a node in a tree are in the columns of the tree
+  // at `handle`, and those of other nodes right after the node, see
+  // YGStandaloneNode. They are read through YGStyleOf and the accessors after
+  // it.
+  YGTreeRef tree;
   struct YGNode *nextChild;
-
-  YGMeasureFunc measure;
-  YGBaselineFunc baseline;
-  YGPrintFunc print;
   YGConfigRef config;
-  void *context;
+  YGMeasureFunc measure;
 
+  YGNodeHandle handle;
   bool isDirty;
   bool hasNewLayout;
+  // Set when some children may be shared with another tree, see
+  // YGCloneChildrenIfNeeded. It may stay set after they are all owned.
+  bool hasSharedChildren;
+  // Whether the node lays out as a simple stack, see YGNodeIsSimpleStack.
+  // Reset to YG_SIMPLE_STACK_UNKNOWN when the node or a child is edited.
+  uint8_t simpleStack;
   YGNodeType nodeType;
+  uint32_t lineIndex;
+  // Slot of this node in its parent's child list. Only a hint: it is checked
+  // against the list before use, since shared children are not renumbered.
+  uint32_t slotInParent;
 
-  YGValue const *resolvedDimensions[2];
+  // Which style value each dimension resolves to, see YGResolveDimensions.
+  uint8_t resolvedDimensions[2];
+  YGLayout layout;
+
+  YGBaselineFunc baseline;
+  YGPrintFunc print;
+  YGArenaRef arena;
+  void *context;
+  uint64_t measureFingerprint;
+  // See YGNodeRecordLayoutChanges. Allocated when the first change is.
+  YGRecordedFrame *recordedFrame;
 } YGNode;
 
+// A node outside of a tree, followed by what a tree keeps in its columns.
+typedef struct YGStandaloneNode {
+  YGNode node;
+  YGNodeRef parent;
+  YGChildList children;
+  float measuredDimensions[2];
+  float position[4];
+  YGStyle style;
+} YGStandaloneNode;
+
+// The nodes of a tree are allocated in chunks, which don't move when the tree
+// grows, so that they can be referred to by pointer like any other node.
+#define YG_TREE_CHUNK_SHIFT 8
+#define YG_TREE_CHUNK_SIZE (1u << YG_TREE_CHUNK_SHIFT)
+
+struct YGTree {
+  YGConfigRef config;
+  uint32_t count;
+  uint32_t capacity;
+  YGNode **chunks;
+  // The columns, indexed by handle.
+  YGStyle *styles;
+  float (*measuredDimensions)[2];
+  float (*positions)[4];
+  YGNodeHandle *parents;
+  YGNodeHandle *firstChildren;
+  YGNodeHandle *nextSiblings;
+  // Only read when a child is appended.
+  YGNodeHandle *lastChildren;
+  uint32_t *childCounts;
+};
+
+static inline YGNodeRef YGTreeNodeAt(const struct YGTree *const tree,
+                                     const YGNodeHandle handle) {
+  return &tree->chunks[handle >> YG_TREE_CHUNK_SHIFT]
+                      [handle & (YG_TREE_CHUNK_SIZE - 1)];
+}
+
+static inline YGStandaloneNode *YGStandaloneOf(const YGNode *const node) {
+  return (YGStandaloneNode *)node;
+}
+
+static inline YGStyle *YGStyleOf(const YGNode *const node) {
+  return node->tree == NULL ? &YGStandaloneOf(node)->style
+                            : &node->tree->styles[node->handle];
+}
+
+static inline float *YGMeasuredDimensionsOf(const YGNode *const node) {
+  return node->tree == NULL ? YGStandaloneOf(node)->measuredDimensions
+                            : node->tree->measuredDimensions[node->handle];
+}
+
+static inline float *YGPositionOf(const YGNode *const node) {
+  return node->tree == NULL ? YGStandaloneOf(node)->position
+                            : node->tree->positions[node->handle];
+}
+
+static inline YGNodeRef YGParentOf(const YGNode *const node) {
+  if (node->tree == NULL) {
+    return YGStandaloneOf(node)->parent;
+  }
+  const YGNodeHandle parent = node->tree->parents[node->handle];
+  return parent != YGNodeHandleNone ? YGTreeNodeAt(node->tree, parent) : NULL;
+}
+
+static inline uint32_t YGChildCountOf(const YGNode *const node) {
+  return node->tree == NULL ? YGStandaloneOf(node)->children.count
+                            : node->tree->childCounts[node->handle];
+}
+
+// Children are visited in order with a cursor, which is an index in the child
+// list of a standalone node and the handle of the child in a tree:
+//
+//   const uint32_t end = YGChildCursorEnd(node);
+//   for (uint32_t cursor = YGChildCursorFirst(node); cursor != end;
+//        cursor = YGChildCursorNext(node, cursor)) {
+//     const YGNodeRef child = YGChildAtCursor(node, cursor);
+//   }
+static inline uint32_t YGChildCursorFirst(const YGNode *const node) {
+  return node->tree == NULL ? 0 : node->tree->firstChildren[node->handle];
+}
+
+static inline uint32_t YGChildCursorEnd(const YGNode *const node) {
+  return node->tree == NULL ? YGStandaloneOf(node)->children.count
+                            : YGNodeHandleNone;
+}
+
+static inline uint32_t YGChildCursorNext(const YGNode *const node,
+                                         const uint32_t cursor) {
+  return node->tree == NULL ? cursor + 1 : node->tree->nextSiblings[cursor];
+}
+
+static inline YGNodeRef YGChildAtCursor(const YGNode *const node,
+                                        const uint32_t cursor) {
+  return node->tree == NULL
+             ? YGChildListGet(&YGStandaloneOf(node)->children, cursor)
+             : YGTreeNodeAt(node->tree, cursor);
+}
+
+// Returns the index of `child` in the children of `node`, or UINT32_MAX.
+static uint32_t YGChildIndexOf(const YGNode *const node,
+                               const YGNodeRef child) {
+  if (node->tree == NULL) {
+    return YGChildListIndexOf(&YGStandaloneOf(node)->children, child);
+  }
+  uint32_t index = 0;
+  for (YGNodeHandle cursor = YGChildCursorFirst(node);
+       cursor != YGNodeHandleNone; cursor = YGChildCursorNext(node, cursor)) {
+    if (YGChildAtCursor(node, cursor) == child) {
+      return index;
+    }
+    index++;
+  }
+  return UINT32_MAX;
+}
+
 #define YG_UNDEFINED_VALUES \
   { .value = YGUndefined, .unit = YGUnitUndefined }
 
 #define YG_AUTO_VALUES \
   { .value = YGUndefined, .unit = YGUnitAuto }
 
-#define YG_DEFAULT_EDGE_VALUES_UNIT                                            \
-  {                                                                            \
-    [YGEdgeLeft] = YG_UNDEFINED_VALUES, [YGEdgeTop] = YG_UNDEFINED_VALUES,     \
-    [YGEdgeRight] = YG_UNDEFINED_VALUES, [YGEdgeBottom] = YG_UNDEFINED_VALUES, \
-    [YGEdgeStart] = YG_UNDEFINED_VALUES, [YGEdgeEnd] = YG_UNDEFINED_VALUES,    \
-    [YGEdgeHorizontal] = YG_UNDEFINED_VALUES,                                  \
-    [YGEdgeVertical] = YG_UNDEFINED_VALUES, [YGEdgeAll] = YG_UNDEFINED_VALUES, \
-  }
-
 #define YG_DEFAULT_DIMENSION_VALUES \
   { [YGDimensionWidth] = YGUndefined, [YGDimensionHeight] = YGUndefined, }
 
@@ -158,14 +548,38 @@ static const float kDefaultFlexGrow = 0.0f;
 static const float kDefaultFlexShrink = 0.0f;
 static const float kWebDefaultFlexShrink = 1.0f;
 
-static const YGNode gYGNodeDefaults = {
+static const YGStandaloneNode gYGNodeDefaults = {
+    .node =
+        {
+            .hasNewLayout = true,
+            .isDirty = false,
+            .nodeType = YGNodeTypeDefault,
+            .layout =
+                {
+                    .dimensions = YG_DEFAULT_DIMENSION_VALUES,
+                    .lastParentDirection = (YGDirection)-1,
+                    .computedFlexBasis = YGUndefined,
+                    .hadOverflow = false,
+
+                    .cachedLayout =
+                        {
+                            .widthMeasureMode = (uint8_t)-1,
+                            .heightMeasureMode = (uint8_t)-1,
+                            .computedWidth = -1,
+                            .computedHeight = -1,
+                        },
+                    .measurementCache = NULL,
+                    .edges = NULL,
+                    .relayout = NULL,
+                },
+        },
     .parent = NULL,
-    .children = NULL,
-    .hasNewLayout = true,
-    .isDirty = false,
-    .nodeType = YGNodeTypeDefault,
-    .resolvedDimensions = {[YGDimensionWidth] = &YGValueUndefined,
-                           [YGDimensionHeight] = &YGValueUndefined},
+    // items is pointed at the node's own inlineItems when the node is created.
+    .children = {.items = NULL,
+                 .count = 0,
+                 .capacity = YG_INLINE_CHILD_COUNT,
+                 .gapStart = 0},
+    .measuredDimensions = YG_DEFAULT_DIMENSION_VALUES,
 
     .style =
         {
@@ -183,29 +597,8 @@ static const YGNode gYGNodeDefaults = {
             .dimensions = YG_DEFAULT_DIMENSION_VALUES_AUTO_UNIT,
             .minDimensions = YG_DEFAULT_DIMENSION_VALUES_UNIT,
             .maxDimensions = YG_DEFAULT_DIMENSION_VALUES_UNIT,
-            .position = YG_DEFAULT_EDGE_VALUES_UNIT,
-            .margin = YG_DEFAULT_EDGE_VALUES_UNIT,
-            .padding = YG_DEFAULT_EDGE_VALUES_UNIT,
-            .border = YG_DEFAULT_EDGE_VALUES_UNIT,
             .aspectRatio = YGUndefined,
-        },
-
-    .layout =
-        {
-            .dimensions = YG_DEFAULT_DIMENSION_VALUES,
-            .lastParentDirection = (YGDirection)-1,
-            .nextCachedMeasurementsIndex = 0,
-            .computedFlexBasis = YGUndefined,
-            .hadOverflow = false,
-            .measuredDimensions = YG_DEFAULT_DIMENSION_VALUES,
-
-            .cachedLayout =
-                {
-                    .widthMeasureMode = (YGMeasureMode)-1,
-                    .heightMeasureMode = (YGMeasureMode)-1,
-                    .computedWidth = -1,
-                    .computedHeight = -1,
-                },
+            .edgeValues = NULL,
         },
 };
 
@@ -230,6 +623,7 @@ static YGConfig gYGConfigDefaults = {
     .logger = &YGDefaultLog,
 #endif
     .context = NULL,
+    .maxCachedMeasurements = YG_MAX_CACHED_RESULT_COUNT,
 };
 
 static void YGNodeMarkDirtyInternal(const YGNodeRef node);
@@ -286,30 +680,94 @@ static int YGDefaultLog(const YGConfigRef config, const YGNodeRef node,
 }
 #endif
 
-static inline const YGValue *YGComputedEdgeValue(
-    const YGValue edges[YGEdgeCount], const YGEdge edge,
-    const YGValue *const defaultValue) {
-  if (edges[edge].unit != YGUnitUndefined) {
-    return &edges[edge];
+#if defined(__GNUC__) || defined(__clang__)
+#define YGPopCount(mask) ((uint32_t)__builtin_popcount(mask))
+#define YGLowestSetBit(mask) ((uint32_t)__builtin_ctz(mask))
+#else
+static inline uint32_t YGPopCount(uint32_t mask) {
+  uint32_t count = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    count++;
   }
+  return count;
+}
 
-  if ((edge == YGEdgeTop || edge == YGEdgeBottom) &&
-      edges[YGEdgeVertical].unit != YGUnitUndefined) {
-    return &edges[YGEdgeVertical];
+static inline uint32_t YGLowestSetBit(const uint32_t mask) {
+  uint32_t bit = 0;
+  while ((mask & (1u << bit)) == 0) {
+    bit++;
   }
+  return bit;
+}
+#endif
 
-  if ((edge == YGEdgeLeft || edge == YGEdgeRight || edge == YGEdgeStart ||
-       edge == YGEdgeEnd) &&
-      edges[YGEdgeHorizontal].unit != YGUnitUndefined) {
-    return &edges[YGEdgeHorizontal];
-  }
+#define YG_EDGE_BIT(edge) (1u << (edge))
+
+// The edges that can provide the value of an edge, in order of precedence.
+// The precedence matches the order of the bits: an edge wins over its
+// horizontal/vertical shorthand, which wins over YGEdgeAll.
+static const uint16_t kYGEdgeCandidates[YGEdgeCount] = {
+    [YGEdgeLeft] = YG_EDGE_BIT(YGEdgeLeft) | YG_EDGE_BIT(YGEdgeHorizontal) |
+                   YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeTop] = YG_EDGE_BIT(YGEdgeTop) | YG_EDGE_BIT(YGEdgeVertical) |
+                  YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeRight] = YG_EDGE_BIT(YGEdgeRight) | YG_EDGE_BIT(YGEdgeHorizontal) |
+                    YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeBottom] = YG_EDGE_BIT(YGEdgeBottom) | YG_EDGE_BIT(YGEdgeVertical) |
+                     YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeStart] = YG_EDGE_BIT(YGEdgeStart) | YG_EDGE_BIT(YGEdgeHorizontal) |
+                    YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeEnd] = YG_EDGE_BIT(YGEdgeEnd) | YG_EDGE_BIT(YGEdgeHorizontal) |
+                  YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeHorizontal] = YG_EDGE_BIT(YGEdgeHorizontal) | YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeVertical] = YG_EDGE_BIT(YGEdgeVertical) | YG_EDGE_BIT(YGEdgeAll),
+    [YGEdgeAll] = YG_EDGE_BIT(YGEdgeAll),
+};
+
+static inline bool YGStyleEdgeIsSet(const YGStyle *const style,
+                                    const YGEdgeProperty property,
+                                    const YGEdge edge) {
+  return (style->edgeMasks[property] & YG_EDGE_BIT(edge)) != 0;
+}
+
+// Position of the value of a set edge in edgeValues.
+static inline uint32_t YGStyleEdgeValueIndex(const YGStyle *const style,
+                                             const YGEdgeProperty property,
+                                             const uint32_t edge) {
+  return style->edgeValueOffsets[property] +
+         YGPopCount(style->edgeMasks[property] & (YG_EDGE_BIT(edge) - 1));
+}
+
+// The value of an edge that is known to be set.
+static inline YGValue YGStyleSetEdgeValue(const YGStyle *const style,
+                                          const YGEdgeProperty property,
+                                          const uint32_t edge) {
+  return (YGValue){
+      .value = style->edgeValues[YGStyleEdgeValueIndex(style, property, edge)],
+      .unit = (YGUnit)((style->edgeUnits[property] >> (edge * 2)) & 0x3),
+  };
+}
+
+static inline YGValue YGStyleEdgeValue(const YGStyle *const style,
+                                       const YGEdgeProperty property,
+                                       const YGEdge edge) {
+  return YGStyleEdgeIsSet(style, property, edge)
+             ? YGStyleSetEdgeValue(style, property, edge)
+             : YGValueUndefined;
+}
 
-  if (edges[YGEdgeAll].unit != YGUnitUndefined) {
-    return &edges[YGEdgeAll];
+static inline YGValue YGComputedEdgeValue(const YGStyle *const style,
+                                          const YGEdgeProperty property,
+                                          const YGEdge edge,
+                                          const YGValue defaultValue) {
+  const uint32_t candidates =
+      style->edgeMasks[property] & kYGEdgeCandidates[edge];
+  if (candidates != 0) {
+    return YGStyleSetEdgeValue(style, property, YGLowestSetBit(candidates));
   }
 
   if (edge == YGEdgeStart || edge == YGEdgeEnd) {
-    return &YGValueUndefined;
+    return YGValueUndefined;
   }
 
   return defaultValue;
@@ -336,86 +794,525 @@ static inline float YGResolveValueMargin(const YGValue *const value,
 
 int32_t gNodeInstanceCount = 0;
 int32_t gConfigInstanceCount = 0;
+int32_t gArenaInstanceCount = 0;
+
+static void YGArenaRetainNode(const YGArenaRef arena);
+static void YGArenaReleaseNode(const YGArenaRef arena);
+static void YGArenaRetainConfig(const YGArenaRef arena);
+static void YGArenaReleaseConfig(const YGArenaRef arena);
+static void YGArenaLinkConfig(const YGArenaRef arena,
+                              const YGConfigRef config);
+static void YGArenaUnlinkConfig(const YGArenaRef arena,
+                                const YGConfigRef config);
+
+// The side arrays of a config in an arena are allocated from it, and go away
+// with it.
+static void *YGConfigReallocArray(const YGConfigRef config, void *array,
+                                  const size_t oldSize, const size_t newSize) {
+  return config->arena != NULL
+             ? YGArenaRealloc(config->arena, array, oldSize, newSize)
+             : gYGRealloc(array, newSize);
+}
+
+static void *YGNodeAllocColdBlock(const YGNodeRef node, const size_t size) {
+  void *block = node->arena != NULL ? YGArenaAlloc(node->arena, size)
+                                    : gYGMalloc(size);
+  YGAssertWithNode(node, block != NULL,
+                   "Could not allocate memory for node");
+  return block;
+}
+
+static void *YGNodeReallocColdBlock(const YGNodeRef node, void *block,
+                                    const size_t oldSize,
+                                    const size_t newSize) {
+  block = node->arena != NULL
+              ? YGArenaRealloc(node->arena, block, oldSize, newSize)
+              : gYGRealloc(block, newSize);
+  YGAssertWithNode(node, block != NULL,
+                   "Could not extend allocation for node");
+  return block;
+}
+
+static void *YGNodeCloneColdBlock(const YGNodeRef node, const void *block,
+                                  const size_t size) {
+  if (block == NULL) {
+    return NULL;
+  }
+  void *clone = YGNodeAllocColdBlock(node, size);
+  memcpy(clone, block, size);
+  return clone;
+}
 
-WIN_EXPORT YGNodeRef YGNodeNewWithConfig(const YGConfigRef config) {
-  const YGNodeRef node = gYGMalloc(sizeof(YGNode));
-  YGAssertWithConfig(config, node != NULL,
-                     "Could not allocate memory for node");
-  gNodeInstanceCount++;
+static void YGConfigAddDirtyRoot(const YGConfigRef config,
+                                 const YGNodeRef node) {
+  if (config->dirtyRootCount == config->dirtyRootCapacity) {
+    const uint32_t capacity = config->dirtyRootCapacity;
+    config->dirtyRootCapacity = capacity == 0 ? 8 : capacity * 2;
+    config->dirtyRoots = YGConfigReallocArray(
+        config, config->dirtyRoots, sizeof(YGNodeRef) * capacity,
+        sizeof(YGNodeRef) * config->dirtyRootCapacity);
+    YGAssertWithConfig(config, config->dirtyRoots != NULL,
+                       "Could not allocate memory for dirty roots");
+  }
+  if (node->arena != NULL && node->arena != config->arena) {
+    YGArenaLinkConfig(node->arena, config);
+  }
+  node->layout.relayout->isDirtyRoot = true;
+  node->layout.relayout->dirtyRootIndex = config->dirtyRootCount;
+  config->dirtyRoots[config->dirtyRootCount++] = node;
+}
+
+static void YGConfigRemoveDirtyRoot(const YGConfigRef config,
+                                    const uint32_t index) {
+  config->dirtyRoots[index]->layout.relayout->isDirtyRoot = false;
+  const YGNodeRef last = config->dirtyRoots[--config->dirtyRootCount];
+  config->dirtyRoots[index] = last;
+  last->layout.relayout->dirtyRootIndex = index;
+}
+
+static inline bool YGNodeIsDirtyRoot(const YGNode *const node) {
+  return node->layout.relayout != NULL && node->layout.relayout->isDirtyRoot;
+}
 
-  memcpy(node, &gYGNodeDefaults, sizeof(YGNode));
+// Returns the index of the last layout change of `node` in its config, or
+// UINT32_MAX if it has none since they were last cleared.
+static inline uint32_t YGNodeLastLayoutChange(const YGNode *const node) {
+  const YGConfigRef config = node->config;
+  const uint32_t index = node->recordedFrame->changeIndex;
+  return index < config->layoutChangeCount &&
+                 config->layoutChanges[index].node == node
+             ? index
+             : UINT32_MAX;
+}
+
+// Drops the layout changes of a node that is freed or reset, following them
+// back from its last one.
+static void YGConfigDropLayoutChanges(const YGConfigRef config,
+                                      const YGNode *const node) {
+  for (uint32_t index = YGNodeLastLayoutChange(node); index != UINT32_MAX;
+       index = config->previousLayoutChanges[index]) {
+    config->layoutChanges[index].node = NULL;
+    config->droppedLayoutChangeCount++;
+  }
+}
+
+// Keeps the block of a node whose layout was reset, or copied from another
+// node, but not the constraints, which are no longer those of its layout.
+static inline void YGNodeForgetConstraints(const YGNodeRef node,
+                                           YGRelayoutState *const relayout) {
+  node->layout.relayout = relayout;
+  if (relayout != NULL) {
+    relayout->widthMeasureMode = (uint8_t)-1;
+    relayout->heightMeasureMode = (uint8_t)-1;
+    relayout->isRounded = false;
+  }
+}
+
+// Gives `node`, a bitwise copy of `oldNode`, its own copy of the cold blocks.
+// The copy is not in the dirty roots, even if `oldNode` is, see YGCloneChild.
+static void YGNodeCloneColdBlocks(const YGNodeRef node,
+                                  const YGNode *const oldNode) {
+  const YGStyle *const oldStyle = YGStyleOf(oldNode);
+  YGStyleOf(node)->edgeValues =
+      YGNodeCloneColdBlock(node, oldStyle->edgeValues,
+                           sizeof(float) * oldStyle->edgeValueCapacity);
+  if (oldNode->layout.measurementCache != NULL) {
+    node->layout.measurementCache = YGNodeCloneColdBlock(
+        node, oldNode->layout.measurementCache,
+        YGMeasurementCacheSize(oldNode->layout.measurementCache->capacity));
+  }
+  node->layout.edges = YGNodeCloneColdBlock(node, oldNode->layout.edges,
+                                            sizeof(YGLayoutEdges));
+  node->layout.relayout = YGNodeCloneColdBlock(
+      node, oldNode->layout.relayout, sizeof(YGRelayoutState));
+  if (node->layout.relayout != NULL) {
+    node->layout.relayout->isDirtyRoot = false;
+  }
+  node->recordedFrame = YGNodeCloneColdBlock(node, oldNode->recordedFrame,
+                                             sizeof(YGRecordedFrame));
+}
+
+static void YGNodeFreeColdBlocks(const YGNodeRef node) {
+  if (YGNodeIsDirtyRoot(node)) {
+    YGConfigRemoveDirtyRoot(node->config,
+                            node->layout.relayout->dirtyRootIndex);
+  }
+  if (node->recordedFrame != NULL && node->config->layoutChangeCount > 0) {
+    YGConfigDropLayoutChanges(node->config, node);
+  }
+  if (node->arena != NULL) {
+    // Reclaimed together with the arena.
+    return;
+  }
+  gYGFree(YGStyleOf(node)->edgeValues);
+  gYGFree(node->layout.measurementCache);
+  gYGFree(node->layout.edges);
+  gYGFree(node->layout.relayout);
+  gYGFree(node->recordedFrame);
+}
+
+static void YGNodeReserveEdgeValues(const YGNodeRef node,
+                                    const uint32_t count) {
+  YGStyle *const style = YGStyleOf(node);
+  if (count > style->edgeValueCapacity) {
+    // Grow in steps of four, there are at most
+    // YGEdgePropertyCount * YGEdgeCount values.
+    const uint32_t capacity = (count + 3) & ~3u;
+    style->edgeValues = YGNodeReallocColdBlock(
+        node, style->edgeValues, sizeof(float) * style->edgeValueCapacity,
+        sizeof(float) * capacity);
+    style->edgeValueCapacity = (uint8_t)capacity;
+  }
+}
+
+static void YGNodeStyleSetEdgeValue(const YGNodeRef node,
+                                    const YGEdgeProperty property,
+                                    const YGEdge edge, const YGValue value) {
+  YGStyle *const style = YGStyleOf(node);
+  const uint32_t index = YGStyleEdgeValueIndex(style, property, edge);
+  const uint32_t unitShift = edge * 2;
+
+  if (value.unit == YGUnitUndefined) {
+    if (!YGStyleEdgeIsSet(style, property, edge)) {
+      return;
+    }
+    memmove(&style->edgeValues[index], &style->edgeValues[index + 1],
+            sizeof(float) * (style->edgeValueCount - index - 1));
+    style->edgeValueCount--;
+    for (uint32_t i = property + 1; i < YGEdgePropertyCount; i++) {
+      style->edgeValueOffsets[i]--;
+    }
+    style->edgeMasks[property] &= ~YG_EDGE_BIT(edge);
+    style->edgeUnits[property] &= ~(0x3u << unitShift);
+    return;
+  }
+
+  if (!YGStyleEdgeIsSet(style, property, edge)) {
+    YGNodeReserveEdgeValues(node, style->edgeValueCount + 1);
+    memmove(&style->edgeValues[index + 1], &style->edgeValues[index],
+            sizeof(float) * (style->edgeValueCount - index));
+    style->edgeValueCount++;
+    for (uint32_t i = property + 1; i < YGEdgePropertyCount; i++) {
+      style->edgeValueOffsets[i]++;
+    }
+    style->edgeMasks[property] |= YG_EDGE_BIT(edge);
+  }
+  style->edgeValues[index] = value.value;
+  style->edgeUnits[property] = (style->edgeUnits[property] &
+                                ~(0x3u << unitShift)) |
+                               ((uint32_t)value.unit << unitShift);
+}
+
+static inline uint64_t YGHashMix(uint64_t hash, const uint64_t value) {
+  hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+  return hash ^ hash >> 32;
+}
+
+static inline uint32_t YGFloatBits(const float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// The layout state of a subtree (its caches, flex bases and dirty flags)
+// depends on everything that happened to it, not only on its structure. So
+// nodes keep a history: a hash of the visits of the node and of the edits of
+// its subtree. Identical subtrees with the same history hold the same state.
+#define YG_HISTORY_EDITED 1
+#define YG_HISTORY_INSERTED 2
+#define YG_HISTORY_REMOVED 3
+#define YG_HISTORY_MOVED 4
+#define YG_HISTORY_RESET 5
+#define YG_HISTORY_ZEROED 6
+#define YG_HISTORY_RESTORED 7
+#define YG_HISTORY_LAID_OUT 8
+#define YG_HISTORY_FLEX_BASIS 9
+
+// Folds an edit into the history of the node, then the history of each node
+// into that of its parent along with its index. The structure hashes of the
+// ancestors are cleared on the way.
+static void YGNodeRecordEdit(YGNodeRef node, const uint64_t edit) {
+  node->layout.history = YGHashMix(node->layout.history, edit);
+  node->layout.structureHash = 0;
+  for (YGNodeRef parent = YGParentOf(node); parent != NULL;
+       node = parent, parent = YGParentOf(parent)) {
+    const uint32_t index = YGChildIndexOf(parent, node);
+    parent->layout.history = YGHashMix(
+        parent->layout.history, YGHashMix(node->layout.history, index));
+    parent->layout.structureHash = 0;
+  }
+}
+
+// Records a change of the children of the node, which is about to be marked
+// dirty.
+static inline void YGNodeRecordChildEdit(const YGNodeRef node,
+                                         const uint64_t edit) {
+  if (node->config->memoizeSubtrees) {
+    node->layout.history = YGHashMix(node->layout.history, edit);
+  }
+}
+
+// Puts the layout back to its initial state, keeping the cold blocks that were
+// already allocated for reuse.
+static void YGNodeResetLayout(const YGNodeRef node) {
+  YGMeasurementCache *const measurementCache = node->layout.measurementCache;
+  YGLayoutEdges *const edges = node->layout.edges;
+  YGRelayoutState *const relayout = node->layout.relayout;
+  // The subtree below keeps its state.
+  const uint64_t history = YGHashMix(node->layout.history, YG_HISTORY_RESET);
+  node->layout = gYGNodeDefaults.node.layout;
+  node->layout.history = history;
+  memcpy(YGMeasuredDimensionsOf(node), gYGNodeDefaults.measuredDimensions,
+         sizeof(gYGNodeDefaults.measuredDimensions));
+  memset(YGPositionOf(node), 0, sizeof(gYGNodeDefaults.position));
+  YGNodeForgetConstraints(node, relayout);
+  if (measurementCache != NULL) {
+    YGMeasurementCacheClear(measurementCache);
+    node->layout.measurementCache = measurementCache;
+  }
+  if (edges != NULL) {
+    memset(edges, 0, sizeof(YGLayoutEdges));
+    node->layout.edges = edges;
+  }
+}
+
+// Returns the entry to store a new measurement in. The cache grows while it is
+// below `limit`, after that the new measurement replaces an entry. Sets
+// `evicted` when it does.
+static YGCachedMeasurement *YGNodeAllocCachedMeasurement(const YGNodeRef node,
+                                                         const uint32_t limit,
+                                                         bool *const evicted) {
+  YGMeasurementCache *cache = node->layout.measurementCache;
+  if (cache == NULL) {
+    const uint32_t capacity = limit < YG_INITIAL_CACHED_RESULT_COUNT
+                                  ? limit
+                                  : YG_INITIAL_CACHED_RESULT_COUNT;
+    cache = YGNodeAllocColdBlock(node, YGMeasurementCacheSize(capacity));
+    cache->capacity = capacity;
+    YGMeasurementCacheClear(cache);
+    node->layout.measurementCache = cache;
+  } else if (cache->count == cache->capacity && cache->capacity < limit) {
+    const uint32_t capacity =
+        cache->capacity * 2 < limit ? cache->capacity * 2 : limit;
+    cache = YGNodeReallocColdBlock(node, cache,
+                                   YGMeasurementCacheSize(cache->capacity),
+                                   YGMeasurementCacheSize(capacity));
+    cache->capacity = capacity;
+    node->layout.measurementCache = cache;
+  }
+
+  *evicted = cache->count == cache->capacity;
+  if (!*evicted) {
+    return &cache->cachedMeasurements[cache->count++];
+  }
+  // Give every entry used since the last sweep a second chance.
+  while (cache->cachedMeasurements[cache->hand].referenced) {
+    cache->cachedMeasurements[cache->hand].referenced = false;
+    cache->hand = (cache->hand + 1) % cache->capacity;
+  }
+  YGCachedMeasurement *const entry = &cache->cachedMeasurements[cache->hand];
+  cache->hand = (cache->hand + 1) % cache->capacity;
+  return entry;
+}
+
+// Gives `node` the resolved edges of `from`, in its own block.
+static void YGNodeCopyLayoutEdges(const YGNodeRef node,
+                                  const YGNode *const from) {
+  if (from->layout.edges != NULL) {
+    if (node->layout.edges == NULL) {
+      node->layout.edges = YGNodeAllocColdBlock(node, sizeof(YGLayoutEdges));
+    }
+    memcpy(node->layout.edges, from->layout.edges, sizeof(YGLayoutEdges));
+  } else if (node->layout.edges != NULL) {
+    memset(node->layout.edges, 0, sizeof(YGLayoutEdges));
+  }
+}
+
+// Gives `node` the layout of `from`, caches included, in the cold blocks of
+// `node`. The measurement cache gets the same capacity, which decides when
+// entries get evicted.
+static void YGNodeCopyLayout(const YGNodeRef node, const YGNode *const from) {
+  YGMeasurementCache *cache = node->layout.measurementCache;
+  const YGMeasurementCache *const fromCache = from->layout.measurementCache;
+  if (fromCache != NULL) {
+    const uint32_t capacity = fromCache->capacity;
+    if (cache == NULL) {
+      cache = YGNodeAllocColdBlock(node, YGMeasurementCacheSize(capacity));
+    } else if (cache->capacity != capacity) {
+      cache = YGNodeReallocColdBlock(node, cache,
+                                     YGMeasurementCacheSize(cache->capacity),
+                                     YGMeasurementCacheSize(capacity));
+    }
+    memcpy(cache, fromCache, YGMeasurementCacheSize(fromCache->count));
+  } else if (cache != NULL) {
+    YGMeasurementCacheClear(cache);
+  }
+  YGNodeCopyLayoutEdges(node, from);
+
+  YGLayoutEdges *const edges = node->layout.edges;
+  YGRelayoutState *const relayout = node->layout.relayout;
+  node->layout = from->layout;
+  memcpy(YGMeasuredDimensionsOf(node), YGMeasuredDimensionsOf(from),
+         sizeof(gYGNodeDefaults.measuredDimensions));
+  memcpy(YGPositionOf(node), YGPositionOf(from),
+         sizeof(gYGNodeDefaults.position));
+  node->layout.measurementCache = cache;
+  node->layout.edges = edges;
+  YGNodeForgetConstraints(node, relayout);
+  node->lineIndex = from->lineIndex;
+}
+
+static void YGNodeInit(const YGNodeRef node, const YGConfigRef config,
+                       const YGArenaRef arena) {
+  memcpy(node, &gYGNodeDefaults, sizeof(YGStandaloneNode));
+  YGChildListInit(&YGStandaloneOf(node)->children);
   if (config->useWebDefaults) {
-    node->style.flexDirection = YGFlexDirectionRow;
-    node->style.alignContent = YGAlignStretch;
+    YGStyleOf(node)->flexDirection = YGFlexDirectionRow;
+    YGStyleOf(node)->alignContent = YGAlignStretch;
   }
   node->config = config;
+  node->arena = arena;
+}
+
+YGNodeRef YGNodeNewInArena(const YGArenaRef arena, const YGConfigRef config) {
+  YGAssertWithConfig(
+      config, arena == NULL || config->arena == NULL || config->arena == arena,
+      "Cannot allocate a node in an arena other than that of its config");
+  const YGNodeRef node =
+      arena != NULL ? YGArenaAlloc(arena, sizeof(YGStandaloneNode))
+                    : gYGMalloc(sizeof(YGStandaloneNode));
+  YGAssertWithConfig(config, node != NULL,
+                     "Could not allocate memory for node");
+  YGAtomicAdd(&gNodeInstanceCount, 1);
+  YGArenaRetainNode(arena);
+
+  YGNodeInit(node, config, arena);
   return node;
 }
 
+WIN_EXPORT YGNodeRef YGNodeNewWithConfig(const YGConfigRef config) {
+  return YGNodeNewInArena(config->arena, config);
+}
+
 YGNodeRef YGNodeNew(void) { return YGNodeNewWithConfig(&gYGConfigDefaults); }
 
-YGNodeRef YGNodeClone(const YGNodeRef oldNode) {
-  const YGNodeRef node = gYGMalloc(sizeof(YGNode));
+static YGNodeRef YGNodeCloneInternal(const YGNodeRef oldNode) {
+  YGAssertWithNode(oldNode, oldNode->tree == NULL,
+                   "Cannot clone a node of a YGTree");
+  const YGArenaRef arena = oldNode->arena;
+  const YGNodeRef node =
+      arena != NULL ? YGArenaAlloc(arena, sizeof(YGStandaloneNode))
+                    : gYGMalloc(sizeof(YGStandaloneNode));
   YGAssertWithConfig(oldNode->config, node != NULL,
                      "Could not allocate memory for node");
-  gNodeInstanceCount++;
+  YGAtomicAdd(&gNodeInstanceCount, 1);
+  YGArenaRetainNode(arena);
+
+  memcpy(node, oldNode, sizeof(YGStandaloneNode));
+  YGStandaloneNode *const standalone = YGStandaloneOf(node);
+  YGChildListCopy(&standalone->children, &YGStandaloneOf(oldNode)->children,
+                  arena);
+  standalone->parent = NULL;
+  // The children stay with oldNode and are cloned when they are written to.
+  node->hasSharedChildren = standalone->children.count > 0;
+  YGNodeCloneColdBlocks(node, oldNode);
+  return node;
+}
 
-  memcpy(node, oldNode, sizeof(YGNode));
-  node->children = YGNodeListClone(oldNode->children);
-  node->parent = NULL;
+YGNodeRef YGNodeClone(const YGNodeRef oldNode) {
+  const YGNodeRef node = YGNodeCloneInternal(oldNode);
+  // A copy of a dirty root is one too.
+  if (YGNodeIsDirtyRoot(oldNode)) {
+    YGConfigAddDirtyRoot(node->config, node);
+  }
   return node;
 }
 
 void YGNodeFree(const YGNodeRef node) {
-  if (node->parent) {
-    YGNodeListDelete(node->parent->children, node);
-    node->parent = NULL;
+  YGAssertWithNode(node, node->tree == NULL,
+                   "Cannot free a node of a YGTree, only the whole tree");
+  YGStandaloneNode *const standalone = YGStandaloneOf(node);
+  if (standalone->parent) {
+    if (node->config->memoizeSubtrees) {
+      YGNodeRecordEdit(standalone->parent,
+                       YGHashMix(YG_HISTORY_REMOVED, node->layout.history));
+    }
+    YGChildListDelete(&YGStandaloneOf(standalone->parent)->children, node);
+    standalone->parent = NULL;
   }
 
-  const uint32_t childCount = YGNodeGetChildCount(node);
+  // Shared children still belong to the other tree.
+  const uint32_t childCount = standalone->children.count;
   for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef child = YGNodeGetChild(node, i);
-    child->parent = NULL;
+    YGStandaloneNode *const child =
+        YGStandaloneOf(YGChildListGet(&standalone->children, i));
+    if (child->parent == node) {
+      child->parent = NULL;
+    }
   }
 
-  YGNodeListFree(node->children);
-  gYGFree(node);
-  gNodeInstanceCount--;
+  YGChildListFree(&standalone->children, node->arena);
+  YGNodeFreeColdBlocks(node);
+  if (node->arena != NULL) {
+    // The memory is reclaimed in bulk when the arena is freed.
+    YGArenaReleaseNode(node->arena);
+  } else {
+    gYGFree(node);
+  }
+  YGAtomicAdd(&gNodeInstanceCount, -1);
 }
 
 void YGNodeFreeRecursive(const YGNodeRef root) {
-  while (YGNodeGetChildCount(root) > 0) {
-    const YGNodeRef child = YGNodeGetChild(root, 0);
-    if (child->parent != root) {
+  // Detach and free the owned children front to back, then drop them all from
+  // the list in a single pass. Removing them one at a time from index 0 would
+  // shift the whole list for every child.
+  YGAssertWithNode(root, root->tree == NULL,
+                   "Cannot free a node of a YGTree, only the whole tree");
+  YGChildList *const children = &YGStandaloneOf(root)->children;
+  const uint32_t childCount = children->count;
+  for (uint32_t i = 0; i < childCount; i++) {
+    const YGNodeRef child = YGChildListGet(children, i);
+    if (YGStandaloneOf(child)->parent != root) {
       // Don't free shared nodes that we don't own.
-      break;
+      continue;
     }
-    YGNodeRemoveChild(root, child);
+    YGStandaloneOf(child)->parent = NULL;
     YGNodeFreeRecursive(child);
   }
+  YGChildListRemoveAll(children);
   YGNodeFree(root);
 }
 
 void YGNodeReset(const YGNodeRef node) {
+  YGAssertWithNode(node, node->tree == NULL,
+                   "Cannot reset a node of a YGTree");
   YGAssertWithNode(node, YGNodeGetChildCount(node) == 0,
                    "Cannot reset a node which still has children attached");
-  YGAssertWithNode(node, node->parent == NULL,
+  YGAssertWithNode(node, YGStandaloneOf(node)->parent == NULL,
                    "Cannot reset a node still attached to a parent");
 
-  YGNodeListFree(node->children);
+  YGChildListFree(&YGStandaloneOf(node)->children, node->arena);
+  YGNodeFreeColdBlocks(node);
 
   const YGConfigRef config = node->config;
-  memcpy(node, &gYGNodeDefaults, sizeof(YGNode));
+  const YGArenaRef arena = node->arena;
+  memcpy(node, &gYGNodeDefaults, sizeof(YGStandaloneNode));
+  YGChildListInit(&YGStandaloneOf(node)->children);
   if (config->useWebDefaults) {
-    node->style.flexDirection = YGFlexDirectionRow;
-    node->style.alignContent = YGAlignStretch;
+    YGStyleOf(node)->flexDirection = YGFlexDirectionRow;
+    YGStyleOf(node)->alignContent = YGAlignStretch;
   }
   node->config = config;
+  node->arena = arena;
 }
 
-int32_t YGNodeGetInstanceCount(void) { return gNodeInstanceCount; }
+int32_t YGNodeGetInstanceCount(void) {
+  return YGAtomicLoad(&gNodeInstanceCount);
+}
 
-int32_t YGConfigGetInstanceCount(void) { return gConfigInstanceCount; }
+int32_t YGConfigGetInstanceCount(void) {
+  return YGAtomicLoad(&gConfigInstanceCount);
+}
 
 // Export only for C#
 YGConfigRef YGConfigGetDefault() { return &gYGConfigDefaults; }
@@ -424,30 +1321,188 @@ YGConfigRef YGConfigNew(void) {
   const YGConfigRef config = gYGMalloc(sizeof(YGConfig));
   YGAssert(config != NULL, "Could not allocate memory for config");
 
-  gConfigInstanceCount++;
+  YGAtomicAdd(&gConfigInstanceCount, 1);
+  memcpy(config, &gYGConfigDefaults, sizeof(YGConfig));
+  return config;
+}
+
+YGConfigRef YGConfigNewInArena(const YGArenaRef arena) {
+  const YGConfigRef config = YGArenaAlloc(arena, sizeof(YGConfig));
+  YGAssert(config != NULL, "Could not allocate memory for config");
+
+  YGAtomicAdd(&gConfigInstanceCount, 1);
+  YGArenaRetainConfig(arena);
   memcpy(config, &gYGConfigDefaults, sizeof(YGConfig));
+  config->arena = arena;
   return config;
 }
 
 void YGConfigFree(const YGConfigRef config) {
-  gYGFree(config);
-  gConfigInstanceCount--;
+  if (config->arena != NULL) {
+    YGArenaReleaseConfig(config->arena);
+  } else {
+    while (config->nodeArenaCount > 0) {
+      YGArenaUnlinkConfig(config->nodeArenas[0], config);
+    }
+    gYGFree(config->nodeArenas);
+    gYGFree(config->dirtyRoots);
+    gYGFree(config->layoutChanges);
+    gYGFree(config->previousLayoutChanges);
+    gYGFree(config);
+  }
+  YGAtomicAdd(&gConfigInstanceCount, -1);
 }
 
 void YGConfigCopy(const YGConfigRef dest, const YGConfigRef src) {
+  // The arena a config lives in is a property of its storage, not a setting,
+  // and the stats count the layouts of dest, as the dirty roots and the layout
+  // changes are its nodes.
+  const YGArenaRef arena = dest->arena;
+  const YGLayoutStats stats = dest->stats;
+  YGNodeRef *const dirtyRoots = dest->dirtyRoots;
+  const uint32_t dirtyRootCount = dest->dirtyRootCount;
+  const uint32_t dirtyRootCapacity = dest->dirtyRootCapacity;
+  YGArenaRef *const nodeArenas = dest->nodeArenas;
+  const uint32_t nodeArenaCount = dest->nodeArenaCount;
+  const uint32_t nodeArenaCapacity = dest->nodeArenaCapacity;
+  YGLayoutChange *const layoutChanges = dest->layoutChanges;
+  uint32_t *const previousLayoutChanges = dest->previousLayoutChanges;
+  const uint32_t layoutChangeCount = dest->layoutChangeCount;
+  const uint32_t layoutChangeCapacity = dest->layoutChangeCapacity;
+  const uint32_t droppedLayoutChangeCount = dest->droppedLayoutChangeCount;
   memcpy(dest, src, sizeof(YGConfig));
+  dest->arena = arena;
+  dest->stats = stats;
+  dest->dirtyRoots = dirtyRoots;
+  dest->dirtyRootCount = dirtyRootCount;
+  dest->dirtyRootCapacity = dirtyRootCapacity;
+  dest->nodeArenas = nodeArenas;
+  dest->nodeArenaCount = nodeArenaCount;
+  dest->nodeArenaCapacity = nodeArenaCapacity;
+  dest->layoutChanges = layoutChanges;
+  dest->previousLayoutChanges = previousLayoutChanges;
+  dest->layoutChangeCount = layoutChangeCount;
+  dest->layoutChangeCapacity = layoutChangeCapacity;
+  dest->droppedLayoutChangeCount = droppedLayoutChangeCount;
+}
+
+void YGConfigSetMaxCachedMeasurements(const YGConfigRef config,
+                                      const uint32_t count) {
+  YGAssertWithConfig(config, count > 0,
+                     "A node must be able to cache one measurement");
+  config->maxCachedMeasurements = count;
+}
+
+void YGConfigSetSubtreeMemoization(const YGConfigRef config,
+                                   const bool enabled) {
+  config->memoizeSubtrees = enabled;
+}
+
+YGLayoutStats YGConfigGetLayoutStats(const YGConfigRef config) {
+  const YGLayoutStats *const total = &config->stats;
+  return (YGLayoutStats){
+      .nodesVisited = YGAtomicLoad64(&total->nodesVisited),
+      .layoutCalls = YGAtomicLoad64(&total->layoutCalls),
+      .measureCalls = YGAtomicLoad64(&total->measureCalls),
+      .cachedLayoutHits = YGAtomicLoad64(&total->cachedLayoutHits),
+      .cachedLayoutMisses = YGAtomicLoad64(&total->cachedLayoutMisses),
+      .cachedMeasurementHits = YGAtomicLoad64(&total->cachedMeasurementHits),
+      .cachedMeasurementMisses =
+          YGAtomicLoad64(&total->cachedMeasurementMisses),
+      .cachedMeasurementEvictions =
+          YGAtomicLoad64(&total->cachedMeasurementEvictions),
+      .measureFuncCalls = YGAtomicLoad64(&total->measureFuncCalls),
+      .nodesRounded = YGAtomicLoad64(&total->nodesRounded),
+      .memoizedSubtrees = YGAtomicLoad64(&total->memoizedSubtrees),
+      .memoizedNodes = YGAtomicLoad64(&total->memoizedNodes),
+      .maxDepth = YGAtomicLoad(&total->maxDepth),
+  };
 }
 
-static void YGNodeMarkDirtyInternal(const YGNodeRef node) {
-  if (!node->isDirty) {
-    node->isDirty = true;
-    node->layout.computedFlexBasis = YGUndefined;
-    if (node->parent) {
-      YGNodeMarkDirtyInternal(node->parent);
+void YGConfigResetLayoutStats(const YGConfigRef config) {
+  YGLayoutStats *const total = &config->stats;
+  YGAtomicStore64(&total->nodesVisited, 0);
+  YGAtomicStore64(&total->layoutCalls, 0);
+  YGAtomicStore64(&total->measureCalls, 0);
+  YGAtomicStore64(&total->cachedLayoutHits, 0);
+  YGAtomicStore64(&total->cachedLayoutMisses, 0);
+  YGAtomicStore64(&total->cachedMeasurementHits, 0);
+  YGAtomicStore64(&total->cachedMeasurementMisses, 0);
+  YGAtomicStore64(&total->cachedMeasurementEvictions, 0);
+  YGAtomicStore64(&total->measureFuncCalls, 0);
+  YGAtomicStore64(&total->nodesRounded, 0);
+  YGAtomicStore64(&total->memoizedSubtrees, 0);
+  YGAtomicStore64(&total->memoizedNodes, 0);
+  YGAtomicStore(&total->maxDepth, 0);
+}
+
+static inline bool YGNodeHasFixedSize(const YGNodeRef node) {
+  return YGStyleOf(node)->display == YGDisplayFlex &&
+         YGStyleOf(node)->dimensions[YGDimensionWidth].unit == YGUnitPoint &&
+         YGStyleOf(node)->dimensions[YGDimensionHeight].unit == YGUnitPoint;
+}
+
+// Whether the size of the node cannot depend on its content: it is fixed, its
+// parent gave it exactly that size when it was last laid out, and no ancestor
+// has used its baseline since. An edit below it then only needs it to be laid
+// out again.
+static bool YGNodeIsRelayoutBoundary(const YGNodeRef node) {
+  const YGRelayoutState *const relayout = node->layout.relayout;
+  return relayout != NULL && YGParentOf(node) != NULL &&
+         node->config->useRelayoutBoundaries &&
+         relayout->widthMeasureMode == YGMeasureModeExactly &&
+         relayout->heightMeasureMode == YGMeasureModeExactly &&
+         !relayout->baselineQueried && YGNodeHasFixedSize(node);
+}
+
+// Marks `node` and its ancestors dirty, up to the first relayout boundary,
+// which goes into the dirty roots of its config rather than dirtying its
+// parent. Unless only the content of `node` changed, its own size may have, so
+// it doesn't stop the walk.
+static void YGNodeMarkDirtyUpwards(const YGNodeRef node,
+                                   const bool contentOnly) {
+  YGNodeRef dirty = node;
+  if (!contentOnly && node->isDirty && YGNodeIsDirtyRoot(node)) {
+    // The walk stopped here before.
+    dirty = YGParentOf(node);
+  }
+  for (; dirty != NULL && !dirty->isDirty; dirty = YGParentOf(dirty)) {
+    dirty->isDirty = true;
+    dirty->layout.computedFlexBasis = YGUndefined;
+    if ((contentOnly || dirty != node) && YGNodeIsRelayoutBoundary(dirty)) {
+      if (!YGNodeIsDirtyRoot(dirty)) {
+        YGConfigAddDirtyRoot(dirty->config, dirty);
+      }
+      return;
     }
   }
 }
 
+static void YGNodeMarkDirtyInternal(const YGNodeRef node) {
+  // The eligibility of a stack depends on the styles of its children too.
+  node->simpleStack = YG_SIMPLE_STACK_UNKNOWN;
+  const YGNodeRef parent = YGParentOf(node);
+  if (parent != NULL) {
+    parent->simpleStack = YG_SIMPLE_STACK_UNKNOWN;
+  }
+  if (node->config->memoizeSubtrees) {
+    // Goes all the way up: nodes hidden by display: none stay dirty through
+    // layouts, yet they are part of the structure of their ancestors.
+    YGNodeRecordEdit(node, YG_HISTORY_EDITED);
+  }
+  YGNodeMarkDirtyUpwards(node, false);
+}
+
+// Like YGNodeMarkDirtyInternal, for edits of the children or the measured
+// content of a node, which leave its style as it was.
+static void YGNodeMarkContentDirty(const YGNodeRef node) {
+  node->simpleStack = YG_SIMPLE_STACK_UNKNOWN;
+  if (node->config->memoizeSubtrees) {
+    YGNodeRecordEdit(node, YG_HISTORY_EDITED);
+  }
+  YGNodeMarkDirtyUpwards(node, true);
+}
+
 void YGNodeSetMeasureFunc(const YGNodeRef node, YGMeasureFunc measureFunc) {
   if (measureFunc == NULL) {
     node->measure = NULL;
@@ -474,132 +1529,239 @@ YGBaselineFunc YGNodeGetBaselineFunc(const YGNodeRef node) {
   return node->baseline;
 }
 
-static void YGCloneChildrenIfNeeded(const YGNodeRef parent) {
-  // YGNodeRemoveChild has a forked variant of this algorithm optimized for
-  // deletions.
-  const uint32_t childCount = YGNodeGetChildCount(parent);
-  if (childCount == 0) {
-    // This is an empty set. Nothing to clone.
-    return;
+#define YG_CLONE_BATCH_SIZE 32
+
+static void YGNotifyClones(const YGNodeRef parent,
+                           const YGNodeRef oldChildren[],
+                           const YGNodeRef newChildren[],
+                           const uint32_t indices[], const uint32_t count) {
+  const YGConfigRef config = parent->config;
+  if (config->nodesClonedCallback != NULL) {
+    config->nodesClonedCallback(parent, oldChildren, newChildren, indices,
+                                count);
+  } else if (config->cloneNodeCallback != NULL) {
+    for (uint32_t i = 0; i < count; i++) {
+      config->cloneNodeCallback(oldChildren[i], newChildren[i], parent,
+                                (int)indices[i]);
+    }
+  }
+}
+
+struct YGLayoutContext;
+static void YGLayoutContextAddClonedDirtyRoot(
+    struct YGLayoutContext *const layoutContext, const YGNodeRef node);
+
+// Clones the child at `index`. The clone of a dirty root is one too; during a
+// layout, which may run on the threads of a pool, it is recorded in the
+// context and only added to the dirty roots of the config once joined.
+static YGNodeRef YGCloneChild(const YGNodeRef parent, const uint32_t index,
+                              struct YGLayoutContext *const layoutContext) {
+  YGChildList *const children = &YGStandaloneOf(parent)->children;
+  const YGNodeRef oldChild = YGChildListGet(children, index);
+  const YGNodeRef newChild = YGNodeCloneInternal(oldChild);
+  YGChildListReplace(children, index, newChild);
+  YGStandaloneOf(newChild)->parent = parent;
+  if (YGNodeIsDirtyRoot(oldChild)) {
+    if (layoutContext != NULL) {
+      YGLayoutContextAddClonedDirtyRoot(layoutContext, newChild);
+    } else {
+      YGConfigAddDirtyRoot(newChild->config, newChild);
+    }
   }
-  const YGNodeRef firstChild = YGNodeGetChild(parent, 0);
-  if (firstChild->parent == parent) {
-    // If the first child has this node as its parent, we assume that it is
-    // already unique. We can do this because if we have it has a child, that
-    // means that its parent was at some point cloned which made that subtree
-    // immutable. We also assume that all its sibling are cloned as well.
+  return newChild;
+}
+
+// A child whose parent is not this node is shared with another tree, which
+// owns it. Clones those children so that the layout can write to them. The
+// owned ones, like the path cloned by YGNodeGetMutableChild, are kept.
+static void YGCloneChildrenIfNeeded(
+    const YGNodeRef parent, struct YGLayoutContext *const layoutContext) {
+  if (!parent->hasSharedChildren) {
     return;
   }
-  const YGNodeClonedFunc cloneNodeCallback = parent->config->cloneNodeCallback;
-  const YGNodeListRef children = parent->children;
+  YGNodeRef oldChildren[YG_CLONE_BATCH_SIZE];
+  YGNodeRef newChildren[YG_CLONE_BATCH_SIZE];
+  uint32_t indices[YG_CLONE_BATCH_SIZE];
+  uint32_t batchCount = 0;
+  const YGChildList *const children = &YGStandaloneOf(parent)->children;
+  const uint32_t childCount = children->count;
   for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef oldChild = YGNodeListGet(children, i);
-    const YGNodeRef newChild = YGNodeClone(oldChild);
-    YGNodeListReplace(children, i, newChild);
-    newChild->parent = parent;
-    if (cloneNodeCallback) {
-      cloneNodeCallback(oldChild, newChild, parent, i);
+    const YGNodeRef oldChild = YGChildListGet(children, i);
+    if (YGStandaloneOf(oldChild)->parent == parent) {
+      continue;
     }
+    oldChildren[batchCount] = oldChild;
+    newChildren[batchCount] = YGCloneChild(parent, i, layoutContext);
+    indices[batchCount] = i;
+    if (++batchCount == YG_CLONE_BATCH_SIZE) {
+      YGNotifyClones(parent, oldChildren, newChildren, indices, batchCount);
+      batchCount = 0;
+    }
+  }
+  if (batchCount > 0) {
+    YGNotifyClones(parent, oldChildren, newChildren, indices, batchCount);
+  }
+  parent->hasSharedChildren = false;
+}
+
+YGNodeRef YGNodeGetMutableChild(const YGNodeRef node, const uint32_t index) {
+  YGAssertWithNode(node, index < YGNodeGetChildCount(node),
+                   "Cannot get child: index is out of bounds.");
+  // The children of a node of a tree are never shared.
+  if (node->tree != NULL) {
+    return YGNodeGetChild(node, index);
+  }
+  YGNodeRef oldChild = YGChildListGet(&YGStandaloneOf(node)->children, index);
+  if (YGStandaloneOf(oldChild)->parent == node) {
+    return oldChild;
   }
+  YGNodeRef newChild = YGCloneChild(node, index, NULL);
+  YGNotifyClones(node, &oldChild, &newChild, &index, 1);
+  return newChild;
 }
 
 void YGNodeInsertChild(const YGNodeRef node, const YGNodeRef child,
                        const uint32_t index) {
-  YGAssertWithNode(node, child->parent == NULL,
+  YGAssertWithNode(node, node->tree == NULL && child->tree == NULL,
+                   "Cannot add child: nodes of a YGTree are appended to it.");
+  YGAssertWithNode(node, YGParentOf(child) == NULL,
                    "Child already has a parent, it must be removed first.");
   YGAssertWithNode(
       node, node->measure == NULL,
       "Cannot add child: Nodes with measure functions cannot have children.");
 
-  YGCloneChildrenIfNeeded(node);
+  YGChildListInsert(&YGStandaloneOf(node)->children, node->arena, child, index);
+  YGStandaloneOf(child)->parent = node;
+  YGNodeRecordChildEdit(node, YGHashMix(YGHashMix(YG_HISTORY_INSERTED, index),
+                                        child->layout.history));
+  YGNodeMarkContentDirty(node);
+}
 
-  YGNodeListInsert(&node->children, child, index);
-  child->parent = node;
-  YGNodeMarkDirtyInternal(node);
+// Detaches a removed child. A shared child stays valid in the tree that owns
+// it, so it keeps its layout and parent.
+static void YGNodeDetachChild(const YGNodeRef parent, const YGNodeRef child) {
+  if (YGStandaloneOf(child)->parent == parent) {
+    YGNodeResetLayout(child);  // layout is no longer valid
+    YGStandaloneOf(child)->parent = NULL;
+  }
 }
 
 void YGNodeRemoveChild(const YGNodeRef parent, const YGNodeRef excludedChild) {
-  // This algorithm is a forked variant from YGCloneChildrenIfNeeded that
-  // excludes a child.
+  YGAssertWithNode(parent, parent->tree == NULL,
+                   "Cannot remove child: nodes of a YGTree stay in it.");
+  if (YGChildListDelete(&YGStandaloneOf(parent)->children, excludedChild) !=
+      NULL) {
+    YGNodeRecordChildEdit(parent, YGHashMix(YG_HISTORY_REMOVED,
+                                            excludedChild->layout.history));
+    YGNodeDetachChild(parent, excludedChild);
+    YGNodeMarkContentDirty(parent);
+  }
+}
+
+void YGNodeRemoveAllChildren(const YGNodeRef parent) {
   const uint32_t childCount = YGNodeGetChildCount(parent);
   if (childCount == 0) {
-    // This is an empty set. Nothing to remove.
-    return;
-  }
-  const YGNodeRef firstChild = YGNodeGetChild(parent, 0);
-  if (firstChild->parent == parent) {
-    // If the first child has this node as its parent, we assume that it is
-    // already unique. We can now try to delete a child in this list.
-    if (YGNodeListDelete(parent->children, excludedChild) != NULL) {
-      excludedChild->layout =
-          gYGNodeDefaults.layout;  // layout is no longer valid
-      excludedChild->parent = NULL;
-      YGNodeMarkDirtyInternal(parent);
-    }
+    // This is an empty set already. Nothing to do.
     return;
   }
-  // Otherwise we have to clone the node list except for the child we're trying
-  // to delete. We don't want to simply clone all children, because then the
-  // host will need to free the clone of the child that was just deleted.
-  const YGNodeClonedFunc cloneNodeCallback = parent->config->cloneNodeCallback;
-  const YGNodeListRef children = parent->children;
-  uint32_t nextInsertIndex = 0;
+  YGAssertWithNode(parent, parent->tree == NULL,
+                   "Cannot remove child: nodes of a YGTree stay in it.");
+  YGChildList *const children = &YGStandaloneOf(parent)->children;
   for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef oldChild = YGNodeListGet(children, i);
-    if (excludedChild == oldChild) {
-      // Ignore the deleted child. Don't reset its layout or parent since it is
-      // still valid in the other parent. However, since this parent has now
-      // changed, we need to mark it as dirty.
-      YGNodeMarkDirtyInternal(parent);
-      continue;
-    }
-    const YGNodeRef newChild = YGNodeClone(oldChild);
-    YGNodeListReplace(children, nextInsertIndex, newChild);
-    newChild->parent = parent;
-    if (cloneNodeCallback) {
-      cloneNodeCallback(oldChild, newChild, parent, nextInsertIndex);
-    }
-    nextInsertIndex++;
+    YGNodeDetachChild(parent, YGChildListGet(children, i));
+  }
+  YGChildListRemoveAll(children);
+  parent->hasSharedChildren = false;
+  YGNodeRecordChildEdit(parent, YG_HISTORY_REMOVED);
+  YGNodeMarkContentDirty(parent);
+}
+
+void YGNodeInsertChildren(const YGNodeRef node, const YGNodeRef children[],
+                          const uint32_t count, const uint32_t index) {
+  YGAssertWithNode(
+      node, node->measure == NULL,
+      "Cannot add child: Nodes with measure functions cannot have children.");
+  if (count == 0) {
+    return;
   }
-  while (nextInsertIndex < childCount) {
-    YGNodeListRemove(children, nextInsertIndex);
-    nextInsertIndex++;
+  YGAssertWithNode(node, node->tree == NULL,
+                   "Cannot add child: nodes of a YGTree are appended to it.");
+
+  YGChildList *const list = &YGStandaloneOf(node)->children;
+  YGChildListReserve(list, node->arena, list->count + count);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef child = children[i];
+    YGAssertWithNode(node, child->tree == NULL,
+                     "Cannot add child: nodes of a YGTree are appended to it.");
+    YGAssertWithNode(node, YGParentOf(child) == NULL,
+                     "Child already has a parent, it must be removed first.");
+    YGChildListInsert(list, node->arena, child, index + i);
+    YGStandaloneOf(child)->parent = node;
+    YGNodeRecordChildEdit(
+        node, YGHashMix(YGHashMix(YG_HISTORY_INSERTED, index + i),
+                        child->layout.history));
   }
+  YGNodeMarkContentDirty(node);
 }
 
-void YGNodeRemoveAllChildren(const YGNodeRef parent) {
+void YGNodeRemoveChildren(const YGNodeRef parent, const uint32_t index,
+                          const uint32_t count) {
   const uint32_t childCount = YGNodeGetChildCount(parent);
-  if (childCount == 0) {
-    // This is an empty set already. Nothing to do.
+  YGAssertWithNode(parent, index + count <= childCount,
+                   "Cannot remove children: range is out of bounds.");
+  if (count == 0) {
     return;
   }
-  const YGNodeRef firstChild = YGNodeGetChild(parent, 0);
-  if (firstChild->parent == parent) {
-    // If the first child has this node as its parent, we assume that this child
-    // set is unique.
-    for (uint32_t i = 0; i < childCount; i++) {
-      const YGNodeRef oldChild = YGNodeGetChild(parent, i);
-      oldChild->layout = gYGNodeDefaults.layout;  // layout is no longer valid
-      oldChild->parent = NULL;
-    }
-    YGNodeListRemoveAll(parent->children);
-    YGNodeMarkDirtyInternal(parent);
+  YGAssertWithNode(parent, parent->tree == NULL,
+                   "Cannot remove child: nodes of a YGTree stay in it.");
+  YGChildList *const children = &YGStandaloneOf(parent)->children;
+  for (uint32_t i = index; i < index + count; i++) {
+    YGNodeDetachChild(parent, YGChildListGet(children, i));
+  }
+  YGChildListRemoveRange(children, index, count);
+  YGNodeRecordChildEdit(parent, YGHashMix(YG_HISTORY_REMOVED,
+                                          (uint64_t)count << 32 | index));
+  YGNodeMarkContentDirty(parent);
+}
+
+void YGNodeMoveChild(const YGNodeRef node, const uint32_t fromIndex,
+                     const uint32_t toIndex) {
+  const uint32_t childCount = YGNodeGetChildCount(node);
+  YGAssertWithNode(node, fromIndex < childCount && toIndex < childCount,
+                   "Cannot move child: index is out of bounds.");
+  if (fromIndex == toIndex) {
     return;
   }
-  // Otherwise, we are not the owner of the child set. We don't have to do
-  // anything to clear it.
-  parent->children = NULL;
-  YGNodeMarkDirtyInternal(parent);
+  YGAssertWithNode(node, node->tree == NULL,
+                   "Cannot move child: nodes of a YGTree stay in place.");
+
+  YGChildList *const children = &YGStandaloneOf(node)->children;
+  const YGNodeRef child = YGChildListRemove(children, fromIndex);
+  YGChildListInsert(children, node->arena, child, toIndex);
+  YGNodeRecordChildEdit(node, YGHashMix(YG_HISTORY_MOVED,
+                                        (uint64_t)toIndex << 32 | fromIndex));
+  YGNodeMarkContentDirty(node);
 }
 
 YGNodeRef YGNodeGetChild(const YGNodeRef node, const uint32_t index) {
-  return YGNodeListGet(node->children, index);
+  if (index >= YGChildCountOf(node)) {
+    return NULL;
+  }
+  if (node->tree == NULL) {
+    return YGChildListGet(&YGStandaloneOf(node)->children, index);
+  }
+  // The children of a node of a tree are a list of siblings.
+  uint32_t cursor = YGChildCursorFirst(node);
+  for (uint32_t i = 0; i < index; i++) {
+    cursor = YGChildCursorNext(node, cursor);
+  }
+  return YGChildAtCursor(node, cursor);
 }
 
-YGNodeRef YGNodeGetParent(const YGNodeRef node) { return node->parent; }
+YGNodeRef YGNodeGetParent(const YGNodeRef node) { return YGParentOf(node); }
 
 uint32_t YGNodeGetChildCount(const YGNodeRef node) {
-  return YGNodeListCount(node->children);
+  return YGChildCountOf(node);
 }
 
 void YGNodeMarkDirty(const YGNodeRef node) {
@@ -607,66 +1769,82 @@ void YGNodeMarkDirty(const YGNodeRef node) {
                    "Only leaf nodes with custom measure functions"
                    "should manually mark themselves as dirty");
 
-  YGNodeMarkDirtyInternal(node);
+  YGNodeMarkContentDirty(node);
 }
 
 bool YGNodeIsDirty(const YGNodeRef node) { return node->isDirty; }
 
 void YGNodeCopyStyle(const YGNodeRef dstNode, const YGNodeRef srcNode) {
-  if (memcmp(&dstNode->style, &srcNode->style, sizeof(YGStyle)) != 0) {
-    memcpy(&dstNode->style, &srcNode->style, sizeof(YGStyle));
+  // Everything up to the edge value storage is compared and copied in one go.
+  const size_t inlineSize = offsetof(YGStyle, edgeValueCapacity);
+  YGStyle *const dstStyle = YGStyleOf(dstNode);
+  const YGStyle *const srcStyle = YGStyleOf(srcNode);
+  const size_t edgeValuesSize = sizeof(float) * srcStyle->edgeValueCount;
+  if (memcmp(dstStyle, srcStyle, inlineSize) != 0 ||
+      (edgeValuesSize > 0 &&
+       memcmp(dstStyle->edgeValues, srcStyle->edgeValues, edgeValuesSize) !=
+           0)) {
+    YGNodeReserveEdgeValues(dstNode, srcStyle->edgeValueCount);
+    memcpy(dstStyle, srcStyle, inlineSize);
+    if (edgeValuesSize > 0) {
+      memcpy(dstStyle->edgeValues, srcStyle->edgeValues, edgeValuesSize);
+    }
     YGNodeMarkDirtyInternal(dstNode);
   }
 }
 
 static inline float YGResolveFlexGrow(const YGNodeRef node) {
   // Root nodes flexGrow should always be 0
-  if (node->parent == NULL) {
+  if (YGParentOf(node) == NULL) {
     return 0.0;
   }
-  if (!YGFloatIsUndefined(node->style.flexGrow)) {
-    return node->style.flexGrow;
+  const YGStyle *const style = YGStyleOf(node);
+  if (!YGFloatIsUndefined(style->flexGrow)) {
+    return style->flexGrow;
   }
-  if (!YGFloatIsUndefined(node->style.flex) && node->style.flex > 0.0f) {
-    return node->style.flex;
+  if (!YGFloatIsUndefined(style->flex) && style->flex > 0.0f) {
+    return style->flex;
   }
   return kDefaultFlexGrow;
 }
 
 float YGNodeStyleGetFlexGrow(const YGNodeRef node) {
-  return YGFloatIsUndefined(node->style.flexGrow) ? kDefaultFlexGrow
-                                                  : node->style.flexGrow;
+  const float flexGrow = YGStyleOf(node)->flexGrow;
+  return YGFloatIsUndefined(flexGrow) ? kDefaultFlexGrow : flexGrow;
 }
 
 float YGNodeStyleGetFlexShrink(const YGNodeRef node) {
-  return YGFloatIsUndefined(node->style.flexShrink)
+  const float flexShrink = YGStyleOf(node)->flexShrink;
+  return YGFloatIsUndefined(flexShrink)
              ? (node->config->useWebDefaults ? kWebDefaultFlexShrink
                                              : kDefaultFlexShrink)
-             : node->style.flexShrink;
+             : flexShrink;
 }
 
 static inline float YGNodeResolveFlexShrink(const YGNodeRef node) {
   // Root nodes flexShrink should always be 0
-  if (node->parent == NULL) {
+  if (YGParentOf(node) == NULL) {
     return 0.0;
   }
-  if (!YGFloatIsUndefined(node->style.flexShrink)) {
-    return node->style.flexShrink;
+  const YGStyle *const style = YGStyleOf(node);
+  if (!YGFloatIsUndefined(style->flexShrink)) {
+    return style->flexShrink;
   }
-  if (!node->config->useWebDefaults && !YGFloatIsUndefined(node->style.flex) &&
-      node->style.flex < 0.0f) {
-    return -node->style.flex;
+  if (!node->config->useWebDefaults && !YGFloatIsUndefined(style->flex) &&
+      style->flex < 0.0f) {
+    return -style->flex;
   }
   return node->config->useWebDefaults ? kWebDefaultFlexShrink
                                       : kDefaultFlexShrink;
 }
 
 static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
-  if (node->style.flexBasis.unit != YGUnitAuto &&
-      node->style.flexBasis.unit != YGUnitUndefined) {
-    return &node->style.flexBasis;
+  const YGStyle *const style = YGStyleOf(node);
+  if (style->flexBasis.unit != YGUnitAuto &&
+      style->flexBasis.unit != YGUnitUndefined) {
+    return &style->flexBasis;
   }
-  if (!YGFloatIsUndefined(node->style.flex) && node->style.flex > 0.0f) {
+  if (!YGFloatIsUndefined(style->flex) && style->flex > 0.0f) {
     return node->config->useWebDefaults ? &YGValueAuto : &YGValueZero;
   }
   return &YGValueAuto;
@@ -682,8 +1860,9 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
 #define YG_NODE_STYLE_PROPERTY_SETTER_IMPL(type, name, paramName,         \
                                            instanceName)                  \
   void YGNodeStyleSet##name(const YGNodeRef node, const type paramName) { \
-    if (node->style.instanceName != paramName) {                          \
-      node->style.instanceName = paramName;                               \
+    YGStyle *const style = YGStyleOf(node);                               \
+    if (style->instanceName != paramName) {                               \
+      style->instanceName = paramName;                                    \
       YGNodeMarkDirtyInternal(node);                                      \
     }                                                                     \
   }
@@ -691,10 +1870,11 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
 #define YG_NODE_STYLE_PROPERTY_SETTER_UNIT_IMPL(type, name, paramName,    \
                                                 instanceName)             \
   void YGNodeStyleSet##name(const YGNodeRef node, const type paramName) { \
-    if (node->style.instanceName.value != paramName ||                    \
-        node->style.instanceName.unit != YGUnitPoint) {                   \
-      node->style.instanceName.value = paramName;                         \
-      node->style.instanceName.unit =                                     \
+    YGStyle *const style = YGStyleOf(node);                               \
+    if (style->instanceName.value != paramName ||                         \
+        style->instanceName.unit != YGUnitPoint) {                        \
+      style->instanceName.value = paramName;                              \
+      style->instanceName.unit =                                          \
           YGFloatIsUndefined(paramName) ? YGUnitAuto : YGUnitPoint;       \
       YGNodeMarkDirtyInternal(node);                                      \
     }                                                                     \
@@ -702,10 +1882,11 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
                                                                           \
   void YGNodeStyleSet##name##Percent(const YGNodeRef node,                \
                                      const type paramName) {              \
-    if (node->style.instanceName.value != paramName ||                    \
-        node->style.instanceName.unit != YGUnitPercent) {                 \
-      node->style.instanceName.value = paramName;                         \
-      node->style.instanceName.unit =                                     \
+    YGStyle *const style = YGStyleOf(node);                               \
+    if (style->instanceName.value != paramName ||                         \
+        style->instanceName.unit != YGUnitPercent) {                      \
+      style->instanceName.value = paramName;                              \
+      style->instanceName.unit =                                          \
           YGFloatIsUndefined(paramName) ? YGUnitAuto : YGUnitPercent;     \
       YGNodeMarkDirtyInternal(node);                                      \
     }                                                                     \
@@ -714,10 +1895,11 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
 #define YG_NODE_STYLE_PROPERTY_SETTER_UNIT_AUTO_IMPL(type, name, paramName, \
                                                      instanceName)          \
   void YGNodeStyleSet##name(const YGNodeRef node, const type paramName) {   \
-    if (node->style.instanceName.value != paramName ||                      \
-        node->style.instanceName.unit != YGUnitPoint) {                     \
-      node->style.instanceName.value = paramName;                           \
-      node->style.instanceName.unit =                                       \
+    YGStyle *const style = YGStyleOf(node);                                 \
+    if (style->instanceName.value != paramName ||                           \
+        style->instanceName.unit != YGUnitPoint) {                          \
+      style->instanceName.value = paramName;                                \
+      style->instanceName.unit =                                            \
           YGFloatIsUndefined(paramName) ? YGUnitAuto : YGUnitPoint;         \
       YGNodeMarkDirtyInternal(node);                                        \
     }                                                                       \
@@ -725,19 +1907,21 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
                                                                             \
   void YGNodeStyleSet##name##Percent(const YGNodeRef node,                  \
                                      const type paramName) {                \
-    if (node->style.instanceName.value != paramName ||                      \
-        node->style.instanceName.unit != YGUnitPercent) {                   \
-      node->style.instanceName.value = paramName;                           \
-      node->style.instanceName.unit =                                       \
+    YGStyle *const style = YGStyleOf(node);                                 \
+    if (style->instanceName.value != paramName ||                           \
+        style->instanceName.unit != YGUnitPercent) {                        \
+      style->instanceName.value = paramName;                                \
+      style->instanceName.unit =                                            \
           YGFloatIsUndefined(paramName) ? YGUnitAuto : YGUnitPercent;       \
       YGNodeMarkDirtyInternal(node);                                        \
     }                                                                       \
   }                                                                         \
                                                                             \
   void YGNodeStyleSet##name##Auto(const YGNodeRef node) {                   \
-    if (node->style.instanceName.unit != YGUnitAuto) {                      \
-      node->style.instanceName.value = YGUndefined;                         \
-      node->style.instanceName.unit = YGUnitAuto;                           \
+    YGStyle *const style = YGStyleOf(node);                                 \
+    if (style->instanceName.unit != YGUnitAuto) {                           \
+      style->instanceName.value = YGUndefined;                              \
+      style->instanceName.unit = YGUnitAuto;                                \
       YGNodeMarkDirtyInternal(node);                                        \
     }                                                                       \
   }
@@ -746,7 +1930,7 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
   YG_NODE_STYLE_PROPERTY_SETTER_IMPL(type, name, paramName, instanceName) \
                                                                           \
   type YGNodeStyleGet##name(const YGNodeRef node) {                       \
-    return node->style.instanceName;                                      \
+    return YGStyleOf(node)->instanceName;                                 \
   }
 
 #define YG_NODE_STYLE_PROPERTY_UNIT_IMPL(type, name, paramName, instanceName) \
@@ -754,7 +1938,7 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
                                           instanceName)                       \
                                                                               \
   type YGNodeStyleGet##name(const YGNodeRef node) {                           \
-    return node->style.instanceName;                                          \
+    return YGStyleOf(node)->instanceName;                                     \
   }
 
 #define YG_NODE_STYLE_PROPERTY_UNIT_AUTO_IMPL(type, name, paramName,   \
@@ -763,96 +1947,115 @@ static inline const YGValue *YGNodeResolveFlexBasisPtr(const YGNodeRef node) {
                                                instanceName)           \
                                                                        \
   type YGNodeStyleGet##name(const YGNodeRef node) {                    \
-    return node->style.instanceName;                                   \
-  }
-
-#define YG_NODE_STYLE_EDGE_PROPERTY_UNIT_AUTO_IMPL(type, name, instanceName) \
-  void YGNodeStyleSet##name##Auto(const YGNodeRef node, const YGEdge edge) { \
-    if (node->style.instanceName[edge].unit != YGUnitAuto) {                 \
-      node->style.instanceName[edge].value = YGUndefined;                    \
-      node->style.instanceName[edge].unit = YGUnitAuto;                      \
-      YGNodeMarkDirtyInternal(node);                                         \
-    }                                                                        \
-  }
-
-#define YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(type, name, paramName,          \
-                                              instanceName)                   \
-  void YGNodeStyleSet##name(const YGNodeRef node, const YGEdge edge,          \
-                            const float paramName) {                          \
-    if (node->style.instanceName[edge].value != paramName ||                  \
-        node->style.instanceName[edge].unit != YGUnitPoint) {                 \
-      node->style.instanceName[edge].value = paramName;                       \
-      node->style.instanceName[edge].unit =                                   \
-          YGFloatIsUndefined(paramName) ? YGUnitUndefined : YGUnitPoint;      \
-      YGNodeMarkDirtyInternal(node);                                          \
-    }                                                                         \
-  }                                                                           \
-                                                                              \
-  void YGNodeStyleSet##name##Percent(const YGNodeRef node, const YGEdge edge, \
-                                     const float paramName) {                 \
-    if (node->style.instanceName[edge].value != paramName ||                  \
-        node->style.instanceName[edge].unit != YGUnitPercent) {               \
-      node->style.instanceName[edge].value = paramName;                       \
-      node->style.instanceName[edge].unit =                                   \
-          YGFloatIsUndefined(paramName) ? YGUnitUndefined : YGUnitPercent;    \
-      YGNodeMarkDirtyInternal(node);                                          \
-    }                                                                         \
-  }                                                                           \
-                                                                              \
-  WIN_STRUCT(type)                                                            \
-  YGNodeStyleGet##name(const YGNodeRef node, const YGEdge edge) {             \
-    return WIN_STRUCT_REF(node->style.instanceName[edge]);                    \
-  }
-
-#define YG_NODE_STYLE_EDGE_PROPERTY_IMPL(type, name, paramName, instanceName) \
-  void YGNodeStyleSet##name(const YGNodeRef node, const YGEdge edge,          \
-                            const float paramName) {                          \
-    if (node->style.instanceName[edge].value != paramName ||                  \
-        node->style.instanceName[edge].unit != YGUnitPoint) {                 \
-      node->style.instanceName[edge].value = paramName;                       \
-      node->style.instanceName[edge].unit =                                   \
-          YGFloatIsUndefined(paramName) ? YGUnitUndefined : YGUnitPoint;      \
-      YGNodeMarkDirtyInternal(node);                                          \
-    }                                                                         \
-  }                                                                           \
-                                                                              \
-  float YGNodeStyleGet##name(const YGNodeRef node, const YGEdge edge) {       \
-    return node->style.instanceName[edge].value;                              \
+    return YGStyleOf(node)->instanceName;                              \
   }
 
-#define YG_NODE_LAYOUT_PROPERTY_IMPL(type, name, instanceName) \
+#define YG_NODE_STYLE_EDGE_PROPERTY_UNIT_AUTO_IMPL(type, name, property)       \
+  void YGNodeStyleSet##name##Auto(const YGNodeRef node, const YGEdge edge) {   \
+    const YGValue current = YGStyleEdgeValue(YGStyleOf(node), property, edge); \
+    if (current.unit != YGUnitAuto) {                                          \
+      YGNodeStyleSetEdgeValue(                                                 \
+          node, property, edge,                                                \
+          (YGValue){.value = YGUndefined, .unit = YGUnitAuto});                \
+      YGNodeMarkDirtyInternal(node);                                           \
+    }                                                                          \
+  }
+
+#define YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(type, name, paramName, property) \
+  void YGNodeStyleSet##name(const YGNodeRef node, const YGEdge edge,           \
+                            const float paramName) {                           \
+    const YGValue current = YGStyleEdgeValue(YGStyleOf(node), property, edge); \
+    if (current.value != paramName || current.unit != YGUnitPoint) {           \
+      YGNodeStyleSetEdgeValue(                                                 \
+          node, property, edge,                                                \
+          (YGValue){.value = paramName,                                        \
+                    .unit = YGFloatIsUndefined(paramName) ? YGUnitUndefined    \
+                                                          : YGUnitPoint});     \
+      YGNodeMarkDirtyInternal(node);                                           \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  void YGNodeStyleSet##name##Percent(const YGNodeRef node, const YGEdge edge,  \
+                                     const float paramName) {                  \
+    const YGValue current = YGStyleEdgeValue(YGStyleOf(node), property, edge); \
+    if (current.value != paramName || current.unit != YGUnitPercent) {         \
+      YGNodeStyleSetEdgeValue(                                                 \
+          node, property, edge,                                                \
+          (YGValue){.value = paramName,                                        \
+                    .unit = YGFloatIsUndefined(paramName) ? YGUnitUndefined    \
+                                                          : YGUnitPercent});   \
+      YGNodeMarkDirtyInternal(node);                                           \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  WIN_STRUCT(type)                                                             \
+  YGNodeStyleGet##name(const YGNodeRef node, const YGEdge edge) {              \
+    const YGValue value = YGStyleEdgeValue(YGStyleOf(node), property, edge);   \
+    return WIN_STRUCT_REF(value);                                              \
+  }
+
+#define YG_NODE_STYLE_EDGE_PROPERTY_IMPL(type, name, paramName, property)      \
+  void YGNodeStyleSet##name(const YGNodeRef node, const YGEdge edge,           \
+                            const float paramName) {                           \
+    const YGValue current = YGStyleEdgeValue(YGStyleOf(node), property, edge); \
+    if (current.value != paramName || current.unit != YGUnitPoint) {           \
+      YGNodeStyleSetEdgeValue(                                                 \
+          node, property, edge,                                                \
+          (YGValue){.value = paramName,                                        \
+                    .unit = YGFloatIsUndefined(paramName) ? YGUnitUndefined    \
+                                                          : YGUnitPoint});     \
+      YGNodeMarkDirtyInternal(node);                                           \
+    }                                                                          \
+  }                                                                            \
+                                                                               \
+  float YGNodeStyleGet##name(const YGNodeRef node, const YGEdge edge) {        \
+    return YGStyleEdgeValue(YGStyleOf(node), property, edge).value;            \
+  }
+
+#define YG_NODE_LAYOUT_PROPERTY_IMPL(type, name, instanceName) \
   type YGNodeLayoutGet##name(const YGNodeRef node) {           \
     return node->layout.instanceName;                          \
   }
 
+#define YG_NODE_LAYOUT_POSITION_PROPERTY_IMPL(name, edge) \
+  float YGNodeLayoutGet##name(const YGNodeRef node) {     \
+    return YGPositionOf(node)[edge];                      \
+  }
+
 #define YG_NODE_LAYOUT_RESOLVED_PROPERTY_IMPL(type, name, instanceName)        \
   type YGNodeLayoutGet##name(const YGNodeRef node, const YGEdge edge) {        \
     YGAssertWithNode(node, edge < YGEdgeEnd,                                   \
                      "Cannot get layout properties of multi-edge shorthands"); \
                                                                                \
+    if (node->layout.edges == NULL) {                                          \
+      return 0;                                                                \
+    }                                                                          \
+                                                                               \
     if (edge == YGEdgeLeft) {                                                  \
       if (node->layout.direction == YGDirectionRTL) {                          \
-        return node->layout.instanceName[YGEdgeEnd];                           \
+        return node->layout.edges->instanceName[YGEdgeEnd];                    \
       } else {                                                                 \
-        return node->layout.instanceName[YGEdgeStart];                         \
+        return node->layout.edges->instanceName[YGEdgeStart];                  \
       }                                                                        \
     }                                                                          \
                                                                                \
     if (edge == YGEdgeRight) {                                                 \
       if (node->layout.direction == YGDirectionRTL) {                          \
-        return node->layout.instanceName[YGEdgeStart];                         \
+        return node->layout.edges->instanceName[YGEdgeStart];                  \
       } else {                                                                 \
-        return node->layout.instanceName[YGEdgeEnd];                           \
+        return node->layout.edges->instanceName[YGEdgeEnd];                    \
       }                                                                        \
     }                                                                          \
                                                                                \
-    return node->layout.instanceName[edge];                                    \
+    return node->layout.edges->instanceName[edge];                             \
   }
 
 YG_NODE_PROPERTY_IMPL(void *, Context, context, context);
 YG_NODE_PROPERTY_IMPL(YGPrintFunc, PrintFunc, printFunc, print);
 YG_NODE_PROPERTY_IMPL(bool, HasNewLayout, hasNewLayout, hasNewLayout);
 YG_NODE_PROPERTY_IMPL(YGNodeType, NodeType, nodeType, nodeType);
+YG_NODE_PROPERTY_IMPL(uint64_t, MeasureFingerprint, measureFingerprint,
+                      measureFingerprint);
 
 YG_NODE_STYLE_PROPERTY_IMPL(YGDirection, Direction, direction, direction);
 YG_NODE_STYLE_PROPERTY_IMPL(YGFlexDirection, FlexDirection, flexDirection,
@@ -873,11 +2076,15 @@ YG_NODE_STYLE_PROPERTY_SETTER_IMPL(float, FlexGrow, flexGrow, flexGrow);
 YG_NODE_STYLE_PROPERTY_SETTER_IMPL(float, FlexShrink, flexShrink, flexShrink);
 YG_NODE_STYLE_PROPERTY_UNIT_AUTO_IMPL(YGValue, FlexBasis, flexBasis, flexBasis);
 
-YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(YGValue, Position, position, position);
-YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(YGValue, Margin, margin, margin);
-YG_NODE_STYLE_EDGE_PROPERTY_UNIT_AUTO_IMPL(YGValue, Margin, margin);
-YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(YGValue, Padding, padding, padding);
-YG_NODE_STYLE_EDGE_PROPERTY_IMPL(float, Border, border, border);
+YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(YGValue, Position, position,
+                                      YGEdgePropertyPosition);
+YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(YGValue, Margin, margin,
+                                      YGEdgePropertyMargin);
+YG_NODE_STYLE_EDGE_PROPERTY_UNIT_AUTO_IMPL(YGValue, Margin,
+                                           YGEdgePropertyMargin);
+YG_NODE_STYLE_EDGE_PROPERTY_UNIT_IMPL(YGValue, Padding, padding,
+                                      YGEdgePropertyPadding);
+YG_NODE_STYLE_EDGE_PROPERTY_IMPL(float, Border, border, YGEdgePropertyBorder);
 
 YG_NODE_STYLE_PROPERTY_UNIT_AUTO_IMPL(YGValue, Width, width,
                                       dimensions[YGDimensionWidth]);
@@ -895,10 +2102,10 @@ YG_NODE_STYLE_PROPERTY_UNIT_IMPL(YGValue, MaxHeight, maxHeight,
 // Yoga specific properties, not compatible with flexbox specification
 YG_NODE_STYLE_PROPERTY_IMPL(float, AspectRatio, aspectRatio, aspectRatio);
 
-YG_NODE_LAYOUT_PROPERTY_IMPL(float, Left, position[YGEdgeLeft]);
-YG_NODE_LAYOUT_PROPERTY_IMPL(float, Top, position[YGEdgeTop]);
-YG_NODE_LAYOUT_PROPERTY_IMPL(float, Right, position[YGEdgeRight]);
-YG_NODE_LAYOUT_PROPERTY_IMPL(float, Bottom, position[YGEdgeBottom]);
+YG_NODE_LAYOUT_POSITION_PROPERTY_IMPL(Left, YGEdgeLeft);
+YG_NODE_LAYOUT_POSITION_PROPERTY_IMPL(Top, YGEdgeTop);
+YG_NODE_LAYOUT_POSITION_PROPERTY_IMPL(Right, YGEdgeRight);
+YG_NODE_LAYOUT_POSITION_PROPERTY_IMPL(Bottom, YGEdgeBottom);
 YG_NODE_LAYOUT_PROPERTY_IMPL(float, Width, dimensions[YGDimensionWidth]);
 YG_NODE_LAYOUT_PROPERTY_IMPL(float, Height, dimensions[YGDimensionHeight]);
 YG_NODE_LAYOUT_PROPERTY_IMPL(YGDirection, Direction, direction);
@@ -908,8 +2115,372 @@ YG_NODE_LAYOUT_RESOLVED_PROPERTY_IMPL(float, Margin, margin);
 YG_NODE_LAYOUT_RESOLVED_PROPERTY_IMPL(float, Border, border);
 YG_NODE_LAYOUT_RESOLVED_PROPERTY_IMPL(float, Padding, padding);
 
+// Generations are handed out to layout passes from a single counter so that
+// a node never sees the same generation from two different passes.
 uint32_t gCurrentGenerationCount = 0;
 
+// State of a single YGNodeCalculateLayout call. Everything a pass mutates
+// lives here or in the nodes it visits, so that independent trees can be laid
+// out concurrently.
+typedef struct YGLayoutContext {
+  uint32_t generation;
+  uint32_t depth;
+  bool printChanges;
+  bool printSkips;
+
+  // Parallel layout. The flex and stretch passes set mayDefer for the child
+  // they are about to lay out; if its subtree is worth it, the child is sized
+  // right away and the layout of its subtree is queued in deferred until the
+  // parent joins.
+  YGThreadPoolRef pool;
+  bool mayDefer;
+  YGNodeRef overflowParent;
+  struct YGDeferredLayout *deferred;
+  uint32_t deferredCount;
+  uint32_t deferredCapacity;
+
+  // Stack of the arrays gathered for the flex lines being resolved. The lines
+  // of a child are pushed above the line of its parent.
+  float *flexScratch;
+  uint32_t flexScratchCount;
+  uint32_t flexScratchCapacity;
+
+  // Nodes to round to the pixel grid, with YG_ROUNDED_EDGE_COUNT edges each.
+  YGNodeRef *roundingNodes;
+  float *roundingEdges;
+  uint32_t roundingCount;
+  uint32_t roundingCapacity;
+
+  // Added to the stats of the config once the pass is done.
+  YGLayoutStats stats;
+
+  // The event handler of the config of the root when the pass started, NULL
+  // when the pass isn't traced.
+  YGEventHandler eventHandler;
+  YGConfigRef eventConfig;
+  void *eventContext;
+
+  // Subtrees laid out by this context in the current pass, when the config
+  // memoizes them. An open addressed table, see YGLayoutContextMemoize.
+  bool memoizeSubtrees;
+  struct YGMemoizedSubtree *memo;
+  uint32_t memoCount;
+  uint32_t memoCapacity;
+
+  // Set for the roots of a batch, which may share a config, so that their
+  // layout changes are recorded once the batch is done.
+  bool deferLayoutChanges;
+
+  // Set for a pass that only measures, which leaves the layout of the tree as
+  // it was. The nodes it visits are saved in savedLayouts on the first visit,
+  // and put back once the pass is done, see YGNodeCalculateSize.
+  bool preserveLayouts;
+  struct YGSavedLayout *savedLayouts;
+  uint32_t savedLayoutCount;
+  uint32_t savedLayoutCapacity;
+
+  // Clones of dirty roots made by the pass, on whatever thread. They are added
+  // to the dirty roots of their config, which is shared, once the pass is
+  // joined, see YGLayoutContextAddDirtyRoots.
+  YGNodeRef *clonedDirtyRoots;
+  uint32_t clonedDirtyRootCount;
+  uint32_t clonedDirtyRootCapacity;
+} YGLayoutContext;
+
+// A subtree layout waiting for its parent to join.
+typedef struct YGDeferredLayout {
+  YGNodeRef node;
+  float availableWidth;
+  float availableHeight;
+  YGDirection parentDirection;
+  float parentWidth;
+  float parentHeight;
+  YGConfigRef config;
+  // Receives the hadOverflow of the node once the subtree is laid out.
+  YGNodeRef overflowParent;
+  uint32_t generation;
+  uint32_t depth;
+  YGThreadPoolRef pool;
+  // Counts of the subtree, added to the context of the parent when it joins.
+  YGLayoutStats stats;
+  YGEventHandler eventHandler;
+  void *eventContext;
+  bool memoizeSubtrees;
+  // Clones of dirty roots made in the subtree, handed to the context of the
+  // parent when it joins.
+  YGNodeRef *clonedDirtyRoots;
+  uint32_t clonedDirtyRootCount;
+} YGDeferredLayout;
+
+// What a pass that only measures changes of the layout of a node, besides its
+// caches.
+typedef struct YGSavedLayout {
+  YGNodeRef node;
+  float measuredDimensions[2];
+  YGDirection direction;
+  bool hadOverflow;
+  YGLayoutEdges edges;
+} YGSavedLayout;
+
+// Subtrees smaller than this are laid out inline; handing them to another
+// thread would cost more than it saves.
+#define YG_PARALLEL_MIN_SUBTREE_SIZE 64
+
+static void YGThreadPoolSpawn(const YGThreadPoolRef pool,
+                              void (*run)(void *arg), void *arg,
+                              int32_t *pending);
+static void YGThreadPoolJoin(const YGThreadPoolRef pool, int32_t *pending);
+static void YGLayoutContextJoin(YGLayoutContext *const layoutContext,
+                                const uint32_t start);
+
+// Lets the next YGLayoutNodeInternal call defer the layout of the subtree.
+// overflowParent, if set, gets the hadOverflow of the child when it is done.
+static inline void YGLayoutContextAllowDeferral(
+    YGLayoutContext *const layoutContext, const YGNodeRef overflowParent) {
+  layoutContext->mayDefer = layoutContext->pool != NULL;
+  layoutContext->overflowParent = overflowParent;
+}
+
+static void YGLayoutContextFreeScratch(YGLayoutContext *const layoutContext) {
+  gYGFree(layoutContext->deferred);
+  gYGFree(layoutContext->flexScratch);
+  gYGFree(layoutContext->roundingNodes);
+  gYGFree(layoutContext->roundingEdges);
+  gYGFree(layoutContext->memo);
+  gYGFree(layoutContext->savedLayouts);
+  gYGFree(layoutContext->clonedDirtyRoots);
+}
+
+static void YGLayoutContextAddClonedDirtyRoot(
+    YGLayoutContext *const layoutContext, const YGNodeRef node) {
+  if (layoutContext->clonedDirtyRootCount ==
+      layoutContext->clonedDirtyRootCapacity) {
+    layoutContext->clonedDirtyRootCapacity =
+        layoutContext->clonedDirtyRootCapacity == 0
+            ? 8
+            : layoutContext->clonedDirtyRootCapacity * 2;
+    layoutContext->clonedDirtyRoots =
+        gYGRealloc(layoutContext->clonedDirtyRoots,
+                   sizeof(YGNodeRef) * layoutContext->clonedDirtyRootCapacity);
+    YGAssert(layoutContext->clonedDirtyRoots != NULL,
+             "Could not allocate memory for cloned dirty roots");
+  }
+  layoutContext->clonedDirtyRoots[layoutContext->clonedDirtyRootCount++] = node;
+}
+
+// Adds the clones of dirty roots made by the pass to the dirty roots of their
+// configs. Only called on the thread that started the pass.
+static void YGLayoutContextAddDirtyRoots(YGLayoutContext *const layoutContext) {
+  for (uint32_t i = 0; i < layoutContext->clonedDirtyRootCount; i++) {
+    const YGNodeRef node = layoutContext->clonedDirtyRoots[i];
+    if (!YGNodeIsDirtyRoot(node)) {
+      YGConfigAddDirtyRoot(node->config, node);
+    }
+  }
+  layoutContext->clonedDirtyRootCount = 0;
+}
+
+static uint64_t YGEventTimestamp(void) {
+#if defined(_WIN32)
+  LARGE_INTEGER counter;
+  LARGE_INTEGER frequency;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&frequency);
+  return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ull +
+         (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ull /
+             (uint64_t)frequency.QuadPart;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static uint32_t gYGEventThreadCount = 0;
+static YG_THREAD_LOCAL uint32_t gYGEventThread = 0;
+
+// Numbers threads in the order they first report an event.
+static uint32_t YGEventThread(void) {
+  if (gYGEventThread == 0) {
+    gYGEventThread = YGAtomicAdd(&gYGEventThreadCount, 1);
+  }
+  return gYGEventThread;
+}
+
+// Stamps an event and passes it to the handler. Callers check that the pass
+// is traced first.
+static void YGLayoutContextEmit(const YGLayoutContext *const layoutContext,
+                                YGEvent event) {
+  event.timestamp = YGEventTimestamp();
+  event.thread = YGEventThread();
+  layoutContext->eventHandler(layoutContext->eventConfig, &event,
+                              layoutContext->eventContext);
+}
+
+static void YGLayoutStatsAdd(YGLayoutStats *const stats,
+                             const YGLayoutStats *const other) {
+  stats->nodesVisited += other->nodesVisited;
+  stats->layoutCalls += other->layoutCalls;
+  stats->measureCalls += other->measureCalls;
+  stats->cachedLayoutHits += other->cachedLayoutHits;
+  stats->cachedLayoutMisses += other->cachedLayoutMisses;
+  stats->cachedMeasurementHits += other->cachedMeasurementHits;
+  stats->cachedMeasurementMisses += other->cachedMeasurementMisses;
+  stats->cachedMeasurementEvictions += other->cachedMeasurementEvictions;
+  stats->measureFuncCalls += other->measureFuncCalls;
+  stats->nodesRounded += other->nodesRounded;
+  stats->memoizedSubtrees += other->memoizedSubtrees;
+  stats->memoizedNodes += other->memoizedNodes;
+  if (other->maxDepth > stats->maxDepth) {
+    stats->maxDepth = other->maxDepth;
+  }
+}
+
+// Adds the counts of a layout to the config, which concurrent layouts may
+// share.
+static void YGConfigAddLayoutStats(const YGConfigRef config,
+                                   const YGLayoutStats *const stats) {
+  YGLayoutStats *const total = &config->stats;
+  YGAtomicAdd64(&total->nodesVisited, stats->nodesVisited);
+  YGAtomicAdd64(&total->layoutCalls, stats->layoutCalls);
+  YGAtomicAdd64(&total->measureCalls, stats->measureCalls);
+  YGAtomicAdd64(&total->cachedLayoutHits, stats->cachedLayoutHits);
+  YGAtomicAdd64(&total->cachedLayoutMisses, stats->cachedLayoutMisses);
+  YGAtomicAdd64(&total->cachedMeasurementHits, stats->cachedMeasurementHits);
+  YGAtomicAdd64(&total->cachedMeasurementMisses,
+                stats->cachedMeasurementMisses);
+  YGAtomicAdd64(&total->cachedMeasurementEvictions,
+                stats->cachedMeasurementEvictions);
+  YGAtomicAdd64(&total->measureFuncCalls, stats->measureFuncCalls);
+  YGAtomicAdd64(&total->nodesRounded, stats->nodesRounded);
+  YGAtomicAdd64(&total->memoizedSubtrees, stats->memoizedSubtrees);
+  YGAtomicAdd64(&total->memoizedNodes, stats->memoizedNodes);
+  uint32_t maxDepth = YGAtomicLoad(&total->maxDepth);
+  while (stats->maxDepth > maxDepth &&
+         !YGAtomicCompareExchange(&total->maxDepth, &maxDepth,
+                                  stats->maxDepth)) {
+  }
+}
+
+// The items of a flex line in struct-of-arrays form, in the order of the
+// nextChild list. Items without a min or max carry -/+infinity so that the
+// clamp never triggers for them.
+typedef struct YGFlexLine {
+  float *basis;
+  float *shrink;
+  float *grow;
+  float *min;
+  float *max;
+  float *paddingAndBorder;
+  // Outputs of YGFlexLineResolve.
+  float *base;
+  float *bound;
+  // Final main sizes of the items.
+  float *size;
+} YGFlexLine;
+
+#define YG_FLEX_LINE_ARRAY_COUNT 9
+
+// Reserves the arrays of a line of `count` items and returns their offset.
+static uint32_t YGLayoutContextPushFlexLine(
+    YGLayoutContext *const layoutContext, const uint32_t count) {
+  const uint32_t offset = layoutContext->flexScratchCount;
+  const uint32_t needed = offset + count * YG_FLEX_LINE_ARRAY_COUNT;
+  if (needed > layoutContext->flexScratchCapacity ||
+      layoutContext->flexScratch == NULL) {
+    uint32_t capacity = layoutContext->flexScratchCapacity == 0
+                            ? 64
+                            : layoutContext->flexScratchCapacity;
+    while (capacity < needed) {
+      capacity *= 2;
+    }
+    layoutContext->flexScratch =
+        gYGRealloc(layoutContext->flexScratch, sizeof(float) * capacity);
+    YGAssert(layoutContext->flexScratch != NULL,
+             "Could not allocate memory for flex lines");
+    layoutContext->flexScratchCapacity = capacity;
+  }
+  layoutContext->flexScratchCount = needed;
+  return offset;
+}
+
+// Pointers into the scratch are only valid until the next push, which may
+// move it, so they are fetched again after laying out a child.
+static inline YGFlexLine YGLayoutContextGetFlexLine(
+    const YGLayoutContext *const layoutContext, const uint32_t offset,
+    const uint32_t count) {
+  float *const arrays = layoutContext->flexScratch + offset;
+  return (YGFlexLine){
+      .basis = arrays,
+      .shrink = arrays + count,
+      .grow = arrays + 2 * count,
+      .min = arrays + 3 * count,
+      .max = arrays + 4 * count,
+      .paddingAndBorder = arrays + 5 * count,
+      .base = arrays + 6 * count,
+      .bound = arrays + 7 * count,
+      .size = arrays + 8 * count,
+  };
+}
+
+// Computes base = basis + scale * factor for every item, and bound, which is
+// base clamped like YGNodeBoundAxis does. The vector versions pick the same
+// operand as the scalar comparisons for NaN and equal inputs, so all of them
+// give the same bits; the multiply-add is not fused, see FP_CONTRACT above.
+static void YGFlexLineResolve(const YGFlexLine *const line,
+                              const float *const factor, const float scale,
+                              const uint32_t count) {
+  uint32_t i = 0;
+#if defined(YG_SIMD_AVX)
+  const __m256 scale8 = _mm256_set1_ps(scale);
+  for (; i + 8 <= count; i += 8) {
+    const __m256 base = _mm256_add_ps(
+        _mm256_loadu_ps(line->basis + i),
+        _mm256_mul_ps(scale8, _mm256_loadu_ps(factor + i)));
+    // minps and maxps return their second operand when either is NaN.
+    __m256 bound = _mm256_min_ps(_mm256_loadu_ps(line->max + i), base);
+    bound = _mm256_max_ps(_mm256_loadu_ps(line->min + i), bound);
+    bound = _mm256_max_ps(bound, _mm256_loadu_ps(line->paddingAndBorder + i));
+    _mm256_storeu_ps(line->base + i, base);
+    _mm256_storeu_ps(line->bound + i, bound);
+  }
+#elif defined(YG_SIMD_SSE)
+  const __m128 scale4 = _mm_set1_ps(scale);
+  for (; i + 4 <= count; i += 4) {
+    const __m128 base =
+        _mm_add_ps(_mm_loadu_ps(line->basis + i),
+                   _mm_mul_ps(scale4, _mm_loadu_ps(factor + i)));
+    // minps and maxps return their second operand when either is NaN.
+    __m128 bound = _mm_min_ps(_mm_loadu_ps(line->max + i), base);
+    bound = _mm_max_ps(_mm_loadu_ps(line->min + i), bound);
+    bound = _mm_max_ps(bound, _mm_loadu_ps(line->paddingAndBorder + i));
+    _mm_storeu_ps(line->base + i, base);
+    _mm_storeu_ps(line->bound + i, bound);
+  }
+#elif defined(YG_SIMD_NEON)
+  const float32x4_t scale4 = vdupq_n_f32(scale);
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t base = vaddq_f32(
+        vld1q_f32(line->basis + i), vmulq_f32(scale4, vld1q_f32(factor + i)));
+    const float32x4_t max = vld1q_f32(line->max + i);
+    const float32x4_t min = vld1q_f32(line->min + i);
+    float32x4_t bound = vbslq_f32(vcgtq_f32(base, max), max, base);
+    bound = vbslq_f32(vcltq_f32(bound, min), min, bound);
+    // fmaxnm, like fmaxf.
+    bound = vmaxnmq_f32(bound, vld1q_f32(line->paddingAndBorder + i));
+    vst1q_f32(line->base + i, base);
+    vst1q_f32(line->bound + i, bound);
+  }
+#endif
+  for (; i < count; i++) {
+    const float base = line->basis[i] + scale * factor[i];
+    float bound = base > line->max[i] ? line->max[i] : base;
+    bound = bound < line->min[i] ? line->min[i] : bound;
+    line->base[i] = base;
+    line->bound[i] = fmaxf(bound, line->paddingAndBorder[i]);
+  }
+}
+
 bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
                           const float availableHeight,
                           const YGDirection parentDirection,
@@ -917,7 +2488,8 @@ bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
                           const YGMeasureMode heightMeasureMode,
                           const float parentWidth, const float parentHeight,
                           const bool performLayout, const char *reason,
-                          const YGConfigRef config);
+                          const YGConfigRef config,
+                          YGLayoutContext *const layoutContext);
 
 inline bool YGFloatIsUndefined(const float value) { return isnan(value); }
 
@@ -933,18 +2505,36 @@ static inline bool YGValueEqual(const YGValue a, const YGValue b) {
   return fabs(a.value - b.value) < 0.0001f;
 }
 
+// What the dimensions of a node resolve to. They are undefined until the node
+// is first laid out.
+#define YG_RESOLVED_UNDEFINED 0
+#define YG_RESOLVED_DIMENSION 1
+#define YG_RESOLVED_MAX_DIMENSION 2
+
 static inline void YGResolveDimensions(YGNodeRef node) {
+  const YGStyle *const style = YGStyleOf(node);
   for (YGDimension dim = YGDimensionWidth; dim <= YGDimensionHeight; dim++) {
-    if (node->style.maxDimensions[dim].unit != YGUnitUndefined &&
-        YGValueEqual(node->style.maxDimensions[dim],
-                     node->style.minDimensions[dim])) {
-      node->resolvedDimensions[dim] = &node->style.maxDimensions[dim];
+    if (style->maxDimensions[dim].unit != YGUnitUndefined &&
+        YGValueEqual(style->maxDimensions[dim], style->minDimensions[dim])) {
+      node->resolvedDimensions[dim] = YG_RESOLVED_MAX_DIMENSION;
     } else {
-      node->resolvedDimensions[dim] = &node->style.dimensions[dim];
+      node->resolvedDimensions[dim] = YG_RESOLVED_DIMENSION;
     }
   }
 }
 
+static inline const YGValue *YGResolvedDimensionOf(const YGNode *const node,
+                                                   const YGDimension dim) {
+  switch (node->resolvedDimensions[dim]) {
+    case YG_RESOLVED_DIMENSION:
+      return &YGStyleOf(node)->dimensions[dim];
+    case YG_RESOLVED_MAX_DIMENSION:
+      return &YGStyleOf(node)->maxDimensions[dim];
+    default:
+      return &YGValueUndefined;
+  }
+}
+
 static inline bool YGFloatsEqual(const float a, const float b) {
   if (YGFloatIsUndefined(a)) {
     return YGFloatIsUndefined(b);
@@ -1018,9 +2608,12 @@ static void YGPrintNumberIfNotAuto(YGStringStream *stream, const char *str,
 }
 
 static void YGPrintEdgeIfNotUndefined(YGStringStream *stream, const char *str,
-                                      const YGValue *edges, const YGEdge edge) {
-  YGPrintNumberIfNotUndefined(
-      stream, str, YGComputedEdgeValue(edges, edge, &YGValueUndefined));
+                                      const YGStyle *style,
+                                      const YGEdgeProperty property,
+                                      const YGEdge edge) {
+  const YGValue value =
+      YGComputedEdgeValue(style, property, edge, YGValueUndefined);
+  YGPrintNumberIfNotUndefined(stream, str, &value);
 }
 
 static void YGPrintNumberIfNotZero(YGStringStream *stream, const char *str,
@@ -1036,7 +2629,12 @@ static bool YGFourValuesEqual(const YGValue four[4]) {
 }
 
 static void YGPrintEdges(YGStringStream *stream, const char *str,
-                         const YGValue *edges) {
+                         const YGStyle *style, const YGEdgeProperty property) {
+  YGValue edges[YGEdgeCount];
+  for (YGEdge edge = YGEdgeLeft; edge < YGEdgeCount; edge++) {
+    edges[edge] = YGStyleEdgeValue(style, property, edge);
+  }
+
   if (YGFourValuesEqual(edges)) {
     YGPrintNumberIfNotZero(stream, str, &edges[YGEdgeLeft]);
   } else {
@@ -1064,83 +2662,86 @@ static void YGNodeToString(YGStringStream *stream, const YGNodeRef node,
     YGWriteToStringStream(stream, "height: %g; ",
                           node->layout.dimensions[YGDimensionHeight]);
     YGWriteToStringStream(stream, "top: %g; ",
-                          node->layout.position[YGEdgeTop]);
+                          YGPositionOf(node)[YGEdgeTop]);
     YGWriteToStringStream(stream, "left: %g;",
-                          node->layout.position[YGEdgeLeft]);
+                          YGPositionOf(node)[YGEdgeLeft]);
     YGWriteToStringStream(stream, "\" ");
   }
 
   if (options & YGPrintOptionsStyle) {
+    const YGStyle *const style = YGStyleOf(node);
     YGWriteToStringStream(stream, "style=\"");
-    if (node->style.flexDirection != gYGNodeDefaults.style.flexDirection) {
+    if (style->flexDirection != gYGNodeDefaults.style.flexDirection) {
       YGWriteToStringStream(stream, "flex-direction: %s; ",
-                            YGFlexDirectionToString(node->style.flexDirection));
+                            YGFlexDirectionToString(style->flexDirection));
     }
-    if (node->style.justifyContent != gYGNodeDefaults.style.justifyContent) {
+    if (style->justifyContent != gYGNodeDefaults.style.justifyContent) {
       YGWriteToStringStream(stream, "justify-content: %s; ",
-                            YGJustifyToString(node->style.justifyContent));
+                            YGJustifyToString(style->justifyContent));
     }
-    if (node->style.alignItems != gYGNodeDefaults.style.alignItems) {
+    if (style->alignItems != gYGNodeDefaults.style.alignItems) {
       YGWriteToStringStream(stream, "align-items: %s; ",
-                            YGAlignToString(node->style.alignItems));
+                            YGAlignToString(style->alignItems));
     }
-    if (node->style.alignContent != gYGNodeDefaults.style.alignContent) {
+    if (style->alignContent != gYGNodeDefaults.style.alignContent) {
       YGWriteToStringStream(stream, "align-content: %s; ",
-                            YGAlignToString(node->style.alignContent));
+                            YGAlignToString(style->alignContent));
     }
-    if (node->style.alignSelf != gYGNodeDefaults.style.alignSelf) {
+    if (style->alignSelf != gYGNodeDefaults.style.alignSelf) {
       YGWriteToStringStream(stream, "align-self: %s; ",
-                            YGAlignToString(node->style.alignSelf));
+                            YGAlignToString(style->alignSelf));
     }
 
-    YGPrintNumberIfNotUndefinedf(stream, "flex-grow", node->style.flexGrow);
-    YGPrintNumberIfNotUndefinedf(stream, "flex-shrink", node->style.flexShrink);
-    YGPrintNumberIfNotAuto(stream, "flex-basis", &node->style.flexBasis);
-    YGPrintNumberIfNotUndefinedf(stream, "flex", node->style.flex);
+    YGPrintNumberIfNotUndefinedf(stream, "flex-grow", style->flexGrow);
+    YGPrintNumberIfNotUndefinedf(stream, "flex-shrink", style->flexShrink);
+    YGPrintNumberIfNotAuto(stream, "flex-basis", &style->flexBasis);
+    YGPrintNumberIfNotUndefinedf(stream, "flex", style->flex);
 
-    if (node->style.flexWrap != gYGNodeDefaults.style.flexWrap) {
+    if (style->flexWrap != gYGNodeDefaults.style.flexWrap) {
       YGWriteToStringStream(stream, "flexWrap: %s; ",
-                            YGWrapToString(node->style.flexWrap));
+                            YGWrapToString(style->flexWrap));
     }
 
-    if (node->style.overflow != gYGNodeDefaults.style.overflow) {
+    if (style->overflow != gYGNodeDefaults.style.overflow) {
       YGWriteToStringStream(stream, "overflow: %s; ",
-                            YGOverflowToString(node->style.overflow));
+                            YGOverflowToString(style->overflow));
     }
 
-    if (node->style.display != gYGNodeDefaults.style.display) {
+    if (style->display != gYGNodeDefaults.style.display) {
       YGWriteToStringStream(stream, "display: %s; ",
-                            YGDisplayToString(node->style.display));
+                            YGDisplayToString(style->display));
     }
 
-    YGPrintEdges(stream, "margin", node->style.margin);
-    YGPrintEdges(stream, "padding", node->style.padding);
-    YGPrintEdges(stream, "border", node->style.border);
+    YGPrintEdges(stream, "margin", style, YGEdgePropertyMargin);
+    YGPrintEdges(stream, "padding", style, YGEdgePropertyPadding);
+    YGPrintEdges(stream, "border", style, YGEdgePropertyBorder);
 
     YGPrintNumberIfNotAuto(stream, "width",
-                           &node->style.dimensions[YGDimensionWidth]);
+                           &style->dimensions[YGDimensionWidth]);
     YGPrintNumberIfNotAuto(stream, "height",
-                           &node->style.dimensions[YGDimensionHeight]);
+                           &style->dimensions[YGDimensionHeight]);
     YGPrintNumberIfNotAuto(stream, "max-width",
-                           &node->style.maxDimensions[YGDimensionWidth]);
+                           &style->maxDimensions[YGDimensionWidth]);
     YGPrintNumberIfNotAuto(stream, "max-height",
-                           &node->style.maxDimensions[YGDimensionHeight]);
+                           &style->maxDimensions[YGDimensionHeight]);
     YGPrintNumberIfNotAuto(stream, "min-width",
-                           &node->style.minDimensions[YGDimensionWidth]);
+                           &style->minDimensions[YGDimensionWidth]);
     YGPrintNumberIfNotAuto(stream, "min-height",
-                           &node->style.minDimensions[YGDimensionHeight]);
+                           &style->minDimensions[YGDimensionHeight]);
 
-    if (node->style.positionType != gYGNodeDefaults.style.positionType) {
+    if (style->positionType != gYGNodeDefaults.style.positionType) {
       YGWriteToStringStream(stream, "position: %s; ",
-                            YGPositionTypeToString(node->style.positionType));
+                            YGPositionTypeToString(style->positionType));
     }
 
-    YGPrintEdgeIfNotUndefined(stream, "left", node->style.position, YGEdgeLeft);
-    YGPrintEdgeIfNotUndefined(stream, "right", node->style.position,
-                              YGEdgeRight);
-    YGPrintEdgeIfNotUndefined(stream, "top", node->style.position, YGEdgeTop);
-    YGPrintEdgeIfNotUndefined(stream, "bottom", node->style.position,
-                              YGEdgeBottom);
+    YGPrintEdgeIfNotUndefined(stream, "left", style,
+                              YGEdgePropertyPosition, YGEdgeLeft);
+    YGPrintEdgeIfNotUndefined(stream, "right", style,
+                              YGEdgePropertyPosition, YGEdgeRight);
+    YGPrintEdgeIfNotUndefined(stream, "top", style,
+                              YGEdgePropertyPosition, YGEdgeTop);
+    YGPrintEdgeIfNotUndefined(stream, "bottom", style,
+                              YGEdgePropertyPosition, YGEdgeBottom);
     YGWriteToStringStream(stream, "\" ");
 
     if (node->measure != NULL) {
@@ -1149,11 +2750,13 @@ static void YGNodeToString(YGStringStream *stream, const YGNodeRef node,
   }
   YGWriteToStringStream(stream, ">");
 
-  const uint32_t childCount = YGNodeListCount(node->children);
-  if (options & YGPrintOptionsChildren && childCount > 0) {
-    for (uint32_t i = 0; i < childCount; i++) {
+  if (options & YGPrintOptionsChildren && YGChildCountOf(node) > 0) {
+    const uint32_t childEnd = YGChildCursorEnd(node);
+    for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+         cursor = YGChildCursorNext(node, cursor)) {
       YGWriteToStringStream(stream, "\n");
-      YGNodeToString(stream, YGNodeGetChild(node, i), options, level + 1);
+      YGNodeToString(stream, YGChildAtCursor(node, cursor), options,
+                     level + 1);
     }
     YGWriteToStringStream(stream, "\n");
     YGIndent(stream, level);
@@ -1217,85 +2820,107 @@ static inline bool YGFlexDirectionIsColumn(
 static inline float YGNodeLeadingMargin(const YGNodeRef node,
                                         const YGFlexDirection axis,
                                         const float widthSize) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.margin[YGEdgeStart].unit != YGUnitUndefined) {
-    return YGResolveValueMargin(&node->style.margin[YGEdgeStart], widthSize);
+      YGStyleEdgeIsSet(style, YGEdgePropertyMargin, YGEdgeStart)) {
+    const YGValue start =
+        YGStyleSetEdgeValue(style, YGEdgePropertyMargin, YGEdgeStart);
+    return YGResolveValueMargin(&start, widthSize);
   }
 
-  return YGResolveValueMargin(
-      YGComputedEdgeValue(node->style.margin, leading[axis], &YGValueZero),
-      widthSize);
+  const YGValue margin = YGComputedEdgeValue(style, YGEdgePropertyMargin,
+                                             leading[axis], YGValueZero);
+  return YGResolveValueMargin(&margin, widthSize);
 }
 
 static float YGNodeTrailingMargin(const YGNodeRef node,
                                   const YGFlexDirection axis,
                                   const float widthSize) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.margin[YGEdgeEnd].unit != YGUnitUndefined) {
-    return YGResolveValueMargin(&node->style.margin[YGEdgeEnd], widthSize);
+      YGStyleEdgeIsSet(style, YGEdgePropertyMargin, YGEdgeEnd)) {
+    const YGValue end =
+        YGStyleSetEdgeValue(style, YGEdgePropertyMargin, YGEdgeEnd);
+    return YGResolveValueMargin(&end, widthSize);
   }
 
-  return YGResolveValueMargin(
-      YGComputedEdgeValue(node->style.margin, trailing[axis], &YGValueZero),
-      widthSize);
+  const YGValue margin = YGComputedEdgeValue(style, YGEdgePropertyMargin,
+                                             trailing[axis], YGValueZero);
+  return YGResolveValueMargin(&margin, widthSize);
 }
 
 static float YGNodeLeadingPadding(const YGNodeRef node,
                                   const YGFlexDirection axis,
                                   const float widthSize) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.padding[YGEdgeStart].unit != YGUnitUndefined &&
-      YGResolveValue(&node->style.padding[YGEdgeStart], widthSize) >= 0.0f) {
-    return YGResolveValue(&node->style.padding[YGEdgeStart], widthSize);
+      YGStyleEdgeIsSet(style, YGEdgePropertyPadding, YGEdgeStart)) {
+    const YGValue start =
+        YGStyleSetEdgeValue(style, YGEdgePropertyPadding, YGEdgeStart);
+    const float resolvedStart = YGResolveValue(&start, widthSize);
+    if (resolvedStart >= 0.0f) {
+      return resolvedStart;
+    }
   }
 
-  return fmaxf(YGResolveValue(YGComputedEdgeValue(node->style.padding,
-                                                  leading[axis], &YGValueZero),
-                              widthSize),
-               0.0f);
+  const YGValue padding = YGComputedEdgeValue(style, YGEdgePropertyPadding,
+                                              leading[axis], YGValueZero);
+  return fmaxf(YGResolveValue(&padding, widthSize), 0.0f);
 }
 
 static float YGNodeTrailingPadding(const YGNodeRef node,
                                    const YGFlexDirection axis,
                                    const float widthSize) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.padding[YGEdgeEnd].unit != YGUnitUndefined &&
-      YGResolveValue(&node->style.padding[YGEdgeEnd], widthSize) >= 0.0f) {
-    return YGResolveValue(&node->style.padding[YGEdgeEnd], widthSize);
+      YGStyleEdgeIsSet(style, YGEdgePropertyPadding, YGEdgeEnd)) {
+    const YGValue end =
+        YGStyleSetEdgeValue(style, YGEdgePropertyPadding, YGEdgeEnd);
+    const float resolvedEnd = YGResolveValue(&end, widthSize);
+    if (resolvedEnd >= 0.0f) {
+      return resolvedEnd;
+    }
   }
 
-  return fmaxf(YGResolveValue(YGComputedEdgeValue(node->style.padding,
-                                                  trailing[axis], &YGValueZero),
-                              widthSize),
-               0.0f);
+  const YGValue padding = YGComputedEdgeValue(style, YGEdgePropertyPadding,
+                                              trailing[axis], YGValueZero);
+  return fmaxf(YGResolveValue(&padding, widthSize), 0.0f);
 }
 
 static float YGNodeLeadingBorder(const YGNodeRef node,
                                  const YGFlexDirection axis) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.border[YGEdgeStart].unit != YGUnitUndefined &&
-      node->style.border[YGEdgeStart].value >= 0.0f) {
-    return node->style.border[YGEdgeStart].value;
+      YGStyleEdgeIsSet(style, YGEdgePropertyBorder, YGEdgeStart)) {
+    const float start =
+        YGStyleSetEdgeValue(style, YGEdgePropertyBorder, YGEdgeStart).value;
+    if (start >= 0.0f) {
+      return start;
+    }
   }
 
-  return fmaxf(
-      YGComputedEdgeValue(node->style.border, leading[axis], &YGValueZero)
-          ->value,
-      0.0f);
+  return fmaxf(YGComputedEdgeValue(style, YGEdgePropertyBorder, leading[axis],
+                                   YGValueZero)
+                   .value,
+               0.0f);
 }
 
 static float YGNodeTrailingBorder(const YGNodeRef node,
                                   const YGFlexDirection axis) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.border[YGEdgeEnd].unit != YGUnitUndefined &&
-      node->style.border[YGEdgeEnd].value >= 0.0f) {
-    return node->style.border[YGEdgeEnd].value;
+      YGStyleEdgeIsSet(style, YGEdgePropertyBorder, YGEdgeEnd)) {
+    const float end =
+        YGStyleSetEdgeValue(style, YGEdgePropertyBorder, YGEdgeEnd).value;
+    if (end >= 0.0f) {
+      return end;
+    }
   }
 
-  return fmaxf(
-      YGComputedEdgeValue(node->style.border, trailing[axis], &YGValueZero)
-          ->value,
-      0.0f);
+  return fmaxf(YGComputedEdgeValue(style, YGEdgePropertyBorder,
+                                   trailing[axis], YGValueZero)
+                   .value,
+               0.0f);
 }
 
 static inline float YGNodeLeadingPaddingAndBorder(const YGNodeRef node,
@@ -1328,11 +2953,11 @@ static inline float YGNodePaddingAndBorderForAxis(const YGNodeRef node,
 
 static inline YGAlign YGNodeAlignItem(const YGNodeRef node,
                                       const YGNodeRef child) {
-  const YGAlign align = child->style.alignSelf == YGAlignAuto
-                            ? node->style.alignItems
-                            : child->style.alignSelf;
+  const YGAlign align = YGStyleOf(child)->alignSelf == YGAlignAuto
+                            ? YGStyleOf(node)->alignItems
+                            : YGStyleOf(child)->alignSelf;
   if (align == YGAlignBaseline &&
-      YGFlexDirectionIsColumn(node->style.flexDirection)) {
+      YGFlexDirectionIsColumn(YGStyleOf(node)->flexDirection)) {
     return YGAlignFlexStart;
   }
   return align;
@@ -1340,32 +2965,54 @@ static inline YGAlign YGNodeAlignItem(const YGNodeRef node,
 
 static inline YGDirection YGNodeResolveDirection(
     const YGNodeRef node, const YGDirection parentDirection) {
-  if (node->style.direction == YGDirectionInherit) {
+  if (YGStyleOf(node)->direction == YGDirectionInherit) {
     return parentDirection > YGDirectionInherit ? parentDirection
                                                 : YGDirectionLTR;
   } else {
-    return node->style.direction;
+    return YGStyleOf(node)->direction;
   }
 }
 
-static float YGBaseline(const YGNodeRef node) {
+static float YGBaseline(const YGNodeRef node,
+                        const YGLayoutContext *const layoutContext) {
+  if (node->layout.relayout != NULL) {
+    node->layout.relayout->baselineQueried = true;
+  }
   if (node->baseline != NULL) {
+    if (layoutContext->eventHandler != NULL) {
+      YGLayoutContextEmit(layoutContext,
+                          (YGEvent){
+                              .type = YGEventTypeBaselineBegin,
+                              .node = node,
+                              .depth = layoutContext->depth,
+                          });
+    }
     const float baseline =
-        node->baseline(node, node->layout.measuredDimensions[YGDimensionWidth],
-                       node->layout.measuredDimensions[YGDimensionHeight]);
+        node->baseline(node, YGMeasuredDimensionsOf(node)[YGDimensionWidth],
+                       YGMeasuredDimensionsOf(node)[YGDimensionHeight]);
+    if (layoutContext->eventHandler != NULL) {
+      YGLayoutContextEmit(layoutContext,
+                          (YGEvent){
+                              .type = YGEventTypeBaselineEnd,
+                              .node = node,
+                              .depth = layoutContext->depth,
+                              .baseline = baseline,
+                          });
+    }
     YGAssertWithNode(node, !YGFloatIsUndefined(baseline),
                      "Expect custom baseline function to not return NaN");
     return baseline;
   }
 
   YGNodeRef baselineChild = NULL;
-  const uint32_t childCount = YGNodeGetChildCount(node);
-  for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef child = YGNodeGetChild(node, i);
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
     if (child->lineIndex > 0) {
       break;
     }
-    if (child->style.positionType == YGPositionTypeAbsolute) {
+    if (YGStyleOf(child)->positionType == YGPositionTypeAbsolute) {
       continue;
     }
     if (YGNodeAlignItem(node, child) == YGAlignBaseline) {
@@ -1379,11 +3026,11 @@ static float YGBaseline(const YGNodeRef node) {
   }
 
   if (baselineChild == NULL) {
-    return node->layout.measuredDimensions[YGDimensionHeight];
+    return YGMeasuredDimensionsOf(node)[YGDimensionHeight];
   }
 
-  const float baseline = YGBaseline(baselineChild);
-  return baseline + baselineChild->layout.position[YGEdgeTop];
+  const float baseline = YGBaseline(baselineChild, layoutContext);
+  return baseline + YGPositionOf(baselineChild)[YGEdgeTop];
 }
 
 static inline YGFlexDirection YGResolveFlexDirection(
@@ -1407,22 +3054,23 @@ static YGFlexDirection YGFlexDirectionCross(const YGFlexDirection flexDirection,
 }
 
 static inline bool YGNodeIsFlex(const YGNodeRef node) {
-  return (node->style.positionType == YGPositionTypeRelative &&
+  return (YGStyleOf(node)->positionType == YGPositionTypeRelative &&
           (YGResolveFlexGrow(node) != 0 || YGNodeResolveFlexShrink(node) != 0));
 }
 
 static bool YGIsBaselineLayout(const YGNodeRef node) {
-  if (YGFlexDirectionIsColumn(node->style.flexDirection)) {
+  if (YGFlexDirectionIsColumn(YGStyleOf(node)->flexDirection)) {
     return false;
   }
-  if (node->style.alignItems == YGAlignBaseline) {
+  if (YGStyleOf(node)->alignItems == YGAlignBaseline) {
     return true;
   }
-  const uint32_t childCount = YGNodeGetChildCount(node);
-  for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef child = YGNodeGetChild(node, i);
-    if (child->style.positionType == YGPositionTypeRelative &&
-        child->style.alignSelf == YGAlignBaseline) {
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (YGStyleOf(child)->positionType == YGPositionTypeRelative &&
+        YGStyleOf(child)->alignSelf == YGAlignBaseline) {
       return true;
     }
   }
@@ -1433,7 +3081,7 @@ static bool YGIsBaselineLayout(const YGNodeRef node) {
 static inline float YGNodeDimWithMargin(const YGNodeRef node,
                                         const YGFlexDirection axis,
                                         const float widthSize) {
-  return node->layout.measuredDimensions[dim[axis]] +
+  return YGMeasuredDimensionsOf(node)[dim[axis]] +
          YGNodeLeadingMargin(node, axis, widthSize) +
          YGNodeTrailingMargin(node, axis, widthSize);
 }
@@ -1441,98 +3089,94 @@ static inline float YGNodeDimWithMargin(const YGNodeRef node,
 static inline bool YGNodeIsStyleDimDefined(const YGNodeRef node,
                                            const YGFlexDirection axis,
                                            const float parentSize) {
-  return !(node->resolvedDimensions[dim[axis]]->unit == YGUnitAuto ||
-           node->resolvedDimensions[dim[axis]]->unit == YGUnitUndefined ||
-           (node->resolvedDimensions[dim[axis]]->unit == YGUnitPoint &&
-            node->resolvedDimensions[dim[axis]]->value < 0.0f) ||
-           (node->resolvedDimensions[dim[axis]]->unit == YGUnitPercent &&
-            (node->resolvedDimensions[dim[axis]]->value < 0.0f ||
-             YGFloatIsUndefined(parentSize))));
+  const YGValue *const resolved = YGResolvedDimensionOf(node, dim[axis]);
+  return !(resolved->unit == YGUnitAuto || resolved->unit == YGUnitUndefined ||
+           (resolved->unit == YGUnitPoint && resolved->value < 0.0f) ||
+           (resolved->unit == YGUnitPercent &&
+            (resolved->value < 0.0f || YGFloatIsUndefined(parentSize))));
 }
 
 static inline bool YGNodeIsLayoutDimDefined(const YGNodeRef node,
                                             const YGFlexDirection axis) {
-  const float value = node->layout.measuredDimensions[dim[axis]];
+  const float value = YGMeasuredDimensionsOf(node)[dim[axis]];
   return !YGFloatIsUndefined(value) && value >= 0.0f;
 }
 
 static inline bool YGNodeIsLeadingPosDefined(const YGNodeRef node,
                                              const YGFlexDirection axis) {
   return (YGFlexDirectionIsRow(axis) &&
-          YGComputedEdgeValue(node->style.position, YGEdgeStart,
-                              &YGValueUndefined)
-                  ->unit != YGUnitUndefined) ||
-         YGComputedEdgeValue(node->style.position, leading[axis],
-                             &YGValueUndefined)
-                 ->unit != YGUnitUndefined;
+          YGComputedEdgeValue(YGStyleOf(node), YGEdgePropertyPosition,
+                              YGEdgeStart, YGValueUndefined)
+                  .unit != YGUnitUndefined) ||
+         YGComputedEdgeValue(YGStyleOf(node), YGEdgePropertyPosition,
+                             leading[axis], YGValueUndefined)
+                 .unit != YGUnitUndefined;
 }
 
 static inline bool YGNodeIsTrailingPosDefined(const YGNodeRef node,
                                               const YGFlexDirection axis) {
   return (YGFlexDirectionIsRow(axis) &&
-          YGComputedEdgeValue(node->style.position, YGEdgeEnd,
-                              &YGValueUndefined)
-                  ->unit != YGUnitUndefined) ||
-         YGComputedEdgeValue(node->style.position, trailing[axis],
-                             &YGValueUndefined)
-                 ->unit != YGUnitUndefined;
+          YGComputedEdgeValue(YGStyleOf(node), YGEdgePropertyPosition,
+                              YGEdgeEnd, YGValueUndefined)
+                  .unit != YGUnitUndefined) ||
+         YGComputedEdgeValue(YGStyleOf(node), YGEdgePropertyPosition,
+                             trailing[axis], YGValueUndefined)
+                 .unit != YGUnitUndefined;
 }
 
 static float YGNodeLeadingPosition(const YGNodeRef node,
                                    const YGFlexDirection axis,
                                    const float axisSize) {
   if (YGFlexDirectionIsRow(axis)) {
-    const YGValue *leadingPosition = YGComputedEdgeValue(
-        node->style.position, YGEdgeStart, &YGValueUndefined);
-    if (leadingPosition->unit != YGUnitUndefined) {
-      return YGResolveValue(leadingPosition, axisSize);
+    const YGValue leadingPosition = YGComputedEdgeValue(
+        YGStyleOf(node), YGEdgePropertyPosition, YGEdgeStart, YGValueUndefined);
+    if (leadingPosition.unit != YGUnitUndefined) {
+      return YGResolveValue(&leadingPosition, axisSize);
     }
   }
 
-  const YGValue *leadingPosition = YGComputedEdgeValue(
-      node->style.position, leading[axis], &YGValueUndefined);
+  const YGValue leadingPosition = YGComputedEdgeValue(
+      YGStyleOf(node), YGEdgePropertyPosition, leading[axis], YGValueUndefined);
 
-  return leadingPosition->unit == YGUnitUndefined
+  return leadingPosition.unit == YGUnitUndefined
              ? 0.0f
-             : YGResolveValue(leadingPosition, axisSize);
+             : YGResolveValue(&leadingPosition, axisSize);
 }
 
 static float YGNodeTrailingPosition(const YGNodeRef node,
                                     const YGFlexDirection axis,
                                     const float axisSize) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis)) {
-    const YGValue *trailingPosition =
-        YGComputedEdgeValue(node->style.position, YGEdgeEnd, &YGValueUndefined);
-    if (trailingPosition->unit != YGUnitUndefined) {
-      return YGResolveValue(trailingPosition, axisSize);
+    const YGValue trailingPosition = YGComputedEdgeValue(
+        style, YGEdgePropertyPosition, YGEdgeEnd, YGValueUndefined);
+    if (trailingPosition.unit != YGUnitUndefined) {
+      return YGResolveValue(&trailingPosition, axisSize);
     }
   }
 
-  const YGValue *trailingPosition = YGComputedEdgeValue(
-      node->style.position, trailing[axis], &YGValueUndefined);
+  const YGValue trailingPosition = YGComputedEdgeValue(
+      style, YGEdgePropertyPosition, trailing[axis], YGValueUndefined);
 
-  return trailingPosition->unit == YGUnitUndefined
+  return trailingPosition.unit == YGUnitUndefined
              ? 0.0f
-             : YGResolveValue(trailingPosition, axisSize);
+             : YGResolveValue(&trailingPosition, axisSize);
 }
 
 static float YGNodeBoundAxisWithinMinAndMax(const YGNodeRef node,
                                             const YGFlexDirection axis,
                                             const float value,
                                             const float axisSize) {
+  const YGStyle *const style = YGStyleOf(node);
   float min = YGUndefined;
   float max = YGUndefined;
 
   if (YGFlexDirectionIsColumn(axis)) {
-    min =
-        YGResolveValue(&node->style.minDimensions[YGDimensionHeight], axisSize);
-    max =
-        YGResolveValue(&node->style.maxDimensions[YGDimensionHeight], axisSize);
+    min = YGResolveValue(&style->minDimensions[YGDimensionHeight], axisSize);
+    max = YGResolveValue(&style->maxDimensions[YGDimensionHeight], axisSize);
   } else if (YGFlexDirectionIsRow(axis)) {
-    min =
-        YGResolveValue(&node->style.minDimensions[YGDimensionWidth], axisSize);
-    max =
-        YGResolveValue(&node->style.maxDimensions[YGDimensionWidth], axisSize);
+    min = YGResolveValue(&style->minDimensions[YGDimensionWidth], axisSize);
+    max = YGResolveValue(&style->maxDimensions[YGDimensionWidth], axisSize);
   }
 
   float boundValue = value;
@@ -1548,23 +3192,25 @@ static float YGNodeBoundAxisWithinMinAndMax(const YGNodeRef node,
   return boundValue;
 }
 
-static inline YGValue *YGMarginLeadingValue(const YGNodeRef node,
-                                            const YGFlexDirection axis) {
+static inline YGUnit YGMarginLeadingUnit(const YGNodeRef node,
+                                         const YGFlexDirection axis) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.margin[YGEdgeStart].unit != YGUnitUndefined) {
-    return &node->style.margin[YGEdgeStart];
+      YGStyleEdgeIsSet(style, YGEdgePropertyMargin, YGEdgeStart)) {
+    return YGStyleEdgeValue(style, YGEdgePropertyMargin, YGEdgeStart).unit;
   } else {
-    return &node->style.margin[leading[axis]];
+    return YGStyleEdgeValue(style, YGEdgePropertyMargin, leading[axis]).unit;
   }
 }
 
-static inline YGValue *YGMarginTrailingValue(const YGNodeRef node,
-                                             const YGFlexDirection axis) {
+static inline YGUnit YGMarginTrailingUnit(const YGNodeRef node,
+                                          const YGFlexDirection axis) {
+  const YGStyle *const style = YGStyleOf(node);
   if (YGFlexDirectionIsRow(axis) &&
-      node->style.margin[YGEdgeEnd].unit != YGUnitUndefined) {
-    return &node->style.margin[YGEdgeEnd];
+      YGStyleEdgeIsSet(style, YGEdgePropertyMargin, YGEdgeEnd)) {
+    return YGStyleEdgeValue(style, YGEdgePropertyMargin, YGEdgeEnd).unit;
   } else {
-    return &node->style.margin[trailing[axis]];
+    return YGStyleEdgeValue(style, YGEdgePropertyMargin, trailing[axis]).unit;
   }
 }
 
@@ -1581,10 +3227,10 @@ static inline float YGNodeBoundAxis(const YGNodeRef node,
 static void YGNodeSetChildTrailingPosition(const YGNodeRef node,
                                            const YGNodeRef child,
                                            const YGFlexDirection axis) {
-  const float size = child->layout.measuredDimensions[dim[axis]];
-  child->layout.position[trailing[axis]] =
-      node->layout.measuredDimensions[dim[axis]] - size -
-      child->layout.position[pos[axis]];
+  const float size = YGMeasuredDimensionsOf(child)[dim[axis]];
+  YGPositionOf(child)[trailing[axis]] =
+      YGMeasuredDimensionsOf(node)[dim[axis]] - size -
+      YGPositionOf(child)[pos[axis]];
 }
 
 // If both left and right are defined, then use left. Otherwise return
@@ -1602,9 +3248,10 @@ static void YGConstrainMaxSizeForMode(const YGNodeRef node,
                                       const float parentAxisSize,
                                       const float parentWidth,
                                       YGMeasureMode *mode, float *size) {
-  const float maxSize =
-      YGResolveValue(&node->style.maxDimensions[dim[axis]], parentAxisSize) +
-      YGNodeMarginForAxis(node, axis, parentWidth);
+  const YGValue *const maxDimension =
+      &YGStyleOf(node)->maxDimensions[dim[axis]];
+  const float maxSize = YGResolveValue(maxDimension, parentAxisSize) +
+                        YGNodeMarginForAxis(node, axis, parentWidth);
   switch (*mode) {
     case YGMeasureModeExactly:
     case YGMeasureModeAtMost:
@@ -1626,9 +3273,9 @@ static void YGNodeSetPosition(const YGNodeRef node, const YGDirection direction,
   /* Root nodes should be always layouted as LTR, so we don't return negative
    * values. */
   const YGDirection directionRespectingRoot =
-      node->parent != NULL ? direction : YGDirectionLTR;
+      YGParentOf(node) != NULL ? direction : YGDirectionLTR;
   const YGFlexDirection mainAxis = YGResolveFlexDirection(
-      node->style.flexDirection, directionRespectingRoot);
+      YGStyleOf(node)->flexDirection, directionRespectingRoot);
   const YGFlexDirection crossAxis =
       YGFlexDirectionCross(mainAxis, directionRespectingRoot);
 
@@ -1637,24 +3284,38 @@ static void YGNodeSetPosition(const YGNodeRef node, const YGDirection direction,
   const float relativePositionCross =
       YGNodeRelativePosition(node, crossAxis, crossSize);
 
-  node->layout.position[leading[mainAxis]] =
+  YGPositionOf(node)[leading[mainAxis]] =
       YGNodeLeadingMargin(node, mainAxis, parentWidth) + relativePositionMain;
-  node->layout.position[trailing[mainAxis]] =
+  YGPositionOf(node)[trailing[mainAxis]] =
       YGNodeTrailingMargin(node, mainAxis, parentWidth) + relativePositionMain;
-  node->layout.position[leading[crossAxis]] =
+  YGPositionOf(node)[leading[crossAxis]] =
       YGNodeLeadingMargin(node, crossAxis, parentWidth) + relativePositionCross;
-  node->layout.position[trailing[crossAxis]] =
+  YGPositionOf(node)[trailing[crossAxis]] =
       YGNodeTrailingMargin(node, crossAxis, parentWidth) +
       relativePositionCross;
 }
 
+// The parent computes the flex basis of a child without necessarily visiting
+// it, so the flex basis goes into the history of the child on its own.
+static inline void YGNodeRecordFlexBasis(
+    const YGNodeRef node, const YGLayoutContext *const layoutContext) {
+  if (layoutContext->memoizeSubtrees) {
+    node->layout.history = YGHashMix(
+        YGHashMix(node->layout.history, YG_HISTORY_FLEX_BASIS),
+        (uint64_t)(node->layout.generationCount != layoutContext->generation)
+                << 32 |
+            YGFloatBits(node->layout.computedFlexBasis));
+  }
+}
+
 static void YGNodeComputeFlexBasisForChild(
     const YGNodeRef node, const YGNodeRef child, const float width,
     const YGMeasureMode widthMode, const float height, const float parentWidth,
     const float parentHeight, const YGMeasureMode heightMode,
-    const YGDirection direction, const YGConfigRef config) {
+    const YGDirection direction, const YGConfigRef config,
+    YGLayoutContext *const layoutContext) {
   const YGFlexDirection mainAxis =
-      YGResolveFlexDirection(node->style.flexDirection, direction);
+      YGResolveFlexDirection(YGStyleOf(node)->flexDirection, direction);
   const bool isMainAxisRow = YGFlexDirectionIsRow(mainAxis);
   const float mainAxisSize = isMainAxisRow ? width : height;
   const float mainAxisParentSize = isMainAxisRow ? parentWidth : parentHeight;
@@ -1677,7 +3338,7 @@ static void YGNodeComputeFlexBasisForChild(
         (YGConfigIsExperimentalFeatureEnabled(
              child->config, YGExperimentalFeatureWebFlexBasis) &&
          child->layout.computedFlexBasisGeneration !=
-             gCurrentGenerationCount)) {
+             layoutContext->generation)) {
       child->layout.computedFlexBasis =
           fmaxf(resolvedFlexBasis,
                 YGNodePaddingAndBorderForAxis(child, mainAxis, parentWidth));
@@ -1685,13 +3346,13 @@ static void YGNodeComputeFlexBasisForChild(
   } else if (isMainAxisRow && isRowStyleDimDefined) {
     // The width is definite, so use that as the flex basis.
     child->layout.computedFlexBasis = fmaxf(
-        YGResolveValue(child->resolvedDimensions[YGDimensionWidth],
+        YGResolveValue(YGResolvedDimensionOf(child, YGDimensionWidth),
                        parentWidth),
         YGNodePaddingAndBorderForAxis(child, YGFlexDirectionRow, parentWidth));
   } else if (!isMainAxisRow && isColumnStyleDimDefined) {
     // The height is definite, so use that as the flex basis.
     child->layout.computedFlexBasis =
-        fmaxf(YGResolveValue(child->resolvedDimensions[YGDimensionHeight],
+        fmaxf(YGResolveValue(YGResolvedDimensionOf(child, YGDimensionHeight),
                              parentHeight),
               YGNodePaddingAndBorderForAxis(child, YGFlexDirectionColumn,
                                             parentWidth));
@@ -1707,45 +3368,48 @@ static void YGNodeComputeFlexBasisForChild(
         YGNodeMarginForAxis(child, YGFlexDirectionRow, parentWidth);
     const float marginColumn =
         YGNodeMarginForAxis(child, YGFlexDirectionColumn, parentWidth);
+    const float aspectRatio = YGStyleOf(child)->aspectRatio;
 
     if (isRowStyleDimDefined) {
-      childWidth = YGResolveValue(child->resolvedDimensions[YGDimensionWidth],
-                                  parentWidth) +
-                   marginRow;
+      childWidth =
+          YGResolveValue(YGResolvedDimensionOf(child, YGDimensionWidth),
+                         parentWidth) +
+          marginRow;
       childWidthMeasureMode = YGMeasureModeExactly;
     }
     if (isColumnStyleDimDefined) {
-      childHeight = YGResolveValue(child->resolvedDimensions[YGDimensionHeight],
-                                   parentHeight) +
-                    marginColumn;
+      childHeight =
+          YGResolveValue(YGResolvedDimensionOf(child, YGDimensionHeight),
+                         parentHeight) +
+          marginColumn;
       childHeightMeasureMode = YGMeasureModeExactly;
     }
 
     // The W3C spec doesn't say anything about the 'overflow' property,
     // but all major browsers appear to implement the following logic.
-    if ((!isMainAxisRow && node->style.overflow == YGOverflowScroll) ||
-        node->style.overflow != YGOverflowScroll) {
+    if ((!isMainAxisRow && YGStyleOf(node)->overflow == YGOverflowScroll) ||
+        YGStyleOf(node)->overflow != YGOverflowScroll) {
       if (YGFloatIsUndefined(childWidth) && !YGFloatIsUndefined(width)) {
         childWidth = width;
         childWidthMeasureMode = YGMeasureModeAtMost;
       }
     }
 
-    if ((isMainAxisRow && node->style.overflow == YGOverflowScroll) ||
-        node->style.overflow != YGOverflowScroll) {
+    if ((isMainAxisRow && YGStyleOf(node)->overflow == YGOverflowScroll) ||
+        YGStyleOf(node)->overflow != YGOverflowScroll) {
       if (YGFloatIsUndefined(childHeight) && !YGFloatIsUndefined(height)) {
         childHeight = height;
         childHeightMeasureMode = YGMeasureModeAtMost;
       }
     }
 
-    if (!YGFloatIsUndefined(child->style.aspectRatio)) {
+    if (!YGFloatIsUndefined(aspectRatio)) {
       if (!isMainAxisRow && childWidthMeasureMode == YGMeasureModeExactly) {
-        childHeight = (childWidth - marginRow) / child->style.aspectRatio;
+        childHeight = (childWidth - marginRow) / aspectRatio;
         childHeightMeasureMode = YGMeasureModeExactly;
       } else if (isMainAxisRow &&
                  childHeightMeasureMode == YGMeasureModeExactly) {
-        childWidth = (childHeight - marginColumn) * child->style.aspectRatio;
+        childWidth = (childHeight - marginColumn) * aspectRatio;
         childWidthMeasureMode = YGMeasureModeExactly;
       }
     }
@@ -1763,8 +3427,8 @@ static void YGNodeComputeFlexBasisForChild(
         childWidthStretch) {
       childWidth = width;
       childWidthMeasureMode = YGMeasureModeExactly;
-      if (!YGFloatIsUndefined(child->style.aspectRatio)) {
-        childHeight = (childWidth - marginRow) / child->style.aspectRatio;
+      if (!YGFloatIsUndefined(aspectRatio)) {
+        childHeight = (childWidth - marginRow) / aspectRatio;
         childHeightMeasureMode = YGMeasureModeExactly;
       }
     }
@@ -1779,8 +3443,8 @@ static void YGNodeComputeFlexBasisForChild(
       childHeight = height;
       childHeightMeasureMode = YGMeasureModeExactly;
 
-      if (!YGFloatIsUndefined(child->style.aspectRatio)) {
-        childWidth = (childHeight - marginColumn) * child->style.aspectRatio;
+      if (!YGFloatIsUndefined(aspectRatio)) {
+        childWidth = (childHeight - marginColumn) * aspectRatio;
         childWidthMeasureMode = YGMeasureModeExactly;
       }
     }
@@ -1794,14 +3458,16 @@ static void YGNodeComputeFlexBasisForChild(
     // Measure the child
     YGLayoutNodeInternal(child, childWidth, childHeight, direction,
                          childWidthMeasureMode, childHeightMeasureMode,
-                         parentWidth, parentHeight, false, "measure", config);
+                         parentWidth, parentHeight, false, "measure", config,
+                         layoutContext);
 
     child->layout.computedFlexBasis =
-        fmaxf(child->layout.measuredDimensions[dim[mainAxis]],
+        fmaxf(YGMeasuredDimensionsOf(child)[dim[mainAxis]],
               YGNodePaddingAndBorderForAxis(child, mainAxis, parentWidth));
   }
 
-  child->layout.computedFlexBasisGeneration = gCurrentGenerationCount;
+  child->layout.computedFlexBasisGeneration = layoutContext->generation;
+  YGNodeRecordFlexBasis(child, layoutContext);
 }
 
 static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
@@ -1809,9 +3475,10 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
                                       const YGMeasureMode widthMode,
                                       const float height,
                                       const YGDirection direction,
-                                      const YGConfigRef config) {
+                                      const YGConfigRef config,
+                                      YGLayoutContext *const layoutContext) {
   const YGFlexDirection mainAxis =
-      YGResolveFlexDirection(node->style.flexDirection, direction);
+      YGResolveFlexDirection(YGStyleOf(node)->flexDirection, direction);
   const YGFlexDirection crossAxis = YGFlexDirectionCross(mainAxis, direction);
   const bool isMainAxisRow = YGFlexDirectionIsRow(mainAxis);
 
@@ -1826,7 +3493,7 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
 
   if (YGNodeIsStyleDimDefined(child, YGFlexDirectionRow, width)) {
     childWidth =
-        YGResolveValue(child->resolvedDimensions[YGDimensionWidth], width) +
+        YGResolveValue(YGResolvedDimensionOf(child, YGDimensionWidth), width) +
         marginRow;
   } else {
     // If the child doesn't have a specified width, compute the width based
@@ -1834,7 +3501,7 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
     // offsets if they're defined.
     if (YGNodeIsLeadingPosDefined(child, YGFlexDirectionRow) &&
         YGNodeIsTrailingPosDefined(child, YGFlexDirectionRow)) {
-      childWidth = node->layout.measuredDimensions[YGDimensionWidth] -
+      childWidth = YGMeasuredDimensionsOf(node)[YGDimensionWidth] -
                    (YGNodeLeadingBorder(node, YGFlexDirectionRow) +
                     YGNodeTrailingBorder(node, YGFlexDirectionRow)) -
                    (YGNodeLeadingPosition(child, YGFlexDirectionRow, width) +
@@ -1845,9 +3512,9 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
   }
 
   if (YGNodeIsStyleDimDefined(child, YGFlexDirectionColumn, height)) {
-    childHeight =
-        YGResolveValue(child->resolvedDimensions[YGDimensionHeight], height) +
-        marginColumn;
+    childHeight = YGResolveValue(
+                      YGResolvedDimensionOf(child, YGDimensionHeight), height) +
+                  marginColumn;
   } else {
     // If the child doesn't have a specified height, compute the height
     // based on the top/bottom
@@ -1855,7 +3522,7 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
     if (YGNodeIsLeadingPosDefined(child, YGFlexDirectionColumn) &&
         YGNodeIsTrailingPosDefined(child, YGFlexDirectionColumn)) {
       childHeight =
-          node->layout.measuredDimensions[YGDimensionHeight] -
+          YGMeasuredDimensionsOf(node)[YGDimensionHeight] -
           (YGNodeLeadingBorder(node, YGFlexDirectionColumn) +
            YGNodeTrailingBorder(node, YGFlexDirectionColumn)) -
           (YGNodeLeadingPosition(child, YGFlexDirectionColumn, height) +
@@ -1869,13 +3536,12 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
   // ratio calculation. One dimension being the anchor and the other being
   // flexible.
   if (YGFloatIsUndefined(childWidth) ^ YGFloatIsUndefined(childHeight)) {
-    if (!YGFloatIsUndefined(child->style.aspectRatio)) {
+    const float aspectRatio = YGStyleOf(child)->aspectRatio;
+    if (!YGFloatIsUndefined(aspectRatio)) {
       if (YGFloatIsUndefined(childWidth)) {
-        childWidth =
-            marginRow + (childHeight - marginColumn) * child->style.aspectRatio;
+        childWidth = marginRow + (childHeight - marginColumn) * aspectRatio;
       } else if (YGFloatIsUndefined(childHeight)) {
-        childHeight =
-            marginColumn + (childWidth - marginRow) / child->style.aspectRatio;
+        childHeight = marginColumn + (childWidth - marginRow) / aspectRatio;
       }
     }
   }
@@ -1901,67 +3567,166 @@ static void YGNodeAbsoluteLayoutChild(const YGNodeRef node,
 
     YGLayoutNodeInternal(child, childWidth, childHeight, direction,
                          childWidthMeasureMode, childHeightMeasureMode,
-                         childWidth, childHeight, false, "abs-measure", config);
-    childWidth = child->layout.measuredDimensions[YGDimensionWidth] +
+                         childWidth, childHeight, false, "abs-measure", config,
+                         layoutContext);
+    childWidth = YGMeasuredDimensionsOf(child)[YGDimensionWidth] +
                  YGNodeMarginForAxis(child, YGFlexDirectionRow, width);
-    childHeight = child->layout.measuredDimensions[YGDimensionHeight] +
+    childHeight = YGMeasuredDimensionsOf(child)[YGDimensionHeight] +
                   YGNodeMarginForAxis(child, YGFlexDirectionColumn, width);
   }
 
   YGLayoutNodeInternal(child, childWidth, childHeight, direction,
                        YGMeasureModeExactly, YGMeasureModeExactly, childWidth,
-                       childHeight, true, "abs-layout", config);
+                       childHeight, true, "abs-layout", config, layoutContext);
 
   if (YGNodeIsTrailingPosDefined(child, mainAxis) &&
       !YGNodeIsLeadingPosDefined(child, mainAxis)) {
-    child->layout.position[leading[mainAxis]] =
-        node->layout.measuredDimensions[dim[mainAxis]] -
-        child->layout.measuredDimensions[dim[mainAxis]] -
+    YGPositionOf(child)[leading[mainAxis]] =
+        YGMeasuredDimensionsOf(node)[dim[mainAxis]] -
+        YGMeasuredDimensionsOf(child)[dim[mainAxis]] -
         YGNodeTrailingBorder(node, mainAxis) -
         YGNodeTrailingMargin(child, mainAxis, width) -
         YGNodeTrailingPosition(child, mainAxis, isMainAxisRow ? width : height);
   } else if (!YGNodeIsLeadingPosDefined(child, mainAxis) &&
-             node->style.justifyContent == YGJustifyCenter) {
-    child->layout.position[leading[mainAxis]] =
-        (node->layout.measuredDimensions[dim[mainAxis]] -
-         child->layout.measuredDimensions[dim[mainAxis]]) /
+             YGStyleOf(node)->justifyContent == YGJustifyCenter) {
+    YGPositionOf(child)[leading[mainAxis]] =
+        (YGMeasuredDimensionsOf(node)[dim[mainAxis]] -
+         YGMeasuredDimensionsOf(child)[dim[mainAxis]]) /
         2.0f;
   } else if (!YGNodeIsLeadingPosDefined(child, mainAxis) &&
-             node->style.justifyContent == YGJustifyFlexEnd) {
-    child->layout.position[leading[mainAxis]] =
-        (node->layout.measuredDimensions[dim[mainAxis]] -
-         child->layout.measuredDimensions[dim[mainAxis]]);
+             YGStyleOf(node)->justifyContent == YGJustifyFlexEnd) {
+    YGPositionOf(child)[leading[mainAxis]] =
+        (YGMeasuredDimensionsOf(node)[dim[mainAxis]] -
+         YGMeasuredDimensionsOf(child)[dim[mainAxis]]);
   }
 
   if (YGNodeIsTrailingPosDefined(child, crossAxis) &&
       !YGNodeIsLeadingPosDefined(child, crossAxis)) {
-    child->layout.position[leading[crossAxis]] =
-        node->layout.measuredDimensions[dim[crossAxis]] -
-        child->layout.measuredDimensions[dim[crossAxis]] -
+    YGPositionOf(child)[leading[crossAxis]] =
+        YGMeasuredDimensionsOf(node)[dim[crossAxis]] -
+        YGMeasuredDimensionsOf(child)[dim[crossAxis]] -
         YGNodeTrailingBorder(node, crossAxis) -
         YGNodeTrailingMargin(child, crossAxis, width) -
         YGNodeTrailingPosition(child, crossAxis,
                                isMainAxisRow ? height : width);
   } else if (!YGNodeIsLeadingPosDefined(child, crossAxis) &&
              YGNodeAlignItem(node, child) == YGAlignCenter) {
-    child->layout.position[leading[crossAxis]] =
-        (node->layout.measuredDimensions[dim[crossAxis]] -
-         child->layout.measuredDimensions[dim[crossAxis]]) /
+    YGPositionOf(child)[leading[crossAxis]] =
+        (YGMeasuredDimensionsOf(node)[dim[crossAxis]] -
+         YGMeasuredDimensionsOf(child)[dim[crossAxis]]) /
         2.0f;
   } else if (!YGNodeIsLeadingPosDefined(child, crossAxis) &&
              ((YGNodeAlignItem(node, child) == YGAlignFlexEnd) ^
-              (node->style.flexWrap == YGWrapWrapReverse))) {
-    child->layout.position[leading[crossAxis]] =
-        (node->layout.measuredDimensions[dim[crossAxis]] -
-         child->layout.measuredDimensions[dim[crossAxis]]);
+              (YGStyleOf(node)->flexWrap == YGWrapWrapReverse))) {
+    YGPositionOf(child)[leading[crossAxis]] =
+        (YGMeasuredDimensionsOf(node)[dim[crossAxis]] -
+         YGMeasuredDimensionsOf(child)[dim[crossAxis]]);
+  }
+}
+
+// A measure cache key. Constraints are in 1/64 points, and 0 in the undefined
+// mode.
+typedef struct YGMeasureCacheKey {
+  uint64_t fingerprint;
+  int32_t width;
+  int32_t height;
+  uint8_t widthMeasureMode;
+  uint8_t heightMeasureMode;
+} YGMeasureCacheKey;
+
+static bool YGMeasureCacheLookup(const YGMeasureCacheRef cache,
+                                 const YGMeasureCacheKey *const key,
+                                 YGSize *const size);
+static void YGMeasureCacheInsert(const YGMeasureCacheRef cache,
+                                 const YGMeasureCacheKey *const key,
+                                 const YGSize size);
+
+static inline int32_t YGMeasureCacheQuantize(const float size,
+                                             const YGMeasureMode mode) {
+  if (mode == YGMeasureModeUndefined) {
+    return 0;
+  }
+  // Anything beyond 2^24 points (and NaN) is treated as unbounded.
+  const float scaled = size * 64;
+  return scaled < 1073741824.0f ? (int32_t)(scaled + 0.5f) : INT32_MAX;
+}
+
+// Calls the measure function of the node, counting and tracing the call.
+static YGSize YGNodeCallMeasureFunc(const YGNodeRef node,
+                                    const float innerWidth,
+                                    const YGMeasureMode widthMeasureMode,
+                                    const float innerHeight,
+                                    const YGMeasureMode heightMeasureMode,
+                                    YGLayoutContext *const layoutContext) {
+  layoutContext->stats.measureFuncCalls++;
+  if (layoutContext->eventHandler == NULL) {
+    return node->measure(node, innerWidth, widthMeasureMode, innerHeight,
+                         heightMeasureMode);
+  }
+
+  YGLayoutContextEmit(layoutContext, (YGEvent){
+                                         .type = YGEventTypeMeasureBegin,
+                                         .node = node,
+                                         .depth = layoutContext->depth,
+                                         .width = innerWidth,
+                                         .height = innerHeight,
+                                         .widthMeasureMode = widthMeasureMode,
+                                         .heightMeasureMode = heightMeasureMode,
+                                     });
+  const YGSize size = node->measure(node, innerWidth, widthMeasureMode,
+                                    innerHeight, heightMeasureMode);
+  YGLayoutContextEmit(layoutContext, (YGEvent){
+                                         .type = YGEventTypeMeasureEnd,
+                                         .node = node,
+                                         .depth = layoutContext->depth,
+                                         .width = size.width,
+                                         .height = size.height,
+                                         .widthMeasureMode = widthMeasureMode,
+                                         .heightMeasureMode = heightMeasureMode,
+                                     });
+  return size;
+}
+
+static YGSize YGNodeMeasure(const YGNodeRef node, const float innerWidth,
+                            const YGMeasureMode widthMeasureMode,
+                            const float innerHeight,
+                            const YGMeasureMode heightMeasureMode,
+                            YGLayoutContext *const layoutContext) {
+  const YGMeasureCacheRef cache = node->config->measureCache;
+  if (cache == NULL || node->measureFingerprint == 0) {
+    return YGNodeCallMeasureFunc(node, innerWidth, widthMeasureMode,
+                                 innerHeight, heightMeasureMode, layoutContext);
+  }
+
+  const YGMeasureCacheKey key = {
+      .fingerprint = node->measureFingerprint,
+      .width = YGMeasureCacheQuantize(innerWidth, widthMeasureMode),
+      .height = YGMeasureCacheQuantize(innerHeight, heightMeasureMode),
+      .widthMeasureMode = (uint8_t)widthMeasureMode,
+      .heightMeasureMode = (uint8_t)heightMeasureMode,
+  };
+  YGSize size;
+  if (YGMeasureCacheLookup(cache, &key, &size)) {
+    // The result may come from a constraint up to 1/128 point larger.
+    if (widthMeasureMode == YGMeasureModeAtMost) {
+      size.width = fminf(size.width, innerWidth);
+    }
+    if (heightMeasureMode == YGMeasureModeAtMost) {
+      size.height = fminf(size.height, innerHeight);
+    }
+    return size;
   }
+  size = YGNodeCallMeasureFunc(node, innerWidth, widthMeasureMode, innerHeight,
+                               heightMeasureMode, layoutContext);
+  YGMeasureCacheInsert(cache, &key, size);
+  return size;
 }
 
 static void YGNodeWithMeasureFuncSetMeasuredDimensions(
     const YGNodeRef node, const float availableWidth,
     const float availableHeight, const YGMeasureMode widthMeasureMode,
     const YGMeasureMode heightMeasureMode, const float parentWidth,
-    const float parentHeight) {
+    const float parentHeight, YGLayoutContext *const layoutContext) {
   YGAssertWithNode(node, node->measure != NULL,
                    "Expected node to have custom measure function");
 
@@ -1987,25 +3752,26 @@ static void YGNodeWithMeasureFuncSetMeasuredDimensions(
   if (widthMeasureMode == YGMeasureModeExactly &&
       heightMeasureMode == YGMeasureModeExactly) {
     // Don't bother sizing the text if both dimensions are already defined.
-    node->layout.measuredDimensions[YGDimensionWidth] = YGNodeBoundAxis(
+    YGMeasuredDimensionsOf(node)[YGDimensionWidth] = YGNodeBoundAxis(
         node, YGFlexDirectionRow, availableWidth - marginAxisRow, parentWidth,
         parentWidth);
-    node->layout.measuredDimensions[YGDimensionHeight] = YGNodeBoundAxis(
+    YGMeasuredDimensionsOf(node)[YGDimensionHeight] = YGNodeBoundAxis(
         node, YGFlexDirectionColumn, availableHeight - marginAxisColumn,
         parentHeight, parentWidth);
   } else {
     // Measure the text under the current constraints.
-    const YGSize measuredSize = node->measure(
-        node, innerWidth, widthMeasureMode, innerHeight, heightMeasureMode);
+    const YGSize measuredSize =
+        YGNodeMeasure(node, innerWidth, widthMeasureMode, innerHeight,
+                      heightMeasureMode, layoutContext);
 
-    node->layout.measuredDimensions[YGDimensionWidth] =
+    YGMeasuredDimensionsOf(node)[YGDimensionWidth] =
         YGNodeBoundAxis(node, YGFlexDirectionRow,
                         (widthMeasureMode == YGMeasureModeUndefined ||
                          widthMeasureMode == YGMeasureModeAtMost)
                             ? measuredSize.width + paddingAndBorderAxisRow
                             : availableWidth - marginAxisRow,
                         availableWidth, availableWidth);
-    node->layout.measuredDimensions[YGDimensionHeight] =
+    YGMeasuredDimensionsOf(node)[YGDimensionHeight] =
         YGNodeBoundAxis(node, YGFlexDirectionColumn,
                         (heightMeasureMode == YGMeasureModeUndefined ||
                          heightMeasureMode == YGMeasureModeAtMost)
@@ -2031,14 +3797,14 @@ static void YGNodeEmptyContainerSetMeasuredDimensions(
   const float marginAxisColumn =
       YGNodeMarginForAxis(node, YGFlexDirectionColumn, parentWidth);
 
-  node->layout.measuredDimensions[YGDimensionWidth] =
+  YGMeasuredDimensionsOf(node)[YGDimensionWidth] =
       YGNodeBoundAxis(node, YGFlexDirectionRow,
                       (widthMeasureMode == YGMeasureModeUndefined ||
                        widthMeasureMode == YGMeasureModeAtMost)
                           ? paddingAndBorderAxisRow
                           : availableWidth - marginAxisRow,
                       parentWidth, parentWidth);
-  node->layout.measuredDimensions[YGDimensionHeight] =
+  YGMeasuredDimensionsOf(node)[YGDimensionHeight] =
       YGNodeBoundAxis(node, YGFlexDirectionColumn,
                       (heightMeasureMode == YGMeasureModeUndefined ||
                        heightMeasureMode == YGMeasureModeAtMost)
@@ -2061,7 +3827,7 @@ static bool YGNodeFixedSizeSetMeasuredDimensions(
     const float marginAxisRow =
         YGNodeMarginForAxis(node, YGFlexDirectionRow, parentWidth);
 
-    node->layout.measuredDimensions[YGDimensionWidth] =
+    YGMeasuredDimensionsOf(node)[YGDimensionWidth] =
         YGNodeBoundAxis(node, YGFlexDirectionRow,
                         YGFloatIsUndefined(availableWidth) ||
                                 (widthMeasureMode == YGMeasureModeAtMost &&
@@ -2070,7 +3836,7 @@ static bool YGNodeFixedSizeSetMeasuredDimensions(
                             : availableWidth - marginAxisRow,
                         parentWidth, parentWidth);
 
-    node->layout.measuredDimensions[YGDimensionHeight] =
+    YGMeasuredDimensionsOf(node)[YGDimensionHeight] =
         YGNodeBoundAxis(node, YGFlexDirectionColumn,
                         YGFloatIsUndefined(availableHeight) ||
                                 (heightMeasureMode == YGMeasureModeAtMost &&
@@ -2085,18 +3851,963 @@ static bool YGNodeFixedSizeSetMeasuredDimensions(
   return false;
 }
 
-static void YGZeroOutLayoutRecursivly(const YGNodeRef node) {
+static void YGZeroOutLayoutRecursivly(const YGNodeRef node,
+                                      YGLayoutContext *const layoutContext) {
+  YGMeasurementCache *const measurementCache = node->layout.measurementCache;
+  YGLayoutEdges *const edges = node->layout.edges;
+  YGRelayoutState *const relayout = node->layout.relayout;
   memset(&(node->layout), 0, sizeof(YGLayout));
+  memset(YGMeasuredDimensionsOf(node), 0,
+         sizeof(gYGNodeDefaults.measuredDimensions));
+  memset(YGPositionOf(node), 0, sizeof(gYGNodeDefaults.position));
+  YGNodeForgetConstraints(node, relayout);
+  // All that is left of the state is the dirty flag and the capacity of the
+  // cache.
+  node->layout.history = YGHashMix(
+      YGHashMix(YG_HISTORY_ZEROED, node->isDirty),
+      measurementCache != NULL ? measurementCache->capacity : 0);
+  if (measurementCache != NULL) {
+    YGMeasurementCacheClear(measurementCache);
+    node->layout.measurementCache = measurementCache;
+  }
+  if (edges != NULL) {
+    memset(edges, 0, sizeof(YGLayoutEdges));
+    node->layout.edges = edges;
+  }
   node->hasNewLayout = true;
-  YGCloneChildrenIfNeeded(node);
-  const uint32_t childCount = YGNodeGetChildCount(node);
-  for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef child = YGNodeListGet(node->children, i);
-    YGZeroOutLayoutRecursivly(child);
+  YGCloneChildrenIfNeeded(node, layoutContext);
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    YGZeroOutLayoutRecursivly(child, layoutContext);
   }
 }
 
 //
+// The per-child loops of a flex line are written once as kernels taking the
+// branches that hold for the whole container as parameters, and instantiated
+// for every combination of the ones each of them tests. The compiler folds the
+// tests away in each copy, and YGNodelayoutImpl picks the copies once per
+// container.
+#if defined(_MSC_VER)
+#define YG_LAYOUT_KERNEL static __forceinline
+#else
+#define YG_LAYOUT_KERNEL static inline __attribute__((always_inline))
+#endif
+
+// Returns `axis`, spelled so that the compiler can tell whether it is a row
+// from `isRow` alone and fold the tests of it in the edge lookups.
+YG_LAYOUT_KERNEL YGFlexDirection YGFlexDirectionOnAxis(
+    const YGFlexDirection axis, const bool isRow) {
+  const bool isReverse = axis == YGFlexDirectionRowReverse ||
+                         axis == YGFlexDirectionColumnReverse;
+  if (isRow) {
+    return isReverse ? YGFlexDirectionRowReverse : YGFlexDirectionRow;
+  }
+  return isReverse ? YGFlexDirectionColumnReverse : YGFlexDirectionColumn;
+}
+
+// What the kernels read of the container, fixed for all of its lines. The
+// arguments of YGNodelayoutImpl and the values of STEPs 1 and 2.
+typedef struct YGContainerLayout {
+  YGNodeRef node;
+  YGConfigRef config;
+  YGLayoutContext *layoutContext;
+  YGDirection direction;
+  YGFlexDirection mainAxis;
+  YGFlexDirection crossAxis;
+  bool isMainAxisRow;
+  bool isNodeFlexWrap;
+  // A child is absolutely positioned or not displayed.
+  bool hasOutOfFlowChildren;
+  bool performLayout;
+  // The flex bases of the children overflow the main axis.
+  bool flexBasisOverflows;
+  YGMeasureMode widthMeasureMode;
+  YGMeasureMode heightMeasureMode;
+  YGMeasureMode measureModeMainDim;
+  YGMeasureMode measureModeCrossDim;
+  float availableWidth;
+  float availableHeight;
+  float parentWidth;
+  float parentHeight;
+  float mainAxisParentSize;
+  float crossAxisParentSize;
+  float marginAxisRow;
+  float marginAxisColumn;
+  float minInnerMainDim;
+  float maxInnerMainDim;
+  float availableInnerWidth;
+  float availableInnerHeight;
+  float availableInnerCrossDim;
+  float leadingPaddingAndBorderMain;
+  float trailingPaddingAndBorderMain;
+  float leadingPaddingAndBorderCross;
+  float paddingAndBorderAxisMain;
+  float paddingAndBorderAxisCross;
+} YGContainerLayout;
+
+// The state of the line being laid out, passed from kernel to kernel.
+typedef struct YGLineLayout {
+  uint32_t index;
+  // The children on the line, see YGChildCursorFirst.
+  uint32_t startCursor;
+  uint32_t endCursor;
+  uint32_t itemsOnLine;
+  float availableInnerMainDim;
+  float sizeConsumed;
+  float totalFlexGrowFactors;
+  float totalFlexShrinkScaledFactors;
+  // The children in the flow, linked through nextChild.
+  YGNodeRef firstRelativeChild;
+  // Offset of the flex line scratch of the items.
+  uint32_t lineOffset;
+  float deltaFreeSpace;
+  bool canSkipFlex;
+  float remainingFreeSpace;
+  float mainDim;
+  float crossDim;
+  float containerCrossAxis;
+  float totalLineCrossDim;
+} YGLineLayout;
+
+// STEP 4: adds the children from startCursor to the line until it is full.
+YG_LAYOUT_KERNEL void YGCollectFlexLineKernel(
+    const YGContainerLayout *const container, YGLineLayout *const line,
+    const bool isMainAxisRow, const bool isNodeFlexWrap,
+    const bool hasOutOfFlowChildren) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis =
+      YGFlexDirectionOnAxis(container->mainAxis, isMainAxisRow);
+  const YGDimension mainDimension =
+      isMainAxisRow ? YGDimensionWidth : YGDimensionHeight;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+
+  uint32_t itemsOnLine = 0;
+  float sizeConsumed = 0;
+  float totalFlexGrowFactors = 0;
+  float totalFlexShrinkScaledFactors = 0;
+  YGNodeRef firstRelativeChild = NULL;
+  YGNodeRef currentRelativeChild = NULL;
+
+  uint32_t cursor = line->startCursor;
+  for (; cursor != childEnd; cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (hasOutOfFlowChildren && YGStyleOf(child)->display == YGDisplayNone) {
+      continue;
+    }
+    child->lineIndex = line->index;
+    if (hasOutOfFlowChildren &&
+        YGStyleOf(child)->positionType == YGPositionTypeAbsolute) {
+      continue;
+    }
+
+    const float childMarginMainAxis =
+        YGNodeMarginForAxis(child, mainAxis, container->availableInnerWidth);
+    const float flexBasisWithMaxConstraints =
+        fminf(YGResolveValue(&YGStyleOf(child)->maxDimensions[mainDimension],
+                             container->mainAxisParentSize),
+              child->layout.computedFlexBasis);
+    const float flexBasisWithMinAndMaxConstraints =
+        fmaxf(YGResolveValue(&YGStyleOf(child)->minDimensions[mainDimension],
+                             container->mainAxisParentSize),
+              flexBasisWithMaxConstraints);
+
+    // If this is a multi-line flow and this item pushes us over the available
+    // size, we've hit the end of the current line.
+    if (isNodeFlexWrap && itemsOnLine > 0 &&
+        sizeConsumed + flexBasisWithMinAndMaxConstraints +
+                childMarginMainAxis >
+            line->availableInnerMainDim) {
+      break;
+    }
+
+    sizeConsumed += flexBasisWithMinAndMaxConstraints + childMarginMainAxis;
+    itemsOnLine++;
+
+    if (YGNodeIsFlex(child)) {
+      totalFlexGrowFactors += YGResolveFlexGrow(child);
+
+      // Unlike the grow factor, the shrink factor is scaled relative to the
+      // child dimension.
+      totalFlexShrinkScaledFactors +=
+          -YGNodeResolveFlexShrink(child) * child->layout.computedFlexBasis;
+    }
+
+    // Store a private linked list of children that need to be layed out.
+    if (firstRelativeChild == NULL) {
+      firstRelativeChild = child;
+    }
+    if (currentRelativeChild != NULL) {
+      currentRelativeChild->nextChild = child;
+    }
+    currentRelativeChild = child;
+    child->nextChild = NULL;
+  }
+
+  line->endCursor = cursor;
+  line->itemsOnLine = itemsOnLine;
+  line->sizeConsumed = sizeConsumed;
+  line->totalFlexGrowFactors = totalFlexGrowFactors;
+  line->totalFlexShrinkScaledFactors = totalFlexShrinkScaledFactors;
+  line->firstRelativeChild = firstRelativeChild;
+}
+
+// Lays out an item of a flex line at `mainSize`, and at the cross size it
+// takes before stretching.
+YG_LAYOUT_KERNEL void YGLayoutFlexItem(const YGContainerLayout *const container,
+                                       const YGNodeRef child,
+                                       const float mainSize,
+                                       const float availableInnerMainDim,
+                                       const bool isMainAxisRow,
+                                       const bool isNodeFlexWrap) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis =
+      YGFlexDirectionOnAxis(container->mainAxis, isMainAxisRow);
+  const YGFlexDirection crossAxis =
+      YGFlexDirectionOnAxis(container->crossAxis, !isMainAxisRow);
+  const YGDimension crossDimension =
+      isMainAxisRow ? YGDimensionHeight : YGDimensionWidth;
+  const float availableInnerWidth = container->availableInnerWidth;
+  const float availableInnerCrossDim = container->availableInnerCrossDim;
+  const YGMeasureMode measureModeCrossDim = container->measureModeCrossDim;
+  YGLayoutContext *const layoutContext = container->layoutContext;
+
+  const float marginMain =
+      YGNodeMarginForAxis(child, mainAxis, availableInnerWidth);
+  const float marginCross =
+      YGNodeMarginForAxis(child, crossAxis, availableInnerWidth);
+
+  float childCrossSize;
+  float childMainSize = mainSize + marginMain;
+  YGMeasureMode childCrossMeasureMode;
+  YGMeasureMode childMainMeasureMode = YGMeasureModeExactly;
+  if (!YGFloatIsUndefined(YGStyleOf(child)->aspectRatio)) {
+    childCrossSize =
+        isMainAxisRow
+            ? (childMainSize - marginMain) / YGStyleOf(child)->aspectRatio
+            : (childMainSize - marginMain) * YGStyleOf(child)->aspectRatio;
+    childCrossMeasureMode = YGMeasureModeExactly;
+
+    childCrossSize += marginCross;
+  } else if (!YGFloatIsUndefined(availableInnerCrossDim) &&
+             !YGNodeIsStyleDimDefined(child, crossAxis,
+                                      availableInnerCrossDim) &&
+             measureModeCrossDim == YGMeasureModeExactly &&
+             !(isNodeFlexWrap && container->flexBasisOverflows) &&
+             YGNodeAlignItem(node, child) == YGAlignStretch) {
+    childCrossSize = availableInnerCrossDim;
+    childCrossMeasureMode = YGMeasureModeExactly;
+  } else if (!YGNodeIsStyleDimDefined(child, crossAxis,
+                                      availableInnerCrossDim)) {
+    childCrossSize = availableInnerCrossDim;
+    childCrossMeasureMode = YGFloatIsUndefined(childCrossSize)
+                                ? YGMeasureModeUndefined
+                                : YGMeasureModeAtMost;
+  } else {
+    childCrossSize =
+        YGResolveValue(YGResolvedDimensionOf(child, crossDimension),
+                       availableInnerCrossDim) +
+        marginCross;
+    const bool isLoosePercentageMeasurement =
+        YGResolvedDimensionOf(child, crossDimension)->unit == YGUnitPercent &&
+        measureModeCrossDim != YGMeasureModeExactly;
+    childCrossMeasureMode =
+        YGFloatIsUndefined(childCrossSize) || isLoosePercentageMeasurement
+            ? YGMeasureModeUndefined
+            : YGMeasureModeExactly;
+  }
+
+  YGConstrainMaxSizeForMode(child, mainAxis, availableInnerMainDim,
+                            availableInnerWidth, &childMainMeasureMode,
+                            &childMainSize);
+  YGConstrainMaxSizeForMode(child, crossAxis, availableInnerCrossDim,
+                            availableInnerWidth, &childCrossMeasureMode,
+                            &childCrossSize);
+
+  const bool requiresStretchLayout =
+      !YGNodeIsStyleDimDefined(child, crossAxis, availableInnerCrossDim) &&
+      YGNodeAlignItem(node, child) == YGAlignStretch;
+
+  const float childWidth = isMainAxisRow ? childMainSize : childCrossSize;
+  const float childHeight = !isMainAxisRow ? childMainSize : childCrossSize;
+
+  const YGMeasureMode childWidthMeasureMode =
+      isMainAxisRow ? childMainMeasureMode : childCrossMeasureMode;
+  const YGMeasureMode childHeightMeasureMode =
+      !isMainAxisRow ? childMainMeasureMode : childCrossMeasureMode;
+
+  // Recursively call the layout algorithm for this child with the updated
+  // main size.
+  YGLayoutContextAllowDeferral(layoutContext, node);
+  YGLayoutNodeInternal(
+      child, childWidth, childHeight, container->direction,
+      childWidthMeasureMode, childHeightMeasureMode, availableInnerWidth,
+      container->availableInnerHeight,
+      container->performLayout && !requiresStretchLayout, "flex",
+      container->config, layoutContext);
+  node->layout.hadOverflow |= child->layout.hadOverflow;
+}
+
+// STEP 5: lays out the items of the line at the main sizes resolved in the
+// flex line scratch.
+YG_LAYOUT_KERNEL void YGLayoutFlexItemsKernel(
+    const YGContainerLayout *const container, YGLineLayout *const line,
+    const bool isMainAxisRow, const bool isNodeFlexWrap) {
+  float deltaFreeSpace = 0;
+  uint32_t index = 0;
+  for (YGNodeRef child = line->firstRelativeChild; child != NULL;
+       child = child->nextChild, index++) {
+    // Laying out the previous child may have moved the scratch.
+    const YGFlexLine items = YGLayoutContextGetFlexLine(
+        container->layoutContext, line->lineOffset, line->itemsOnLine);
+    const float updatedMainSize = items.size[index];
+    deltaFreeSpace -= updatedMainSize - items.basis[index];
+    YGLayoutFlexItem(container, child, updatedMainSize,
+                     line->availableInnerMainDim, isMainAxisRow,
+                     isNodeFlexWrap);
+  }
+
+  line->deltaFreeSpace = deltaFreeSpace;
+}
+
+// STEP 6: distributes the remaining space along the main axis, positions the
+// children on it and measures the line.
+YG_LAYOUT_KERNEL void YGJustifyFlexLineKernel(
+    const YGContainerLayout *const container, YGLineLayout *const line,
+    const bool isMainAxisRow, const bool hasOutOfFlowChildren) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis =
+      YGFlexDirectionOnAxis(container->mainAxis, isMainAxisRow);
+  const YGFlexDirection crossAxis =
+      YGFlexDirectionOnAxis(container->crossAxis, !isMainAxisRow);
+  const float availableInnerWidth = container->availableInnerWidth;
+  const float remainingFreeSpace = line->remainingFreeSpace;
+  const uint32_t itemsOnLine = line->itemsOnLine;
+
+  int numberOfAutoMarginsOnCurrentLine = 0;
+  for (uint32_t cursor = line->startCursor; cursor != line->endCursor;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (!hasOutOfFlowChildren ||
+        YGStyleOf(child)->positionType == YGPositionTypeRelative) {
+      if (YGMarginLeadingUnit(child, mainAxis) == YGUnitAuto) {
+        numberOfAutoMarginsOnCurrentLine++;
+      }
+      if (YGMarginTrailingUnit(child, mainAxis) == YGUnitAuto) {
+        numberOfAutoMarginsOnCurrentLine++;
+      }
+    }
+  }
+
+  // In order to position the elements in the main axis, we have two
+  // controls. The space between the beginning and the first element
+  // and the space between each two elements.
+  float leadingMainDim = 0;
+  float betweenMainDim = 0;
+  if (numberOfAutoMarginsOnCurrentLine == 0) {
+    switch (YGStyleOf(node)->justifyContent) {
+      case YGJustifyCenter:
+        leadingMainDim = remainingFreeSpace / 2;
+        break;
+      case YGJustifyFlexEnd:
+        leadingMainDim = remainingFreeSpace;
+        break;
+      case YGJustifySpaceBetween:
+        if (itemsOnLine > 1) {
+          betweenMainDim = fmaxf(remainingFreeSpace, 0) / (itemsOnLine - 1);
+        } else {
+          betweenMainDim = 0;
+        }
+        break;
+      case YGJustifySpaceAround:
+        // Space on the edges is half of the space between elements
+        betweenMainDim = remainingFreeSpace / itemsOnLine;
+        leadingMainDim = betweenMainDim / 2;
+        break;
+      case YGJustifyFlexStart:
+        break;
+    }
+  }
+
+  float mainDim = container->leadingPaddingAndBorderMain + leadingMainDim;
+  float crossDim = 0;
+
+  for (uint32_t cursor = line->startCursor; cursor != line->endCursor;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (hasOutOfFlowChildren) {
+      if (YGStyleOf(child)->display == YGDisplayNone) {
+        continue;
+      }
+      if (YGStyleOf(child)->positionType == YGPositionTypeAbsolute) {
+        if (YGNodeIsLeadingPosDefined(child, mainAxis)) {
+          if (container->performLayout) {
+            // In case the child is position absolute and has left/top being
+            // defined, we override the position to whatever the user said
+            // (and margin/border).
+            YGPositionOf(child)[pos[mainAxis]] =
+                YGNodeLeadingPosition(child, mainAxis,
+                                      line->availableInnerMainDim) +
+                YGNodeLeadingBorder(node, mainAxis) +
+                YGNodeLeadingMargin(child, mainAxis, availableInnerWidth);
+          }
+        } else if (container->performLayout) {
+          YGPositionOf(child)[pos[mainAxis]] +=
+              YGNodeLeadingBorder(node, mainAxis) + leadingMainDim;
+        }
+        continue;
+      }
+    }
+
+    // Now that we placed the element, we need to update the variables.
+    // We need to do that only for relative elements. Absolute elements
+    // do not take part in that phase.
+    if (YGMarginLeadingUnit(child, mainAxis) == YGUnitAuto) {
+      mainDim += remainingFreeSpace / numberOfAutoMarginsOnCurrentLine;
+    }
+
+    if (container->performLayout) {
+      YGPositionOf(child)[pos[mainAxis]] += mainDim;
+    }
+
+    if (YGMarginTrailingUnit(child, mainAxis) == YGUnitAuto) {
+      mainDim += remainingFreeSpace / numberOfAutoMarginsOnCurrentLine;
+    }
+
+    if (line->canSkipFlex) {
+      // If we skipped the flex step, then we can't rely on the measuredDims
+      // because they weren't computed. This means we can't call
+      // YGNodeDimWithMargin.
+      mainDim += betweenMainDim +
+                 YGNodeMarginForAxis(child, mainAxis, availableInnerWidth) +
+                 child->layout.computedFlexBasis;
+      crossDim = container->availableInnerCrossDim;
+    } else {
+      // The main dimension is the sum of all the elements dimension plus
+      // the spacing.
+      mainDim += betweenMainDim +
+                 YGNodeDimWithMargin(child, mainAxis, availableInnerWidth);
+
+      // The cross dimension is the max of the elements dimension since
+      // there can only be one element in that cross dimension.
+      crossDim = fmaxf(
+          crossDim, YGNodeDimWithMargin(child, crossAxis, availableInnerWidth));
+    }
+  }
+
+  line->mainDim = mainDim;
+  line->crossDim = crossDim;
+}
+
+// Aligns an item of a flex line on the cross axis, stretching it if it asks
+// for it.
+YG_LAYOUT_KERNEL void YGAlignFlexItem(const YGContainerLayout *const container,
+                                      const YGLineLayout *const line,
+                                      const YGNodeRef child,
+                                      const bool isMainAxisRow) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis =
+      YGFlexDirectionOnAxis(container->mainAxis, isMainAxisRow);
+  const YGFlexDirection crossAxis =
+      YGFlexDirectionOnAxis(container->crossAxis, !isMainAxisRow);
+  const YGDimension mainDimension =
+      isMainAxisRow ? YGDimensionWidth : YGDimensionHeight;
+  const float availableInnerWidth = container->availableInnerWidth;
+  const float availableInnerCrossDim = container->availableInnerCrossDim;
+
+  float leadingCrossDim = container->leadingPaddingAndBorderCross;
+
+  // For a relative children, we're either using alignItems (parent) or
+  // alignSelf (child) in order to determine the position in the cross axis
+  const YGAlign alignItem = YGNodeAlignItem(node, child);
+
+  // If the child uses align stretch, we need to lay it out one more time,
+  // this time forcing the cross-axis size to be the computed cross size for
+  // the current line.
+  if (alignItem == YGAlignStretch &&
+      YGMarginLeadingUnit(child, crossAxis) != YGUnitAuto &&
+      YGMarginTrailingUnit(child, crossAxis) != YGUnitAuto) {
+    // If the child defines a definite size for its cross axis, there's
+    // no need to stretch.
+    if (!YGNodeIsStyleDimDefined(child, crossAxis, availableInnerCrossDim)) {
+      float childMainSize = YGMeasuredDimensionsOf(child)[mainDimension];
+      const float aspectRatio = YGStyleOf(child)->aspectRatio;
+      float childCrossSize =
+          !YGFloatIsUndefined(aspectRatio)
+              ? ((YGNodeMarginForAxis(child, crossAxis, availableInnerWidth) +
+                  (isMainAxisRow ? childMainSize / aspectRatio
+                                 : childMainSize * aspectRatio)))
+              : line->crossDim;
+
+      childMainSize +=
+          YGNodeMarginForAxis(child, mainAxis, availableInnerWidth);
+
+      YGMeasureMode childMainMeasureMode = YGMeasureModeExactly;
+      YGMeasureMode childCrossMeasureMode = YGMeasureModeExactly;
+      YGConstrainMaxSizeForMode(child, mainAxis, line->availableInnerMainDim,
+                                availableInnerWidth, &childMainMeasureMode,
+                                &childMainSize);
+      YGConstrainMaxSizeForMode(child, crossAxis, availableInnerCrossDim,
+                                availableInnerWidth, &childCrossMeasureMode,
+                                &childCrossSize);
+
+      const float childWidth = isMainAxisRow ? childMainSize : childCrossSize;
+      const float childHeight = !isMainAxisRow ? childMainSize : childCrossSize;
+
+      const YGMeasureMode childWidthMeasureMode =
+          YGFloatIsUndefined(childWidth) ? YGMeasureModeUndefined
+                                         : YGMeasureModeExactly;
+      const YGMeasureMode childHeightMeasureMode =
+          YGFloatIsUndefined(childHeight) ? YGMeasureModeUndefined
+                                          : YGMeasureModeExactly;
+
+      YGLayoutContextAllowDeferral(container->layoutContext, NULL);
+      YGLayoutNodeInternal(child, childWidth, childHeight, container->direction,
+                           childWidthMeasureMode, childHeightMeasureMode,
+                           availableInnerWidth, container->availableInnerHeight,
+                           true, "stretch", container->config,
+                           container->layoutContext);
+    }
+  } else {
+    const float remainingCrossDim =
+        line->containerCrossAxis -
+        YGNodeDimWithMargin(child, crossAxis, availableInnerWidth);
+
+    if (YGMarginLeadingUnit(child, crossAxis) == YGUnitAuto &&
+        YGMarginTrailingUnit(child, crossAxis) == YGUnitAuto) {
+      leadingCrossDim += fmaxf(0.0f, remainingCrossDim / 2);
+    } else if (YGMarginTrailingUnit(child, crossAxis) == YGUnitAuto) {
+      // No-Op
+    } else if (YGMarginLeadingUnit(child, crossAxis) == YGUnitAuto) {
+      leadingCrossDim += fmaxf(0.0f, remainingCrossDim);
+    } else if (alignItem == YGAlignFlexStart) {
+      // No-Op
+    } else if (alignItem == YGAlignCenter) {
+      leadingCrossDim += remainingCrossDim / 2;
+    } else {
+      leadingCrossDim += remainingCrossDim;
+    }
+  }
+  // And we apply the position
+  YGPositionOf(child)[pos[crossAxis]] +=
+      line->totalLineCrossDim + leadingCrossDim;
+}
+
+// STEP 7: aligns the children of the line on the cross axis, stretching the
+// ones that ask for it.
+YG_LAYOUT_KERNEL void YGAlignFlexLineKernel(
+    const YGContainerLayout *const container, YGLineLayout *const line,
+    const bool isMainAxisRow, const bool hasOutOfFlowChildren) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection crossAxis =
+      YGFlexDirectionOnAxis(container->crossAxis, !isMainAxisRow);
+  const float availableInnerWidth = container->availableInnerWidth;
+  const float availableInnerCrossDim = container->availableInnerCrossDim;
+
+  for (uint32_t cursor = line->startCursor; cursor != line->endCursor;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (hasOutOfFlowChildren) {
+      if (YGStyleOf(child)->display == YGDisplayNone) {
+        continue;
+      }
+      if (YGStyleOf(child)->positionType == YGPositionTypeAbsolute) {
+        // If the child is absolutely positioned and has a
+        // top/left/bottom/right set, override all the previously computed
+        // positions to set it correctly.
+        const bool isChildLeadingPosDefined =
+            YGNodeIsLeadingPosDefined(child, crossAxis);
+        if (isChildLeadingPosDefined) {
+          YGPositionOf(child)[pos[crossAxis]] =
+              YGNodeLeadingPosition(child, crossAxis, availableInnerCrossDim) +
+              YGNodeLeadingBorder(node, crossAxis) +
+              YGNodeLeadingMargin(child, crossAxis, availableInnerWidth);
+        }
+        // If leading position is not defined or calculations result in Nan,
+        // default to border + margin
+        if (!isChildLeadingPosDefined ||
+            YGFloatIsUndefined(YGPositionOf(child)[pos[crossAxis]])) {
+          YGPositionOf(child)[pos[crossAxis]] =
+              YGNodeLeadingBorder(node, crossAxis) +
+              YGNodeLeadingMargin(child, crossAxis, availableInnerWidth);
+        }
+        continue;
+      }
+    }
+
+    YGAlignFlexItem(container, line, child, isMainAxisRow);
+  }
+}
+
+typedef void (*YGLineKernel)(const YGContainerLayout *const container,
+                             YGLineLayout *const line);
+
+typedef struct YGLayoutKernels {
+  YGLineKernel collect;
+  YGLineKernel layoutItems;
+  YGLineKernel justify;
+  YGLineKernel align;
+} YGLayoutKernels;
+
+#define YG_LINE_KERNEL_IMPL(kernel, name, ...)                             \
+  static void kernel##name(const YGContainerLayout *const container,      \
+                           YGLineLayout *const line) {                    \
+    kernel##Kernel(container, line, __VA_ARGS__);                         \
+  }
+
+// The copies for a container, by its axis and whether it wraps and has
+// children out of the flow. Any of the last two may be left empty.
+#define YG_LAYOUT_KERNELS(axis, wrap, outOfFlow)                            \
+  {                                                                         \
+    YGCollectFlexLine##axis##wrap##outOfFlow, YGLayoutFlexItems##axis##wrap, \
+        YGJustifyFlexLine##axis##outOfFlow, YGAlignFlexLine##axis##outOfFlow \
+  }
+
+// The generic copies test the branches per child, as the loops used to.
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, Generic, container->isMainAxisRow,
+                    container->isNodeFlexWrap, container->hasOutOfFlowChildren)
+YG_LINE_KERNEL_IMPL(YGLayoutFlexItems, Generic, container->isMainAxisRow,
+                    container->isNodeFlexWrap)
+YG_LINE_KERNEL_IMPL(YGJustifyFlexLine, Generic, container->isMainAxisRow,
+                    container->hasOutOfFlowChildren)
+YG_LINE_KERNEL_IMPL(YGAlignFlexLine, Generic, container->isMainAxisRow,
+                    container->hasOutOfFlowChildren)
+
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, Column, false, false, false)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, Row, true, false, false)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, ColumnWrap, false, true, false)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, RowWrap, true, true, false)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, ColumnOutOfFlow, false, false, true)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, RowOutOfFlow, true, false, true)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, ColumnWrapOutOfFlow, false, true, true)
+YG_LINE_KERNEL_IMPL(YGCollectFlexLine, RowWrapOutOfFlow, true, true, true)
+
+YG_LINE_KERNEL_IMPL(YGLayoutFlexItems, Column, false, false)
+YG_LINE_KERNEL_IMPL(YGLayoutFlexItems, Row, true, false)
+YG_LINE_KERNEL_IMPL(YGLayoutFlexItems, ColumnWrap, false, true)
+YG_LINE_KERNEL_IMPL(YGLayoutFlexItems, RowWrap, true, true)
+
+YG_LINE_KERNEL_IMPL(YGJustifyFlexLine, Column, false, false)
+YG_LINE_KERNEL_IMPL(YGJustifyFlexLine, Row, true, false)
+YG_LINE_KERNEL_IMPL(YGJustifyFlexLine, ColumnOutOfFlow, false, true)
+YG_LINE_KERNEL_IMPL(YGJustifyFlexLine, RowOutOfFlow, true, true)
+
+YG_LINE_KERNEL_IMPL(YGAlignFlexLine, Column, false, false)
+YG_LINE_KERNEL_IMPL(YGAlignFlexLine, Row, true, false)
+YG_LINE_KERNEL_IMPL(YGAlignFlexLine, ColumnOutOfFlow, false, true)
+YG_LINE_KERNEL_IMPL(YGAlignFlexLine, RowOutOfFlow, true, true)
+
+static const YGLayoutKernels gYGGenericLayoutKernels =
+    YG_LAYOUT_KERNELS(Generic, , );
+
+// Indexed by isMainAxisRow | isNodeFlexWrap << 1 | hasOutOfFlowChildren << 2.
+static const YGLayoutKernels gYGLayoutKernels[8] = {
+    YG_LAYOUT_KERNELS(Column, , ),
+    YG_LAYOUT_KERNELS(Row, , ),
+    YG_LAYOUT_KERNELS(Column, Wrap, ),
+    YG_LAYOUT_KERNELS(Row, Wrap, ),
+    YG_LAYOUT_KERNELS(Column, , OutOfFlow),
+    YG_LAYOUT_KERNELS(Row, , OutOfFlow),
+    YG_LAYOUT_KERNELS(Column, Wrap, OutOfFlow),
+    YG_LAYOUT_KERNELS(Row, Wrap, OutOfFlow),
+};
+
+static const YGLayoutKernels *YGLayoutKernelsForContainer(
+    const YGContainerLayout *const container) {
+  if (container->config->useGenericLayoutKernels) {
+    return &gYGGenericLayoutKernels;
+  }
+  return &gYGLayoutKernels[(uint32_t)container->isMainAxisRow |
+                           (uint32_t)container->isNodeFlexWrap << 1 |
+                           (uint32_t)container->hasOutOfFlowChildren << 2];
+}
+
+// Simple stacks are containers whose children keep their flex bases and are
+// packed at the start of a single line, like most rows and columns of an
+// interface. They skip the flex line machinery, see YGLayoutSimpleStack.
+static bool YGNodeComputeIsSimpleStack(const YGNodeRef node) {
+  if (YGStyleOf(node)->flexWrap != YGWrapNoWrap ||
+      YGStyleOf(node)->justifyContent != YGJustifyFlexStart ||
+      YGStyleOf(node)->alignItems == YGAlignBaseline) {
+    return false;
+  }
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    const YGStyle *const style = YGStyleOf(child);
+    if (style->positionType != YGPositionTypeRelative ||
+        style->display != YGDisplayFlex ||
+        style->alignSelf == YGAlignBaseline || YGResolveFlexGrow(child) != 0 ||
+        YGNodeResolveFlexShrink(child) != 0 ||
+        style->flexBasis.unit == YGUnitPercent) {
+      return false;
+    }
+    for (uint32_t dim = YGDimensionWidth; dim <= YGDimensionHeight; dim++) {
+      if (style->dimensions[dim].unit == YGUnitPercent ||
+          style->minDimensions[dim].unit == YGUnitPercent ||
+          style->maxDimensions[dim].unit == YGUnitPercent) {
+        return false;
+      }
+    }
+    // Percent and auto both have the high bit of their two bit unit set.
+    if (((style->edgeUnits[YGEdgePropertyMargin] |
+          style->edgeUnits[YGEdgePropertyPadding]) &
+         0xAAAAAAAAu) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static inline bool YGNodeIsSimpleStack(const YGNodeRef node) {
+  if (node->simpleStack == YG_SIMPLE_STACK_UNKNOWN) {
+    node->simpleStack = YGNodeComputeIsSimpleStack(node)
+                            ? YG_SIMPLE_STACK_YES
+                            : YG_SIMPLE_STACK_NO;
+  }
+  return node->simpleStack == YG_SIMPLE_STACK_YES;
+}
+
+// STEPs 3 to 7 for a simple stack. The flex bases are resolved first, as the
+// length of the stack may depend on all of them, then a single pass lays out
+// the children at their bases and positions them. It aligns them too when
+// the cross size of the stack is known; otherwise that takes a second pass.
+YG_LAYOUT_KERNEL void YGLayoutSimpleStackKernel(
+    const YGContainerLayout *const container, YGLineLayout *const line,
+    const bool isMainAxisRow) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis =
+      YGFlexDirectionOnAxis(container->mainAxis, isMainAxisRow);
+  const YGFlexDirection crossAxis =
+      YGFlexDirectionOnAxis(container->crossAxis, !isMainAxisRow);
+  const YGDimension mainDimension =
+      isMainAxisRow ? YGDimensionWidth : YGDimensionHeight;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  const float availableInnerWidth = container->availableInnerWidth;
+  const float availableInnerCrossDim = container->availableInnerCrossDim;
+  const float mainAxisParentSize = container->mainAxisParentSize;
+  const bool performLayout = container->performLayout;
+  YGLayoutContext *const layoutContext = container->layoutContext;
+
+  float sizeConsumed = 0;
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    YGResolveDimensions(child);
+    if (performLayout) {
+      child->layout.positionGenerationCount = layoutContext->generation;
+      const YGDirection childDirection =
+          YGNodeResolveDirection(child, container->direction);
+      YGNodeSetPosition(child, childDirection, line->availableInnerMainDim,
+                        availableInnerCrossDim, availableInnerWidth);
+    }
+    YGNodeComputeFlexBasisForChild(
+        node, child, availableInnerWidth, container->widthMeasureMode,
+        container->availableInnerHeight, availableInnerWidth,
+        container->availableInnerHeight, container->heightMeasureMode,
+        container->direction, container->config, layoutContext);
+    child->lineIndex = 0;
+    const YGStyle *const childStyle = YGStyleOf(child);
+    sizeConsumed +=
+        fmaxf(YGResolveValue(&childStyle->minDimensions[mainDimension],
+                             mainAxisParentSize),
+              fminf(YGResolveValue(&childStyle->maxDimensions[mainDimension],
+                                   mainAxisParentSize),
+                    child->layout.computedFlexBasis)) +
+        YGNodeMarginForAxis(child, mainAxis, availableInnerWidth);
+  }
+
+  // Unless its length is given, the stack is as long as its children.
+  float availableInnerMainDim = line->availableInnerMainDim;
+  if (container->measureModeMainDim != YGMeasureModeExactly) {
+    if (!YGFloatIsUndefined(container->minInnerMainDim) &&
+        sizeConsumed < container->minInnerMainDim) {
+      availableInnerMainDim = container->minInnerMainDim;
+    } else if (!YGFloatIsUndefined(container->maxInnerMainDim) &&
+               sizeConsumed > container->maxInnerMainDim) {
+      availableInnerMainDim = container->maxInnerMainDim;
+    } else if (!node->config->useLegacyStretchBehaviour) {
+      availableInnerMainDim = sizeConsumed;
+    }
+  }
+  float remainingFreeSpace = 0;
+  if (!YGFloatIsUndefined(availableInnerMainDim)) {
+    remainingFreeSpace = availableInnerMainDim - sizeConsumed;
+  } else if (sizeConsumed < 0) {
+    remainingFreeSpace = -sizeConsumed;
+  }
+  node->layout.hadOverflow |= (remainingFreeSpace < 0);
+
+  // A line of a stack sized on its cross axis is as thick as the stack.
+  const bool isCrossDimExact =
+      container->measureModeCrossDim == YGMeasureModeExactly;
+  const bool canSkipFlex = !performLayout && isCrossDimExact;
+  line->availableInnerMainDim = availableInnerMainDim;
+  line->totalLineCrossDim = 0;
+  line->containerCrossAxis = availableInnerCrossDim;
+  line->crossDim =
+      YGNodeBoundAxis(node, crossAxis,
+                      availableInnerCrossDim +
+                          container->paddingAndBorderAxisCross,
+                      container->crossAxisParentSize, container->parentWidth) -
+      container->paddingAndBorderAxisCross;
+
+  float mainDim = container->leadingPaddingAndBorderMain;
+  float crossDim = 0;
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (canSkipFlex) {
+      mainDim += YGNodeMarginForAxis(child, mainAxis, availableInnerWidth) +
+                 child->layout.computedFlexBasis;
+      continue;
+    }
+
+    const float childFlexBasis = fminf(
+        YGResolveValue(&YGStyleOf(child)->maxDimensions[mainDimension],
+                       mainAxisParentSize),
+        fmaxf(YGResolveValue(&YGStyleOf(child)->minDimensions[mainDimension],
+                             mainAxisParentSize),
+              child->layout.computedFlexBasis));
+    YGLayoutFlexItem(container, child, childFlexBasis, availableInnerMainDim,
+                     isMainAxisRow, false);
+    if (performLayout) {
+      YGPositionOf(child)[pos[mainAxis]] += mainDim;
+    }
+    mainDim += YGNodeDimWithMargin(child, mainAxis, availableInnerWidth);
+    crossDim = fmaxf(
+        crossDim, YGNodeDimWithMargin(child, crossAxis, availableInnerWidth));
+    if (performLayout && isCrossDimExact) {
+      YGAlignFlexItem(container, line, child, isMainAxisRow);
+    }
+  }
+  line->mainDim = mainDim + container->trailingPaddingAndBorderMain;
+
+  if (!isCrossDimExact) {
+    line->crossDim =
+        YGNodeBoundAxis(node, crossAxis,
+                        crossDim + container->paddingAndBorderAxisCross,
+                        container->crossAxisParentSize,
+                        container->parentWidth) -
+        container->paddingAndBorderAxisCross;
+    line->containerCrossAxis = line->crossDim;
+    if (performLayout) {
+      for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+           cursor = YGChildCursorNext(node, cursor)) {
+        YGAlignFlexItem(container, line, YGChildAtCursor(node, cursor),
+                        isMainAxisRow);
+      }
+    }
+  }
+}
+
+static void YGLayoutSimpleStack(const YGContainerLayout *const container,
+                                YGLineLayout *const line) {
+  if (container->isMainAxisRow) {
+    YGLayoutSimpleStackKernel(container, line, true);
+  } else {
+    YGLayoutSimpleStackKernel(container, line, false);
+  }
+}
+
+// STEP 9: sets the measured dimensions of the container from the size of its
+// lines, unless they are given.
+static void YGNodeSetContainerDimensions(
+    const YGContainerLayout *const container,
+    const float availableInnerMainDim, const float maxLineMainDim,
+    const float totalLineCrossDim) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis = container->mainAxis;
+  const YGFlexDirection crossAxis = container->crossAxis;
+  const YGMeasureMode measureModeMainDim = container->measureModeMainDim;
+  const YGMeasureMode measureModeCrossDim = container->measureModeCrossDim;
+  const float parentWidth = container->parentWidth;
+  const float paddingAndBorderAxisMain = container->paddingAndBorderAxisMain;
+  const float paddingAndBorderAxisCross = container->paddingAndBorderAxisCross;
+
+  YGMeasuredDimensionsOf(node)[YGDimensionWidth] = YGNodeBoundAxis(
+      node, YGFlexDirectionRow,
+      container->availableWidth - container->marginAxisRow, parentWidth,
+      parentWidth);
+  YGMeasuredDimensionsOf(node)[YGDimensionHeight] = YGNodeBoundAxis(
+      node, YGFlexDirectionColumn,
+      container->availableHeight - container->marginAxisColumn,
+      container->parentHeight, parentWidth);
+
+  // If the user didn't specify a width or height for the node, set the
+  // dimensions based on the children.
+  if (measureModeMainDim == YGMeasureModeUndefined ||
+      (YGStyleOf(node)->overflow != YGOverflowScroll &&
+       measureModeMainDim == YGMeasureModeAtMost)) {
+    // Clamp the size to the min/max size, if specified, and make sure it
+    // doesn't go below the padding and border amount.
+    YGMeasuredDimensionsOf(node)[dim[mainAxis]] =
+        YGNodeBoundAxis(node, mainAxis, maxLineMainDim,
+                        container->mainAxisParentSize, parentWidth);
+  } else if (measureModeMainDim == YGMeasureModeAtMost &&
+             YGStyleOf(node)->overflow == YGOverflowScroll) {
+    YGMeasuredDimensionsOf(node)[dim[mainAxis]] = fmaxf(
+        fminf(availableInnerMainDim + paddingAndBorderAxisMain,
+              YGNodeBoundAxisWithinMinAndMax(node, mainAxis, maxLineMainDim,
+                                             container->mainAxisParentSize)),
+        paddingAndBorderAxisMain);
+  }
+
+  if (measureModeCrossDim == YGMeasureModeUndefined ||
+      (YGStyleOf(node)->overflow != YGOverflowScroll &&
+       measureModeCrossDim == YGMeasureModeAtMost)) {
+    // Clamp the size to the min/max size, if specified, and make sure it
+    // doesn't go below the padding and border amount.
+    YGMeasuredDimensionsOf(node)[dim[crossAxis]] = YGNodeBoundAxis(
+        node, crossAxis, totalLineCrossDim + paddingAndBorderAxisCross,
+        container->crossAxisParentSize, parentWidth);
+  } else if (measureModeCrossDim == YGMeasureModeAtMost &&
+             YGStyleOf(node)->overflow == YGOverflowScroll) {
+    YGMeasuredDimensionsOf(node)[dim[crossAxis]] =
+        fmaxf(fminf(container->availableInnerCrossDim +
+                        paddingAndBorderAxisCross,
+                    YGNodeBoundAxisWithinMinAndMax(
+                        node, crossAxis,
+                        totalLineCrossDim + paddingAndBorderAxisCross,
+                        container->crossAxisParentSize)),
+              paddingAndBorderAxisCross);
+  }
+}
+
+// STEP 11: sets the trailing positions of the children on reversed axes.
+static void YGNodeSetTrailingPositions(
+    const YGContainerLayout *const container) {
+  const YGNodeRef node = container->node;
+  const YGFlexDirection mainAxis = container->mainAxis;
+  const YGFlexDirection crossAxis = container->crossAxis;
+  const bool needsMainTrailingPos = mainAxis == YGFlexDirectionRowReverse ||
+                                    mainAxis == YGFlexDirectionColumnReverse;
+  const bool needsCrossTrailingPos = crossAxis == YGFlexDirectionRowReverse ||
+                                     crossAxis == YGFlexDirectionColumnReverse;
+  if (!needsMainTrailingPos && !needsCrossTrailingPos) {
+    return;
+  }
+
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (YGStyleOf(child)->display == YGDisplayNone) {
+      continue;
+    }
+    if (needsMainTrailingPos) {
+      YGNodeSetChildTrailingPosition(node, child, mainAxis);
+    }
+
+    if (needsCrossTrailingPos) {
+      YGNodeSetChildTrailingPosition(node, child, crossAxis);
+    }
+  }
+}
+
 // This is the main routine that implements a subset of the flexbox layout
 // algorithm
 // described in the W3C YG documentation: https://www.w3.org/TR/YG3-flexbox/.
@@ -2188,7 +4899,8 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
                              const YGMeasureMode heightMeasureMode,
                              const float parentWidth, const float parentHeight,
                              const bool performLayout,
-                             const YGConfigRef config) {
+                             const YGConfigRef config,
+                             YGLayoutContext *const layoutContext) {
   YGAssertWithNode(node,
                    YGFloatIsUndefined(availableWidth)
                        ? widthMeasureMode == YGMeasureModeUndefined
@@ -2211,46 +4923,56 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
   const YGFlexDirection flexColumnDirection =
       YGResolveFlexDirection(YGFlexDirectionColumn, direction);
 
-  node->layout.margin[YGEdgeStart] =
+  YGLayoutEdges edges = {{0}};
+  edges.margin[YGEdgeStart] =
       YGNodeLeadingMargin(node, flexRowDirection, parentWidth);
-  node->layout.margin[YGEdgeEnd] =
+  edges.margin[YGEdgeEnd] =
       YGNodeTrailingMargin(node, flexRowDirection, parentWidth);
-  node->layout.margin[YGEdgeTop] =
+  edges.margin[YGEdgeTop] =
       YGNodeLeadingMargin(node, flexColumnDirection, parentWidth);
-  node->layout.margin[YGEdgeBottom] =
+  edges.margin[YGEdgeBottom] =
       YGNodeTrailingMargin(node, flexColumnDirection, parentWidth);
 
-  node->layout.border[YGEdgeStart] =
-      YGNodeLeadingBorder(node, flexRowDirection);
-  node->layout.border[YGEdgeEnd] = YGNodeTrailingBorder(node, flexRowDirection);
-  node->layout.border[YGEdgeTop] =
-      YGNodeLeadingBorder(node, flexColumnDirection);
-  node->layout.border[YGEdgeBottom] =
-      YGNodeTrailingBorder(node, flexColumnDirection);
+  edges.border[YGEdgeStart] = YGNodeLeadingBorder(node, flexRowDirection);
+  edges.border[YGEdgeEnd] = YGNodeTrailingBorder(node, flexRowDirection);
+  edges.border[YGEdgeTop] = YGNodeLeadingBorder(node, flexColumnDirection);
+  edges.border[YGEdgeBottom] = YGNodeTrailingBorder(node, flexColumnDirection);
 
-  node->layout.padding[YGEdgeStart] =
+  edges.padding[YGEdgeStart] =
       YGNodeLeadingPadding(node, flexRowDirection, parentWidth);
-  node->layout.padding[YGEdgeEnd] =
+  edges.padding[YGEdgeEnd] =
       YGNodeTrailingPadding(node, flexRowDirection, parentWidth);
-  node->layout.padding[YGEdgeTop] =
+  edges.padding[YGEdgeTop] =
       YGNodeLeadingPadding(node, flexColumnDirection, parentWidth);
-  node->layout.padding[YGEdgeBottom] =
+  edges.padding[YGEdgeBottom] =
       YGNodeTrailingPadding(node, flexColumnDirection, parentWidth);
 
+  // Nodes without margin, border and padding never allocate the block; the
+  // getters report zero for them.
+  static const YGLayoutEdges kZeroEdges = {{0}};
+  if (node->layout.edges == NULL &&
+      memcmp(&edges, &kZeroEdges, sizeof(YGLayoutEdges)) != 0) {
+    node->layout.edges = YGNodeAllocColdBlock(node, sizeof(YGLayoutEdges));
+  }
+  if (node->layout.edges != NULL) {
+    memcpy(node->layout.edges, &edges, sizeof(YGLayoutEdges));
+  }
+
   if (node->measure) {
     YGNodeWithMeasureFuncSetMeasuredDimensions(
         node, availableWidth, availableHeight, widthMeasureMode,
-        heightMeasureMode, parentWidth, parentHeight);
+        heightMeasureMode, parentWidth, parentHeight, layoutContext);
     return;
   }
 
-  const uint32_t childCount = YGNodeListCount(node->children);
+  const uint32_t childCount = YGChildCountOf(node);
   if (childCount == 0) {
     YGNodeEmptyContainerSetMeasuredDimensions(
         node, availableWidth, availableHeight, widthMeasureMode,
         heightMeasureMode, parentWidth, parentHeight);
     return;
   }
+  const uint32_t childEnd = YGChildCursorEnd(node);
 
   // If we're not being asked to perform a full layout we can skip the algorithm
   // if we already know the size
@@ -2263,18 +4985,20 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
 
   // At this point we know we're going to perform work. Ensure that each child
   // has a mutable copy.
-  YGCloneChildrenIfNeeded(node);
+  YGCloneChildrenIfNeeded(node, layoutContext);
 
   // Reset layout flags, as they could have changed.
   node->layout.hadOverflow = false;
 
+  // Subtrees of children deferred from here on are joined before STEP 8.
+  const uint32_t deferredStart = layoutContext->deferredCount;
+
   // STEP 1: CALCULATE VALUES FOR REMAINDER OF ALGORITHM
   const YGFlexDirection mainAxis =
-      YGResolveFlexDirection(node->style.flexDirection, direction);
+      YGResolveFlexDirection(YGStyleOf(node)->flexDirection, direction);
   const YGFlexDirection crossAxis = YGFlexDirectionCross(mainAxis, direction);
   const bool isMainAxisRow = YGFlexDirectionIsRow(mainAxis);
-  const YGJustify justifyContent = node->style.justifyContent;
-  const bool isNodeFlexWrap = node->style.flexWrap != YGWrapNoWrap;
+  const bool isNodeFlexWrap = YGStyleOf(node)->flexWrap != YGWrapNoWrap;
 
   const float mainAxisParentSize = isMainAxisRow ? parentWidth : parentHeight;
   const float crossAxisParentSize = isMainAxisRow ? parentHeight : parentWidth;
@@ -2310,19 +5034,19 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
 
   // STEP 2: DETERMINE AVAILABLE SIZE IN MAIN AND CROSS DIRECTIONS
   const float minInnerWidth =
-      YGResolveValue(&node->style.minDimensions[YGDimensionWidth],
+      YGResolveValue(&YGStyleOf(node)->minDimensions[YGDimensionWidth],
                      parentWidth) -
       marginAxisRow - paddingAndBorderAxisRow;
   const float maxInnerWidth =
-      YGResolveValue(&node->style.maxDimensions[YGDimensionWidth],
+      YGResolveValue(&YGStyleOf(node)->maxDimensions[YGDimensionWidth],
                      parentWidth) -
       marginAxisRow - paddingAndBorderAxisRow;
   const float minInnerHeight =
-      YGResolveValue(&node->style.minDimensions[YGDimensionHeight],
+      YGResolveValue(&YGStyleOf(node)->minDimensions[YGDimensionHeight],
                      parentHeight) -
       marginAxisColumn - paddingAndBorderAxisColumn;
   const float maxInnerHeight =
-      YGResolveValue(&node->style.maxDimensions[YGDimensionHeight],
+      YGResolveValue(&YGStyleOf(node)->maxDimensions[YGDimensionHeight],
                      parentHeight) -
       marginAxisColumn - paddingAndBorderAxisColumn;
   const float minInnerMainDim = isMainAxisRow ? minInnerWidth : minInnerHeight;
@@ -2353,13 +5077,63 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
   const float availableInnerCrossDim =
       isMainAxisRow ? availableInnerHeight : availableInnerWidth;
 
+  YGContainerLayout container = {
+      .node = node,
+      .config = config,
+      .layoutContext = layoutContext,
+      .direction = direction,
+      .mainAxis = mainAxis,
+      .crossAxis = crossAxis,
+      .isMainAxisRow = isMainAxisRow,
+      .isNodeFlexWrap = isNodeFlexWrap,
+      .performLayout = performLayout,
+      .widthMeasureMode = widthMeasureMode,
+      .heightMeasureMode = heightMeasureMode,
+      .measureModeMainDim = measureModeMainDim,
+      .measureModeCrossDim = measureModeCrossDim,
+      .availableWidth = availableWidth,
+      .availableHeight = availableHeight,
+      .parentWidth = parentWidth,
+      .parentHeight = parentHeight,
+      .mainAxisParentSize = mainAxisParentSize,
+      .crossAxisParentSize = crossAxisParentSize,
+      .marginAxisRow = marginAxisRow,
+      .marginAxisColumn = marginAxisColumn,
+      .minInnerMainDim = minInnerMainDim,
+      .maxInnerMainDim = maxInnerMainDim,
+      .availableInnerWidth = availableInnerWidth,
+      .availableInnerHeight = availableInnerHeight,
+      .availableInnerCrossDim = availableInnerCrossDim,
+      .leadingPaddingAndBorderMain = leadingPaddingAndBorderMain,
+      .trailingPaddingAndBorderMain = trailingPaddingAndBorderMain,
+      .leadingPaddingAndBorderCross = leadingPaddingAndBorderCross,
+      .paddingAndBorderAxisMain = paddingAndBorderAxisMain,
+      .paddingAndBorderAxisCross = paddingAndBorderAxisCross,
+  };
+
+  // Simple stacks skip the flex lines altogether, and have a single line with
+  // neither absolute children nor content alignment: STEPs 8 and 10 are no-ops.
+  if (!config->useGenericLayoutKernels && YGNodeIsSimpleStack(node)) {
+    YGLineLayout lineLayout = {.availableInnerMainDim = availableInnerMainDim};
+    YGLayoutSimpleStack(&container, &lineLayout);
+    YGLayoutContextJoin(layoutContext, deferredStart);
+    YGNodeSetContainerDimensions(&container, lineLayout.availableInnerMainDim,
+                                 fmaxf(0, lineLayout.mainDim),
+                                 lineLayout.crossDim);
+    if (performLayout) {
+      YGNodeSetTrailingPositions(&container);
+    }
+    return;
+  }
+
   // If there is only one child with flexGrow + flexShrink it means we can set
   // the computedFlexBasis to 0 instead of measuring and shrinking / flexing the
   // child to exactly match the remaining space
   YGNodeRef singleFlexChild = NULL;
   if (measureModeMainDim == YGMeasureModeExactly) {
-    for (uint32_t i = 0; i < childCount; i++) {
-      const YGNodeRef child = YGNodeGetChild(node, i);
+    for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+         cursor = YGChildCursorNext(node, cursor)) {
+      const YGNodeRef child = YGChildAtCursor(node, cursor);
       if (singleFlexChild) {
         if (YGNodeIsFlex(child)) {
           // There is already a flexible child, abort.
@@ -2374,18 +5148,23 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
   }
 
   float totalOuterFlexBasis = 0;
+  bool hasOutOfFlowChildren = false;
 
   // STEP 3: DETERMINE FLEX BASIS FOR EACH ITEM
-  for (uint32_t i = 0; i < childCount; i++) {
-    const YGNodeRef child = YGNodeListGet(node->children, i);
-    if (child->style.display == YGDisplayNone) {
-      YGZeroOutLayoutRecursivly(child);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (YGStyleOf(child)->display == YGDisplayNone) {
+      hasOutOfFlowChildren = true;
+      YGZeroOutLayoutRecursivly(child, layoutContext);
+      child->layout.positionGenerationCount = layoutContext->generation;
       child->hasNewLayout = true;
       child->isDirty = false;
       continue;
     }
     YGResolveDimensions(child);
     if (performLayout) {
+      child->layout.positionGenerationCount = layoutContext->generation;
       // Set the initial position (relative to the parent).
       const YGDirection childDirection =
           YGNodeResolveDirection(child, direction);
@@ -2395,9 +5174,10 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
 
     // Absolute-positioned children don't participate in flex layout. Add them
     // to a list that we can process later.
-    if (child->style.positionType == YGPositionTypeAbsolute) {
+    if (YGStyleOf(child)->positionType == YGPositionTypeAbsolute) {
       // Store a private linked list of absolutely positioned children
       // so that we can efficiently traverse them later.
+      hasOutOfFlowChildren = true;
       if (firstAbsoluteChild == NULL) {
         firstAbsoluteChild = child;
       }
@@ -2408,13 +5188,14 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
       child->nextChild = NULL;
     } else {
       if (child == singleFlexChild) {
-        child->layout.computedFlexBasisGeneration = gCurrentGenerationCount;
+        child->layout.computedFlexBasisGeneration = layoutContext->generation;
         child->layout.computedFlexBasis = 0;
+        YGNodeRecordFlexBasis(child, layoutContext);
       } else {
         YGNodeComputeFlexBasisForChild(
             node, child, availableInnerWidth, widthMeasureMode,
             availableInnerHeight, availableInnerWidth, availableInnerHeight,
-            heightMeasureMode, direction, config);
+            heightMeasureMode, direction, config, layoutContext);
       }
     }
 
@@ -2435,9 +5216,17 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
 
   // STEP 4: COLLECT FLEX ITEMS INTO FLEX LINES
 
-  // Indexes of children that represent the first and last items in the line.
-  uint32_t startOfLineIndex = 0;
-  uint32_t endOfLineIndex = 0;
+  container.hasOutOfFlowChildren = hasOutOfFlowChildren;
+  container.flexBasisOverflows = flexBasisOverflows;
+  container.measureModeMainDim = measureModeMainDim;
+  const YGLayoutKernels *const kernels =
+      YGLayoutKernelsForContainer(&container);
+  YGLineLayout lineLayout = {0};
+
+  // Cursors of the children that represent the first and last items in the
+  // line.
+  uint32_t startOfLineCursor = YGChildCursorFirst(node);
+  uint32_t endOfLineCursor = startOfLineCursor;
 
   // Number of lines.
   uint32_t lineCount = 0;
@@ -2448,85 +5237,32 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
   // Max main dimension of all the lines.
   float maxLineMainDim = 0;
 
-  for (; endOfLineIndex < childCount;
-       lineCount++, startOfLineIndex = endOfLineIndex) {
+  for (; endOfLineCursor != childEnd;
+       lineCount++, startOfLineCursor = endOfLineCursor) {
+    // Add items to the current line until it's full or we run out of items.
+    lineLayout.index = lineCount;
+    lineLayout.startCursor = startOfLineCursor;
+    lineLayout.availableInnerMainDim = availableInnerMainDim;
+    kernels->collect(&container, &lineLayout);
+    endOfLineCursor = lineLayout.endCursor;
+
     // Number of items on the currently line. May be different than the
-    // difference
-    // between start and end indicates because we skip over absolute-positioned
-    // items.
-    uint32_t itemsOnLine = 0;
+    // difference between start and end indicates because we skip over
+    // absolute-positioned items.
+    const uint32_t itemsOnLine = lineLayout.itemsOnLine;
 
     // sizeConsumedOnCurrentLine is accumulation of the dimensions and margin
     // of all the children on the current line. This will be used in order to
     // either set the dimensions of the node if none already exist or to compute
     // the remaining space left for the flexible children.
-    float sizeConsumedOnCurrentLine = 0;
-    float sizeConsumedOnCurrentLineIncludingMinConstraint = 0;
-
-    float totalFlexGrowFactors = 0;
-    float totalFlexShrinkScaledFactors = 0;
-
-    // Maintain a linked list of the child nodes that can shrink and/or grow.
-    YGNodeRef firstRelativeChild = NULL;
-    YGNodeRef currentRelativeChild = NULL;
-
-    // Add items to the current line until it's full or we run out of items.
-    for (uint32_t i = startOfLineIndex; i < childCount; i++, endOfLineIndex++) {
-      const YGNodeRef child = YGNodeListGet(node->children, i);
-      if (child->style.display == YGDisplayNone) {
-        continue;
-      }
-      child->lineIndex = lineCount;
-
-      if (child->style.positionType != YGPositionTypeAbsolute) {
-        const float childMarginMainAxis =
-            YGNodeMarginForAxis(child, mainAxis, availableInnerWidth);
-        const float flexBasisWithMaxConstraints =
-            fminf(YGResolveValue(&child->style.maxDimensions[dim[mainAxis]],
-                                 mainAxisParentSize),
-                  child->layout.computedFlexBasis);
-        const float flexBasisWithMinAndMaxConstraints =
-            fmaxf(YGResolveValue(&child->style.minDimensions[dim[mainAxis]],
-                                 mainAxisParentSize),
-                  flexBasisWithMaxConstraints);
-
-        // If this is a multi-line flow and this item pushes us over the
-        // available size, we've
-        // hit the end of the current line. Break out of the loop and lay out
-        // the current line.
-        if (sizeConsumedOnCurrentLineIncludingMinConstraint +
-                    flexBasisWithMinAndMaxConstraints + childMarginMainAxis >
-                availableInnerMainDim &&
-            isNodeFlexWrap && itemsOnLine > 0) {
-          break;
-        }
-
-        sizeConsumedOnCurrentLineIncludingMinConstraint +=
-            flexBasisWithMinAndMaxConstraints + childMarginMainAxis;
-        sizeConsumedOnCurrentLine +=
-            flexBasisWithMinAndMaxConstraints + childMarginMainAxis;
-        itemsOnLine++;
-
-        if (YGNodeIsFlex(child)) {
-          totalFlexGrowFactors += YGResolveFlexGrow(child);
+    const float sizeConsumedOnCurrentLine = lineLayout.sizeConsumed;
 
-          // Unlike the grow factor, the shrink factor is scaled relative to the
-          // child dimension.
-          totalFlexShrinkScaledFactors +=
-              -YGNodeResolveFlexShrink(child) * child->layout.computedFlexBasis;
-        }
+    float totalFlexGrowFactors = lineLayout.totalFlexGrowFactors;
+    float totalFlexShrinkScaledFactors =
+        lineLayout.totalFlexShrinkScaledFactors;
 
-        // Store a private linked list of children that need to be layed out.
-        if (firstRelativeChild == NULL) {
-          firstRelativeChild = child;
-        }
-        if (currentRelativeChild != NULL) {
-          currentRelativeChild->nextChild = child;
-        }
-        currentRelativeChild = child;
-        child->nextChild = NULL;
-      }
-    }
+    // The linked list of the child nodes that can shrink and/or grow.
+    const YGNodeRef firstRelativeChild = lineLayout.firstRelativeChild;
 
     // The total flex factor needs to be floored to 1.
     if (totalFlexGrowFactors > 0 && totalFlexGrowFactors < 1) {
@@ -2543,12 +5279,6 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
     const bool canSkipFlex =
         !performLayout && measureModeCrossDim == YGMeasureModeExactly;
 
-    // In order to position the elements in the main axis, we have two
-    // controls. The space between the beginning and the first element
-    // and the space between each two elements.
-    float leadingMainDim = 0;
-    float betweenMainDim = 0;
-
     // STEP 5: RESOLVING FLEXIBLE LENGTHS ON MAIN AXIS
     // Calculate the remaining available space that needs to be allocated.
     // If the main dimension size isn't known, it is computed based on
@@ -2589,12 +5319,6 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
     float deltaFreeSpace = 0;
 
     if (!canSkipFlex) {
-      float childFlexBasis;
-      float flexShrinkScaledFactor;
-      float flexGrowFactor;
-      float baseMainSize;
-      float boundMainSize;
-
       // Do two passes over the flex items to figure out how to distribute the
       // remaining space.
       // The first pass finds the items whose min/max constraints trigger,
@@ -2617,69 +5341,88 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
       // performance
       // concerns because we know exactly how many passes it'll do.
 
+      // Gather the items into arrays, so that the passes don't have to resolve
+      // the same styles again. The bounds are only needed when there is space
+      // to distribute.
+      const bool hasFreeSpace =
+          remainingFreeSpace < 0 || remainingFreeSpace > 0;
+      const uint32_t lineOffset =
+          YGLayoutContextPushFlexLine(layoutContext, itemsOnLine);
+      YGFlexLine line =
+          YGLayoutContextGetFlexLine(layoutContext, lineOffset, itemsOnLine);
+      uint32_t index = 0;
+      for (YGNodeRef child = firstRelativeChild; child != NULL;
+           child = child->nextChild, index++) {
+        const YGStyle *const childStyle = YGStyleOf(child);
+        const float childFlexBasis = fminf(
+            YGResolveValue(&childStyle->maxDimensions[dim[mainAxis]],
+                           mainAxisParentSize),
+            fmaxf(YGResolveValue(&childStyle->minDimensions[dim[mainAxis]],
+                                 mainAxisParentSize),
+                  child->layout.computedFlexBasis));
+        line.basis[index] = childFlexBasis;
+        line.size[index] = childFlexBasis;
+        if (!hasFreeSpace) {
+          continue;
+        }
+
+        line.shrink[index] = -YGNodeResolveFlexShrink(child) * childFlexBasis;
+        line.grow[index] = YGResolveFlexGrow(child);
+        line.min[index] = -INFINITY;
+        line.max[index] = INFINITY;
+        line.paddingAndBorder[index] = 0;
+        if (line.shrink[index] == 0 && line.grow[index] == 0) {
+          continue;
+        }
+
+        // Same bounds as YGNodeBoundAxis.
+        const float min =
+            YGResolveValue(&childStyle->minDimensions[dim[mainAxis]],
+                           availableInnerMainDim);
+        const float max =
+            YGResolveValue(&childStyle->maxDimensions[dim[mainAxis]],
+                           availableInnerMainDim);
+        if (!YGFloatIsUndefined(min) && min >= 0.0f) {
+          line.min[index] = min;
+        }
+        if (!YGFloatIsUndefined(max) && max >= 0.0f) {
+          line.max[index] = max;
+        }
+        line.paddingAndBorder[index] =
+            YGNodePaddingAndBorderForAxis(child, mainAxis, availableInnerWidth);
+      }
+
       // First pass: detect the flex items whose min/max constraints trigger
       float deltaFlexShrinkScaledFactors = 0;
       float deltaFlexGrowFactors = 0;
-      currentRelativeChild = firstRelativeChild;
-      while (currentRelativeChild != NULL) {
-        childFlexBasis = fminf(
-            YGResolveValue(
-                &currentRelativeChild->style.maxDimensions[dim[mainAxis]],
-                mainAxisParentSize),
-            fmaxf(YGResolveValue(
-                      &currentRelativeChild->style.minDimensions[dim[mainAxis]],
-                      mainAxisParentSize),
-                  currentRelativeChild->layout.computedFlexBasis));
-
-        if (remainingFreeSpace < 0) {
-          flexShrinkScaledFactor =
-              -YGNodeResolveFlexShrink(currentRelativeChild) * childFlexBasis;
-
+      if (remainingFreeSpace < 0) {
+        YGFlexLineResolve(&line, line.shrink,
+                          remainingFreeSpace / totalFlexShrinkScaledFactors,
+                          itemsOnLine);
+        for (uint32_t i = 0; i < itemsOnLine; i++) {
           // Is this child able to shrink?
-          if (flexShrinkScaledFactor != 0) {
-            baseMainSize = childFlexBasis + remainingFreeSpace /
-                                                totalFlexShrinkScaledFactors *
-                                                flexShrinkScaledFactor;
-            boundMainSize =
-                YGNodeBoundAxis(currentRelativeChild, mainAxis, baseMainSize,
-                                availableInnerMainDim, availableInnerWidth);
-            if (baseMainSize != boundMainSize) {
-              // By excluding this item's size and flex factor from remaining,
-              // this item's
-              // min/max constraints should also trigger in the second pass
-              // resulting in the
-              // item's size calculation being identical in the first and second
-              // passes.
-              deltaFreeSpace -= boundMainSize - childFlexBasis;
-              deltaFlexShrinkScaledFactors -= flexShrinkScaledFactor;
-            }
+          if (line.shrink[i] != 0 && line.base[i] != line.bound[i]) {
+            // By excluding this item's size and flex factor from remaining,
+            // this item's
+            // min/max constraints should also trigger in the second pass
+            // resulting in the
+            // item's size calculation being identical in the first and second
+            // passes.
+            deltaFreeSpace -= line.bound[i] - line.basis[i];
+            deltaFlexShrinkScaledFactors -= line.shrink[i];
           }
-        } else if (remainingFreeSpace > 0) {
-          flexGrowFactor = YGResolveFlexGrow(currentRelativeChild);
-
+        }
+      } else if (remainingFreeSpace > 0) {
+        YGFlexLineResolve(&line, line.grow,
+                          remainingFreeSpace / totalFlexGrowFactors,
+                          itemsOnLine);
+        for (uint32_t i = 0; i < itemsOnLine; i++) {
           // Is this child able to grow?
-          if (flexGrowFactor != 0) {
-            baseMainSize = childFlexBasis + remainingFreeSpace /
-                                                totalFlexGrowFactors *
-                                                flexGrowFactor;
-            boundMainSize =
-                YGNodeBoundAxis(currentRelativeChild, mainAxis, baseMainSize,
-                                availableInnerMainDim, availableInnerWidth);
-
-            if (baseMainSize != boundMainSize) {
-              // By excluding this item's size and flex factor from remaining,
-              // this item's
-              // min/max constraints should also trigger in the second pass
-              // resulting in the
-              // item's size calculation being identical in the first and second
-              // passes.
-              deltaFreeSpace -= boundMainSize - childFlexBasis;
-              deltaFlexGrowFactors -= flexGrowFactor;
-            }
+          if (line.grow[i] != 0 && line.base[i] != line.bound[i]) {
+            deltaFreeSpace -= line.bound[i] - line.basis[i];
+            deltaFlexGrowFactors -= line.grow[i];
           }
         }
-
-        currentRelativeChild = currentRelativeChild->nextChild;
       }
 
       totalFlexShrinkScaledFactors += deltaFlexShrinkScaledFactors;
@@ -2687,135 +5430,34 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
       remainingFreeSpace += deltaFreeSpace;
 
       // Second pass: resolve the sizes of the flexible items
-      deltaFreeSpace = 0;
-      currentRelativeChild = firstRelativeChild;
-      while (currentRelativeChild != NULL) {
-        childFlexBasis = fminf(
-            YGResolveValue(
-                &currentRelativeChild->style.maxDimensions[dim[mainAxis]],
-                mainAxisParentSize),
-            fmaxf(YGResolveValue(
-                      &currentRelativeChild->style.minDimensions[dim[mainAxis]],
-                      mainAxisParentSize),
-                  currentRelativeChild->layout.computedFlexBasis));
-        float updatedMainSize = childFlexBasis;
-
-        if (remainingFreeSpace < 0) {
-          flexShrinkScaledFactor =
-              -YGNodeResolveFlexShrink(currentRelativeChild) * childFlexBasis;
-          // Is this child able to shrink?
-          if (flexShrinkScaledFactor != 0) {
-            float childSize;
-
-            if (totalFlexShrinkScaledFactors == 0) {
-              childSize = childFlexBasis + flexShrinkScaledFactor;
-            } else {
-              childSize = childFlexBasis +
-                          (remainingFreeSpace / totalFlexShrinkScaledFactors) *
-                              flexShrinkScaledFactor;
-            }
-
-            updatedMainSize =
-                YGNodeBoundAxis(currentRelativeChild, mainAxis, childSize,
-                                availableInnerMainDim, availableInnerWidth);
-          }
-        } else if (remainingFreeSpace > 0) {
-          flexGrowFactor = YGResolveFlexGrow(currentRelativeChild);
-
-          // Is this child able to grow?
-          if (flexGrowFactor != 0) {
-            updatedMainSize = YGNodeBoundAxis(
-                currentRelativeChild, mainAxis,
-                childFlexBasis +
-                    remainingFreeSpace / totalFlexGrowFactors * flexGrowFactor,
-                availableInnerMainDim, availableInnerWidth);
+      if (remainingFreeSpace < 0) {
+        YGFlexLineResolve(&line, line.shrink,
+                          totalFlexShrinkScaledFactors == 0
+                              ? 1.0f
+                              : remainingFreeSpace /
+                                    totalFlexShrinkScaledFactors,
+                          itemsOnLine);
+        for (uint32_t i = 0; i < itemsOnLine; i++) {
+          if (line.shrink[i] != 0) {
+            line.size[i] = line.bound[i];
           }
         }
-
-        deltaFreeSpace -= updatedMainSize - childFlexBasis;
-
-        const float marginMain = YGNodeMarginForAxis(
-            currentRelativeChild, mainAxis, availableInnerWidth);
-        const float marginCross = YGNodeMarginForAxis(
-            currentRelativeChild, crossAxis, availableInnerWidth);
-
-        float childCrossSize;
-        float childMainSize = updatedMainSize + marginMain;
-        YGMeasureMode childCrossMeasureMode;
-        YGMeasureMode childMainMeasureMode = YGMeasureModeExactly;
-
-        if (!YGFloatIsUndefined(currentRelativeChild->style.aspectRatio)) {
-          childCrossSize = isMainAxisRow
-                               ? (childMainSize - marginMain) /
-                                     currentRelativeChild->style.aspectRatio
-                               : (childMainSize - marginMain) *
-                                     currentRelativeChild->style.aspectRatio;
-          childCrossMeasureMode = YGMeasureModeExactly;
-
-          childCrossSize += marginCross;
-        } else if (!YGFloatIsUndefined(availableInnerCrossDim) &&
-                   !YGNodeIsStyleDimDefined(currentRelativeChild, crossAxis,
-                                            availableInnerCrossDim) &&
-                   measureModeCrossDim == YGMeasureModeExactly &&
-                   !(isNodeFlexWrap && flexBasisOverflows) &&
-                   YGNodeAlignItem(node, currentRelativeChild) ==
-                       YGAlignStretch) {
-          childCrossSize = availableInnerCrossDim;
-          childCrossMeasureMode = YGMeasureModeExactly;
-        } else if (!YGNodeIsStyleDimDefined(currentRelativeChild, crossAxis,
-                                            availableInnerCrossDim)) {
-          childCrossSize = availableInnerCrossDim;
-          childCrossMeasureMode = YGFloatIsUndefined(childCrossSize)
-                                      ? YGMeasureModeUndefined
-                                      : YGMeasureModeAtMost;
-        } else {
-          childCrossSize =
-              YGResolveValue(
-                  currentRelativeChild->resolvedDimensions[dim[crossAxis]],
-                  availableInnerCrossDim) +
-              marginCross;
-          const bool isLoosePercentageMeasurement =
-              currentRelativeChild->resolvedDimensions[dim[crossAxis]]->unit ==
-                  YGUnitPercent &&
-              measureModeCrossDim != YGMeasureModeExactly;
-          childCrossMeasureMode =
-              YGFloatIsUndefined(childCrossSize) || isLoosePercentageMeasurement
-                  ? YGMeasureModeUndefined
-                  : YGMeasureModeExactly;
+      } else if (remainingFreeSpace > 0) {
+        YGFlexLineResolve(&line, line.grow,
+                          remainingFreeSpace / totalFlexGrowFactors,
+                          itemsOnLine);
+        for (uint32_t i = 0; i < itemsOnLine; i++) {
+          if (line.grow[i] != 0) {
+            line.size[i] = line.bound[i];
+          }
         }
-
-        YGConstrainMaxSizeForMode(currentRelativeChild, mainAxis,
-                                  availableInnerMainDim, availableInnerWidth,
-                                  &childMainMeasureMode, &childMainSize);
-        YGConstrainMaxSizeForMode(currentRelativeChild, crossAxis,
-                                  availableInnerCrossDim, availableInnerWidth,
-                                  &childCrossMeasureMode, &childCrossSize);
-
-        const bool requiresStretchLayout =
-            !YGNodeIsStyleDimDefined(currentRelativeChild, crossAxis,
-                                     availableInnerCrossDim) &&
-            YGNodeAlignItem(node, currentRelativeChild) == YGAlignStretch;
-
-        const float childWidth = isMainAxisRow ? childMainSize : childCrossSize;
-        const float childHeight =
-            !isMainAxisRow ? childMainSize : childCrossSize;
-
-        const YGMeasureMode childWidthMeasureMode =
-            isMainAxisRow ? childMainMeasureMode : childCrossMeasureMode;
-        const YGMeasureMode childHeightMeasureMode =
-            !isMainAxisRow ? childMainMeasureMode : childCrossMeasureMode;
-
-        // Recursively call the layout algorithm for this child with the updated
-        // main size.
-        YGLayoutNodeInternal(
-            currentRelativeChild, childWidth, childHeight, direction,
-            childWidthMeasureMode, childHeightMeasureMode, availableInnerWidth,
-            availableInnerHeight, performLayout && !requiresStretchLayout,
-            "flex", config);
-        node->layout.hadOverflow |= currentRelativeChild->layout.hadOverflow;
-
-        currentRelativeChild = currentRelativeChild->nextChild;
       }
+
+      lineLayout.availableInnerMainDim = availableInnerMainDim;
+      lineLayout.lineOffset = lineOffset;
+      kernels->layoutItems(&container, &lineLayout);
+      deltaFreeSpace = lineLayout.deltaFreeSpace;
+      layoutContext->flexScratchCount = lineOffset;
     }
 
     remainingFreeSpace = originalRemainingFreeSpace + deltaFreeSpace;
@@ -2834,122 +5476,25 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
     // space when constraint by the min size defined for the main axis.
 
     if (measureModeMainDim == YGMeasureModeAtMost && remainingFreeSpace > 0) {
-      if (node->style.minDimensions[dim[mainAxis]].unit != YGUnitUndefined &&
-          YGResolveValue(&node->style.minDimensions[dim[mainAxis]],
-                         mainAxisParentSize) >= 0) {
+      const YGValue *const minDimension =
+          &YGStyleOf(node)->minDimensions[dim[mainAxis]];
+      if (minDimension->unit != YGUnitUndefined &&
+          YGResolveValue(minDimension, mainAxisParentSize) >= 0) {
         remainingFreeSpace =
-            fmaxf(0, YGResolveValue(&node->style.minDimensions[dim[mainAxis]],
-                                    mainAxisParentSize) -
+            fmaxf(0, YGResolveValue(minDimension, mainAxisParentSize) -
                          (availableInnerMainDim - remainingFreeSpace));
       } else {
         remainingFreeSpace = 0;
       }
     }
 
-    int numberOfAutoMarginsOnCurrentLine = 0;
-    for (uint32_t i = startOfLineIndex; i < endOfLineIndex; i++) {
-      const YGNodeRef child = YGNodeListGet(node->children, i);
-      if (child->style.positionType == YGPositionTypeRelative) {
-        if (YGMarginLeadingValue(child, mainAxis)->unit == YGUnitAuto) {
-          numberOfAutoMarginsOnCurrentLine++;
-        }
-        if (YGMarginTrailingValue(child, mainAxis)->unit == YGUnitAuto) {
-          numberOfAutoMarginsOnCurrentLine++;
-        }
-      }
-    }
-
-    if (numberOfAutoMarginsOnCurrentLine == 0) {
-      switch (justifyContent) {
-        case YGJustifyCenter:
-          leadingMainDim = remainingFreeSpace / 2;
-          break;
-        case YGJustifyFlexEnd:
-          leadingMainDim = remainingFreeSpace;
-          break;
-        case YGJustifySpaceBetween:
-          if (itemsOnLine > 1) {
-            betweenMainDim = fmaxf(remainingFreeSpace, 0) / (itemsOnLine - 1);
-          } else {
-            betweenMainDim = 0;
-          }
-          break;
-        case YGJustifySpaceAround:
-          // Space on the edges is half of the space between elements
-          betweenMainDim = remainingFreeSpace / itemsOnLine;
-          leadingMainDim = betweenMainDim / 2;
-          break;
-        case YGJustifyFlexStart:
-          break;
-      }
-    }
-
-    float mainDim = leadingPaddingAndBorderMain + leadingMainDim;
-    float crossDim = 0;
-
-    for (uint32_t i = startOfLineIndex; i < endOfLineIndex; i++) {
-      const YGNodeRef child = YGNodeListGet(node->children, i);
-      if (child->style.display == YGDisplayNone) {
-        continue;
-      }
-      if (child->style.positionType == YGPositionTypeAbsolute &&
-          YGNodeIsLeadingPosDefined(child, mainAxis)) {
-        if (performLayout) {
-          // In case the child is position absolute and has left/top being
-          // defined, we override the position to whatever the user said
-          // (and margin/border).
-          child->layout.position[pos[mainAxis]] =
-              YGNodeLeadingPosition(child, mainAxis, availableInnerMainDim) +
-              YGNodeLeadingBorder(node, mainAxis) +
-              YGNodeLeadingMargin(child, mainAxis, availableInnerWidth);
-        }
-      } else {
-        // Now that we placed the element, we need to update the variables.
-        // We need to do that only for relative elements. Absolute elements
-        // do not take part in that phase.
-        if (child->style.positionType == YGPositionTypeRelative) {
-          if (YGMarginLeadingValue(child, mainAxis)->unit == YGUnitAuto) {
-            mainDim += remainingFreeSpace / numberOfAutoMarginsOnCurrentLine;
-          }
-
-          if (performLayout) {
-            child->layout.position[pos[mainAxis]] += mainDim;
-          }
-
-          if (YGMarginTrailingValue(child, mainAxis)->unit == YGUnitAuto) {
-            mainDim += remainingFreeSpace / numberOfAutoMarginsOnCurrentLine;
-          }
-
-          if (canSkipFlex) {
-            // If we skipped the flex step, then we can't rely on the
-            // measuredDims because
-            // they weren't computed. This means we can't call
-            // YGNodeDimWithMargin.
-            mainDim +=
-                betweenMainDim +
-                YGNodeMarginForAxis(child, mainAxis, availableInnerWidth) +
-                child->layout.computedFlexBasis;
-            crossDim = availableInnerCrossDim;
-          } else {
-            // The main dimension is the sum of all the elements dimension plus
-            // the spacing.
-            mainDim +=
-                betweenMainDim +
-                YGNodeDimWithMargin(child, mainAxis, availableInnerWidth);
-
-            // The cross dimension is the max of the elements dimension since
-            // there can only be one element in that cross dimension.
-            crossDim = fmaxf(
-                crossDim,
-                YGNodeDimWithMargin(child, crossAxis, availableInnerWidth));
-          }
-        } else if (performLayout) {
-          child->layout.position[pos[mainAxis]] +=
-              YGNodeLeadingBorder(node, mainAxis) + leadingMainDim;
-        }
-      }
-    }
+    lineLayout.availableInnerMainDim = availableInnerMainDim;
+    lineLayout.canSkipFlex = canSkipFlex;
+    lineLayout.remainingFreeSpace = remainingFreeSpace;
+    kernels->justify(&container, &lineLayout);
 
+    float mainDim = lineLayout.mainDim;
+    float crossDim = lineLayout.crossDim;
     mainDim += trailingPaddingAndBorderMain;
 
     float containerCrossAxis = availableInnerCrossDim;
@@ -2976,126 +5521,20 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
     // STEP 7: CROSS-AXIS ALIGNMENT
     // We can skip child alignment if we're just measuring the container.
     if (performLayout) {
-      for (uint32_t i = startOfLineIndex; i < endOfLineIndex; i++) {
-        const YGNodeRef child = YGNodeListGet(node->children, i);
-        if (child->style.display == YGDisplayNone) {
-          continue;
-        }
-        if (child->style.positionType == YGPositionTypeAbsolute) {
-          // If the child is absolutely positioned and has a
-          // top/left/bottom/right
-          // set, override all the previously computed positions to set it
-          // correctly.
-          const bool isChildLeadingPosDefined =
-              YGNodeIsLeadingPosDefined(child, crossAxis);
-          if (isChildLeadingPosDefined) {
-            child->layout.position[pos[crossAxis]] =
-                YGNodeLeadingPosition(child, crossAxis,
-                                      availableInnerCrossDim) +
-                YGNodeLeadingBorder(node, crossAxis) +
-                YGNodeLeadingMargin(child, crossAxis, availableInnerWidth);
-          }
-          // If leading position is not defined or calculations result in Nan,
-          // default to border + margin
-          if (!isChildLeadingPosDefined ||
-              YGFloatIsUndefined(child->layout.position[pos[crossAxis]])) {
-            child->layout.position[pos[crossAxis]] =
-                YGNodeLeadingBorder(node, crossAxis) +
-                YGNodeLeadingMargin(child, crossAxis, availableInnerWidth);
-          }
-        } else {
-          float leadingCrossDim = leadingPaddingAndBorderCross;
-
-          // For a relative children, we're either using alignItems (parent) or
-          // alignSelf (child) in order to determine the position in the cross
-          // axis
-          const YGAlign alignItem = YGNodeAlignItem(node, child);
-
-          // If the child uses align stretch, we need to lay it out one more
-          // time, this time
-          // forcing the cross-axis size to be the computed cross size for the
-          // current line.
-          if (alignItem == YGAlignStretch &&
-              YGMarginLeadingValue(child, crossAxis)->unit != YGUnitAuto &&
-              YGMarginTrailingValue(child, crossAxis)->unit != YGUnitAuto) {
-            // If the child defines a definite size for its cross axis, there's
-            // no need to stretch.
-            if (!YGNodeIsStyleDimDefined(child, crossAxis,
-                                         availableInnerCrossDim)) {
-              float childMainSize =
-                  child->layout.measuredDimensions[dim[mainAxis]];
-              float childCrossSize =
-                  !YGFloatIsUndefined(child->style.aspectRatio)
-                      ? ((YGNodeMarginForAxis(child, crossAxis,
-                                              availableInnerWidth) +
-                          (isMainAxisRow
-                               ? childMainSize / child->style.aspectRatio
-                               : childMainSize * child->style.aspectRatio)))
-                      : crossDim;
-
-              childMainSize +=
-                  YGNodeMarginForAxis(child, mainAxis, availableInnerWidth);
-
-              YGMeasureMode childMainMeasureMode = YGMeasureModeExactly;
-              YGMeasureMode childCrossMeasureMode = YGMeasureModeExactly;
-              YGConstrainMaxSizeForMode(child, mainAxis, availableInnerMainDim,
-                                        availableInnerWidth,
-                                        &childMainMeasureMode, &childMainSize);
-              YGConstrainMaxSizeForMode(
-                  child, crossAxis, availableInnerCrossDim, availableInnerWidth,
-                  &childCrossMeasureMode, &childCrossSize);
-
-              const float childWidth =
-                  isMainAxisRow ? childMainSize : childCrossSize;
-              const float childHeight =
-                  !isMainAxisRow ? childMainSize : childCrossSize;
-
-              const YGMeasureMode childWidthMeasureMode =
-                  YGFloatIsUndefined(childWidth) ? YGMeasureModeUndefined
-                                                 : YGMeasureModeExactly;
-              const YGMeasureMode childHeightMeasureMode =
-                  YGFloatIsUndefined(childHeight) ? YGMeasureModeUndefined
-                                                  : YGMeasureModeExactly;
-
-              YGLayoutNodeInternal(child, childWidth, childHeight, direction,
-                                   childWidthMeasureMode,
-                                   childHeightMeasureMode, availableInnerWidth,
-                                   availableInnerHeight, true, "stretch",
-                                   config);
-            }
-          } else {
-            const float remainingCrossDim =
-                containerCrossAxis -
-                YGNodeDimWithMargin(child, crossAxis, availableInnerWidth);
-
-            if (YGMarginLeadingValue(child, crossAxis)->unit == YGUnitAuto &&
-                YGMarginTrailingValue(child, crossAxis)->unit == YGUnitAuto) {
-              leadingCrossDim += fmaxf(0.0f, remainingCrossDim / 2);
-            } else if (YGMarginTrailingValue(child, crossAxis)->unit ==
-                       YGUnitAuto) {
-              // No-Op
-            } else if (YGMarginLeadingValue(child, crossAxis)->unit ==
-                       YGUnitAuto) {
-              leadingCrossDim += fmaxf(0.0f, remainingCrossDim);
-            } else if (alignItem == YGAlignFlexStart) {
-              // No-Op
-            } else if (alignItem == YGAlignCenter) {
-              leadingCrossDim += remainingCrossDim / 2;
-            } else {
-              leadingCrossDim += remainingCrossDim;
-            }
-          }
-          // And we apply the position
-          child->layout.position[pos[crossAxis]] +=
-              totalLineCrossDim + leadingCrossDim;
-        }
-      }
+      lineLayout.crossDim = crossDim;
+      lineLayout.containerCrossAxis = containerCrossAxis;
+      lineLayout.totalLineCrossDim = totalLineCrossDim;
+      kernels->align(&container, &lineLayout);
     }
 
     totalLineCrossDim += crossDim;
     maxLineMainDim = fmaxf(maxLineMainDim, mainDim);
   }
 
+  // Baselines and multi-line stretching read the subtrees of the children, so
+  // wait for the ones being laid out in parallel.
+  YGLayoutContextJoin(layoutContext, deferredStart);
+
   // STEP 8: MULTI-LINE CONTENT ALIGNMENT
   if (performLayout && (lineCount > 1 || YGIsBaselineLayout(node)) &&
       !YGFloatIsUndefined(availableInnerCrossDim)) {
@@ -3105,7 +5544,7 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
     float crossDimLead = 0;
     float currentLead = leadingPaddingAndBorderCross;
 
-    switch (node->style.alignContent) {
+    switch (YGStyleOf(node)->alignContent) {
       case YGAlignFlexEnd:
         currentLead += remainingAlignContentDim;
         break;
@@ -3138,37 +5577,38 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
         break;
     }
 
-    uint32_t endIndex = 0;
+    uint32_t endCursor = YGChildCursorFirst(node);
     for (uint32_t i = 0; i < lineCount; i++) {
-      const uint32_t startIndex = endIndex;
-      uint32_t ii;
+      const uint32_t startCursor = endCursor;
+      uint32_t cursor;
 
-      // compute the line's height and find the endIndex
+      // compute the line's height and find the endCursor
       float lineHeight = 0;
       float maxAscentForCurrentLine = 0;
       float maxDescentForCurrentLine = 0;
-      for (ii = startIndex; ii < childCount; ii++) {
-        const YGNodeRef child = YGNodeListGet(node->children, ii);
-        if (child->style.display == YGDisplayNone) {
+      for (cursor = startCursor; cursor != childEnd;
+           cursor = YGChildCursorNext(node, cursor)) {
+        const YGNodeRef child = YGChildAtCursor(node, cursor);
+        if (YGStyleOf(child)->display == YGDisplayNone) {
           continue;
         }
-        if (child->style.positionType == YGPositionTypeRelative) {
+        if (YGStyleOf(child)->positionType == YGPositionTypeRelative) {
           if (child->lineIndex != i) {
             break;
           }
           if (YGNodeIsLayoutDimDefined(child, crossAxis)) {
             lineHeight = fmaxf(
                 lineHeight,
-                child->layout.measuredDimensions[dim[crossAxis]] +
+                YGMeasuredDimensionsOf(child)[dim[crossAxis]] +
                     YGNodeMarginForAxis(child, crossAxis, availableInnerWidth));
           }
           if (YGNodeAlignItem(node, child) == YGAlignBaseline) {
             const float ascent =
-                YGBaseline(child) + YGNodeLeadingMargin(child,
-                                                        YGFlexDirectionColumn,
-                                                        availableInnerWidth);
+                YGBaseline(child, layoutContext) +
+                YGNodeLeadingMargin(child, YGFlexDirectionColumn,
+                                    availableInnerWidth);
             const float descent =
-                child->layout.measuredDimensions[YGDimensionHeight] +
+                YGMeasuredDimensionsOf(child)[YGDimensionHeight] +
                 YGNodeMarginForAxis(child, YGFlexDirectionColumn,
                                     availableInnerWidth) -
                 ascent;
@@ -3179,40 +5619,41 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
           }
         }
       }
-      endIndex = ii;
+      endCursor = cursor;
       lineHeight += crossDimLead;
 
       if (performLayout) {
-        for (ii = startIndex; ii < endIndex; ii++) {
-          const YGNodeRef child = YGNodeListGet(node->children, ii);
-          if (child->style.display == YGDisplayNone) {
+        for (cursor = startCursor; cursor != endCursor;
+             cursor = YGChildCursorNext(node, cursor)) {
+          const YGNodeRef child = YGChildAtCursor(node, cursor);
+          if (YGStyleOf(child)->display == YGDisplayNone) {
             continue;
           }
-          if (child->style.positionType == YGPositionTypeRelative) {
+          if (YGStyleOf(child)->positionType == YGPositionTypeRelative) {
             switch (YGNodeAlignItem(node, child)) {
               case YGAlignFlexStart: {
-                child->layout.position[pos[crossAxis]] =
+                YGPositionOf(child)[pos[crossAxis]] =
                     currentLead +
                     YGNodeLeadingMargin(child, crossAxis, availableInnerWidth);
                 break;
               }
               case YGAlignFlexEnd: {
-                child->layout.position[pos[crossAxis]] =
+                YGPositionOf(child)[pos[crossAxis]] =
                     currentLead + lineHeight -
                     YGNodeTrailingMargin(child, crossAxis,
                                          availableInnerWidth) -
-                    child->layout.measuredDimensions[dim[crossAxis]];
+                    YGMeasuredDimensionsOf(child)[dim[crossAxis]];
                 break;
               }
               case YGAlignCenter: {
                 float childHeight =
-                    child->layout.measuredDimensions[dim[crossAxis]];
-                child->layout.position[pos[crossAxis]] =
+                    YGMeasuredDimensionsOf(child)[dim[crossAxis]];
+                YGPositionOf(child)[pos[crossAxis]] =
                     currentLead + (lineHeight - childHeight) / 2;
                 break;
               }
               case YGAlignStretch: {
-                child->layout.position[pos[crossAxis]] =
+                YGPositionOf(child)[pos[crossAxis]] =
                     currentLead +
                     YGNodeLeadingMargin(child, crossAxis, availableInnerWidth);
 
@@ -3220,42 +5661,41 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
                 // measured with the parents height yet.
                 if (!YGNodeIsStyleDimDefined(child, crossAxis,
                                              availableInnerCrossDim)) {
+                  const float *const childMeasuredDimensions =
+                      YGMeasuredDimensionsOf(child);
                   const float childWidth =
                       isMainAxisRow
-                          ? (child->layout
-                                 .measuredDimensions[YGDimensionWidth] +
+                          ? (childMeasuredDimensions[YGDimensionWidth] +
                              YGNodeMarginForAxis(child, mainAxis,
                                                  availableInnerWidth))
                           : lineHeight;
 
                   const float childHeight =
                       !isMainAxisRow
-                          ? (child->layout
-                                 .measuredDimensions[YGDimensionHeight] +
+                          ? (childMeasuredDimensions[YGDimensionHeight] +
                              YGNodeMarginForAxis(child, crossAxis,
                                                  availableInnerWidth))
                           : lineHeight;
 
                   if (!(YGFloatsEqual(
                             childWidth,
-                            child->layout
-                                .measuredDimensions[YGDimensionWidth]) &&
+                            childMeasuredDimensions[YGDimensionWidth]) &&
                         YGFloatsEqual(
                             childHeight,
-                            child->layout
-                                .measuredDimensions[YGDimensionHeight]))) {
+                            childMeasuredDimensions[YGDimensionHeight]))) {
                     YGLayoutNodeInternal(
                         child, childWidth, childHeight, direction,
                         YGMeasureModeExactly, YGMeasureModeExactly,
                         availableInnerWidth, availableInnerHeight, true,
-                        "multiline-stretch", config);
+                        "multiline-stretch", config, layoutContext);
                   }
                 }
                 break;
               }
               case YGAlignBaseline: {
-                child->layout.position[YGEdgeTop] =
-                    currentLead + maxAscentForCurrentLine - YGBaseline(child) +
+                YGPositionOf(child)[YGEdgeTop] =
+                    currentLead + maxAscentForCurrentLine -
+                    YGBaseline(child, layoutContext) +
                     YGNodeLeadingPosition(child, YGFlexDirectionColumn,
                                           availableInnerCrossDim);
                 break;
@@ -3274,60 +5714,20 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
   }
 
   // STEP 9: COMPUTING FINAL DIMENSIONS
-  node->layout.measuredDimensions[YGDimensionWidth] =
-      YGNodeBoundAxis(node, YGFlexDirectionRow, availableWidth - marginAxisRow,
-                      parentWidth, parentWidth);
-  node->layout.measuredDimensions[YGDimensionHeight] = YGNodeBoundAxis(
-      node, YGFlexDirectionColumn, availableHeight - marginAxisColumn,
-      parentHeight, parentWidth);
-
-  // If the user didn't specify a width or height for the node, set the
-  // dimensions based on the children.
-  if (measureModeMainDim == YGMeasureModeUndefined ||
-      (node->style.overflow != YGOverflowScroll &&
-       measureModeMainDim == YGMeasureModeAtMost)) {
-    // Clamp the size to the min/max size, if specified, and make sure it
-    // doesn't go below the padding and border amount.
-    node->layout.measuredDimensions[dim[mainAxis]] = YGNodeBoundAxis(
-        node, mainAxis, maxLineMainDim, mainAxisParentSize, parentWidth);
-  } else if (measureModeMainDim == YGMeasureModeAtMost &&
-             node->style.overflow == YGOverflowScroll) {
-    node->layout.measuredDimensions[dim[mainAxis]] =
-        fmaxf(fminf(availableInnerMainDim + paddingAndBorderAxisMain,
-                    YGNodeBoundAxisWithinMinAndMax(
-                        node, mainAxis, maxLineMainDim, mainAxisParentSize)),
-              paddingAndBorderAxisMain);
-  }
-
-  if (measureModeCrossDim == YGMeasureModeUndefined ||
-      (node->style.overflow != YGOverflowScroll &&
-       measureModeCrossDim == YGMeasureModeAtMost)) {
-    // Clamp the size to the min/max size, if specified, and make sure it
-    // doesn't go below the padding and border amount.
-    node->layout.measuredDimensions[dim[crossAxis]] = YGNodeBoundAxis(
-        node, crossAxis, totalLineCrossDim + paddingAndBorderAxisCross,
-        crossAxisParentSize, parentWidth);
-  } else if (measureModeCrossDim == YGMeasureModeAtMost &&
-             node->style.overflow == YGOverflowScroll) {
-    node->layout.measuredDimensions[dim[crossAxis]] =
-        fmaxf(fminf(availableInnerCrossDim + paddingAndBorderAxisCross,
-                    YGNodeBoundAxisWithinMinAndMax(
-                        node, crossAxis,
-                        totalLineCrossDim + paddingAndBorderAxisCross,
-                        crossAxisParentSize)),
-              paddingAndBorderAxisCross);
-  }
+  YGNodeSetContainerDimensions(&container, availableInnerMainDim,
+                               maxLineMainDim, totalLineCrossDim);
 
   // As we only wrapped in normal direction yet, we need to reverse the
   // positions on wrap-reverse.
-  if (performLayout && node->style.flexWrap == YGWrapWrapReverse) {
-    for (uint32_t i = 0; i < childCount; i++) {
-      const YGNodeRef child = YGNodeGetChild(node, i);
-      if (child->style.positionType == YGPositionTypeRelative) {
-        child->layout.position[pos[crossAxis]] =
-            node->layout.measuredDimensions[dim[crossAxis]] -
-            child->layout.position[pos[crossAxis]] -
-            child->layout.measuredDimensions[dim[crossAxis]];
+  if (performLayout && YGStyleOf(node)->flexWrap == YGWrapWrapReverse) {
+    for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+         cursor = YGChildCursorNext(node, cursor)) {
+      const YGNodeRef child = YGChildAtCursor(node, cursor);
+      if (YGStyleOf(child)->positionType == YGPositionTypeRelative) {
+        YGPositionOf(child)[pos[crossAxis]] =
+            YGMeasuredDimensionsOf(node)[dim[crossAxis]] -
+            YGPositionOf(child)[pos[crossAxis]] -
+            YGMeasuredDimensionsOf(child)[dim[crossAxis]];
       }
     }
   }
@@ -3340,40 +5740,14 @@ static void YGNodelayoutImpl(const YGNodeRef node, const float availableWidth,
       YGNodeAbsoluteLayoutChild(
           node, currentAbsoluteChild, availableInnerWidth,
           isMainAxisRow ? measureModeMainDim : measureModeCrossDim,
-          availableInnerHeight, direction, config);
+          availableInnerHeight, direction, config, layoutContext);
     }
 
     // STEP 11: SETTING TRAILING POSITIONS FOR CHILDREN
-    const bool needsMainTrailingPos = mainAxis == YGFlexDirectionRowReverse ||
-                                      mainAxis == YGFlexDirectionColumnReverse;
-    const bool needsCrossTrailingPos =
-        crossAxis == YGFlexDirectionRowReverse ||
-        crossAxis == YGFlexDirectionColumnReverse;
-
-    // Set trailing position if necessary.
-    if (needsMainTrailingPos || needsCrossTrailingPos) {
-      for (uint32_t i = 0; i < childCount; i++) {
-        const YGNodeRef child = YGNodeListGet(node->children, i);
-        if (child->style.display == YGDisplayNone) {
-          continue;
-        }
-        if (needsMainTrailingPos) {
-          YGNodeSetChildTrailingPosition(node, child, mainAxis);
-        }
-
-        if (needsCrossTrailingPos) {
-          YGNodeSetChildTrailingPosition(node, child, crossAxis);
-        }
-      }
-    }
+    YGNodeSetTrailingPositions(&container);
   }
 }
 
-uint32_t gDepth = 0;
-bool gPrintTree = false;
-bool gPrintChanges = false;
-bool gPrintSkips = false;
-
 static const char *spacer =
     "                                                            ";
 
@@ -3424,10 +5798,17 @@ static inline bool YGMeasureModeNewMeasureSizeIsStricterAndStillValid(
          (lastComputedSize <= size || YGFloatsEqual(size, lastComputedSize));
 }
 
+// Same as fmodf(value, 1.0f), down to the sign of zero and of NaN, but
+// cheaper.
+static inline float YGFloatFraction(const float value) {
+  const float fraction = value - truncf(value);
+  return fraction == 0.0f ? copysignf(0.0f, value) : fraction;
+}
+
 float YGRoundValueToPixelGrid(const float value, const float pointScaleFactor,
                               const bool forceCeil, const bool forceFloor) {
   float scaledValue = value * pointScaleFactor;
-  float fractial = fmodf(scaledValue, 1.0);
+  float fractial = YGFloatFraction(scaledValue);
   if (YGFloatsEqual(fractial, 0)) {
     // First we check if the value is already rounded
     scaledValue = scaledValue - fractial;
@@ -3445,42 +5826,165 @@ float YGRoundValueToPixelGrid(const float value, const float pointScaleFactor,
   return scaledValue / pointScaleFactor;
 }
 
-bool YGNodeCanUseCachedMeasurement(
-    const YGMeasureMode widthMode, const float width,
+// Rounds every value to the pixel grid like YGRoundValueToPixelGrid without
+// forced rounding.
+static void YGRoundValuesToPixelGrid(float *const values, const uint32_t count,
+                                     const float pointScaleFactor) {
+  uint32_t i = 0;
+#if defined(YG_SIMD_AVX)
+  const __m256 scale = _mm256_set1_ps(pointScaleFactor);
+  const __m256 signMask = _mm256_set1_ps(-0.0f);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+  const __m256 half = _mm256_set1_ps(0.5f);
+  const __m256 epsilon = _mm256_set1_ps(0.0001f);
+  for (; i + 8 <= count; i += 8) {
+    const __m256 scaled = _mm256_mul_ps(_mm256_loadu_ps(values + i), scale);
+    __m256 fraction = _mm256_sub_ps(
+        scaled,
+        _mm256_round_ps(scaled, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+    fraction = _mm256_or_ps(
+        fraction, _mm256_and_ps(_mm256_and_ps(scaled, signMask),
+                                _mm256_cmp_ps(fraction, zero, _CMP_EQ_OQ)));
+    const __m256 isZero = _mm256_cmp_ps(_mm256_andnot_ps(signMask, fraction),
+                                        epsilon, _CMP_LT_OQ);
+    const __m256 isOne = _mm256_cmp_ps(
+        _mm256_andnot_ps(signMask, _mm256_sub_ps(fraction, one)), epsilon,
+        _CMP_LT_OQ);
+    const __m256 roundsUp = _mm256_andnot_ps(
+        isZero,
+        _mm256_or_ps(isOne, _mm256_cmp_ps(fraction, half, _CMP_GE_OQ)));
+    const __m256 rounded = _mm256_add_ps(_mm256_sub_ps(scaled, fraction),
+                                         _mm256_and_ps(roundsUp, one));
+    _mm256_storeu_ps(values + i, _mm256_div_ps(rounded, scale));
+  }
+#elif defined(YG_SIMD_SSE)
+  const __m128 scale = _mm_set1_ps(pointScaleFactor);
+  const __m128 signMask = _mm_set1_ps(-0.0f);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 half = _mm_set1_ps(0.5f);
+  const __m128 epsilon = _mm_set1_ps(0.0001f);
+  // Values this large have no fraction, and cvttps2dq can't hold them.
+  const __m128 integral = _mm_set1_ps(8388608.0f);
+  for (; i + 4 <= count; i += 4) {
+    const __m128 scaled = _mm_mul_ps(_mm_loadu_ps(values + i), scale);
+    const __m128 small =
+        _mm_cmplt_ps(_mm_andnot_ps(signMask, scaled), integral);
+    const __m128 truncated = _mm_or_ps(
+        _mm_and_ps(small, _mm_cvtepi32_ps(_mm_cvttps_epi32(scaled))),
+        _mm_andnot_ps(small, scaled));
+    __m128 fraction = _mm_sub_ps(scaled, truncated);
+    fraction = _mm_or_ps(fraction,
+                         _mm_and_ps(_mm_and_ps(scaled, signMask),
+                                    _mm_cmpeq_ps(fraction, zero)));
+    const __m128 isZero =
+        _mm_cmplt_ps(_mm_andnot_ps(signMask, fraction), epsilon);
+    const __m128 isOne = _mm_cmplt_ps(
+        _mm_andnot_ps(signMask, _mm_sub_ps(fraction, one)), epsilon);
+    const __m128 roundsUp = _mm_andnot_ps(
+        isZero, _mm_or_ps(isOne, _mm_cmpge_ps(fraction, half)));
+    const __m128 rounded = _mm_add_ps(_mm_sub_ps(scaled, fraction),
+                                      _mm_and_ps(roundsUp, one));
+    _mm_storeu_ps(values + i, _mm_div_ps(rounded, scale));
+  }
+#elif defined(YG_SIMD_NEON)
+  const float32x4_t scale = vdupq_n_f32(pointScaleFactor);
+  const uint32x4_t signMask = vdupq_n_u32(0x80000000);
+  const float32x4_t one = vdupq_n_f32(1.0f);
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  const float32x4_t epsilon = vdupq_n_f32(0.0001f);
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t scaled = vmulq_f32(vld1q_f32(values + i), scale);
+    float32x4_t fraction = vsubq_f32(scaled, vrndq_f32(scaled));
+    fraction = vreinterpretq_f32_u32(vorrq_u32(
+        vreinterpretq_u32_f32(fraction),
+        vandq_u32(vandq_u32(vreinterpretq_u32_f32(scaled), signMask),
+                  vceqzq_f32(fraction))));
+    const uint32x4_t isZero = vcltq_f32(vabsq_f32(fraction), epsilon);
+    const uint32x4_t isOne =
+        vcltq_f32(vabsq_f32(vsubq_f32(fraction, one)), epsilon);
+    const uint32x4_t roundsUp =
+        vbicq_u32(vorrq_u32(isOne, vcgeq_f32(fraction, half)), isZero);
+    const float32x4_t rounded = vaddq_f32(
+        vsubq_f32(scaled, fraction),
+        vreinterpretq_f32_u32(
+            vandq_u32(roundsUp, vreinterpretq_u32_f32(one))));
+    vst1q_f32(values + i, vdivq_f32(rounded, scale));
+  }
+#endif
+  for (; i < count; i++) {
+    values[i] = YGRoundValueToPixelGrid(values[i], pointScaleFactor, false,
+                                        false);
+  }
+}
+
+// Rounds a size for comparison with the cached ones. Sizes are compared as is
+// when the config doesn't round.
+static inline float YGCacheKeyRound(const float size, const float scale) {
+  return scale != 0 ? YGRoundValueToPixelGrid(size, scale, false, false)
+                    : size;
+}
+
+// The key of a cached size for a lookup at `scale`. Only needs rounding when
+// the point scale factor changed since the entry was stored.
+static inline float YGCachedMeasurementKey(
+    const YGCachedMeasurement *const cached, const float available,
+    const float rounded, const float scale) {
+  return cached->keyScale == scale ? rounded
+                                   : YGCacheKeyRound(available, scale);
+}
+
+static inline void YGCachedMeasurementStore(YGCachedMeasurement *const cached,
+                                            const float availableWidth,
+                                            const float availableHeight,
+                                            const YGMeasureMode widthMode,
+                                            const YGMeasureMode heightMode,
+                                            const float computedWidth,
+                                            const float computedHeight,
+                                            const float scale) {
+  cached->availableWidth = availableWidth;
+  cached->availableHeight = availableHeight;
+  cached->roundedWidth = YGCacheKeyRound(availableWidth, scale);
+  cached->roundedHeight = YGCacheKeyRound(availableHeight, scale);
+  cached->keyScale = scale;
+  cached->widthMeasureMode = (uint8_t)widthMode;
+  cached->heightMeasureMode = (uint8_t)heightMode;
+  cached->computedWidth = computedWidth;
+  cached->computedHeight = computedHeight;
+  cached->referenced = false;
+}
+
+// Whether a measurement cached for a node with a measure function can be used
+// for the given constraints. roundedWidth and roundedHeight are width and
+// height passed through YGCacheKeyRound at `scale`.
+static bool YGCachedMeasurementIsCompatible(
+    const YGCachedMeasurement *const cached, const YGMeasureMode widthMode,
+    const float width, const float roundedWidth,
     const YGMeasureMode heightMode, const float height,
-    const YGMeasureMode lastWidthMode, const float lastWidth,
-    const YGMeasureMode lastHeightMode, const float lastHeight,
-    const float lastComputedWidth, const float lastComputedHeight,
-    const float marginRow, const float marginColumn, const YGConfigRef config) {
+    const float roundedHeight, const float marginRow,
+    const float marginColumn, const float scale) {
+  const float lastComputedWidth = cached->computedWidth;
+  const float lastComputedHeight = cached->computedHeight;
   if (lastComputedHeight < 0 || lastComputedWidth < 0) {
     return false;
   }
-  bool useRoundedComparison = config != NULL && config->pointScaleFactor != 0;
-  const float effectiveWidth =
-      useRoundedComparison ? YGRoundValueToPixelGrid(
-                                 width, config->pointScaleFactor, false, false)
-                           : width;
-  const float effectiveHeight =
-      useRoundedComparison ? YGRoundValueToPixelGrid(
-                                 height, config->pointScaleFactor, false, false)
-                           : height;
-  const float effectiveLastWidth =
-      useRoundedComparison
-          ? YGRoundValueToPixelGrid(lastWidth, config->pointScaleFactor, false,
-                                    false)
-          : lastWidth;
-  const float effectiveLastHeight =
-      useRoundedComparison
-          ? YGRoundValueToPixelGrid(lastHeight, config->pointScaleFactor, false,
-                                    false)
-          : lastHeight;
+  const YGMeasureMode lastWidthMode = (YGMeasureMode)cached->widthMeasureMode;
+  const YGMeasureMode lastHeightMode =
+      (YGMeasureMode)cached->heightMeasureMode;
+  const float lastWidth = cached->availableWidth;
+  const float lastHeight = cached->availableHeight;
 
   const bool hasSameWidthSpec =
       lastWidthMode == widthMode &&
-      YGFloatsEqual(effectiveLastWidth, effectiveWidth);
+      YGFloatsEqual(YGCachedMeasurementKey(cached, lastWidth,
+                                           cached->roundedWidth, scale),
+                    roundedWidth);
   const bool hasSameHeightSpec =
       lastHeightMode == heightMode &&
-      YGFloatsEqual(effectiveLastHeight, effectiveHeight);
+      YGFloatsEqual(YGCachedMeasurementKey(cached, lastHeight,
+                                           cached->roundedHeight, scale),
+                    roundedHeight);
 
   const bool widthIsCompatible =
       hasSameWidthSpec ||
@@ -3506,6 +6010,578 @@ bool YGNodeCanUseCachedMeasurement(
   return widthIsCompatible && heightIsCompatible;
 }
 
+bool YGNodeCanUseCachedMeasurement(
+    const YGMeasureMode widthMode, const float width,
+    const YGMeasureMode heightMode, const float height,
+    const YGMeasureMode lastWidthMode, const float lastWidth,
+    const YGMeasureMode lastHeightMode, const float lastHeight,
+    const float lastComputedWidth, const float lastComputedHeight,
+    const float marginRow, const float marginColumn, const YGConfigRef config) {
+  const float scale = config != NULL ? config->pointScaleFactor : 0;
+  YGCachedMeasurement cached;
+  YGCachedMeasurementStore(&cached, lastWidth, lastHeight, lastWidthMode,
+                           lastHeightMode, lastComputedWidth,
+                           lastComputedHeight, scale);
+  return YGCachedMeasurementIsCompatible(
+      &cached, widthMode, width, YGCacheKeyRound(width, scale), heightMode,
+      height, YGCacheKeyRound(height, scale), marginRow, marginColumn, scale);
+}
+
+static uint32_t YGNodeCountSubtree(const YGNodeRef node, const uint32_t limit) {
+  uint32_t count = 1;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node);
+       cursor != childEnd && count < limit;
+       cursor = YGChildCursorNext(node, cursor)) {
+    count += YGNodeCountSubtree(YGChildAtCursor(node, cursor), limit - count);
+  }
+  return count;
+}
+
+static bool YGNodeIsLargeSubtree(const YGNodeRef node) {
+  if (node->isDirty || node->layout.subtreeSizeHint == 0) {
+    node->layout.subtreeSizeHint =
+        (uint8_t)YGNodeCountSubtree(node, YG_PARALLEL_MIN_SUBTREE_SIZE);
+  }
+  return node->layout.subtreeSizeHint >= YG_PARALLEL_MIN_SUBTREE_SIZE;
+}
+
+// A container laid out at an exact size gets that size no matter what its
+// children do, so its parent can carry on while the subtree is laid out.
+static bool YGNodeCanDeferLayout(const YGNodeRef node,
+                                 const YGMeasureMode widthMeasureMode,
+                                 const YGMeasureMode heightMeasureMode,
+                                 const bool performLayout) {
+  return performLayout && widthMeasureMode == YGMeasureModeExactly &&
+         heightMeasureMode == YGMeasureModeExactly && node->measure == NULL &&
+         YGChildCountOf(node) > 0;
+}
+
+static void YGLayoutContextDefer(YGLayoutContext *const layoutContext,
+                                 const YGNodeRef node,
+                                 const float availableWidth,
+                                 const float availableHeight,
+                                 const YGDirection parentDirection,
+                                 const float parentWidth,
+                                 const float parentHeight,
+                                 const YGConfigRef config) {
+  // Same dimensions as STEP 9 of YGNodelayoutImpl will compute.
+  YGNodeFixedSizeSetMeasuredDimensions(
+      node, availableWidth, availableHeight, YGMeasureModeExactly,
+      YGMeasureModeExactly, parentWidth, parentHeight);
+  // Reset now so the parent doesn't fold in the flag of the last layout.
+  node->layout.hadOverflow = false;
+
+  if (layoutContext->deferredCount == layoutContext->deferredCapacity) {
+    layoutContext->deferredCapacity = layoutContext->deferredCapacity == 0
+                                          ? 8
+                                          : layoutContext->deferredCapacity * 2;
+    layoutContext->deferred =
+        gYGRealloc(layoutContext->deferred,
+                   sizeof(YGDeferredLayout) * layoutContext->deferredCapacity);
+    YGAssert(layoutContext->deferred != NULL,
+             "Could not allocate memory for deferred layouts");
+  }
+  layoutContext->deferred[layoutContext->deferredCount++] = (YGDeferredLayout){
+      .node = node,
+      .availableWidth = availableWidth,
+      .availableHeight = availableHeight,
+      .parentDirection = parentDirection,
+      .parentWidth = parentWidth,
+      .parentHeight = parentHeight,
+      .config = config,
+      .overflowParent = layoutContext->overflowParent,
+      .generation = layoutContext->generation,
+      .depth = layoutContext->depth,
+      .pool = layoutContext->pool,
+      .eventHandler = layoutContext->eventHandler,
+      .eventContext = layoutContext->eventContext,
+      .memoizeSubtrees = layoutContext->memoizeSubtrees,
+  };
+}
+
+static void YGDeferredLayoutRun(void *arg) {
+  YGDeferredLayout *const deferred = arg;
+  YGLayoutContext layoutContext = {
+      .generation = deferred->generation,
+      .depth = deferred->depth,
+      .pool = deferred->pool,
+      .eventHandler = deferred->eventHandler,
+      .eventConfig = deferred->config,
+      .eventContext = deferred->eventContext,
+      .memoizeSubtrees = deferred->memoizeSubtrees,
+  };
+  const YGNodeRef node = deferred->node;
+  if (layoutContext.eventHandler != NULL) {
+    YGLayoutContextEmit(&layoutContext,
+                        (YGEvent){
+                            .type = YGEventTypeNodeLayoutBegin,
+                            .node = node,
+                            .depth = layoutContext.depth,
+                            .reason = "deferred",
+                            .performLayout = true,
+                            .width = deferred->availableWidth,
+                            .height = deferred->availableHeight,
+                            .widthMeasureMode = YGMeasureModeExactly,
+                            .heightMeasureMode = YGMeasureModeExactly,
+                        });
+  }
+  YGNodelayoutImpl(node, deferred->availableWidth, deferred->availableHeight,
+                   deferred->parentDirection, YGMeasureModeExactly,
+                   YGMeasureModeExactly, deferred->parentWidth,
+                   deferred->parentHeight, true, deferred->config,
+                   &layoutContext);
+  if (layoutContext.eventHandler != NULL) {
+    YGLayoutContextEmit(
+        &layoutContext,
+        (YGEvent){
+            .type = YGEventTypeNodeLayoutEnd,
+            .node = node,
+            .depth = layoutContext.depth,
+            .reason = "deferred",
+            .performLayout = true,
+            .width = YGMeasuredDimensionsOf(node)[YGDimensionWidth],
+            .height = YGMeasuredDimensionsOf(node)[YGDimensionHeight],
+            .widthMeasureMode = YGMeasureModeExactly,
+            .heightMeasureMode = YGMeasureModeExactly,
+            .cacheOutcome = YGCacheOutcomeMiss,
+        });
+  }
+  deferred->stats = layoutContext.stats;
+  deferred->clonedDirtyRoots = layoutContext.clonedDirtyRoots;
+  deferred->clonedDirtyRootCount = layoutContext.clonedDirtyRootCount;
+  layoutContext.clonedDirtyRoots = NULL;
+  YGLayoutContextFreeScratch(&layoutContext);
+}
+
+// Lays out the subtrees deferred since `start`, one on this thread and the
+// others on the pool, and waits for all of them.
+static void YGLayoutContextJoin(YGLayoutContext *const layoutContext,
+                                const uint32_t start) {
+  const uint32_t end = layoutContext->deferredCount;
+  if (start == end) {
+    return;
+  }
+
+  YGDeferredLayout *const deferred = layoutContext->deferred;
+  int32_t pending = (int32_t)(end - start - 1);
+  for (uint32_t i = start + 1; i < end; i++) {
+    YGThreadPoolSpawn(layoutContext->pool, &YGDeferredLayoutRun, &deferred[i],
+                      &pending);
+  }
+  YGDeferredLayoutRun(&deferred[start]);
+  YGThreadPoolJoin(layoutContext->pool, &pending);
+
+  for (uint32_t i = start; i < end; i++) {
+    YGLayoutStatsAdd(&layoutContext->stats, &deferred[i].stats);
+    if (deferred[i].overflowParent != NULL) {
+      deferred[i].overflowParent->layout.hadOverflow |=
+          deferred[i].node->layout.hadOverflow;
+    }
+    for (uint32_t j = 0; j < deferred[i].clonedDirtyRootCount; j++) {
+      YGLayoutContextAddClonedDirtyRoot(layoutContext,
+                                        deferred[i].clonedDirtyRoots[j]);
+    }
+    gYGFree(deferred[i].clonedDirtyRoots);
+  }
+  layoutContext->deferredCount = start;
+}
+
+// The layout of a subtree only depends on its structure and the constraints
+// it is laid out within, so identical subtrees, such as the rows of a uniform
+// list, lay out the same. With memoization, the first of them is laid out and
+// remembered by the layout context, and its layout is copied into the others.
+
+// Structure hashes that don't identify a structure: not computed yet, and
+// subtrees that measure content without a fingerprint.
+#define YG_STRUCTURE_HASH_UNKNOWN 0
+#define YG_STRUCTURE_HASH_OPAQUE 1
+
+static inline uint64_t YGHashValue(const uint64_t hash, const YGValue value) {
+  return YGHashMix(hash,
+                   (uint64_t)value.unit << 32 | YGFloatBits(value.value));
+}
+
+// Everything the layout of the node depends on besides its children and
+// constraints.
+static uint64_t YGNodeHashShape(const YGNodeRef node) {
+  const YGStyle *const style = YGStyleOf(node);
+  uint64_t hash = YGHashMix(
+      0xCBF29CE484222325ull,
+      (uint64_t)style->direction | (uint64_t)style->flexDirection << 4 |
+          (uint64_t)style->justifyContent << 8 |
+          (uint64_t)style->alignContent << 12 |
+          (uint64_t)style->alignItems << 16 |
+          (uint64_t)style->alignSelf << 20 |
+          (uint64_t)style->positionType << 24 |
+          (uint64_t)style->flexWrap << 28 | (uint64_t)style->overflow << 32 |
+          (uint64_t)style->display << 36);
+  hash = YGHashMix(hash, (uint64_t)YGFloatBits(style->flex) << 32 |
+                             YGFloatBits(style->flexGrow));
+  hash = YGHashMix(hash, (uint64_t)YGFloatBits(style->flexShrink) << 32 |
+                             YGFloatBits(style->aspectRatio));
+  hash = YGHashValue(hash, style->flexBasis);
+  for (YGDimension dim = YGDimensionWidth; dim <= YGDimensionHeight; dim++) {
+    hash = YGHashValue(hash, style->dimensions[dim]);
+    hash = YGHashValue(hash, style->minDimensions[dim]);
+    hash = YGHashValue(hash, style->maxDimensions[dim]);
+  }
+  // The masks and units place the packed values.
+  for (uint32_t property = 0; property < YGEdgePropertyCount; property++) {
+    hash = YGHashMix(hash, (uint64_t)style->edgeUnits[property] << 16 |
+                               style->edgeMasks[property]);
+  }
+  for (uint32_t i = 0; i < style->edgeValueCount; i++) {
+    hash = YGHashMix(hash, YGFloatBits(style->edgeValues[i]));
+  }
+  hash = YGHashMix(hash, (uint64_t)(uintptr_t)node->measure);
+  hash = YGHashMix(hash, (uint64_t)(uintptr_t)node->baseline);
+  hash = YGHashMix(hash, node->measureFingerprint);
+  hash = YGHashMix(hash, (uint64_t)(uintptr_t)node->config);
+  return YGHashMix(hash,
+                   (uint64_t)node->nodeType << 32 | YGChildCountOf(node));
+}
+
+// Hash of the structure of the subtree of the node. Kept until the node is
+// marked dirty, which clears the hashes of its ancestors as well.
+static uint64_t YGNodeStructureHash(const YGNodeRef node) {
+  if (node->layout.structureHash != YG_STRUCTURE_HASH_UNKNOWN) {
+    return node->layout.structureHash;
+  }
+  // Baselines are read off the positions left by earlier layouts, which the
+  // history of the node doesn't cover.
+  bool opaque = (node->measure != NULL && node->measureFingerprint == 0) ||
+                YGStyleOf(node)->alignItems == YGAlignBaseline ||
+                YGStyleOf(node)->alignSelf == YGAlignBaseline;
+  uint64_t hash = YGNodeHashShape(node);
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    // Hashes every child, so that the hashes of the subtree are all known
+    // once that of its root is.
+    const uint64_t childHash =
+        YGNodeStructureHash(YGChildAtCursor(node, cursor));
+    opaque |= childHash == YG_STRUCTURE_HASH_OPAQUE;
+    hash = YGHashMix(hash, childHash);
+  }
+  if (opaque) {
+    hash = YG_STRUCTURE_HASH_OPAQUE;
+  } else if (hash <= YG_STRUCTURE_HASH_OPAQUE) {
+    hash += 2;
+  }
+  node->layout.structureHash = hash;
+  return hash;
+}
+
+// What a visit does to the state of a node besides the state itself: the
+// constraints, whether it is the first visit of the pass, and the settings of
+// the config the caches depend on.
+static uint64_t YGLayoutVisitHash(
+    const YGNodeRef node, const float availableWidth,
+    const float availableHeight, const YGDirection parentDirection,
+    const YGMeasureMode widthMeasureMode, const YGMeasureMode heightMeasureMode,
+    const float parentWidth, const float parentHeight,
+    const bool performLayout, const YGConfigRef config,
+    const uint32_t generation) {
+  // Chained, as the sizes often equal those of the parent.
+  uint64_t hash = YGHashMix(0xCBF29CE484222325ull,
+                            (uint64_t)YGFloatBits(availableWidth) << 32 |
+                                YGFloatBits(availableHeight));
+  hash = YGHashMix(hash, (uint64_t)YGFloatBits(parentWidth) << 32 |
+                             YGFloatBits(parentHeight));
+  hash = YGHashMix(hash, (uint64_t)widthMeasureMode |
+                             (uint64_t)heightMeasureMode << 8 |
+                             (uint64_t)parentDirection << 16 |
+                             (uint64_t)performLayout << 24 |
+                             (uint64_t)(node->layout.generationCount !=
+                                        generation)
+                                 << 25 |
+                             (uint64_t)config->useLegacyStretchBehaviour << 26 |
+                             (uint64_t)config->experimentalFeatures
+                                     [YGExperimentalFeatureWebFlexBasis]
+                                 << 27 |
+                             (uint64_t)config->fixedPointRounding << 28);
+  return YGHashMix(hash, (uint64_t)YGFloatBits(config->pointScaleFactor) << 32 |
+                             config->maxCachedMeasurements);
+}
+
+// A visit of a subtree and its outcome. The history of the node includes the
+// visit, see YGLayoutNodeInternal, so the sizes in the key are compared bit
+// for bit and everything else by hash.
+typedef struct YGMemoizedSubtree {
+  // Hash of the fields below but the outcome, 0 for an empty slot.
+  uint64_t key;
+  uint64_t structureHash;
+  uint64_t history;
+  float availableWidth;
+  float availableHeight;
+  float parentWidth;
+  float parentHeight;
+  uint8_t widthMeasureMode;
+  uint8_t heightMeasureMode;
+  uint8_t parentDirection;
+  bool performLayout;
+  // The outcome: the node visited and the size it got.
+  YGNodeRef node;
+  float measuredWidth;
+  float measuredHeight;
+} YGMemoizedSubtree;
+
+// Fills in the visit. Returns false if the subtree isn't worth remembering:
+// a leaf is answered by its own caches.
+static bool YGMemoizedSubtreeInit(
+    YGMemoizedSubtree *const visit, const YGNodeRef node,
+    const float availableWidth, const float availableHeight,
+    const YGDirection parentDirection, const YGMeasureMode widthMeasureMode,
+    const YGMeasureMode heightMeasureMode, const float parentWidth,
+    const float parentHeight, const bool performLayout) {
+  if (YGChildCountOf(node) == 0 ||
+      (YGParentOf(node) != NULL && YGIsBaselineLayout(YGParentOf(node)))) {
+    return false;
+  }
+  const uint64_t structureHash = YGNodeStructureHash(node);
+  if (structureHash == YG_STRUCTURE_HASH_OPAQUE) {
+    return false;
+  }
+  *visit = (YGMemoizedSubtree){
+      .structureHash = structureHash,
+      .history = node->layout.history,
+      .availableWidth = availableWidth,
+      .availableHeight = availableHeight,
+      .parentWidth = parentWidth,
+      .parentHeight = parentHeight,
+      .widthMeasureMode = (uint8_t)widthMeasureMode,
+      .heightMeasureMode = (uint8_t)heightMeasureMode,
+      .parentDirection = (uint8_t)parentDirection,
+      .performLayout = performLayout,
+  };
+  const uint64_t key = YGHashMix(structureHash, node->layout.history);
+  visit->key = key != 0 ? key : 1;
+  return true;
+}
+
+static inline bool YGMemoizedSubtreeEqual(const YGMemoizedSubtree *const a,
+                                          const YGMemoizedSubtree *const b) {
+  return a->key == b->key && a->structureHash == b->structureHash &&
+         a->history == b->history &&
+         YGFloatBits(a->availableWidth) == YGFloatBits(b->availableWidth) &&
+         YGFloatBits(a->availableHeight) == YGFloatBits(b->availableHeight) &&
+         YGFloatBits(a->parentWidth) == YGFloatBits(b->parentWidth) &&
+         YGFloatBits(a->parentHeight) == YGFloatBits(b->parentHeight) &&
+         a->widthMeasureMode == b->widthMeasureMode &&
+         a->heightMeasureMode == b->heightMeasureMode &&
+         a->parentDirection == b->parentDirection &&
+         a->performLayout == b->performLayout;
+}
+
+// Whether the subtree the visit was remembered from still holds its outcome:
+// any later visit or edit would have changed its history.
+static inline bool YGMemoizedSubtreeIsCurrent(
+    const YGMemoizedSubtree *const memoized) {
+  return memoized->node->layout.history == memoized->history;
+}
+
+// Returns the slot of the visit, or the empty slot it would go in.
+static YGMemoizedSubtree *YGLayoutContextFindSubtree(
+    const YGLayoutContext *const layoutContext,
+    const YGMemoizedSubtree *const visit) {
+  const uint32_t mask = layoutContext->memoCapacity - 1;
+  for (uint32_t i = (uint32_t)visit->key & mask;; i = (i + 1) & mask) {
+    YGMemoizedSubtree *const slot = &layoutContext->memo[i];
+    if (slot->key == 0 || YGMemoizedSubtreeEqual(slot, visit)) {
+      return slot;
+    }
+  }
+}
+
+// Remembers a visit that was just computed, in place of an identical one
+// whose subtree changed since. The table is kept at most half full.
+static void YGLayoutContextMemoize(YGLayoutContext *const layoutContext,
+                                   const YGMemoizedSubtree *const visit) {
+  if ((layoutContext->memoCount + 1) * 2 > layoutContext->memoCapacity) {
+    YGMemoizedSubtree *const memo = layoutContext->memo;
+    const uint32_t capacity = layoutContext->memoCapacity;
+    layoutContext->memoCapacity = capacity == 0 ? 64 : capacity * 2;
+    layoutContext->memo = gYGCalloc(layoutContext->memoCapacity,
+                                    sizeof(YGMemoizedSubtree));
+    YGAssert(layoutContext->memo != NULL,
+             "Could not allocate memory for memoized subtrees");
+    for (uint32_t i = 0; i < capacity; i++) {
+      if (memo[i].key != 0) {
+        *YGLayoutContextFindSubtree(layoutContext, &memo[i]) = memo[i];
+      }
+    }
+    gYGFree(memo);
+  }
+  YGMemoizedSubtree *const slot =
+      YGLayoutContextFindSubtree(layoutContext, visit);
+  if (slot->key == 0) {
+    layoutContext->memoCount++;
+  }
+  *slot = *visit;
+}
+
+// Forgets the subtrees of the last root, which have been rounded since.
+static void YGLayoutContextForgetSubtrees(
+    YGLayoutContext *const layoutContext) {
+  if (layoutContext->memoCount > 0) {
+    memset(layoutContext->memo, 0,
+           sizeof(YGMemoizedSubtree) * layoutContext->memoCapacity);
+    layoutContext->memoCount = 0;
+  }
+}
+
+// Copies what the visit of `from` did to its subtree into that of `node`,
+// which has the same structure and history. Children `from` didn't visit in
+// this generation are left alone, as the visit of `node` wouldn't have
+// visited them either, hidden children are zeroed out again, and only the
+// nodes positioned get the position and size of their counterpart. Returns
+// the number of nodes copied.
+static uint32_t YGNodeCopyChildLayouts(const YGNodeRef node,
+                                       const YGNodeRef from,
+                                       YGLayoutContext *const layoutContext) {
+  const uint32_t generation = layoutContext->generation;
+  YGCloneChildrenIfNeeded(node, layoutContext);
+  uint32_t copied = 0;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  uint32_t fromCursor = YGChildCursorFirst(from);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor),
+                fromCursor = YGChildCursorNext(from, fromCursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    const YGNodeRef fromChild = YGChildAtCursor(from, fromCursor);
+    const YGLayout *const fromLayout = &fromChild->layout;
+    // The parent may compute the flex basis of a child without visiting it.
+    const bool visited = fromLayout->generationCount == generation ||
+                         fromLayout->computedFlexBasisGeneration == generation;
+    const bool positioned = fromLayout->positionGenerationCount == generation;
+    if (positioned && !visited) {
+      YGZeroOutLayoutRecursivly(child, layoutContext);
+      memcpy(YGPositionOf(child), YGPositionOf(fromChild),
+             sizeof(gYGNodeDefaults.position));
+      child->layout.positionGenerationCount = generation;
+      child->isDirty = false;
+      copied++;
+      continue;
+    } else if (positioned) {
+      YGNodeCopyLayout(child, fromChild);
+      child->hasNewLayout = fromChild->hasNewLayout;
+    } else if (!visited) {
+      continue;
+    } else {
+      float position[4];
+      float dimensions[2];
+      memcpy(position, YGPositionOf(child), sizeof(position));
+      memcpy(dimensions, child->layout.dimensions, sizeof(dimensions));
+      YGNodeCopyLayout(child, fromChild);
+      memcpy(YGPositionOf(child), position, sizeof(position));
+      memcpy(child->layout.dimensions, dimensions, sizeof(dimensions));
+    }
+    child->isDirty = fromChild->isDirty;
+    copied += 1 + YGNodeCopyChildLayouts(child, fromChild, layoutContext);
+  }
+  return copied;
+}
+
+// Answers the visit of a node from an identical subtree visited before in
+// this pass, if that subtree hasn't changed since.
+static bool YGLayoutContextRecallSubtree(YGLayoutContext *const layoutContext,
+                                         const YGNodeRef node,
+                                         const YGMemoizedSubtree *const visit) {
+  // The layouts copied to the children would not be put back.
+  if (layoutContext->memoCount == 0 || layoutContext->preserveLayouts) {
+    return false;
+  }
+  const YGMemoizedSubtree *const memoized =
+      YGLayoutContextFindSubtree(layoutContext, visit);
+  const YGNodeRef from = memoized->node;
+  if (memoized->key == 0 || from == node ||
+      !YGMemoizedSubtreeIsCurrent(memoized)) {
+    return false;
+  }
+  node->layout.direction = from->layout.direction;
+  node->layout.hadOverflow = from->layout.hadOverflow;
+  YGNodeCopyLayoutEdges(node, from);
+  layoutContext->stats.memoizedNodes +=
+      YGNodeCopyChildLayouts(node, from, layoutContext);
+  YGMeasuredDimensionsOf(node)[YGDimensionWidth] = memoized->measuredWidth;
+  YGMeasuredDimensionsOf(node)[YGDimensionHeight] =
+      memoized->measuredHeight;
+  layoutContext->stats.memoizedSubtrees++;
+  return true;
+}
+
+// Keeps the layout of a node that a pass which only measures visits for the
+// first time.
+static void YGLayoutContextSaveLayout(YGLayoutContext *const layoutContext,
+                                      const YGNodeRef node) {
+  if (layoutContext->savedLayoutCount == layoutContext->savedLayoutCapacity) {
+    layoutContext->savedLayoutCapacity =
+        layoutContext->savedLayoutCapacity == 0
+            ? 64
+            : layoutContext->savedLayoutCapacity * 2;
+    layoutContext->savedLayouts =
+        gYGRealloc(layoutContext->savedLayouts,
+                   sizeof(YGSavedLayout) * layoutContext->savedLayoutCapacity);
+    YGAssert(layoutContext->savedLayouts != NULL,
+             "Could not allocate memory for saved layouts");
+  }
+  YGSavedLayout *const saved =
+      &layoutContext->savedLayouts[layoutContext->savedLayoutCount++];
+  saved->node = node;
+  memcpy(saved->measuredDimensions, YGMeasuredDimensionsOf(node),
+         sizeof(saved->measuredDimensions));
+  saved->direction = node->layout.direction;
+  saved->hadOverflow = node->layout.hadOverflow;
+  if (node->layout.edges != NULL) {
+    saved->edges = *node->layout.edges;
+  } else {
+    memset(&saved->edges, 0, sizeof(YGLayoutEdges));
+  }
+}
+
+// Puts back the layouts saved by YGLayoutContextSaveLayout. The caches filled
+// since are kept.
+static void YGLayoutContextRestoreLayouts(
+    YGLayoutContext *const layoutContext) {
+  for (uint32_t i = 0; i < layoutContext->savedLayoutCount; i++) {
+    const YGSavedLayout *const saved = &layoutContext->savedLayouts[i];
+    YGLayout *const layout = &saved->node->layout;
+    memcpy(YGMeasuredDimensionsOf(saved->node), saved->measuredDimensions,
+           sizeof(saved->measuredDimensions));
+    layout->direction = saved->direction;
+    layout->hadOverflow = saved->hadOverflow;
+    if (layout->edges != NULL) {
+      *layout->edges = saved->edges;
+    }
+  }
+  layoutContext->savedLayoutCount = 0;
+}
+
+// Keeps what a root, a node of a fixed size or a node with children was laid
+// out with, so that it can be laid out again on its own.
+static void YGNodeRecordConstraints(const YGNodeRef node,
+                                    const float availableWidth,
+                                    const float availableHeight,
+                                    const YGMeasureMode widthMeasureMode,
+                                    const YGMeasureMode heightMeasureMode,
+                                    const float parentWidth,
+                                    const float parentHeight) {
+  YGRelayoutState *relayout = node->layout.relayout;
+  if (relayout == NULL) {
+    relayout = YGNodeAllocColdBlock(node, sizeof(YGRelayoutState));
+    memset(relayout, 0, sizeof(YGRelayoutState));
+    node->layout.relayout = relayout;
+  }
+  relayout->availableWidth = availableWidth;
+  relayout->availableHeight = availableHeight;
+  relayout->parentWidth = parentWidth;
+  relayout->parentHeight = parentHeight;
+  relayout->widthMeasureMode = (uint8_t)widthMeasureMode;
+  relayout->heightMeasureMode = (uint8_t)heightMeasureMode;
+  relayout->baselineQueried = false;
+}
+
 //
 // This is a wrapper around the YGNodelayoutImpl function. It determines
 // whether the layout request is redundant and can be skipped.
@@ -3521,24 +6597,73 @@ bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
                           const YGMeasureMode heightMeasureMode,
                           const float parentWidth, const float parentHeight,
                           const bool performLayout, const char *reason,
-                          const YGConfigRef config) {
+                          const YGConfigRef config,
+                          YGLayoutContext *const layoutContext) {
   YGLayout *layout = &node->layout;
+  float *const measuredDimensions = YGMeasuredDimensionsOf(node);
 
-  gDepth++;
+  layoutContext->depth++;
+  YGLayoutStats *const stats = &layoutContext->stats;
+  stats->nodesVisited++;
+  if (performLayout) {
+    stats->layoutCalls++;
+  } else {
+    stats->measureCalls++;
+  }
+  if (layoutContext->depth > stats->maxDepth) {
+    stats->maxDepth = layoutContext->depth;
+  }
+  if (layoutContext->preserveLayouts &&
+      layout->generationCount != layoutContext->generation) {
+    YGLayoutContextSaveLayout(layoutContext, node);
+  }
+  if (layoutContext->eventHandler != NULL) {
+    YGLayoutContextEmit(layoutContext, (YGEvent){
+                                           .type = YGEventTypeNodeLayoutBegin,
+                                           .node = node,
+                                           .depth = layoutContext->depth,
+                                           .reason = reason,
+                                           .performLayout = performLayout,
+                                           .width = availableWidth,
+                                           .height = availableHeight,
+                                           .widthMeasureMode = widthMeasureMode,
+                                           .heightMeasureMode = heightMeasureMode,
+                                       });
+  }
+
+  // Only the call the flag was set for may be deferred, not the calls it makes.
+  const bool mayDefer = layoutContext->mayDefer;
+  layoutContext->mayDefer = false;
+
+  if (layoutContext->memoizeSubtrees) {
+    layout->history = YGHashMix(
+        layout->history,
+        YGLayoutVisitHash(node, availableWidth, availableHeight,
+                          parentDirection, widthMeasureMode, heightMeasureMode,
+                          parentWidth, parentHeight, performLayout, config,
+                          layoutContext->generation));
+  }
 
   const bool needToVisitNode =
-      (node->isDirty && layout->generationCount != gCurrentGenerationCount) ||
+      (node->isDirty && layout->generationCount != layoutContext->generation) ||
       layout->lastParentDirection != parentDirection;
 
+  YGMeasurementCache *measurementCache = layout->measurementCache;
+
   if (needToVisitNode) {
     // Invalidate the cached results.
-    layout->nextCachedMeasurementsIndex = 0;
-    layout->cachedLayout.widthMeasureMode = (YGMeasureMode)-1;
-    layout->cachedLayout.heightMeasureMode = (YGMeasureMode)-1;
+    if (measurementCache != NULL) {
+      YGMeasurementCacheClear(measurementCache);
+    }
+    layout->cachedLayout.widthMeasureMode = (uint8_t)-1;
+    layout->cachedLayout.heightMeasureMode = (uint8_t)-1;
     layout->cachedLayout.computedWidth = -1;
     layout->cachedLayout.computedHeight = -1;
   }
 
+  const uint32_t cachedMeasurementCount =
+      measurementCache != NULL ? measurementCache->count : 0;
+  const float scale = config->pointScaleFactor;
   YGCachedMeasurement *cachedResults = NULL;
 
   // Determine whether the results are already cached. We maintain a separate
@@ -3559,30 +6684,26 @@ bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
     const float marginAxisColumn =
         YGNodeMarginForAxis(node, YGFlexDirectionColumn, parentWidth);
 
+    // The cached sizes are rounded when stored, round these once.
+    const float roundedWidth = YGCacheKeyRound(availableWidth, scale);
+    const float roundedHeight = YGCacheKeyRound(availableHeight, scale);
+
     // First, try to use the layout cache.
-    if (YGNodeCanUseCachedMeasurement(
-            widthMeasureMode, availableWidth, heightMeasureMode,
-            availableHeight, layout->cachedLayout.widthMeasureMode,
-            layout->cachedLayout.availableWidth,
-            layout->cachedLayout.heightMeasureMode,
-            layout->cachedLayout.availableHeight,
-            layout->cachedLayout.computedWidth,
-            layout->cachedLayout.computedHeight, marginAxisRow,
-            marginAxisColumn, config)) {
+    if (YGCachedMeasurementIsCompatible(
+            &layout->cachedLayout, widthMeasureMode, availableWidth,
+            roundedWidth, heightMeasureMode, availableHeight, roundedHeight,
+            marginAxisRow, marginAxisColumn, scale)) {
       cachedResults = &layout->cachedLayout;
     } else {
       // Try to use the measurement cache.
-      for (uint32_t i = 0; i < layout->nextCachedMeasurementsIndex; i++) {
-        if (YGNodeCanUseCachedMeasurement(
-                widthMeasureMode, availableWidth, heightMeasureMode,
-                availableHeight, layout->cachedMeasurements[i].widthMeasureMode,
-                layout->cachedMeasurements[i].availableWidth,
-                layout->cachedMeasurements[i].heightMeasureMode,
-                layout->cachedMeasurements[i].availableHeight,
-                layout->cachedMeasurements[i].computedWidth,
-                layout->cachedMeasurements[i].computedHeight, marginAxisRow,
-                marginAxisColumn, config)) {
-          cachedResults = &layout->cachedMeasurements[i];
+      for (uint32_t i = 0; i < cachedMeasurementCount; i++) {
+        YGCachedMeasurement *const cached =
+            &measurementCache->cachedMeasurements[i];
+        if (YGCachedMeasurementIsCompatible(
+                cached, widthMeasureMode, availableWidth, roundedWidth,
+                heightMeasureMode, availableHeight, roundedHeight,
+                marginAxisRow, marginAxisColumn, scale)) {
+          cachedResults = cached;
           break;
         }
       }
@@ -3595,27 +6716,35 @@ bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
       cachedResults = &layout->cachedLayout;
     }
   } else {
-    for (uint32_t i = 0; i < layout->nextCachedMeasurementsIndex; i++) {
-      if (YGFloatsEqual(layout->cachedMeasurements[i].availableWidth,
-                        availableWidth) &&
-          YGFloatsEqual(layout->cachedMeasurements[i].availableHeight,
-                        availableHeight) &&
-          layout->cachedMeasurements[i].widthMeasureMode == widthMeasureMode &&
-          layout->cachedMeasurements[i].heightMeasureMode ==
-              heightMeasureMode) {
-        cachedResults = &layout->cachedMeasurements[i];
+    for (uint32_t i = 0; i < cachedMeasurementCount; i++) {
+      YGCachedMeasurement *const cached =
+          &measurementCache->cachedMeasurements[i];
+      if (YGFloatsEqual(cached->availableWidth, availableWidth) &&
+          YGFloatsEqual(cached->availableHeight, availableHeight) &&
+          cached->widthMeasureMode == widthMeasureMode &&
+          cached->heightMeasureMode == heightMeasureMode) {
+        cachedResults = cached;
         break;
       }
     }
   }
 
-  if (!needToVisitNode && cachedResults != NULL) {
-    layout->measuredDimensions[YGDimensionWidth] = cachedResults->computedWidth;
-    layout->measuredDimensions[YGDimensionHeight] =
+  const bool cacheHit = !needToVisitNode && cachedResults != NULL;
+  bool memoized = false;
+  if (cacheHit) {
+    if (cachedResults == &layout->cachedLayout) {
+      stats->cachedLayoutHits++;
+    } else {
+      cachedResults->referenced = true;
+      stats->cachedMeasurementHits++;
+    }
+    measuredDimensions[YGDimensionWidth] = cachedResults->computedWidth;
+    measuredDimensions[YGDimensionHeight] =
         cachedResults->computedHeight;
 
-    if (gPrintChanges && gPrintSkips) {
-      printf("%s%d.{[skipped] ", YGSpacer(gDepth), gDepth);
+    if (layoutContext->printChanges && layoutContext->printSkips) {
+      printf("%s%d.{[skipped] ", YGSpacer(layoutContext->depth),
+             layoutContext->depth);
       if (node->print) {
         node->print(node);
       }
@@ -3626,8 +6755,9 @@ bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
              cachedResults->computedHeight, reason);
     }
   } else {
-    if (gPrintChanges) {
-      printf("%s%d.{%s", YGSpacer(gDepth), gDepth, needToVisitNode ? "*" : "");
+    if (layoutContext->printChanges) {
+      printf("%s%d.{%s", YGSpacer(layoutContext->depth), layoutContext->depth,
+             needToVisitNode ? "*" : "");
       if (node->print) {
         node->print(node);
       }
@@ -3637,65 +6767,124 @@ bool YGLayoutNodeInternal(const YGNodeRef node, const float availableWidth,
              availableWidth, availableHeight, reason);
     }
 
-    YGNodelayoutImpl(node, availableWidth, availableHeight, parentDirection,
-                     widthMeasureMode, heightMeasureMode, parentWidth,
-                     parentHeight, performLayout, config);
+    const YGThreadPoolRef pool = layoutContext->pool;
+    bool deferred = false;
+    if (mayDefer && YGNodeCanDeferLayout(node, widthMeasureMode,
+                                         heightMeasureMode, performLayout)) {
+      if (YGNodeIsLargeSubtree(node)) {
+        YGLayoutContextDefer(layoutContext, node, availableWidth,
+                             availableHeight, parentDirection, parentWidth,
+                             parentHeight, config);
+        deferred = true;
+      } else {
+        // Nothing below a subtree too small to defer is worth deferring.
+        layoutContext->pool = NULL;
+      }
+    }
+    if (!deferred) {
+      YGMemoizedSubtree visit;
+      const bool memoizable =
+          layoutContext->memoizeSubtrees &&
+          YGMemoizedSubtreeInit(&visit, node, availableWidth, availableHeight,
+                                parentDirection, widthMeasureMode,
+                                heightMeasureMode, parentWidth, parentHeight,
+                                performLayout);
+      memoized = memoizable &&
+                 YGLayoutContextRecallSubtree(layoutContext, node, &visit);
+      if (!memoized) {
+        YGNodelayoutImpl(node, availableWidth, availableHeight,
+                         parentDirection, widthMeasureMode, heightMeasureMode,
+                         parentWidth, parentHeight, performLayout, config,
+                         layoutContext);
+      }
+      if (memoizable && !memoized) {
+        visit.node = node;
+        visit.measuredWidth = measuredDimensions[YGDimensionWidth];
+        visit.measuredHeight = measuredDimensions[YGDimensionHeight];
+        YGLayoutContextMemoize(layoutContext, &visit);
+      }
+    }
+    layoutContext->pool = pool;
 
-    if (gPrintChanges) {
-      printf("%s%d.}%s", YGSpacer(gDepth), gDepth, needToVisitNode ? "*" : "");
+    if (layoutContext->printChanges) {
+      printf("%s%d.}%s", YGSpacer(layoutContext->depth), layoutContext->depth,
+             needToVisitNode ? "*" : "");
       if (node->print) {
         node->print(node);
       }
       printf("wm: %s, hm: %s, d: (%f, %f) %s\n",
              YGMeasureModeName(widthMeasureMode, performLayout),
              YGMeasureModeName(heightMeasureMode, performLayout),
-             layout->measuredDimensions[YGDimensionWidth],
-             layout->measuredDimensions[YGDimensionHeight], reason);
+             measuredDimensions[YGDimensionWidth],
+             measuredDimensions[YGDimensionHeight], reason);
     }
 
     layout->lastParentDirection = parentDirection;
 
     if (cachedResults == NULL) {
-      if (layout->nextCachedMeasurementsIndex == YG_MAX_CACHED_RESULT_COUNT) {
-        if (gPrintChanges) {
-          printf("Out of cache entries!\n");
-        }
-        layout->nextCachedMeasurementsIndex = 0;
-      }
-
       YGCachedMeasurement *newCacheEntry;
       if (performLayout) {
         // Use the single layout cache entry.
         newCacheEntry = &layout->cachedLayout;
+        stats->cachedLayoutMisses++;
       } else {
-        // Allocate a new measurement cache entry.
-        newCacheEntry =
-            &layout->cachedMeasurements[layout->nextCachedMeasurementsIndex];
-        layout->nextCachedMeasurementsIndex++;
+        bool evicted;
+        newCacheEntry = YGNodeAllocCachedMeasurement(
+            node, config->maxCachedMeasurements, &evicted);
+        stats->cachedMeasurementMisses++;
+        if (evicted) {
+          stats->cachedMeasurementEvictions++;
+          if (layoutContext->printChanges) {
+            printf("Out of cache entries!\n");
+          }
+        }
       }
 
-      newCacheEntry->availableWidth = availableWidth;
-      newCacheEntry->availableHeight = availableHeight;
-      newCacheEntry->widthMeasureMode = widthMeasureMode;
-      newCacheEntry->heightMeasureMode = heightMeasureMode;
-      newCacheEntry->computedWidth =
-          layout->measuredDimensions[YGDimensionWidth];
-      newCacheEntry->computedHeight =
-          layout->measuredDimensions[YGDimensionHeight];
+      YGCachedMeasurementStore(
+          newCacheEntry, availableWidth, availableHeight, widthMeasureMode,
+          heightMeasureMode, measuredDimensions[YGDimensionWidth],
+          measuredDimensions[YGDimensionHeight], scale);
     }
   }
 
   if (performLayout) {
     node->layout.dimensions[YGDimensionWidth] =
-        node->layout.measuredDimensions[YGDimensionWidth];
+        measuredDimensions[YGDimensionWidth];
     node->layout.dimensions[YGDimensionHeight] =
-        node->layout.measuredDimensions[YGDimensionHeight];
+        measuredDimensions[YGDimensionHeight];
     node->hasNewLayout = true;
     node->isDirty = false;
+    if (config->useRelayoutBoundaries &&
+        (YGChildCountOf(node) > 0 || YGNodeHasFixedSize(node))) {
+      YGNodeRecordConstraints(node, availableWidth, availableHeight,
+                              widthMeasureMode, heightMeasureMode,
+                              parentWidth, parentHeight);
+    }
   }
 
-  gDepth--;
-  layout->generationCount = gCurrentGenerationCount;
+  if (layoutContext->eventHandler != NULL) {
+    YGLayoutContextEmit(
+        layoutContext,
+        (YGEvent){
+            .type = YGEventTypeNodeLayoutEnd,
+            .node = node,
+            .depth = layoutContext->depth,
+            .reason = reason,
+            .performLayout = performLayout,
+            .width = measuredDimensions[YGDimensionWidth],
+            .height = measuredDimensions[YGDimensionHeight],
+            .widthMeasureMode = widthMeasureMode,
+            .heightMeasureMode = heightMeasureMode,
+            .cacheOutcome = memoized ? YGCacheOutcomeSubtreeHit
+                            : !cacheHit ? YGCacheOutcomeMiss
+                            : cachedResults == &layout->cachedLayout
+                                ? YGCacheOutcomeLayoutHit
+                                : YGCacheOutcomeMeasurementHit,
+        });
+  }
+
+  layoutContext->depth--;
+  layout->generationCount = layoutContext->generation;
   return (needToVisitNode || cachedResults == NULL);
 }
 
@@ -3713,137 +6902,790 @@ void YGConfigSetPointScaleFactor(const YGConfigRef config,
   }
 }
 
-static void YGRoundToPixelGrid(const YGNodeRef node,
-                               const float pointScaleFactor,
-                               const float absoluteLeft,
-                               const float absoluteTop) {
-  if (pointScaleFactor == 0.0f) {
-    return;
-  }
+float YGConfigGetPointScaleFactor(const YGConfigRef config) {
+  return config->pointScaleFactor;
+}
 
-  const float nodeLeft = node->layout.position[YGEdgeLeft];
-  const float nodeTop = node->layout.position[YGEdgeTop];
+// Rounds the layout of a node with forced rounding, as text nodes need.
+static void YGRoundTextNodeToPixelGrid(const YGNodeRef node,
+                                       const float pointScaleFactor,
+                                       const float absoluteNodeLeft,
+                                       const float absoluteNodeTop) {
+  const float nodeLeft = YGPositionOf(node)[YGEdgeLeft];
+  const float nodeTop = YGPositionOf(node)[YGEdgeTop];
 
   const float nodeWidth = node->layout.dimensions[YGDimensionWidth];
   const float nodeHeight = node->layout.dimensions[YGDimensionHeight];
 
-  const float absoluteNodeLeft = absoluteLeft + nodeLeft;
-  const float absoluteNodeTop = absoluteTop + nodeTop;
-
   const float absoluteNodeRight = absoluteNodeLeft + nodeWidth;
   const float absoluteNodeBottom = absoluteNodeTop + nodeHeight;
 
   // If a node has a custom measure function we never want to round down its
   // size as this could lead to unwanted text truncation.
-  const bool textRounding = node->nodeType == YGNodeTypeText;
-
-  node->layout.position[YGEdgeLeft] =
-      YGRoundValueToPixelGrid(nodeLeft, pointScaleFactor, false, textRounding);
-  node->layout.position[YGEdgeTop] =
-      YGRoundValueToPixelGrid(nodeTop, pointScaleFactor, false, textRounding);
+  YGPositionOf(node)[YGEdgeLeft] =
+      YGRoundValueToPixelGrid(nodeLeft, pointScaleFactor, false, true);
+  YGPositionOf(node)[YGEdgeTop] =
+      YGRoundValueToPixelGrid(nodeTop, pointScaleFactor, false, true);
 
   // We multiply dimension by scale factor and if the result is close to the
   // whole number, we don't have any fraction To verify if the result is close
   // to whole number we want to check both floor and ceil numbers
-  const bool hasFractionalWidth =
-      !YGFloatsEqual(fmodf(nodeWidth * pointScaleFactor, 1.0), 0) &&
-      !YGFloatsEqual(fmodf(nodeWidth * pointScaleFactor, 1.0), 1.0);
-  const bool hasFractionalHeight =
-      !YGFloatsEqual(fmodf(nodeHeight * pointScaleFactor, 1.0), 0) &&
-      !YGFloatsEqual(fmodf(nodeHeight * pointScaleFactor, 1.0), 1.0);
+  const float widthFraction = YGFloatFraction(nodeWidth * pointScaleFactor);
+  const float heightFraction = YGFloatFraction(nodeHeight * pointScaleFactor);
+  const bool hasFractionalWidth = !YGFloatsEqual(widthFraction, 0) &&
+                                  !YGFloatsEqual(widthFraction, 1.0);
+  const bool hasFractionalHeight = !YGFloatsEqual(heightFraction, 0) &&
+                                   !YGFloatsEqual(heightFraction, 1.0);
 
   node->layout.dimensions[YGDimensionWidth] =
       YGRoundValueToPixelGrid(absoluteNodeRight, pointScaleFactor,
-                              (textRounding && hasFractionalWidth),
-                              (textRounding && !hasFractionalWidth)) -
-      YGRoundValueToPixelGrid(absoluteNodeLeft, pointScaleFactor, false,
-                              textRounding);
+                              hasFractionalWidth, !hasFractionalWidth) -
+      YGRoundValueToPixelGrid(absoluteNodeLeft, pointScaleFactor, false, true);
   node->layout.dimensions[YGDimensionHeight] =
       YGRoundValueToPixelGrid(absoluteNodeBottom, pointScaleFactor,
-                              (textRounding && hasFractionalHeight),
-                              (textRounding && !hasFractionalHeight)) -
-      YGRoundValueToPixelGrid(absoluteNodeTop, pointScaleFactor, false,
-                              textRounding);
-
-  const uint32_t childCount = YGNodeListCount(node->children);
-  for (uint32_t i = 0; i < childCount; i++) {
-    YGRoundToPixelGrid(YGNodeGetChild(node, i), pointScaleFactor,
-                       absoluteNodeLeft, absoluteNodeTop);
+                              hasFractionalHeight, !hasFractionalHeight) -
+      YGRoundValueToPixelGrid(absoluteNodeTop, pointScaleFactor, false, true);
+}
+
+// Edges of a node gathered for YGRoundValuesToPixelGrid: its position in the
+// parent, then its absolute left, top, right and bottom.
+#define YG_ROUNDED_EDGE_COUNT 6
+
+// Gathers the nodes laid out in this generation, in preorder. The rest of the
+// tree still holds the layout rounded by an earlier pass, and rounding it
+// again wouldn't change it, so whole subtrees are skipped.
+static void YGGatherNodesToRound(const YGNodeRef node,
+                                 const float pointScaleFactor,
+                                 const float absoluteLeft,
+                                 const float absoluteTop,
+                                 YGLayoutContext *const layoutContext) {
+  if (node->layout.generationCount != layoutContext->generation) {
+    return;
   }
-}
+  layoutContext->stats.nodesRounded++;
 
-void YGNodeCalculateLayout(const YGNodeRef node, const float parentWidth,
-                           const float parentHeight,
-                           const YGDirection parentDirection) {
-  // Increment the generation count. This will force the recursive routine to
-  // visit
-  // all dirty nodes at least once. Subsequent visits will be skipped if the
-  // input
-  // parameters don't change.
-  gCurrentGenerationCount++;
+  const float nodeLeft = YGPositionOf(node)[YGEdgeLeft];
+  const float nodeTop = YGPositionOf(node)[YGEdgeTop];
 
-  YGResolveDimensions(node);
+  const float absoluteNodeLeft = absoluteLeft + nodeLeft;
+  const float absoluteNodeTop = absoluteTop + nodeTop;
 
-  float width = YGUndefined;
-  YGMeasureMode widthMeasureMode = YGMeasureModeUndefined;
-  if (YGNodeIsStyleDimDefined(node, YGFlexDirectionRow, parentWidth)) {
-    width = YGResolveValue(node->resolvedDimensions[dim[YGFlexDirectionRow]],
-                           parentWidth) +
-            YGNodeMarginForAxis(node, YGFlexDirectionRow, parentWidth);
-    widthMeasureMode = YGMeasureModeExactly;
-  } else if (YGResolveValue(&node->style.maxDimensions[YGDimensionWidth],
-                            parentWidth) >= 0.0f) {
-    width = YGResolveValue(&node->style.maxDimensions[YGDimensionWidth],
-                           parentWidth);
-    widthMeasureMode = YGMeasureModeAtMost;
-  } else {
-    width = parentWidth;
-    widthMeasureMode = YGFloatIsUndefined(width) ? YGMeasureModeUndefined
-                                                 : YGMeasureModeExactly;
+  YGRelayoutState *const relayout = node->layout.relayout;
+  if (relayout != NULL) {
+    relayout->left = nodeLeft;
+    relayout->top = nodeTop;
+    relayout->isRounded = true;
   }
 
-  float height = YGUndefined;
-  YGMeasureMode heightMeasureMode = YGMeasureModeUndefined;
-  if (YGNodeIsStyleDimDefined(node, YGFlexDirectionColumn, parentHeight)) {
-    height =
-        YGResolveValue(node->resolvedDimensions[dim[YGFlexDirectionColumn]],
-                       parentHeight) +
-        YGNodeMarginForAxis(node, YGFlexDirectionColumn, parentWidth);
-    heightMeasureMode = YGMeasureModeExactly;
-  } else if (YGResolveValue(&node->style.maxDimensions[YGDimensionHeight],
-                            parentHeight) >= 0.0f) {
-    height = YGResolveValue(&node->style.maxDimensions[YGDimensionHeight],
-                            parentHeight);
-    heightMeasureMode = YGMeasureModeAtMost;
+  if (node->nodeType == YGNodeTypeText) {
+    YGRoundTextNodeToPixelGrid(node, pointScaleFactor, absoluteNodeLeft,
+                               absoluteNodeTop);
   } else {
-    height = parentHeight;
-    heightMeasureMode = YGFloatIsUndefined(height) ? YGMeasureModeUndefined
-                                                   : YGMeasureModeExactly;
-  }
-
-  if (YGLayoutNodeInternal(node, width, height, parentDirection,
-                           widthMeasureMode, heightMeasureMode, parentWidth,
-                           parentHeight, true, "initial", node->config)) {
-    YGNodeSetPosition(node, node->layout.direction, parentWidth, parentHeight,
-                      parentWidth);
-    YGRoundToPixelGrid(node, node->config->pointScaleFactor, 0.0f, 0.0f);
-
-    if (gPrintTree) {
-      YGNodePrint(node, YGPrintOptionsLayout | YGPrintOptionsChildren |
-                            YGPrintOptionsStyle);
+    if (layoutContext->roundingCount == layoutContext->roundingCapacity) {
+      layoutContext->roundingCapacity =
+          layoutContext->roundingCapacity == 0
+              ? 64
+              : layoutContext->roundingCapacity * 2;
+      layoutContext->roundingNodes =
+          gYGRealloc(layoutContext->roundingNodes,
+                     sizeof(YGNodeRef) * layoutContext->roundingCapacity);
+      layoutContext->roundingEdges = gYGRealloc(
+          layoutContext->roundingEdges, sizeof(float) * YG_ROUNDED_EDGE_COUNT *
+                                            layoutContext->roundingCapacity);
+      YGAssert(layoutContext->roundingNodes != NULL &&
+                   layoutContext->roundingEdges != NULL,
+               "Could not allocate memory for pixel grid rounding");
     }
+    const uint32_t index = layoutContext->roundingCount++;
+    float *const edges =
+        layoutContext->roundingEdges + index * YG_ROUNDED_EDGE_COUNT;
+    layoutContext->roundingNodes[index] = node;
+    edges[0] = nodeLeft;
+    edges[1] = nodeTop;
+    edges[2] = absoluteNodeLeft;
+    edges[3] = absoluteNodeTop;
+    edges[4] = absoluteNodeLeft + node->layout.dimensions[YGDimensionWidth];
+    edges[5] = absoluteNodeTop + node->layout.dimensions[YGDimensionHeight];
+  }
+
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    YGGatherNodesToRound(YGChildAtCursor(node, cursor), pointScaleFactor,
+                         absoluteNodeLeft, absoluteNodeTop, layoutContext);
+  }
+}
+
+// Fixed point values of the rounding pass, in 1/65536 of a device pixel.
+#define YG_FIXED_POINT_SHIFT 16
+#define YG_FIXED_POINT_ONE ((int64_t)1 << YG_FIXED_POINT_SHIFT)
+// The tolerance of YGFloatsEqual, 0.0001 of a pixel.
+#define YG_FIXED_POINT_EPSILON 7
+// A billion pixels, far beyond any layout.
+#define YG_FIXED_POINT_MAX 1073741824.0
+
+// Scales in double: a float has no more than 1/16 of a pixel left at 640k.
+static inline int64_t YGFloatToFixedPoint(const float value,
+                                          const float pointScaleFactor) {
+  if (YGFloatIsUndefined(value)) {
+    return 0;
+  }
+  const double scaled = fmax(fmin((double)value * pointScaleFactor,
+                                  YG_FIXED_POINT_MAX),
+                             -YG_FIXED_POINT_MAX);
+  return llround(scaled * YG_FIXED_POINT_ONE);
+}
+
+// Divides by 2^shift, rounding down.
+static inline int64_t YGFixedPointShift(const int64_t value,
+                                        const uint32_t shift) {
+  const int64_t one = (int64_t)1 << shift;
+  return value >= 0 ? value / one : -((one - 1 - value) / one);
+}
+
+// The pixel below the value, or above it when it is just under that one.
+static inline int64_t YGFixedPointFloor(const int64_t value) {
+  return YGFixedPointShift(value + YG_FIXED_POINT_EPSILON,
+                           YG_FIXED_POINT_SHIFT);
+}
+
+static inline int64_t YGFixedPointCeil(const int64_t value) {
+  return YGFixedPointShift(value + YG_FIXED_POINT_ONE - 1 -
+                               YG_FIXED_POINT_EPSILON,
+                           YG_FIXED_POINT_SHIFT);
+}
+
+static inline int64_t YGFixedPointRound(const int64_t value) {
+  return YGFixedPointShift(value + YG_FIXED_POINT_ONE / 2,
+                           YG_FIXED_POINT_SHIFT);
+}
+
+static inline bool YGFixedPointIsFractional(const int64_t value) {
+  const int64_t fraction = value & (YG_FIXED_POINT_ONE - 1);
+  return fraction > YG_FIXED_POINT_EPSILON &&
+         fraction < YG_FIXED_POINT_ONE - YG_FIXED_POINT_EPSILON;
+}
+
+// Rounds the nodes laid out in this generation like YGGatherNodesToRound and
+// YGRoundValuesToPixelGrid, in fixed point. The absolute edges are sums of
+// integers, which don't pick up float error with the depth of the tree, and
+// negative values are rounded to the nearest pixel like positive ones.
+static void YGRoundToFixedPointGrid(const YGNodeRef node,
+                                    const float pointScaleFactor,
+                                    const int64_t absoluteLeft,
+                                    const int64_t absoluteTop,
+                                    YGLayoutContext *const layoutContext) {
+  if (node->layout.generationCount != layoutContext->generation) {
+    return;
   }
-}
-
-void YGConfigSetLogger(const YGConfigRef config, YGLogger logger) {
-  if (logger != NULL) {
-    config->logger = logger;
+  layoutContext->stats.nodesRounded++;
+
+  YGLayout *const layout = &node->layout;
+  float *const position = YGPositionOf(node);
+  const int64_t left =
+      YGFloatToFixedPoint(position[YGEdgeLeft], pointScaleFactor);
+  const int64_t top =
+      YGFloatToFixedPoint(position[YGEdgeTop], pointScaleFactor);
+  const int64_t width = YGFloatToFixedPoint(
+      layout->dimensions[YGDimensionWidth], pointScaleFactor);
+  const int64_t height = YGFloatToFixedPoint(
+      layout->dimensions[YGDimensionHeight], pointScaleFactor);
+  const int64_t absoluteNodeLeft = absoluteLeft + left;
+  const int64_t absoluteNodeTop = absoluteTop + top;
+
+  YGRelayoutState *const relayout = layout->relayout;
+  if (relayout != NULL) {
+    relayout->left = position[YGEdgeLeft];
+    relayout->top = position[YGEdgeTop];
+    relayout->isRounded = true;
+  }
+
+  if (node->nodeType == YGNodeTypeText) {
+    // Text is never rounded down to a smaller size, which could truncate it.
+    const int64_t pixelLeft = YGFixedPointFloor(absoluteNodeLeft);
+    const int64_t pixelTop = YGFixedPointFloor(absoluteNodeTop);
+    const int64_t pixelRight =
+        YGFixedPointIsFractional(width)
+            ? YGFixedPointCeil(absoluteNodeLeft + width)
+            : YGFixedPointFloor(absoluteNodeLeft + width);
+    const int64_t pixelBottom =
+        YGFixedPointIsFractional(height)
+            ? YGFixedPointCeil(absoluteNodeTop + height)
+            : YGFixedPointFloor(absoluteNodeTop + height);
+    position[YGEdgeLeft] = YGFixedPointFloor(left) / pointScaleFactor;
+    position[YGEdgeTop] = YGFixedPointFloor(top) / pointScaleFactor;
+    layout->dimensions[YGDimensionWidth] =
+        (pixelRight - pixelLeft) / pointScaleFactor;
+    layout->dimensions[YGDimensionHeight] =
+        (pixelBottom - pixelTop) / pointScaleFactor;
   } else {
-#ifdef ANDROID
-    config->logger = &YGAndroidLog;
-#else
-    config->logger = &YGDefaultLog;
-#endif
+    position[YGEdgeLeft] = YGFixedPointRound(left) / pointScaleFactor;
+    position[YGEdgeTop] = YGFixedPointRound(top) / pointScaleFactor;
+    layout->dimensions[YGDimensionWidth] =
+        (YGFixedPointRound(absoluteNodeLeft + width) -
+         YGFixedPointRound(absoluteNodeLeft)) /
+        pointScaleFactor;
+    layout->dimensions[YGDimensionHeight] =
+        (YGFixedPointRound(absoluteNodeTop + height) -
+         YGFixedPointRound(absoluteNodeTop)) /
+        pointScaleFactor;
+  }
+
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    YGRoundToFixedPointGrid(YGChildAtCursor(node, cursor), pointScaleFactor,
+                            absoluteNodeLeft, absoluteNodeTop, layoutContext);
+  }
+}
+
+// The absolute position of a node as the rounding passes sum it up, in float
+// and in fixed point.
+typedef struct YGRoundingOrigin {
+  float left;
+  float top;
+  int64_t fixedLeft;
+  int64_t fixedTop;
+} YGRoundingOrigin;
+
+// Sums up the positions `node` and its ancestors had when they were last
+// rounded, from the root down like the rounding passes. Returns false if one
+// of them wasn't rounded since its layout was reset.
+static bool YGNodeGetRoundingOrigin(const YGNodeRef node,
+                                    const float pointScaleFactor,
+                                    YGRoundingOrigin *const origin) {
+  if (node == NULL) {
+    *origin = (YGRoundingOrigin){0};
+    return true;
+  }
+  const YGRelayoutState *const relayout = node->layout.relayout;
+  if (relayout == NULL || !relayout->isRounded ||
+      !YGNodeGetRoundingOrigin(YGParentOf(node), pointScaleFactor, origin)) {
+    return false;
+  }
+  origin->left += relayout->left;
+  origin->top += relayout->top;
+  origin->fixedLeft += YGFloatToFixedPoint(relayout->left, pointScaleFactor);
+  origin->fixedTop += YGFloatToFixedPoint(relayout->top, pointScaleFactor);
+  return true;
+}
+
+// Rounds the subtree of `node`, whose parent is at `origin`. Roots are at 0.
+static void YGRoundToPixelGrid(const YGNodeRef node,
+                               const float pointScaleFactor,
+                               const YGRoundingOrigin origin,
+                               YGLayoutContext *const layoutContext) {
+  if (pointScaleFactor == 0.0f) {
+    return;
+  }
+  if (node->config->fixedPointRounding) {
+    YGRoundToFixedPointGrid(node, pointScaleFactor, origin.fixedLeft,
+                            origin.fixedTop, layoutContext);
+    return;
+  }
+
+  layoutContext->roundingCount = 0;
+  YGGatherNodesToRound(node, pointScaleFactor, origin.left, origin.top,
+                       layoutContext);
+
+  const uint32_t count = layoutContext->roundingCount;
+  float *const edges = layoutContext->roundingEdges;
+  YGRoundValuesToPixelGrid(edges, count * YG_ROUNDED_EDGE_COUNT,
+                           pointScaleFactor);
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef rounded = layoutContext->roundingNodes[i];
+    const float *const nodeEdges = edges + i * YG_ROUNDED_EDGE_COUNT;
+    YGPositionOf(rounded)[YGEdgeLeft] = nodeEdges[0];
+    YGPositionOf(rounded)[YGEdgeTop] = nodeEdges[1];
+    rounded->layout.dimensions[YGDimensionWidth] = nodeEdges[4] - nodeEdges[2];
+    rounded->layout.dimensions[YGDimensionHeight] = nodeEdges[5] - nodeEdges[3];
+  }
+}
+
+// Starts a pass over the subtree of `node`.
+static void YGLayoutContextBegin(YGLayoutContext *const layoutContext,
+                                 const YGNodeRef node, const float parentWidth,
+                                 const float parentHeight) {
+  // Increment the generation count. This will force the recursive routine to
+  // visit
+  // all dirty nodes at least once. Subsequent visits will be skipped if the
+  // input
+  // parameters don't change.
+  const YGConfigRef config = node->config;
+  layoutContext->generation = YGAtomicAdd(&gCurrentGenerationCount, 1);
+  layoutContext->depth = 0;
+  memset(&layoutContext->stats, 0, sizeof(YGLayoutStats));
+  layoutContext->printChanges = config->printChanges;
+  layoutContext->printSkips = config->printSkips;
+  layoutContext->eventHandler = config->eventHandler;
+  layoutContext->eventConfig = config;
+  layoutContext->eventContext = config->eventContext;
+  // Memoized subtrees are rounded along with the root they were laid out in.
+  layoutContext->memoizeSubtrees = config->memoizeSubtrees;
+  YGLayoutContextForgetSubtrees(layoutContext);
+  if (layoutContext->eventHandler != NULL) {
+    YGLayoutContextEmit(layoutContext, (YGEvent){
+                                           .type = YGEventTypeLayoutBegin,
+                                           .node = node,
+                                           .width = parentWidth,
+                                           .height = parentHeight,
+                                       });
+  }
+  // Arenas are not thread safe, and printed changes must come in order.
+  layoutContext->pool =
+      node->arena == NULL && !config->printChanges ? config->pool : NULL;
+}
+
+static void YGLayoutContextEnd(YGLayoutContext *const layoutContext,
+                               const YGNodeRef node) {
+  if (layoutContext->memoizeSubtrees && !layoutContext->preserveLayouts &&
+      YGParentOf(node) != NULL) {
+    // The ancestors of the root weren't visited. A pass that only measures
+    // leaves the layouts, and so their history, as they were.
+    YGNodeRecordEdit(node, YG_HISTORY_LAID_OUT);
+  }
+  // Those of a batch are added once it is done.
+  if (!layoutContext->deferLayoutChanges) {
+    YGLayoutContextAddDirtyRoots(layoutContext);
+  }
+  YGConfigAddLayoutStats(node->config, &layoutContext->stats);
+
+  if (layoutContext->eventHandler != NULL) {
+    YGLayoutContextEmit(layoutContext,
+                        (YGEvent){
+                            .type = YGEventTypeLayoutEnd,
+                            .node = node,
+                            .width = node->layout.dimensions[YGDimensionWidth],
+                            .height =
+                                node->layout.dimensions[YGDimensionHeight],
+                        });
+  }
+}
+
+static inline bool YGFrameValueEquals(const float a, const float b) {
+  return a == b || (YGFloatIsUndefined(a) && YGFloatIsUndefined(b));
+}
+
+static inline bool YGFrameEquals(const YGFrame *const a,
+                                 const YGFrame *const b) {
+  return YGFrameValueEquals(a->left, b->left) &&
+         YGFrameValueEquals(a->top, b->top) &&
+         YGFrameValueEquals(a->width, b->width) &&
+         YGFrameValueEquals(a->height, b->height);
+}
+
+// Appends a layout change to the config of `node` if its frame isn't the one
+// recorded last.
+static void YGNodeRecordLayoutChange(const YGNodeRef node) {
+  const YGFrame frame = {
+      .left = YGPositionOf(node)[YGEdgeLeft],
+      .top = YGPositionOf(node)[YGEdgeTop],
+      .width = node->layout.dimensions[YGDimensionWidth],
+      .height = node->layout.dimensions[YGDimensionHeight],
+  };
+  YGRecordedFrame *recorded = node->recordedFrame;
+  if (recorded == NULL) {
+    recorded = YGNodeAllocColdBlock(node, sizeof(YGRecordedFrame));
+    *recorded = (YGRecordedFrame){.changeIndex = UINT32_MAX};
+    node->recordedFrame = recorded;
+  }
+  if (YGFrameEquals(&recorded->frame, &frame)) {
+    return;
+  }
+
+  const YGConfigRef config = node->config;
+  if (config->layoutChangeCount == config->layoutChangeCapacity) {
+    const uint32_t capacity = config->layoutChangeCapacity;
+    config->layoutChangeCapacity = capacity == 0 ? 64 : capacity * 2;
+    config->layoutChanges = YGConfigReallocArray(
+        config, config->layoutChanges, sizeof(YGLayoutChange) * capacity,
+        sizeof(YGLayoutChange) * config->layoutChangeCapacity);
+    config->previousLayoutChanges = YGConfigReallocArray(
+        config, config->previousLayoutChanges, sizeof(uint32_t) * capacity,
+        sizeof(uint32_t) * config->layoutChangeCapacity);
+    YGAssertWithConfig(config,
+                       config->layoutChanges != NULL &&
+                           config->previousLayoutChanges != NULL,
+                       "Could not allocate memory for layout changes");
+  }
+  if (node->arena != NULL && node->arena != config->arena) {
+    YGArenaLinkConfig(node->arena, config);
+  }
+  const uint32_t index = config->layoutChangeCount++;
+  config->previousLayoutChanges[index] = YGNodeLastLayoutChange(node);
+  config->layoutChanges[index] = (YGLayoutChange){
+      .node = node,
+      .oldFrame = recorded->frame,
+      .newFrame = frame,
+  };
+  recorded->frame = frame;
+  recorded->changeIndex = index;
+}
+
+// Records the layout changes of the nodes the layout of `generation` reached:
+// those it visited or positioned, and the subtrees of the hidden ones, which it
+// zeroed out. The rest of the tree kept its frames.
+static void YGNodeRecordLayoutChanges(const YGNodeRef node,
+                                      const uint32_t generation) {
+  YGNodeRecordLayoutChange(node);
+  const bool zeroed = node->layout.generationCount != generation;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    const YGNodeRef child = YGChildAtCursor(node, cursor);
+    if (zeroed || child->layout.generationCount == generation ||
+        child->layout.positionGenerationCount == generation) {
+      YGNodeRecordLayoutChanges(child, generation);
+    }
+  }
+}
+
+// Resolves the size of a root along `axis` from its style: the size it sets,
+// or at most its max size. Otherwise `size` and `measureMode`, the constraint
+// the root was given, are left as they are.
+static void YGNodeResolveRootSize(const YGNodeRef node,
+                                  const YGFlexDirection axis,
+                                  const float parentSize,
+                                  const float parentWidth, float *const size,
+                                  YGMeasureMode *const measureMode) {
+  if (YGNodeIsStyleDimDefined(node, axis, parentSize)) {
+    *size = YGResolveValue(YGResolvedDimensionOf(node, dim[axis]), parentSize) +
+            YGNodeMarginForAxis(node, axis, parentWidth);
+    *measureMode = YGMeasureModeExactly;
+    return;
+  }
+  const float maxSize =
+      YGResolveValue(&YGStyleOf(node)->maxDimensions[dim[axis]], parentSize);
+  if (maxSize >= 0.0f) {
+    *size = *measureMode == YGMeasureModeAtMost ? fminf(*size, maxSize)
+                                                : maxSize;
+    *measureMode = YGMeasureModeAtMost;
+  }
+}
+
+// Lays out one root. The scratch space of the context (the deferred layouts)
+// is kept, so that it can be reused for the next root.
+static void YGNodeCalculateLayoutInContext(
+    const YGNodeRef node, const float parentWidth, const float parentHeight,
+    const YGDirection parentDirection, YGLayoutContext *const layoutContext) {
+  const YGConfigRef config = node->config;
+  YGLayoutContextBegin(layoutContext, node, parentWidth, parentHeight);
+  YGResolveDimensions(node);
+
+  float width = parentWidth;
+  YGMeasureMode widthMeasureMode =
+      YGFloatIsUndefined(width) ? YGMeasureModeUndefined : YGMeasureModeExactly;
+  YGNodeResolveRootSize(node, YGFlexDirectionRow, parentWidth, parentWidth,
+                        &width, &widthMeasureMode);
+  float height = parentHeight;
+  YGMeasureMode heightMeasureMode = YGFloatIsUndefined(height)
+                                        ? YGMeasureModeUndefined
+                                        : YGMeasureModeExactly;
+  YGNodeResolveRootSize(node, YGFlexDirectionColumn, parentHeight, parentWidth,
+                        &height, &heightMeasureMode);
+
+  if (config->useRelayoutBoundaries) {
+    YGNodeRecordConstraints(node, width, height, widthMeasureMode,
+                            heightMeasureMode, parentWidth, parentHeight);
+  }
+  if (YGLayoutNodeInternal(node, width, height, parentDirection,
+                           widthMeasureMode, heightMeasureMode, parentWidth,
+                           parentHeight, true, "initial", config,
+                           layoutContext)) {
+    YGNodeSetPosition(node, node->layout.direction, parentWidth, parentHeight,
+                      parentWidth);
+    YGRoundToPixelGrid(node, config->pointScaleFactor, (YGRoundingOrigin){0},
+                       layoutContext);
+
+    if (config->printTree) {
+      YGNodePrint(node, YGPrintOptionsLayout | YGPrintOptionsChildren |
+                            YGPrintOptionsStyle);
+    }
+  }
+  // A root answered by its cache still has its size set again.
+  if (config->recordLayoutChanges && !layoutContext->deferLayoutChanges) {
+    YGNodeRecordLayoutChanges(node, layoutContext->generation);
+  }
+  YGLayoutContextEnd(layoutContext, node);
+}
+
+// Lays out a relayout boundary again with the constraints of its last layout,
+// and rounds it from where its ancestors were last rounded. If its parent
+// depends on the new layout after all, the edit goes on past it.
+static void YGNodeCalculateBoundaryLayoutInContext(
+    const YGNodeRef node, YGLayoutContext *const layoutContext) {
+  const YGConfigRef config = node->config;
+  const YGRelayoutState *const boundary = node->layout.relayout;
+  const float width = YGMeasuredDimensionsOf(node)[YGDimensionWidth];
+  const float height = YGMeasuredDimensionsOf(node)[YGDimensionHeight];
+  const bool hadOverflow = node->layout.hadOverflow;
+
+  YGRoundingOrigin origin = {0};
+  if (config->pointScaleFactor != 0.0f &&
+      (!boundary->isRounded ||
+       !YGNodeGetRoundingOrigin(YGParentOf(node), config->pointScaleFactor,
+                                &origin))) {
+    YGNodeMarkContentDirty(YGParentOf(node));
+    return;
+  }
+  YGLayoutContextBegin(layoutContext, node, boundary->parentWidth,
+                       boundary->parentHeight);
+  if (YGLayoutNodeInternal(
+          node, boundary->availableWidth, boundary->availableHeight,
+          node->layout.lastParentDirection,
+          (YGMeasureMode)boundary->widthMeasureMode,
+          (YGMeasureMode)boundary->heightMeasureMode, boundary->parentWidth,
+          boundary->parentHeight, true, "relayout-boundary", config,
+          layoutContext)) {
+    if (config->pointScaleFactor != 0.0f) {
+      // The position was set by the parent, and rounded since.
+      YGPositionOf(node)[YGEdgeLeft] = boundary->left;
+      YGPositionOf(node)[YGEdgeTop] = boundary->top;
+    }
+    YGRoundToPixelGrid(node, config->pointScaleFactor, origin, layoutContext);
+
+    if (config->printTree) {
+      YGNodePrint(node, YGPrintOptionsLayout | YGPrintOptionsChildren |
+                            YGPrintOptionsStyle);
+    }
+  }
+  if (config->recordLayoutChanges) {
+    YGNodeRecordLayoutChanges(node, layoutContext->generation);
+  }
+  YGLayoutContextEnd(layoutContext, node);
+
+  // The parent folds the overflow of its children into its own.
+  if (YGMeasuredDimensionsOf(node)[YGDimensionWidth] != width ||
+      YGMeasuredDimensionsOf(node)[YGDimensionHeight] != height ||
+      node->layout.hadOverflow != hadOverflow) {
+    YGNodeMarkContentDirty(YGParentOf(node));
+  }
+}
+
+// Lays out the dirty roots in the subtree of `root` on their own, until none
+// is left. Those that aren't dirty anymore were laid out with an ancestor, and
+// those with a dirty parent will be. The stats of the context add up those of
+// all the passes.
+static void YGNodeCalculateDirtyRootsInContext(
+    const YGNodeRef root, YGLayoutContext *const layoutContext) {
+  const YGConfigRef config = root->config;
+  YGLayoutStats stats = layoutContext->stats;
+  uint32_t i = 0;
+  while (i < config->dirtyRootCount) {
+    const YGNodeRef node = config->dirtyRoots[i];
+    YGNodeRef ancestor = node;
+    while (ancestor != NULL && ancestor != root) {
+      ancestor = YGParentOf(ancestor);
+    }
+    if (ancestor == NULL) {
+      // In another tree.
+      i++;
+      continue;
+    }
+
+    // Entries taken out are replaced by the last one, and new ones are
+    // appended, so the loop sees every entry.
+    YGConfigRemoveDirtyRoot(config, i);
+    if (node == root || !node->isDirty || YGParentOf(node)->isDirty) {
+      continue;
+    }
+    if (YGNodeIsRelayoutBoundary(node)) {
+      YGNodeCalculateBoundaryLayoutInContext(node, layoutContext);
+      YGLayoutStatsAdd(&stats, &layoutContext->stats);
+    } else {
+      // No longer a boundary, its parent lays it out.
+      YGNodeMarkContentDirty(YGParentOf(node));
+    }
+    if (root->isDirty) {
+      const YGRelayoutState *const constraints = root->layout.relayout;
+      YGNodeCalculateLayoutInContext(root, constraints->parentWidth,
+                                     constraints->parentHeight,
+                                     root->layout.lastParentDirection,
+                                     layoutContext);
+      YGLayoutStatsAdd(&stats, &layoutContext->stats);
+    }
+  }
+  layoutContext->stats = stats;
+}
+
+void YGNodeCalculateLayout(const YGNodeRef node, const float parentWidth,
+                           const float parentHeight,
+                           const YGDirection parentDirection) {
+  YGLayoutContext layoutContext = {.deferred = NULL};
+  YGNodeCalculateLayoutInContext(node, parentWidth, parentHeight,
+                                 parentDirection, &layoutContext);
+  if (node->config->dirtyRootCount > 0) {
+    YGNodeCalculateDirtyRootsInContext(node, &layoutContext);
+  }
+  YGLayoutContextFreeScratch(&layoutContext);
+}
+
+YGSize YGNodeCalculateSize(const YGNodeRef node, const float availableWidth,
+                           const YGMeasureMode widthMeasureMode,
+                           const float availableHeight,
+                           const YGMeasureMode heightMeasureMode) {
+  const YGConfigRef config = node->config;
+  const float parentWidth =
+      widthMeasureMode == YGMeasureModeUndefined ? YGUndefined : availableWidth;
+  const float parentHeight = heightMeasureMode == YGMeasureModeUndefined
+                                 ? YGUndefined
+                                 : availableHeight;
+  YGLayoutContext layoutContext = {.deferred = NULL, .preserveLayouts = true};
+  YGLayoutContextBegin(&layoutContext, node, parentWidth, parentHeight);
+  YGResolveDimensions(node);
+
+  float width = parentWidth;
+  YGMeasureMode widthMode = widthMeasureMode;
+  YGNodeResolveRootSize(node, YGFlexDirectionRow, parentWidth, parentWidth,
+                        &width, &widthMode);
+  float height = parentHeight;
+  YGMeasureMode heightMode = heightMeasureMode;
+  YGNodeResolveRootSize(node, YGFlexDirectionColumn, parentHeight, parentWidth,
+                        &height, &heightMode);
+
+  YGLayoutNodeInternal(node, width, height,
+                       (YGDirection)YGStyleOf(node)->direction, widthMode,
+                       heightMode, parentWidth, parentHeight, false,
+                       "measure-size", config, &layoutContext);
+  const YGSize size = {
+      .width = YGMeasuredDimensionsOf(node)[YGDimensionWidth],
+      .height = YGMeasuredDimensionsOf(node)[YGDimensionHeight],
+  };
+  YGLayoutContextEnd(&layoutContext, node);
+  YGLayoutContextRestoreLayouts(&layoutContext);
+  YGLayoutContextFreeScratch(&layoutContext);
+  return size;
+}
+
+void YGNodeCalculateDirtyLayouts(const YGNodeRef root) {
+  YGLayoutContext layoutContext = {.deferred = NULL};
+  if (root->isDirty) {
+    const YGRelayoutState *const constraints = root->layout.relayout;
+    YGAssertWithNode(root, constraints != NULL,
+                     "Cannot lay out a root that was never laid out with "
+                     "relayout boundaries");
+    YGNodeCalculateLayoutInContext(root, constraints->parentWidth,
+                                   constraints->parentHeight,
+                                   root->layout.lastParentDirection,
+                                   &layoutContext);
+  }
+  if (root->config->dirtyRootCount > 0) {
+    YGNodeCalculateDirtyRootsInContext(root, &layoutContext);
+  }
+  YGLayoutContextFreeScratch(&layoutContext);
+}
+
+void YGNodeCalculateLayoutWithStats(const YGNodeRef node,
+                                    const float parentWidth,
+                                    const float parentHeight,
+                                    const YGDirection parentDirection,
+                                    YGLayoutStats *const stats) {
+  YGLayoutContext layoutContext = {.deferred = NULL};
+  YGNodeCalculateLayoutInContext(node, parentWidth, parentHeight,
+                                 parentDirection, &layoutContext);
+  if (node->config->dirtyRootCount > 0) {
+    YGNodeCalculateDirtyRootsInContext(node, &layoutContext);
+  }
+  *stats = layoutContext.stats;
+  YGLayoutContextFreeScratch(&layoutContext);
+}
+
+typedef struct YGLayoutBatch {
+  const YGNodeRef *roots;
+  const YGSize *constraints;
+  uint32_t count;
+  // Index of the next root to lay out, shared by the threads of the batch.
+  uint32_t next;
+  // One context per thread of the batch, kept until the batch is done.
+  YGLayoutContext *contexts;
+  uint32_t contextCount;
+} YGLayoutBatch;
+
+// Takes roots off the batch until there are none left, reusing one context
+// for all of them.
+static void YGLayoutBatchRun(void *arg) {
+  YGLayoutBatch *const batch = arg;
+  YGLayoutContext *const layoutContext =
+      &batch->contexts[YGAtomicAdd(&batch->contextCount, 1) - 1];
+  *layoutContext = (YGLayoutContext){.deferred = NULL,
+                                     .deferLayoutChanges = true};
+  for (uint32_t index = YGAtomicAdd(&batch->next, 1) - 1; index < batch->count;
+       index = YGAtomicAdd(&batch->next, 1) - 1) {
+    const YGNodeRef root = batch->roots[index];
+    YGNodeCalculateLayoutInContext(
+        root, batch->constraints[index].width,
+        batch->constraints[index].height,
+        (YGDirection)YGStyleOf(root)->direction, layoutContext);
+  }
+}
+
+// The roots of a batch may share a config, and with it the dirty roots and
+// the layout changes, so those are handled on one thread once the batch is
+// done. Each root is still in the generation of its layout.
+static void YGLayoutBatchFinish(const YGLayoutBatch *const batch) {
+  for (uint32_t i = 0; i < batch->contextCount; i++) {
+    YGLayoutContextAddDirtyRoots(&batch->contexts[i]);
+    YGLayoutContextFreeScratch(&batch->contexts[i]);
+  }
+  YGLayoutContext layoutContext = {.deferred = NULL};
+  for (uint32_t i = 0; i < batch->count; i++) {
+    const YGNodeRef root = batch->roots[i];
+    if (root->config->recordLayoutChanges) {
+      YGNodeRecordLayoutChanges(root, root->layout.generationCount);
+    }
+    if (root->config->dirtyRootCount > 0) {
+      YGNodeCalculateDirtyRootsInContext(root, &layoutContext);
+    }
+  }
+  YGLayoutContextFreeScratch(&layoutContext);
+}
+
+void YGNodeCalculateLayoutBatch(const YGNodeRef *roots,
+                                const YGSize *constraints, const size_t count,
+                                const YGThreadPoolRef pool) {
+  YGAssert(count <= UINT32_MAX, "Too many roots in a layout batch");
+  YGLayoutBatch batch = {
+      .roots = roots,
+      .constraints = constraints,
+      .count = (uint32_t)count,
+      .next = 0,
+      .contextCount = 0,
+  };
+  if (pool == NULL || count < 2) {
+    YGLayoutContext layoutContext;
+    batch.contexts = &layoutContext;
+    YGLayoutBatchRun(&batch);
+    YGLayoutBatchFinish(&batch);
+    return;
+  }
+
+  // Roots are handed out one at a time rather than in fixed slices, so that
+  // a few large roots don't leave the other threads idle.
+  const uint32_t threadCount = YGThreadPoolGetThreadCount(pool);
+  const uint32_t taskCount =
+      threadCount < batch.count - 1 ? threadCount : batch.count - 1;
+  batch.contexts = gYGMalloc(sizeof(YGLayoutContext) * (taskCount + 1));
+  YGAssert(batch.contexts != NULL,
+           "Could not allocate memory for layout contexts");
+  int32_t pending = (int32_t)taskCount;
+  for (uint32_t i = 0; i < taskCount; i++) {
+    YGThreadPoolSpawn(pool, &YGLayoutBatchRun, &batch, &pending);
+  }
+  YGLayoutBatchRun(&batch);
+  YGThreadPoolJoin(pool, &pending);
+  YGLayoutBatchFinish(&batch);
+  gYGFree(batch.contexts);
+}
+
+void YGConfigSetLogger(const YGConfigRef config, YGLogger logger) {
+  if (logger != NULL) {
+    config->logger = logger;
+  } else {
+#ifdef ANDROID
+    config->logger = &YGAndroidLog;
+#else
+    config->logger = &YGDefaultLog;
+#endif
   }
 }
 
@@ -3912,6 +7754,96 @@ void YGConfigSetUseLegacyStretchBehaviour(
   config->useLegacyStretchBehaviour = useLegacyStretchBehaviour;
 }
 
+void YGConfigSetFixedPointRounding(const YGConfigRef config,
+                                   const bool enabled) {
+  config->fixedPointRounding = enabled;
+}
+
+bool YGConfigGetFixedPointRounding(const YGConfigRef config) {
+  return config->fixedPointRounding;
+}
+
+void YGConfigSetUseGenericLayoutKernels(const YGConfigRef config,
+                                        const bool enabled) {
+  config->useGenericLayoutKernels = enabled;
+}
+
+bool YGConfigGetUseGenericLayoutKernels(const YGConfigRef config) {
+  return config->useGenericLayoutKernels;
+}
+
+void YGConfigSetUseRelayoutBoundaries(const YGConfigRef config,
+                                      const bool enabled) {
+  config->useRelayoutBoundaries = enabled;
+}
+
+bool YGConfigGetUseRelayoutBoundaries(const YGConfigRef config) {
+  return config->useRelayoutBoundaries;
+}
+
+void YGConfigSetRecordLayoutChanges(const YGConfigRef config,
+                                    const bool enabled) {
+  config->recordLayoutChanges = enabled;
+}
+
+bool YGConfigGetRecordLayoutChanges(const YGConfigRef config) {
+  return config->recordLayoutChanges;
+}
+
+// Takes out the entries dropped since the last call, keeping the order of the
+// others. Each node still has its entries in order, so the index of its last
+// one so far is that of the one before the next.
+static void YGConfigCompactLayoutChanges(const YGConfigRef config) {
+  uint32_t count = 0;
+  for (uint32_t i = 0; i < config->layoutChangeCount; i++) {
+    const YGLayoutChange change = config->layoutChanges[i];
+    if (change.node == NULL) {
+      continue;
+    }
+    YGRecordedFrame *const recorded = change.node->recordedFrame;
+    config->previousLayoutChanges[count] =
+        config->previousLayoutChanges[i] == UINT32_MAX ? UINT32_MAX
+                                                       : recorded->changeIndex;
+    config->layoutChanges[count] = change;
+    recorded->changeIndex = count++;
+  }
+  config->layoutChangeCount = count;
+  config->droppedLayoutChangeCount = 0;
+}
+
+const YGLayoutChange *YGConfigGetLayoutChanges(const YGConfigRef config,
+                                               uint32_t *const count) {
+  if (config->droppedLayoutChangeCount > 0) {
+    YGConfigCompactLayoutChanges(config);
+  }
+  *count = config->layoutChangeCount;
+  return config->layoutChanges;
+}
+
+void YGConfigClearLayoutChanges(const YGConfigRef config) {
+  config->layoutChangeCount = 0;
+  config->droppedLayoutChangeCount = 0;
+}
+
+void YGConfigSetPrintTreeFlag(const YGConfigRef config, const bool enabled) {
+  config->printTree = enabled;
+}
+
+void YGConfigSetPrintChangesFlag(const YGConfigRef config,
+                                 const bool enabled) {
+  config->printChanges = enabled;
+}
+
+void YGConfigSetPrintSkipsFlag(const YGConfigRef config, const bool enabled) {
+  config->printSkips = enabled;
+}
+
+void YGConfigSetEventHandler(const YGConfigRef config,
+                             const YGEventHandler handler, void *context) {
+  config->eventHandler = handler;
+  config->eventContext = context;
+}
+
 bool YGConfigGetUseWebDefaults(const YGConfigRef config) {
   return config->useWebDefaults;
 }
@@ -3927,9 +7859,16 @@ void YGConfigSetNodeClonedFunc(const YGConfigRef config,
   config->cloneNodeCallback = callback;
 }
 
+void YGConfigSetNodesClonedFunc(const YGConfigRef config,
+                                const YGNodesClonedFunc callback) {
+  config->nodesClonedCallback = callback;
+}
+
 void YGSetMemoryFuncs(YGMalloc ygmalloc, YGCalloc yccalloc, YGRealloc ygrealloc,
                       YGFree ygfree) {
-  YGAssert(gNodeInstanceCount == 0 && gConfigInstanceCount == 0,
+  YGAssert(YGAtomicLoad(&gNodeInstanceCount) == 0 &&
+               YGAtomicLoad(&gConfigInstanceCount) == 0 &&
+               YGAtomicLoad(&gArenaInstanceCount) == 0,
            "Cannot set memory functions: all node must be freed first");
   YGAssert(
       (ygmalloc == NULL && yccalloc == NULL && ygrealloc == NULL &&
@@ -3976,6 +7915,22 @@ const char *YGAlignToString(const YGAlign value) {
   return "unknown";
 }
 
+const char *YGCacheOutcomeToString(const YGCacheOutcome value) {
+  switch (value) {
+    case YGCacheOutcomeNone:
+      return "none";
+    case YGCacheOutcomeLayoutHit:
+      return "layout-hit";
+    case YGCacheOutcomeMeasurementHit:
+      return "measurement-hit";
+    case YGCacheOutcomeMiss:
+      return "miss";
+    case YGCacheOutcomeSubtreeHit:
+      return "subtree-hit";
+  }
+  return "unknown";
+}
+
 const char *YGDimensionToString(const YGDimension value) {
   switch (value) {
     case YGDimensionWidth:
@@ -4032,6 +7987,28 @@ const char *YGEdgeToString(const YGEdge value) {
   return "unknown";
 }
 
+const char *YGEventTypeToString(const YGEventType value) {
+  switch (value) {
+    case YGEventTypeLayoutBegin:
+      return "layout-begin";
+    case YGEventTypeLayoutEnd:
+      return "layout-end";
+    case YGEventTypeNodeLayoutBegin:
+      return "node-layout-begin";
+    case YGEventTypeNodeLayoutEnd:
+      return "node-layout-end";
+    case YGEventTypeMeasureBegin:
+      return "measure-begin";
+    case YGEventTypeMeasureEnd:
+      return "measure-end";
+    case YGEventTypeBaselineBegin:
+      return "baseline-begin";
+    case YGEventTypeBaselineEnd:
+      return "baseline-end";
+  }
+  return "unknown";
+}
+
 const char *YGExperimentalFeatureToString(const YGExperimentalFeature value) {
   switch (value) {
     case YGExperimentalFeatureWebFlexBasis:
@@ -4170,14 +8147,196 @@ const char *YGWrapToString(const YGWrap value) {
   return "unknown";
 }
 
-// YGNodeList
+// YGChildList
 
-#include <string.h>
+static inline void YGChildListInit(YGChildList *const list) {
+  list->items = list->inlineItems;
+  list->count = 0;
+  list->capacity = YG_INLINE_CHILD_COUNT;
+  list->gapStart = 0;
+}
+
+static inline bool YGChildListIsInline(const YGChildList *const list) {
+  return list->items == list->inlineItems;
+}
+
+static inline uint32_t YGChildListGapSize(const YGChildList *const list) {
+  return list->capacity - list->count;
+}
+
+static void YGChildListRenumber(YGChildList *const list, const uint32_t start,
+                                const uint32_t end) {
+  for (uint32_t slot = start; slot < end; slot++) {
+    list->items[slot]->slotInParent = slot;
+  }
+}
+
+// Moves the gap so that it starts at `index`, shifting the items in between
+// across it.
+static void YGChildListMoveGap(YGChildList *const list, const uint32_t index) {
+  const uint32_t gapSize = YGChildListGapSize(list);
+  if (gapSize > 0 && index < list->gapStart) {
+    memmove(&list->items[index + gapSize], &list->items[index],
+            sizeof(YGNodeRef) * (list->gapStart - index));
+    YGChildListRenumber(list, index + gapSize, list->gapStart + gapSize);
+  } else if (gapSize > 0 && index > list->gapStart) {
+    memmove(&list->items[list->gapStart],
+            &list->items[list->gapStart + gapSize],
+            sizeof(YGNodeRef) * (index - list->gapStart));
+    YGChildListRenumber(list, list->gapStart, index);
+  }
+  list->gapStart = index;
+}
+
+// Returns the position of `node` in the list, or count if it isn't there.
+static uint32_t YGChildListIndexOf(const YGChildList *const list,
+                                   const YGNodeRef node) {
+  const uint32_t gapSize = YGChildListGapSize(list);
+  const uint32_t slot = node->slotInParent;
+  if (slot < list->capacity && list->items[slot] == node) {
+    if (slot < list->gapStart) {
+      return slot;
+    }
+    if (slot >= list->gapStart + gapSize) {
+      return slot - gapSize;
+    }
+  }
+
+  for (uint32_t i = 0; i < list->count; i++) {
+    if (YGChildListGet(list, i) == node) {
+      return i;
+    }
+  }
+  return list->count;
+}
+
+// Initializes `list` with the items of `from`. `list` may be a bitwise copy of
+// `from` and is not freed first.
+static void YGChildListCopy(YGChildList *const list,
+                            const YGChildList *const from,
+                            const YGArenaRef arena) {
+  const uint32_t count = from->count;
+  const uint32_t gapStart = from->gapStart;
+  YGNodeRef *const items = from->items;
+  YGChildListInit(list);
+  if (count > YG_INLINE_CHILD_COUNT) {
+    const size_t size = sizeof(YGNodeRef) * count;
+    list->items =
+        arena != NULL ? YGArenaAlloc(arena, size) : gYGMalloc(size);
+    YGAssert(list->items != NULL, "Could not allocate memory for items");
+    list->capacity = count;
+  }
+  memcpy(list->items, items, sizeof(YGNodeRef) * gapStart);
+  memcpy(&list->items[gapStart], &items[gapStart + YGChildListGapSize(from)],
+         sizeof(YGNodeRef) * (count - gapStart));
+  list->count = count;
+  list->gapStart = count;
+}
+
+static void YGChildListFree(YGChildList *const list, const YGArenaRef arena) {
+  if (!YGChildListIsInline(list) && arena == NULL) {
+    gYGFree(list->items);
+  }
+  YGChildListInit(list);
+}
+
+// Grows the list to hold at least `capacity` items. The gap stays at
+// gapStart.
+static void YGChildListReserve(YGChildList *const list, const YGArenaRef arena,
+                               const uint32_t capacity) {
+  if (capacity <= list->capacity) {
+    return;
+  }
 
-extern YGMalloc gYGMalloc;
-extern YGRealloc gYGRealloc;
-extern YGFree gYGFree;
+  uint32_t newCapacity = list->capacity * 2;
+  if (newCapacity < capacity) {
+    newCapacity = capacity;
+  }
+  const size_t size = sizeof(YGNodeRef) * newCapacity;
+  const uint32_t tailCount = list->count - list->gapStart;
+  const uint32_t tailStart = list->capacity - tailCount;
+  if (YGChildListIsInline(list)) {
+    YGNodeRef *items =
+        arena != NULL ? YGArenaAlloc(arena, size) : gYGMalloc(size);
+    YGAssert(items != NULL, "Could not allocate memory for items");
+    memcpy(items, list->inlineItems, sizeof(YGNodeRef) * list->capacity);
+    list->items = items;
+  } else {
+    list->items =
+        arena != NULL
+            ? YGArenaRealloc(arena, list->items,
+                             sizeof(YGNodeRef) * list->capacity, size)
+            : gYGRealloc(list->items, size);
+    YGAssert(list->items != NULL, "Could not extend allocation for items");
+  }
+
+  // Keep the items after the gap at the end of the list.
+  const uint32_t newTailStart = newCapacity - tailCount;
+  memmove(&list->items[newTailStart], &list->items[tailStart],
+          sizeof(YGNodeRef) * tailCount);
+  list->capacity = newCapacity;
+  YGChildListRenumber(list, newTailStart, newCapacity);
+}
+
+static void YGChildListInsert(YGChildList *const list, const YGArenaRef arena,
+                              const YGNodeRef node, const uint32_t index) {
+  YGChildListMoveGap(list, index);
+  YGChildListReserve(list, arena, list->count + 1);
+
+  list->items[index] = node;
+  node->slotInParent = index;
+  list->gapStart++;
+  list->count++;
+}
+
+static inline void YGChildListReplace(YGChildList *const list,
+                                      const uint32_t index,
+                                      const YGNodeRef newNode) {
+  const uint32_t slot = index < list->gapStart
+                            ? index
+                            : index + YGChildListGapSize(list);
+  list->items[slot] = newNode;
+  newNode->slotInParent = slot;
+}
+
+static inline void YGChildListRemoveAll(YGChildList *const list) {
+  list->count = 0;
+  list->gapStart = 0;
+}
 
+static void YGChildListRemoveRange(YGChildList *const list,
+                                   const uint32_t index, const uint32_t count) {
+  // Bring the gap up against the range without moving the removed items, which
+  // the caller may already have freed. The range then just widens the gap.
+  if (list->gapStart < index) {
+    YGChildListMoveGap(list, index);
+  } else if (list->gapStart > index + count) {
+    YGChildListMoveGap(list, index + count);
+  }
+  list->gapStart = index;
+  list->count -= count;
+}
+
+static YGNodeRef YGChildListRemove(YGChildList *const list,
+                                   const uint32_t index) {
+  const YGNodeRef removed = YGChildListGet(list, index);
+  YGChildListRemoveRange(list, index, 1);
+  return removed;
+}
+
+static YGNodeRef YGChildListDelete(YGChildList *const list,
+                                   const YGNodeRef node) {
+  const uint32_t index = YGChildListIndexOf(list, node);
+  if (index == list->count) {
+    return NULL;
+  }
+  return YGChildListRemove(list, index);
+}
+
+// YGNodeList
+
+// The list of nodes of the header. Nodes keep their children in a YGChildList,
+// these are for code that keeps lists of nodes of its own.
 struct YGNodeList {
   uint32_t capacity;
   uint32_t count;
@@ -4188,7 +8347,7 @@ YGNodeListRef YGNodeListNew(const uint32_t initialCapacity) {
   const YGNodeListRef list = gYGMalloc(sizeof(struct YGNodeList));
   YGAssert(list != NULL, "Could not allocate memory for list");
 
-  list->capacity = initialCapacity;
+  list->capacity = initialCapacity > 0 ? initialCapacity : 1;
   list->count = 0;
   list->items = gYGMalloc(sizeof(YGNodeRef) * list->capacity);
   YGAssert(list->items != NULL, "Could not allocate memory for items");
@@ -4230,35 +8389,25 @@ void YGNodeListInsert(YGNodeListRef *listp, const YGNodeRef node,
     YGAssert(list->items != NULL, "Could not extend allocation for items");
   }
 
-  for (uint32_t i = list->count; i > index; i--) {
-    list->items[i] = list->items[i - 1];
-  }
-
+  memmove(&list->items[index + 1], &list->items[index],
+          sizeof(YGNodeRef) * (list->count - index));
   list->count++;
   list->items[index] = node;
 }
 
-void YGNodeListReplace(YGNodeListRef list, const uint32_t index,
+void YGNodeListReplace(const YGNodeListRef list, const uint32_t index,
                        const YGNodeRef newNode) {
   list->items[index] = newNode;
 }
 
 void YGNodeListRemoveAll(const YGNodeListRef list) {
-  for (uint32_t i = 0; i < list->count; i++) {
-    list->items[i] = NULL;
-  }
   list->count = 0;
 }
 
 YGNodeRef YGNodeListRemove(const YGNodeListRef list, const uint32_t index) {
   const YGNodeRef removed = list->items[index];
-  list->items[index] = NULL;
-
-  for (uint32_t i = index; i < list->count - 1; i++) {
-    list->items[i] = list->items[i + 1];
-    list->items[i + 1] = NULL;
-  }
-
+  memmove(&list->items[index], &list->items[index + 1],
+          sizeof(YGNodeRef) * (list->count - index - 1));
   list->count--;
   return removed;
 }
@@ -4282,10 +8431,7 @@ YGNodeRef YGNodeListGet(const YGNodeListRef list, const uint32_t index) {
 }
 
 YGNodeListRef YGNodeListClone(const YGNodeListRef oldList) {
-  if (!oldList) {
-    return NULL;
-  }
-  const uint32_t count = oldList->count;
+  const uint32_t count = YGNodeListCount(oldList);
   if (count == 0) {
     return NULL;
   }
@@ -4294,3 +8440,1596 @@ YGNodeListRef YGNodeListClone(const YGNodeListRef oldList) {
   newList->count = count;
   return newList;
 }
+
+// YGArena
+
+// Slabs are sized so that a few hundred nodes fit in each one.
+#define YG_ARENA_DEFAULT_CHUNK_SIZE (256 * 1024)
+#define YG_ARENA_ALIGNMENT 16
+
+typedef struct YGArenaChunk {
+  struct YGArenaChunk *next;
+  size_t capacity;
+  size_t used;
+  _Alignas(YG_ARENA_ALIGNMENT) uint8_t data[];
+} YGArenaChunk;
+
+struct YGArena {
+  YGArenaChunk *head;
+  size_t chunkSize;
+  size_t allocatedBytes;
+  int32_t nodeCount;
+  int32_t configCount;
+  // The configs outside the arena that hold entries of its nodes, see
+  // YGArenaDropEntries.
+  YGConfigRef *linkedConfigs;
+  uint32_t linkedConfigCount;
+  uint32_t linkedConfigCapacity;
+};
+
+static inline size_t YGArenaAlign(const size_t size) {
+  return (size + YG_ARENA_ALIGNMENT - 1) & ~((size_t)YG_ARENA_ALIGNMENT - 1);
+}
+
+static YGArenaChunk *YGArenaChunkNew(const size_t capacity) {
+  YGArenaChunk *chunk = gYGMalloc(sizeof(YGArenaChunk) + capacity);
+  YGAssert(chunk != NULL, "Could not allocate memory for arena chunk");
+  chunk->next = NULL;
+  chunk->capacity = capacity;
+  chunk->used = 0;
+  return chunk;
+}
+
+YGArenaRef YGArenaNew(const size_t chunkSize) {
+  const YGArenaRef arena = gYGMalloc(sizeof(struct YGArena));
+  YGAssert(arena != NULL, "Could not allocate memory for arena");
+  YGAtomicAdd(&gArenaInstanceCount, 1);
+
+  arena->chunkSize = YGArenaAlign(
+      chunkSize > 0 ? chunkSize : YG_ARENA_DEFAULT_CHUNK_SIZE);
+  arena->head = YGArenaChunkNew(arena->chunkSize);
+  arena->allocatedBytes = 0;
+  arena->nodeCount = 0;
+  arena->configCount = 0;
+  arena->linkedConfigs = NULL;
+  arena->linkedConfigCount = 0;
+  arena->linkedConfigCapacity = 0;
+  return arena;
+}
+
+static void YGArenaFreeChunks(YGArenaChunk *chunk) {
+  while (chunk != NULL) {
+    YGArenaChunk *next = chunk->next;
+    gYGFree(chunk);
+    chunk = next;
+  }
+}
+
+// Takes the nodes of the arena out of the dirty roots and the layout changes
+// of the configs outside it, while they can still be read.
+static void YGArenaDropEntries(const YGArenaRef arena) {
+  while (arena->linkedConfigCount > 0) {
+    const YGConfigRef config = arena->linkedConfigs[0];
+    uint32_t i = 0;
+    while (i < config->dirtyRootCount) {
+      if (config->dirtyRoots[i]->arena == arena) {
+        YGConfigRemoveDirtyRoot(config, i);
+      } else {
+        i++;
+      }
+    }
+    for (i = 0; i < config->layoutChangeCount; i++) {
+      YGLayoutChange *const change = &config->layoutChanges[i];
+      if (change->node != NULL && change->node->arena == arena) {
+        change->node = NULL;
+        config->droppedLayoutChangeCount++;
+      }
+    }
+    YGArenaUnlinkConfig(arena, config);
+  }
+}
+
+void YGArenaReset(const YGArenaRef arena) {
+  YGArenaDropEntries(arena);
+  // Everything still alive in the arena goes away with it.
+  YGAtomicAdd(&gNodeInstanceCount, -arena->nodeCount);
+  YGAtomicAdd(&gConfigInstanceCount, -arena->configCount);
+  arena->nodeCount = 0;
+  arena->configCount = 0;
+
+  // Keep the most recent slab around for reuse and drop the others.
+  YGArenaFreeChunks(arena->head->next);
+  arena->head->next = NULL;
+  arena->head->used = 0;
+  arena->allocatedBytes = 0;
+}
+
+void YGArenaFree(const YGArenaRef arena) {
+  YGArenaDropEntries(arena);
+  gYGFree(arena->linkedConfigs);
+  YGAtomicAdd(&gNodeInstanceCount, -arena->nodeCount);
+  YGAtomicAdd(&gConfigInstanceCount, -arena->configCount);
+  YGArenaFreeChunks(arena->head);
+  gYGFree(arena);
+  YGAtomicAdd(&gArenaInstanceCount, -1);
+}
+
+size_t YGArenaGetAllocatedBytes(const YGArenaRef arena) {
+  return arena->allocatedBytes;
+}
+
+void *YGArenaAlloc(const YGArenaRef arena, const size_t size) {
+  const size_t alignedSize = YGArenaAlign(size);
+  YGArenaChunk *chunk = arena->head;
+  if (chunk->used + alignedSize > chunk->capacity) {
+    // Oversized requests get a slab of their own.
+    chunk = YGArenaChunkNew(alignedSize > arena->chunkSize ? alignedSize
+                                                            : arena->chunkSize);
+    chunk->next = arena->head;
+    arena->head = chunk;
+  }
+  void *ptr = chunk->data + chunk->used;
+  chunk->used += alignedSize;
+  arena->allocatedBytes += alignedSize;
+  return ptr;
+}
+
+void *YGArenaRealloc(const YGArenaRef arena, void *ptr, const size_t oldSize,
+                     const size_t newSize) {
+  YGArenaChunk *chunk = arena->head;
+  const size_t alignedOldSize = YGArenaAlign(oldSize);
+  const size_t alignedNewSize = YGArenaAlign(newSize);
+  // The most recent allocation can grow in place.
+  if (ptr != NULL &&
+      (uint8_t *)ptr + alignedOldSize ==
+          chunk->data + chunk->used &&
+      chunk->used - alignedOldSize + alignedNewSize <= chunk->capacity) {
+    chunk->used += alignedNewSize - alignedOldSize;
+    arena->allocatedBytes += alignedNewSize - alignedOldSize;
+    return ptr;
+  }
+  void *newPtr = YGArenaAlloc(arena, newSize);
+  if (ptr != NULL) {
+    memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+  }
+  return newPtr;
+}
+
+static void YGArenaRetainNode(const YGArenaRef arena) {
+  if (arena != NULL) {
+    arena->nodeCount++;
+  }
+}
+
+static void YGArenaReleaseNode(const YGArenaRef arena) {
+  if (arena != NULL) {
+    arena->nodeCount--;
+  }
+}
+
+static void YGArenaRetainConfig(const YGArenaRef arena) {
+  if (arena != NULL) {
+    arena->configCount++;
+  }
+}
+
+static void YGArenaReleaseConfig(const YGArenaRef arena) {
+  if (arena != NULL) {
+    arena->configCount--;
+  }
+}
+
+// Called when a node of `arena` gets an entry in `config`, which is outside
+// it. The arena takes the entries of its nodes out when it is reset or freed,
+// and the config unlinks itself when it is freed first. Both lists hold a few
+// items at most.
+static void YGArenaLinkConfig(const YGArenaRef arena,
+                              const YGConfigRef config) {
+  for (uint32_t i = 0; i < arena->linkedConfigCount; i++) {
+    if (arena->linkedConfigs[i] == config) {
+      return;
+    }
+  }
+  if (arena->linkedConfigCount == arena->linkedConfigCapacity) {
+    arena->linkedConfigCapacity = arena->linkedConfigCapacity == 0
+                                      ? 4
+                                      : arena->linkedConfigCapacity * 2;
+    arena->linkedConfigs =
+        gYGRealloc(arena->linkedConfigs,
+                   sizeof(YGConfigRef) * arena->linkedConfigCapacity);
+  }
+  if (config->nodeArenaCount == config->nodeArenaCapacity) {
+    config->nodeArenaCapacity =
+        config->nodeArenaCapacity == 0 ? 4 : config->nodeArenaCapacity * 2;
+    config->nodeArenas = gYGRealloc(
+        config->nodeArenas, sizeof(YGArenaRef) * config->nodeArenaCapacity);
+  }
+  YGAssertWithConfig(config,
+                     arena->linkedConfigs != NULL && config->nodeArenas != NULL,
+                     "Could not allocate memory for arena links");
+  arena->linkedConfigs[arena->linkedConfigCount++] = config;
+  config->nodeArenas[config->nodeArenaCount++] = arena;
+}
+
+static void YGArenaUnlinkConfig(const YGArenaRef arena,
+                                const YGConfigRef config) {
+  for (uint32_t i = 0; i < arena->linkedConfigCount; i++) {
+    if (arena->linkedConfigs[i] == config) {
+      arena->linkedConfigs[i] =
+          arena->linkedConfigs[--arena->linkedConfigCount];
+      break;
+    }
+  }
+  for (uint32_t i = 0; i < config->nodeArenaCount; i++) {
+    if (config->nodeArenas[i] == arena) {
+      config->nodeArenas[i] = config->nodeArenas[--config->nodeArenaCount];
+      break;
+    }
+  }
+}
+
+// YGTree
+
+YGTreeRef YGTreeNew(const YGConfigRef config) {
+  // The nodes of a tree are not allocated from an arena, and must not outlive
+  // their config.
+  YGAssertWithConfig(config, config->arena == NULL,
+                     "Cannot create a tree with the config of an arena");
+  const YGTreeRef tree = gYGMalloc(sizeof(struct YGTree));
+  YGAssertWithConfig(config, tree != NULL,
+                     "Could not allocate memory for tree");
+  memset(tree, 0, sizeof(struct YGTree));
+  tree->config = config;
+  return tree;
+}
+
+void YGTreeFree(const YGTreeRef tree) {
+  for (uint32_t i = 0; i < tree->count; i++) {
+    YGNodeFreeColdBlocks(YGTreeNodeAt(tree, i));
+  }
+  YGAtomicAdd(&gNodeInstanceCount, -(int32_t)tree->count);
+  for (uint32_t i = 0; i < tree->capacity >> YG_TREE_CHUNK_SHIFT; i++) {
+    gYGFree(tree->chunks[i]);
+  }
+  gYGFree(tree->chunks);
+  gYGFree(tree->styles);
+  gYGFree(tree->measuredDimensions);
+  gYGFree(tree->positions);
+  gYGFree(tree->parents);
+  gYGFree(tree->firstChildren);
+  gYGFree(tree->nextSiblings);
+  gYGFree(tree->lastChildren);
+  gYGFree(tree->childCounts);
+  gYGFree(tree);
+}
+
+static void *YGTreeReallocColumn(const YGTreeRef tree, void *column,
+                                 const size_t itemSize,
+                                 const uint32_t capacity) {
+  column = gYGRealloc(column, itemSize * capacity);
+  YGAssertWithConfig(tree->config, column != NULL,
+                     "Could not allocate memory for tree");
+  return column;
+}
+
+void YGTreeReserve(const YGTreeRef tree, const uint32_t capacity) {
+  if (capacity <= tree->capacity) {
+    return;
+  }
+  // Records are allocated a chunk at a time, and the columns as many.
+  const uint32_t chunkCount =
+      (capacity + YG_TREE_CHUNK_SIZE - 1) >> YG_TREE_CHUNK_SHIFT;
+  const uint32_t newCapacity = chunkCount << YG_TREE_CHUNK_SHIFT;
+  tree->chunks = YGTreeReallocColumn(tree, tree->chunks, sizeof(YGNode *),
+                                     chunkCount);
+  for (uint32_t i = tree->capacity >> YG_TREE_CHUNK_SHIFT; i < chunkCount;
+       i++) {
+    tree->chunks[i] = gYGMalloc(sizeof(YGNode) * YG_TREE_CHUNK_SIZE);
+    YGAssertWithConfig(tree->config, tree->chunks[i] != NULL,
+                       "Could not allocate memory for tree");
+  }
+
+  tree->styles = YGTreeReallocColumn(tree, tree->styles, sizeof(YGStyle),
+                                     newCapacity);
+  tree->measuredDimensions =
+      YGTreeReallocColumn(tree, tree->measuredDimensions,
+                          sizeof(*tree->measuredDimensions), newCapacity);
+  tree->positions = YGTreeReallocColumn(
+      tree, tree->positions, sizeof(*tree->positions), newCapacity);
+  tree->parents = YGTreeReallocColumn(tree, tree->parents,
+                                      sizeof(YGNodeHandle), newCapacity);
+  tree->firstChildren = YGTreeReallocColumn(
+      tree, tree->firstChildren, sizeof(YGNodeHandle), newCapacity);
+  tree->nextSiblings = YGTreeReallocColumn(tree, tree->nextSiblings,
+                                           sizeof(YGNodeHandle), newCapacity);
+  tree->lastChildren = YGTreeReallocColumn(tree, tree->lastChildren,
+                                           sizeof(YGNodeHandle), newCapacity);
+  tree->childCounts = YGTreeReallocColumn(tree, tree->childCounts,
+                                          sizeof(uint32_t), newCapacity);
+  tree->capacity = newCapacity;
+}
+
+YGTreeRef YGTreeCopy(const YGTreeRef tree) {
+  const YGTreeRef copy = YGTreeNew(tree->config);
+  const uint32_t count = tree->count;
+  YGTreeReserve(copy, count);
+  for (uint32_t i = 0; i < count; i += YG_TREE_CHUNK_SIZE) {
+    const uint32_t chunkCount =
+        count - i < YG_TREE_CHUNK_SIZE ? count - i : YG_TREE_CHUNK_SIZE;
+    memcpy(copy->chunks[i >> YG_TREE_CHUNK_SHIFT],
+           tree->chunks[i >> YG_TREE_CHUNK_SHIFT],
+           sizeof(YGNode) * chunkCount);
+  }
+  memcpy(copy->styles, tree->styles, sizeof(YGStyle) * count);
+  memcpy(copy->measuredDimensions, tree->measuredDimensions,
+         sizeof(*tree->measuredDimensions) * count);
+  memcpy(copy->positions, tree->positions, sizeof(*tree->positions) * count);
+  memcpy(copy->parents, tree->parents, sizeof(YGNodeHandle) * count);
+  memcpy(copy->firstChildren, tree->firstChildren,
+         sizeof(YGNodeHandle) * count);
+  memcpy(copy->nextSiblings, tree->nextSiblings, sizeof(YGNodeHandle) * count);
+  memcpy(copy->lastChildren, tree->lastChildren, sizeof(YGNodeHandle) * count);
+  memcpy(copy->childCounts, tree->childCounts, sizeof(uint32_t) * count);
+  copy->count = count;
+  YGAtomicAdd(&gNodeInstanceCount, (int32_t)count);
+
+  // Only the records point outside of the columns.
+  for (uint32_t i = 0; i < count; i++) {
+    const YGNodeRef node = YGTreeNodeAt(copy, i);
+    const YGNode *const oldNode = YGTreeNodeAt(tree, i);
+    node->tree = copy;
+    node->nextChild = NULL;
+    YGNodeCloneColdBlocks(node, oldNode);
+    // A copy of a dirty root is one too, as with YGNodeClone.
+    if (YGNodeIsDirtyRoot(oldNode)) {
+      YGConfigAddDirtyRoot(node->config, node);
+    }
+  }
+  return copy;
+}
+
+YGNodeHandle YGTreeAppendNode(const YGTreeRef tree, const YGNodeHandle parent) {
+  YGAssertWithConfig(tree->config,
+                     parent != YGNodeHandleNone || tree->count == 0,
+                     "Only the first node of a tree can be its root");
+  YGAssertWithConfig(tree->config,
+                     parent == YGNodeHandleNone || parent < tree->count,
+                     "Parent is not a node of this tree");
+  if (tree->count == tree->capacity) {
+    YGTreeReserve(tree, tree->capacity > 0 ? tree->capacity * 2
+                                           : YG_TREE_CHUNK_SIZE);
+  }
+
+  const YGNodeHandle handle = tree->count++;
+  YGAtomicAdd(&gNodeInstanceCount, 1);
+  const YGNodeRef node = YGTreeNodeAt(tree, handle);
+  memcpy(node, &gYGNodeDefaults.node, sizeof(YGNode));
+  node->tree = tree;
+  node->handle = handle;
+  node->config = tree->config;
+
+  YGStyle *const style = &tree->styles[handle];
+  memcpy(style, &gYGNodeDefaults.style, sizeof(YGStyle));
+  if (tree->config->useWebDefaults) {
+    style->flexDirection = YGFlexDirectionRow;
+    style->alignContent = YGAlignStretch;
+  }
+  memcpy(tree->measuredDimensions[handle], gYGNodeDefaults.measuredDimensions,
+         sizeof(gYGNodeDefaults.measuredDimensions));
+  memset(tree->positions[handle], 0, sizeof(gYGNodeDefaults.position));
+  tree->parents[handle] = parent;
+  tree->firstChildren[handle] = YGNodeHandleNone;
+  tree->nextSiblings[handle] = YGNodeHandleNone;
+  tree->lastChildren[handle] = YGNodeHandleNone;
+  tree->childCounts[handle] = 0;
+  if (parent == YGNodeHandleNone) {
+    return handle;
+  }
+
+  const YGNodeRef parentNode = YGTreeNodeAt(tree, parent);
+  YGAssertWithNode(
+      parentNode, parentNode->measure == NULL,
+      "Cannot add child: Nodes with measure functions cannot have children.");
+  const uint32_t index = tree->childCounts[parent]++;
+  if (index == 0) {
+    tree->firstChildren[parent] = handle;
+  } else {
+    tree->nextSiblings[tree->lastChildren[parent]] = handle;
+  }
+  tree->lastChildren[parent] = handle;
+  YGNodeRecordChildEdit(parentNode,
+                        YGHashMix(YGHashMix(YG_HISTORY_INSERTED, index),
+                                  node->layout.history));
+  YGNodeMarkContentDirty(parentNode);
+  return handle;
+}
+
+uint32_t YGTreeGetNodeCount(const YGTreeRef tree) { return tree->count; }
+
+YGNodeRef YGTreeGetNode(const YGTreeRef tree, const YGNodeHandle handle) {
+  YGAssertWithConfig(tree->config, handle < tree->count,
+                     "Handle is not a node of this tree");
+  return YGTreeNodeAt(tree, handle);
+}
+
+YGNodeHandle YGTreeGetNodeHandle(const YGTreeRef tree, const YGNodeRef node) {
+  YGAssertWithNode(node, node->tree == tree,
+                   "Node does not belong to this tree");
+  return node->handle;
+}
+
+YGNodeHandle YGTreeGetParent(const YGTreeRef tree, const YGNodeHandle handle) {
+  return tree->parents[handle];
+}
+
+YGNodeHandle YGTreeGetFirstChild(const YGTreeRef tree,
+                                 const YGNodeHandle handle) {
+  return tree->firstChildren[handle];
+}
+
+YGNodeHandle YGTreeGetNextSibling(const YGTreeRef tree,
+                                  const YGNodeHandle handle) {
+  return tree->nextSiblings[handle];
+}
+
+void YGTreeCalculateLayout(const YGTreeRef tree, const float availableWidth,
+                           const float availableHeight,
+                           const YGDirection parentDirection) {
+  if (tree->count > 0) {
+    YGNodeCalculateLayout(YGTreeNodeAt(tree, 0), availableWidth,
+                          availableHeight, parentDirection);
+  }
+}
+
+// YGThreadPool
+
+void YGConfigSetParallelism(const YGConfigRef config,
+                            const YGThreadPoolRef pool) {
+  config->pool = pool;
+}
+
+#ifdef YG_THREAD_POOL
+
+// Worker threads lay out whole subtrees recursively.
+#define YG_THREAD_POOL_STACK_SIZE (4 * 1024 * 1024)
+
+typedef struct YGTask {
+  void (*run)(void *arg);
+  void *arg;
+  // Decremented once the task has run.
+  int32_t *pending;
+} YGTask;
+
+// A ring of tasks. Its owner takes the newest task, which keeps the subtree it
+// just deferred warm in its cache; thieves take the oldest.
+typedef struct YGTaskQueue {
+  pthread_mutex_t lock;
+  YGTask *tasks;
+  uint32_t head;
+  uint32_t count;
+  uint32_t capacity;
+} YGTaskQueue;
+
+typedef struct YGThreadPoolWorker {
+  YGThreadPoolRef pool;
+  uint32_t index;
+  pthread_t thread;
+} YGThreadPoolWorker;
+
+struct YGThreadPool {
+  uint32_t threadCount;
+  YGThreadPoolWorker *workers;
+  // One queue per worker, then the one shared by threads outside the pool.
+  YGTaskQueue *queues;
+  int32_t queuedCount;
+  bool shutdown;
+  pthread_mutex_t sleepLock;
+  pthread_cond_t wake;
+};
+
+static _Thread_local YGThreadPoolRef gYGCurrentPool = NULL;
+static _Thread_local uint32_t gYGCurrentQueue = 0;
+
+static void YGTaskQueuePush(YGTaskQueue *const queue, const YGTask task) {
+  pthread_mutex_lock(&queue->lock);
+  if (queue->count == queue->capacity) {
+    const uint32_t capacity = queue->capacity == 0 ? 16 : queue->capacity * 2;
+    YGTask *const tasks = gYGMalloc(sizeof(YGTask) * capacity);
+    YGAssert(tasks != NULL, "Could not allocate memory for tasks");
+    for (uint32_t i = 0; i < queue->count; i++) {
+      tasks[i] = queue->tasks[(queue->head + i) % queue->capacity];
+    }
+    gYGFree(queue->tasks);
+    queue->tasks = tasks;
+    queue->head = 0;
+    queue->capacity = capacity;
+  }
+  queue->tasks[(queue->head + queue->count++) % queue->capacity] = task;
+  pthread_mutex_unlock(&queue->lock);
+}
+
+static bool YGTaskQueuePop(YGTaskQueue *const queue, const bool newest,
+                           YGTask *const task) {
+  pthread_mutex_lock(&queue->lock);
+  const bool found = queue->count > 0;
+  if (found) {
+    if (newest) {
+      *task = queue->tasks[(queue->head + queue->count - 1) % queue->capacity];
+    } else {
+      *task = queue->tasks[queue->head];
+      queue->head = (queue->head + 1) % queue->capacity;
+    }
+    queue->count--;
+  }
+  pthread_mutex_unlock(&queue->lock);
+  return found;
+}
+
+static uint32_t YGThreadPoolCurrentQueue(const YGThreadPoolRef pool) {
+  return gYGCurrentPool == pool ? gYGCurrentQueue : pool->threadCount;
+}
+
+// Runs a task from the queue of the calling thread or, failing that, steals
+// one from the other queues.
+static bool YGThreadPoolRunTask(const YGThreadPoolRef pool) {
+  const uint32_t queueCount = pool->threadCount + 1;
+  const uint32_t current = YGThreadPoolCurrentQueue(pool);
+  YGTask task;
+  bool found = YGTaskQueuePop(&pool->queues[current], true, &task);
+  for (uint32_t i = 1; !found && i < queueCount; i++) {
+    found = YGTaskQueuePop(&pool->queues[(current + i) % queueCount], false,
+                           &task);
+  }
+  if (!found) {
+    return false;
+  }
+
+  YGAtomicAdd(&pool->queuedCount, -1);
+  task.run(task.arg);
+  __atomic_sub_fetch(task.pending, 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void *YGThreadPoolWorkerMain(void *arg) {
+  const YGThreadPoolWorker *const worker = arg;
+  const YGThreadPoolRef pool = worker->pool;
+  gYGCurrentPool = pool;
+  gYGCurrentQueue = worker->index;
+
+  for (;;) {
+    if (YGThreadPoolRunTask(pool)) {
+      continue;
+    }
+    pthread_mutex_lock(&pool->sleepLock);
+    while (YGAtomicLoad(&pool->queuedCount) <= 0 && !pool->shutdown) {
+      pthread_cond_wait(&pool->wake, &pool->sleepLock);
+    }
+    const bool shutdown = pool->shutdown;
+    pthread_mutex_unlock(&pool->sleepLock);
+    if (shutdown) {
+      return NULL;
+    }
+  }
+}
+
+static void YGThreadPoolSpawn(const YGThreadPoolRef pool,
+                              void (*run)(void *arg), void *arg,
+                              int32_t *pending) {
+  YGTaskQueuePush(&pool->queues[YGThreadPoolCurrentQueue(pool)],
+                  (YGTask){.run = run, .arg = arg, .pending = pending});
+  YGAtomicAdd(&pool->queuedCount, 1);
+
+  pthread_mutex_lock(&pool->sleepLock);
+  pthread_cond_signal(&pool->wake);
+  pthread_mutex_unlock(&pool->sleepLock);
+}
+
+// The joining thread helps with whatever tasks are queued, its own first,
+// rather than blocking.
+static void YGThreadPoolJoin(const YGThreadPoolRef pool, int32_t *pending) {
+  while (__atomic_load_n(pending, __ATOMIC_ACQUIRE) > 0) {
+    if (!YGThreadPoolRunTask(pool)) {
+      sched_yield();
+    }
+  }
+}
+
+YGThreadPoolRef YGThreadPoolNew(const uint32_t threadCount) {
+  const YGThreadPoolRef pool = gYGMalloc(sizeof(struct YGThreadPool));
+  YGAssert(pool != NULL, "Could not allocate memory for thread pool");
+  pool->threadCount = threadCount;
+  pool->queuedCount = 0;
+  pool->shutdown = false;
+  pthread_mutex_init(&pool->sleepLock, NULL);
+  pthread_cond_init(&pool->wake, NULL);
+
+  pool->queues = gYGCalloc(threadCount + 1, sizeof(YGTaskQueue));
+  YGAssert(pool->queues != NULL, "Could not allocate memory for thread pool");
+  for (uint32_t i = 0; i <= threadCount; i++) {
+    pthread_mutex_init(&pool->queues[i].lock, NULL);
+  }
+
+  pool->workers = gYGCalloc(threadCount > 0 ? threadCount : 1,
+                            sizeof(YGThreadPoolWorker));
+  YGAssert(pool->workers != NULL, "Could not allocate memory for thread pool");
+  pthread_attr_t attributes;
+  pthread_attr_init(&attributes);
+  pthread_attr_setstacksize(&attributes, YG_THREAD_POOL_STACK_SIZE);
+  for (uint32_t i = 0; i < threadCount; i++) {
+    YGThreadPoolWorker *const worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->index = i;
+    const int result = pthread_create(&worker->thread, &attributes,
+                                      &YGThreadPoolWorkerMain, worker);
+    YGAssert(result == 0, "Could not start thread pool worker");
+  }
+  pthread_attr_destroy(&attributes);
+  return pool;
+}
+
+void YGThreadPoolFree(const YGThreadPoolRef pool) {
+  pthread_mutex_lock(&pool->sleepLock);
+  pool->shutdown = true;
+  pthread_cond_broadcast(&pool->wake);
+  pthread_mutex_unlock(&pool->sleepLock);
+
+  for (uint32_t i = 0; i < pool->threadCount; i++) {
+    pthread_join(pool->workers[i].thread, NULL);
+  }
+  for (uint32_t i = 0; i <= pool->threadCount; i++) {
+    pthread_mutex_destroy(&pool->queues[i].lock);
+    gYGFree(pool->queues[i].tasks);
+  }
+  pthread_cond_destroy(&pool->wake);
+  pthread_mutex_destroy(&pool->sleepLock);
+  gYGFree(pool->queues);
+  gYGFree(pool->workers);
+  gYGFree(pool);
+}
+
+uint32_t YGThreadPoolGetThreadCount(const YGThreadPoolRef pool) {
+  return pool->threadCount;
+}
+
+#else
+
+YGThreadPoolRef YGThreadPoolNew(const uint32_t threadCount) { return NULL; }
+
+void YGThreadPoolFree(const YGThreadPoolRef pool) {}
+
+uint32_t YGThreadPoolGetThreadCount(const YGThreadPoolRef pool) { return 0; }
+
+// Never called: layouts without a pool don't defer.
+static void YGThreadPoolSpawn(const YGThreadPoolRef pool,
+                              void (*run)(void *arg), void *arg,
+                              int32_t *pending) {
+  run(arg);
+  (*pending)--;
+}
+
+static void YGThreadPoolJoin(const YGThreadPoolRef pool, int32_t *pending) {}
+
+#endif
+
+// YGMeasureCache
+
+// Entries are spread over independently locked shards, so layout threads
+// measuring different content rarely wait for each other.
+#define YG_MEASURE_CACHE_SHARD_COUNT 16
+#define YG_MEASURE_CACHE_NONE UINT32_MAX
+
+#ifdef YG_THREAD_POOL
+typedef pthread_mutex_t YGMutex;
+#define YGMutexInit(mutex) pthread_mutex_init(mutex, NULL)
+#define YGMutexDestroy(mutex) pthread_mutex_destroy(mutex)
+#define YGMutexLock(mutex) pthread_mutex_lock(mutex)
+#define YGMutexUnlock(mutex) pthread_mutex_unlock(mutex)
+#else
+// Without pthreads a shard is guarded by a spin lock.
+typedef volatile long YGMutex;
+#define YGMutexInit(mutex) (*(mutex) = 0)
+#define YGMutexDestroy(mutex)
+#if defined(__GNUC__) || defined(__clang__)
+#define YGMutexLock(mutex)                                \
+  while (__atomic_exchange_n(mutex, 1, __ATOMIC_ACQUIRE)) \
+  ;
+#define YGMutexUnlock(mutex) __atomic_store_n(mutex, 0, __ATOMIC_RELEASE)
+#else
+#define YGMutexLock(mutex)               \
+  while (_InterlockedExchange(mutex, 1)) \
+  ;
+#define YGMutexUnlock(mutex) _InterlockedExchange(mutex, 0)
+#endif
+#endif
+
+typedef struct YGMeasureCacheEntry {
+  YGMeasureCacheKey key;
+  YGSize size;
+  // Next entry in the same bucket.
+  uint32_t next;
+  // Neighbours in the recency list, most recently used first.
+  uint32_t newer;
+  uint32_t older;
+} YGMeasureCacheEntry;
+
+typedef struct YGMeasureCacheShard {
+  YGMutex lock;
+  uint32_t *buckets;
+  uint32_t bucketMask;
+  YGMeasureCacheEntry *entries;
+  uint32_t count;
+  uint32_t capacity;
+  uint32_t newest;
+  uint32_t oldest;
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+} YGMeasureCacheShard;
+
+typedef struct YGMeasureCache {
+  YGMeasureCacheShard shards[YG_MEASURE_CACHE_SHARD_COUNT];
+  size_t bytes;
+} YGMeasureCache;
+
+static inline uint64_t YGMeasureCacheHash(const YGMeasureCacheKey *const key) {
+  uint64_t hash = key->fingerprint ^
+                  ((uint64_t)(uint32_t)key->width << 32 |
+                   (uint32_t)key->height) *
+                      0x9E3779B97F4A7C15ull ^
+                  (uint64_t)(key->widthMeasureMode << 2 |
+                             key->heightMeasureMode);
+  hash ^= hash >> 33;
+  hash *= 0xFF51AFD7ED558CCDull;
+  hash ^= hash >> 33;
+  hash *= 0xC4CEB9FE1A85EC53ull;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+static inline bool YGMeasureCacheKeyEqual(const YGMeasureCacheKey *const a,
+                                          const YGMeasureCacheKey *const b) {
+  return a->fingerprint == b->fingerprint && a->width == b->width &&
+         a->height == b->height &&
+         a->widthMeasureMode == b->widthMeasureMode &&
+         a->heightMeasureMode == b->heightMeasureMode;
+}
+
+static inline YGMeasureCacheShard *YGMeasureCacheGetShard(
+    const YGMeasureCacheRef cache, const uint64_t hash) {
+  return &cache->shards[hash >> 60];
+}
+
+static uint32_t YGMeasureCacheShardFind(YGMeasureCacheShard *const shard,
+                                        const YGMeasureCacheKey *const key,
+                                        const uint64_t hash) {
+  for (uint32_t i = shard->buckets[hash & shard->bucketMask];
+       i != YG_MEASURE_CACHE_NONE; i = shard->entries[i].next) {
+    if (YGMeasureCacheKeyEqual(&shard->entries[i].key, key)) {
+      return i;
+    }
+  }
+  return YG_MEASURE_CACHE_NONE;
+}
+
+static void YGMeasureCacheShardUnlink(YGMeasureCacheShard *const shard,
+                                      const uint32_t index) {
+  YGMeasureCacheEntry *const entry = &shard->entries[index];
+  if (entry->newer != YG_MEASURE_CACHE_NONE) {
+    shard->entries[entry->newer].older = entry->older;
+  } else {
+    shard->newest = entry->older;
+  }
+  if (entry->older != YG_MEASURE_CACHE_NONE) {
+    shard->entries[entry->older].newer = entry->newer;
+  } else {
+    shard->oldest = entry->newer;
+  }
+}
+
+static void YGMeasureCacheShardPushNewest(YGMeasureCacheShard *const shard,
+                                          const uint32_t index) {
+  YGMeasureCacheEntry *const entry = &shard->entries[index];
+  entry->newer = YG_MEASURE_CACHE_NONE;
+  entry->older = shard->newest;
+  if (shard->newest != YG_MEASURE_CACHE_NONE) {
+    shard->entries[shard->newest].newer = index;
+  } else {
+    shard->oldest = index;
+  }
+  shard->newest = index;
+}
+
+// Takes the least recently used entry out of its bucket and the recency list.
+static uint32_t YGMeasureCacheShardEvict(YGMeasureCacheShard *const shard) {
+  const uint32_t index = shard->oldest;
+  const uint64_t hash = YGMeasureCacheHash(&shard->entries[index].key);
+  uint32_t *link = &shard->buckets[hash & shard->bucketMask];
+  while (*link != index) {
+    link = &shard->entries[*link].next;
+  }
+  *link = shard->entries[index].next;
+  YGMeasureCacheShardUnlink(shard, index);
+  shard->evictions++;
+  return index;
+}
+
+static void YGMeasureCacheShardClear(YGMeasureCacheShard *const shard) {
+  for (uint32_t i = 0; i <= shard->bucketMask; i++) {
+    shard->buckets[i] = YG_MEASURE_CACHE_NONE;
+  }
+  shard->count = 0;
+  shard->newest = YG_MEASURE_CACHE_NONE;
+  shard->oldest = YG_MEASURE_CACHE_NONE;
+}
+
+YGMeasureCacheRef YGMeasureCacheNew(const size_t byteBudget) {
+  const YGMeasureCacheRef cache = gYGCalloc(1, sizeof(YGMeasureCache));
+  YGAssert(cache != NULL, "Could not allocate memory for measure cache");
+
+  // Every entry costs its own size plus up to two buckets, so the tables stay
+  // within the budget once the shards are full.
+  const size_t entryCost = sizeof(YGMeasureCacheEntry) + 2 * sizeof(uint32_t);
+  const size_t budget =
+      byteBudget > sizeof(YGMeasureCache) ? byteBudget - sizeof(YGMeasureCache)
+                                          : 0;
+  size_t capacity = budget / YG_MEASURE_CACHE_SHARD_COUNT / entryCost;
+  if (capacity > UINT32_MAX / 2) {
+    capacity = UINT32_MAX / 2;
+  }
+  uint32_t bucketCount = 1;
+  while (bucketCount < capacity) {
+    bucketCount *= 2;
+  }
+
+  cache->bytes = sizeof(YGMeasureCache);
+  for (uint32_t i = 0; i < YG_MEASURE_CACHE_SHARD_COUNT; i++) {
+    YGMeasureCacheShard *const shard = &cache->shards[i];
+    YGMutexInit(&shard->lock);
+    shard->capacity = (uint32_t)capacity;
+    shard->bucketMask = bucketCount - 1;
+    shard->buckets = gYGMalloc(sizeof(uint32_t) * bucketCount);
+    shard->entries =
+        capacity > 0 ? gYGMalloc(sizeof(YGMeasureCacheEntry) * capacity)
+                     : NULL;
+    YGAssert(shard->buckets != NULL && (capacity == 0 || shard->entries),
+             "Could not allocate memory for measure cache");
+    YGMeasureCacheShardClear(shard);
+    cache->bytes += sizeof(uint32_t) * bucketCount +
+                    sizeof(YGMeasureCacheEntry) * capacity;
+  }
+  return cache;
+}
+
+void YGMeasureCacheFree(const YGMeasureCacheRef cache) {
+  for (uint32_t i = 0; i < YG_MEASURE_CACHE_SHARD_COUNT; i++) {
+    YGMeasureCacheShard *const shard = &cache->shards[i];
+    YGMutexDestroy(&shard->lock);
+    gYGFree(shard->buckets);
+    gYGFree(shard->entries);
+  }
+  gYGFree(cache);
+}
+
+void YGMeasureCacheClear(const YGMeasureCacheRef cache) {
+  for (uint32_t i = 0; i < YG_MEASURE_CACHE_SHARD_COUNT; i++) {
+    YGMeasureCacheShard *const shard = &cache->shards[i];
+    YGMutexLock(&shard->lock);
+    YGMeasureCacheShardClear(shard);
+    YGMutexUnlock(&shard->lock);
+  }
+}
+
+YGMeasureCacheStats YGMeasureCacheGetStats(const YGMeasureCacheRef cache) {
+  YGMeasureCacheStats stats = {.bytes = cache->bytes};
+  for (uint32_t i = 0; i < YG_MEASURE_CACHE_SHARD_COUNT; i++) {
+    YGMeasureCacheShard *const shard = &cache->shards[i];
+    YGMutexLock(&shard->lock);
+    stats.hits += shard->hits;
+    stats.misses += shard->misses;
+    stats.evictions += shard->evictions;
+    stats.count += shard->count;
+    stats.capacity += shard->capacity;
+    YGMutexUnlock(&shard->lock);
+  }
+  return stats;
+}
+
+void YGConfigSetMeasureCache(const YGConfigRef config,
+                             const YGMeasureCacheRef cache) {
+  config->measureCache = cache;
+}
+
+static bool YGMeasureCacheLookup(const YGMeasureCacheRef cache,
+                                 const YGMeasureCacheKey *const key,
+                                 YGSize *const size) {
+  const uint64_t hash = YGMeasureCacheHash(key);
+  YGMeasureCacheShard *const shard = YGMeasureCacheGetShard(cache, hash);
+  YGMutexLock(&shard->lock);
+  const uint32_t index = YGMeasureCacheShardFind(shard, key, hash);
+  if (index == YG_MEASURE_CACHE_NONE) {
+    shard->misses++;
+    YGMutexUnlock(&shard->lock);
+    return false;
+  }
+  *size = shard->entries[index].size;
+  if (shard->newest != index) {
+    YGMeasureCacheShardUnlink(shard, index);
+    YGMeasureCacheShardPushNewest(shard, index);
+  }
+  shard->hits++;
+  YGMutexUnlock(&shard->lock);
+  return true;
+}
+
+static void YGMeasureCacheInsert(const YGMeasureCacheRef cache,
+                                 const YGMeasureCacheKey *const key,
+                                 const YGSize size) {
+  const uint64_t hash = YGMeasureCacheHash(key);
+  YGMeasureCacheShard *const shard = YGMeasureCacheGetShard(cache, hash);
+  YGMutexLock(&shard->lock);
+  if (shard->capacity == 0) {
+    YGMutexUnlock(&shard->lock);
+    return;
+  }
+  // Another thread may have measured the same content in the meantime.
+  uint32_t index = YGMeasureCacheShardFind(shard, key, hash);
+  if (index != YG_MEASURE_CACHE_NONE) {
+    YGMeasureCacheShardUnlink(shard, index);
+  } else {
+    index = shard->count < shard->capacity ? shard->count++
+                                           : YGMeasureCacheShardEvict(shard);
+    uint32_t *const bucket = &shard->buckets[hash & shard->bucketMask];
+    shard->entries[index].key = *key;
+    shard->entries[index].next = *bucket;
+    *bucket = index;
+  }
+  shard->entries[index].size = size;
+  YGMeasureCacheShardPushNewest(shard, index);
+  YGMutexUnlock(&shard->lock);
+}
+
+struct YGTraceSink {
+  FILE *file;
+  YGMutex lock;
+  // Timestamps are written relative to the creation of the sink.
+  uint64_t origin;
+  bool empty;
+};
+
+YGTraceSinkRef YGTraceSinkNew(FILE *file) {
+  YGAssert(file != NULL, "Cannot write a trace without a file");
+  const YGTraceSinkRef sink = gYGMalloc(sizeof(struct YGTraceSink));
+  YGAssert(sink != NULL, "Could not allocate memory for trace sink");
+  sink->file = file;
+  YGMutexInit(&sink->lock);
+  sink->origin = YGEventTimestamp();
+  sink->empty = true;
+  fputs("{\"traceEvents\":[", file);
+  return sink;
+}
+
+void YGTraceSinkFree(const YGTraceSinkRef sink) {
+  fputs("\n]}\n", sink->file);
+  fflush(sink->file);
+  YGMutexDestroy(&sink->lock);
+  gYGFree(sink);
+}
+
+// Arguments of a trace event, each prefixed by a comma.
+typedef struct YGTraceArgs {
+  char buffer[384];
+  size_t length;
+} YGTraceArgs;
+
+static void YGTraceArgsAppend(YGTraceArgs *const args, const char *format,
+                              ...) {
+  if (args->length >= sizeof(args->buffer)) {
+    return;
+  }
+  va_list list;
+  va_start(list, format);
+  const int length =
+      vsnprintf(args->buffer + args->length,
+                sizeof(args->buffer) - args->length, format, list);
+  va_end(list);
+  args->length += length > 0 ? (size_t)length : 0;
+}
+
+// JSON has no NaN, undefined sizes are written as null.
+static void YGTraceArgsAppendFloat(YGTraceArgs *const args, const char *key,
+                                   const float value) {
+  if (YGFloatIsUndefined(value)) {
+    YGTraceArgsAppend(args, ",\"%s\":null", key);
+  } else {
+    YGTraceArgsAppend(args, ",\"%s\":%g", key, value);
+  }
+}
+
+static void YGTraceArgsAppendSize(YGTraceArgs *const args,
+                                  const YGEvent *const event) {
+  YGTraceArgsAppendFloat(args, "width", event->width);
+  YGTraceArgsAppendFloat(args, "height", event->height);
+}
+
+static void YGTraceArgsAppendMeasuredSize(YGTraceArgs *const args,
+                                          const YGEvent *const event) {
+  YGTraceArgsAppendFloat(args, "measuredWidth", event->width);
+  YGTraceArgsAppendFloat(args, "measuredHeight", event->height);
+}
+
+static void YGTraceArgsAppendMeasureModes(YGTraceArgs *const args,
+                                          const YGEvent *const event) {
+  YGTraceArgsAppend(args, ",\"widthMode\":\"%s\",\"heightMode\":\"%s\"",
+                    YGMeasureModeToString(event->widthMeasureMode),
+                    YGMeasureModeToString(event->heightMeasureMode));
+}
+
+void YGTraceSinkHandleEvent(const YGConfigRef config, const YGEvent *event,
+                            void *context) {
+  (void)config;
+  const YGTraceSinkRef sink = context;
+  YGTraceArgs args = {.length = 0};
+  const char *name = "";
+  bool begin = false;
+  switch (event->type) {
+    case YGEventTypeLayoutBegin:
+      begin = true;
+      YGTraceArgsAppend(&args, ",\"node\":\"%p\"", (void *)event->node);
+      YGTraceArgsAppendSize(&args, event);
+      name = "YGNodeCalculateLayout";
+      break;
+    case YGEventTypeLayoutEnd:
+      YGTraceArgsAppendMeasuredSize(&args, event);
+      name = "YGNodeCalculateLayout";
+      break;
+    case YGEventTypeNodeLayoutBegin:
+      begin = true;
+      YGTraceArgsAppend(&args, ",\"node\":\"%p\",\"depth\":%u,\"layout\":%s",
+                        (void *)event->node, event->depth,
+                        event->performLayout ? "true" : "false");
+      YGTraceArgsAppendSize(&args, event);
+      YGTraceArgsAppendMeasureModes(&args, event);
+      name = event->reason;
+      break;
+    case YGEventTypeNodeLayoutEnd:
+      YGTraceArgsAppendMeasuredSize(&args, event);
+      YGTraceArgsAppend(&args, ",\"cache\":\"%s\"",
+                        YGCacheOutcomeToString(event->cacheOutcome));
+      name = event->reason;
+      break;
+    case YGEventTypeMeasureBegin:
+      begin = true;
+      YGTraceArgsAppend(&args, ",\"node\":\"%p\"", (void *)event->node);
+      YGTraceArgsAppendSize(&args, event);
+      YGTraceArgsAppendMeasureModes(&args, event);
+      name = "measure";
+      break;
+    case YGEventTypeMeasureEnd:
+      YGTraceArgsAppendMeasuredSize(&args, event);
+      name = "measure";
+      break;
+    case YGEventTypeBaselineBegin:
+      begin = true;
+      YGTraceArgsAppend(&args, ",\"node\":\"%p\"", (void *)event->node);
+      name = "baseline";
+      break;
+    case YGEventTypeBaselineEnd:
+      YGTraceArgsAppendFloat(&args, "baseline", event->baseline);
+      name = "baseline";
+      break;
+  }
+
+  const double timestamp = (double)(int64_t)(event->timestamp - sink->origin);
+  YGMutexLock(&sink->lock);
+  fprintf(sink->file,
+          "%s\n{\"name\":\"%s\",\"cat\":\"yoga\",\"ph\":\"%c\",\"ts\":%.3f,"
+          "\"pid\":1,\"tid\":%u,\"args\":{%s}}",
+          sink->empty ? "" : ",", name, begin ? 'B' : 'E', timestamp / 1000,
+          event->thread, args.length > 0 ? args.buffer + 1 : "");
+  sink->empty = false;
+  YGMutexUnlock(&sink->lock);
+}
+
+// Snapshots are written in the byte order of the host, which the header
+// records, since they are meant to be read back on the same device.
+#define YG_SNAPSHOT_MAGIC 0x4e534759u
+#define YG_SNAPSHOT_VERSION 1u
+#define YG_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+typedef struct YGSnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t byteOrder;
+  uint32_t nodeCount;
+  uint64_t styleHash;
+  uint64_t payloadSize;
+} YGSnapshotHeader;
+
+typedef struct YGSnapshotWriter {
+  uint8_t *data;
+  size_t size;
+  size_t capacity;
+  // FNV-1a of the shapes written, see YGSnapshotWriteShape.
+  uint64_t styleHash;
+  uint32_t nodeCount;
+  // Only the shapes are hashed, nothing is stored.
+  bool hashOnly;
+} YGSnapshotWriter;
+
+static void YGSnapshotWrite(YGSnapshotWriter *const writer,
+                            const void *const bytes, const size_t size) {
+  if (writer->size + size > writer->capacity) {
+    size_t capacity = writer->capacity == 0 ? 4096 : writer->capacity * 2;
+    while (capacity < writer->size + size) {
+      capacity *= 2;
+    }
+    writer->data = gYGRealloc(writer->data, capacity);
+    YGAssert(writer->data != NULL, "Could not allocate memory for snapshot");
+    writer->capacity = capacity;
+  }
+  memcpy(writer->data + writer->size, bytes, size);
+  writer->size += size;
+}
+
+static inline void YGSnapshotWriteU8(YGSnapshotWriter *const writer,
+                                     const uint8_t value) {
+  YGSnapshotWrite(writer, &value, sizeof(value));
+}
+
+static inline void YGSnapshotWriteU32(YGSnapshotWriter *const writer,
+                                      const uint32_t value) {
+  YGSnapshotWrite(writer, &value, sizeof(value));
+}
+
+static inline void YGSnapshotWriteFloat(YGSnapshotWriter *const writer,
+                                        const float value) {
+  YGSnapshotWrite(writer, &value, sizeof(value));
+}
+
+static inline void YGSnapshotWriteValue(YGSnapshotWriter *const writer,
+                                        const YGValue value) {
+  YGSnapshotWriteFloat(writer, value.value);
+  YGSnapshotWriteU8(writer, (uint8_t)value.unit);
+}
+
+static void YGSnapshotWriteEntry(YGSnapshotWriter *const writer,
+                                 const YGCachedMeasurement *const entry) {
+  YGSnapshotWriteFloat(writer, entry->availableWidth);
+  YGSnapshotWriteFloat(writer, entry->availableHeight);
+  YGSnapshotWriteFloat(writer, entry->roundedWidth);
+  YGSnapshotWriteFloat(writer, entry->roundedHeight);
+  YGSnapshotWriteFloat(writer, entry->keyScale);
+  YGSnapshotWriteFloat(writer, entry->computedWidth);
+  YGSnapshotWriteFloat(writer, entry->computedHeight);
+  YGSnapshotWriteU8(writer, entry->widthMeasureMode);
+  YGSnapshotWriteU8(writer, entry->heightMeasureMode);
+  YGSnapshotWriteU8(writer, entry->referenced);
+}
+
+// Everything the layout of the node depends on besides its subtree and
+// constraints: its style, child count, callbacks and measure fingerprint.
+static void YGSnapshotWriteShape(YGSnapshotWriter *const writer,
+                                 const YGNodeRef node) {
+  const size_t start = writer->size;
+  const YGStyle *const style = YGStyleOf(node);
+  YGSnapshotWriteU32(writer, YGNodeGetChildCount(node));
+  YGSnapshotWriteU8(writer, (uint8_t)node->nodeType |
+                                (node->measure != NULL) << 2 |
+                                (node->baseline != NULL) << 3);
+  YGSnapshotWrite(writer, &node->measureFingerprint,
+                  sizeof(node->measureFingerprint));
+  const uint8_t enums[] = {
+      style->direction,  style->flexDirection, style->justifyContent,
+      style->alignContent, style->alignItems,  style->alignSelf,
+      style->positionType, style->flexWrap,    style->overflow,
+      style->display,
+  };
+  YGSnapshotWrite(writer, enums, sizeof(enums));
+  YGSnapshotWriteFloat(writer, style->flex);
+  YGSnapshotWriteFloat(writer, style->flexGrow);
+  YGSnapshotWriteFloat(writer, style->flexShrink);
+  YGSnapshotWriteValue(writer, style->flexBasis);
+  for (YGDimension dim = YGDimensionWidth; dim <= YGDimensionHeight; dim++) {
+    YGSnapshotWriteValue(writer, style->dimensions[dim]);
+    YGSnapshotWriteValue(writer, style->minDimensions[dim]);
+    YGSnapshotWriteValue(writer, style->maxDimensions[dim]);
+  }
+  YGSnapshotWriteFloat(writer, style->aspectRatio);
+  for (uint32_t property = 0; property < YGEdgePropertyCount; property++) {
+    const uint16_t mask = style->edgeMasks[property];
+    YGSnapshotWrite(writer, &mask, sizeof(mask));
+    for (uint32_t edges = mask; edges != 0; edges &= edges - 1) {
+      YGSnapshotWriteValue(writer,
+                           YGStyleSetEdgeValue(style, property,
+                                               YGLowestSetBit(edges)));
+    }
+  }
+
+  for (size_t i = start; i < writer->size; i++) {
+    writer->styleHash = (writer->styleHash ^ writer->data[i]) * 1099511628211ull;
+  }
+  if (writer->hashOnly) {
+    writer->size = start;
+  }
+  writer->nodeCount++;
+}
+
+static void YGSnapshotWriteLayout(YGSnapshotWriter *const writer,
+                                  const YGNodeRef node) {
+  const YGLayout *const layout = &node->layout;
+  YGSnapshotWrite(writer, YGPositionOf(node), sizeof(gYGNodeDefaults.position));
+  YGSnapshotWrite(writer, layout->dimensions, sizeof(layout->dimensions));
+  YGSnapshotWrite(writer, YGMeasuredDimensionsOf(node),
+                  sizeof(gYGNodeDefaults.measuredDimensions));
+  YGSnapshotWriteU8(writer, (uint8_t)layout->direction);
+  YGSnapshotWriteU8(writer, (uint8_t)layout->lastParentDirection);
+  YGSnapshotWriteU8(writer, layout->hadOverflow);
+  YGSnapshotWriteFloat(writer, layout->computedFlexBasis);
+  YGSnapshotWriteU32(writer, node->lineIndex);
+  YGSnapshotWriteEntry(writer, &layout->cachedLayout);
+  const YGMeasurementCache *const cache = layout->measurementCache;
+  const uint32_t count = cache != NULL ? cache->count : 0;
+  YGSnapshotWriteU32(writer, count);
+  for (uint32_t i = 0; i < count; i++) {
+    YGSnapshotWriteEntry(writer, &cache->cachedMeasurements[i]);
+  }
+  YGSnapshotWriteU8(writer, layout->edges != NULL);
+  if (layout->edges != NULL) {
+    YGSnapshotWrite(writer, layout->edges, sizeof(YGLayoutEdges));
+  }
+}
+
+static void YGSnapshotWriteNode(YGSnapshotWriter *const writer,
+                                const YGNodeRef node) {
+  YGSnapshotWriteShape(writer, node);
+  if (!writer->hashOnly) {
+    YGSnapshotWriteLayout(writer, node);
+  }
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    YGSnapshotWriteNode(writer, YGChildAtCursor(node, cursor));
+  }
+}
+
+// The settings of the config that change layouts, hashed before the nodes.
+static void YGSnapshotWriteConfig(YGSnapshotWriter *const writer,
+                                  const YGConfigRef config) {
+  const uint8_t flags[] = {
+      config->useWebDefaults,
+      config->useLegacyStretchBehaviour,
+      config->experimentalFeatures[YGExperimentalFeatureWebFlexBasis],
+      config->fixedPointRounding,
+  };
+  YGSnapshotWrite(writer, flags, sizeof(flags));
+  YGSnapshotWriteFloat(writer, config->pointScaleFactor);
+  for (size_t i = 0; i < writer->size; i++) {
+    writer->styleHash = (writer->styleHash ^ writer->data[i]) * 1099511628211ull;
+  }
+  writer->size = 0;
+}
+
+static YGSnapshotWriter YGSnapshotWriteTree(const YGNodeRef root,
+                                            const bool hashOnly) {
+  YGSnapshotWriter writer = {
+      .styleHash = 14695981039346656037ull,
+      .hashOnly = hashOnly,
+  };
+  YGSnapshotWriteConfig(&writer, root->config);
+  YGSnapshotWriteNode(&writer, root);
+  return writer;
+}
+
+bool YGNodeSerializeSnapshot(const YGNodeRef root, FILE *file) {
+  if (root->isDirty) {
+    return false;
+  }
+  YGSnapshotWriter writer = YGSnapshotWriteTree(root, false);
+  const YGSnapshotHeader header = {
+      .magic = YG_SNAPSHOT_MAGIC,
+      .version = YG_SNAPSHOT_VERSION,
+      .byteOrder = YG_SNAPSHOT_BYTE_ORDER,
+      .nodeCount = writer.nodeCount,
+      .styleHash = writer.styleHash,
+      .payloadSize = writer.size,
+  };
+  const bool written =
+      fwrite(&header, sizeof(header), 1, file) == 1 &&
+      fwrite(writer.data, 1, writer.size, file) == writer.size;
+  gYGFree(writer.data);
+  return written;
+}
+
+// Numbers the snapshots restored, see YGSnapshotReader.
+static uint32_t gRestoredSnapshotCount = 0;
+
+typedef struct YGSnapshotReader {
+  const uint8_t *data;
+  size_t size;
+  size_t offset;
+  // Set once a read goes past the end. Reads then return zeros.
+  bool failed;
+  // Restored layouts didn't come from visits, so each node gets a history of
+  // its own, see YGNodeRecordEdit.
+  uint64_t history;
+} YGSnapshotReader;
+
+static void YGSnapshotRead(YGSnapshotReader *const reader, void *const bytes,
+                           const size_t size) {
+  if (reader->failed || size > reader->size - reader->offset) {
+    reader->failed = true;
+    memset(bytes, 0, size);
+    return;
+  }
+  memcpy(bytes, reader->data + reader->offset, size);
+  reader->offset += size;
+}
+
+static inline uint8_t YGSnapshotReadU8(YGSnapshotReader *const reader) {
+  uint8_t value;
+  YGSnapshotRead(reader, &value, sizeof(value));
+  return value;
+}
+
+static inline uint32_t YGSnapshotReadU32(YGSnapshotReader *const reader) {
+  uint32_t value;
+  YGSnapshotRead(reader, &value, sizeof(value));
+  return value;
+}
+
+static inline float YGSnapshotReadFloat(YGSnapshotReader *const reader) {
+  float value;
+  YGSnapshotRead(reader, &value, sizeof(value));
+  return value;
+}
+
+static void YGSnapshotReadEntry(YGSnapshotReader *const reader,
+                                YGCachedMeasurement *const entry) {
+  entry->availableWidth = YGSnapshotReadFloat(reader);
+  entry->availableHeight = YGSnapshotReadFloat(reader);
+  entry->roundedWidth = YGSnapshotReadFloat(reader);
+  entry->roundedHeight = YGSnapshotReadFloat(reader);
+  entry->keyScale = YGSnapshotReadFloat(reader);
+  entry->computedWidth = YGSnapshotReadFloat(reader);
+  entry->computedHeight = YGSnapshotReadFloat(reader);
+  entry->widthMeasureMode = YGSnapshotReadU8(reader);
+  entry->heightMeasureMode = YGSnapshotReadU8(reader);
+  entry->referenced = YGSnapshotReadU8(reader) != 0;
+}
+
+// Reads the layout of a node, into the node only if `apply` is set, so that
+// a first pass can check the whole snapshot before anything changes.
+static void YGSnapshotReadLayout(YGSnapshotReader *const reader,
+                                 const YGNodeRef node, const bool apply) {
+  YGLayout layout = node->layout;
+  float position[4];
+  float measuredDimensions[2];
+  YGSnapshotRead(reader, position, sizeof(position));
+  YGSnapshotRead(reader, layout.dimensions, sizeof(layout.dimensions));
+  YGSnapshotRead(reader, measuredDimensions, sizeof(measuredDimensions));
+  layout.direction = (YGDirection)YGSnapshotReadU8(reader);
+  const uint8_t lastParentDirection = YGSnapshotReadU8(reader);
+  layout.lastParentDirection = lastParentDirection == (uint8_t)-1
+                                   ? (YGDirection)-1
+                                   : (YGDirection)lastParentDirection;
+  layout.hadOverflow = YGSnapshotReadU8(reader) != 0;
+  layout.computedFlexBasis = YGSnapshotReadFloat(reader);
+  const uint32_t lineIndex = YGSnapshotReadU32(reader);
+  YGSnapshotReadEntry(reader, &layout.cachedLayout);
+
+  const uint32_t count = YGSnapshotReadU32(reader);
+  const uint32_t limit = node->config->maxCachedMeasurements;
+  YGMeasurementCache *cache = NULL;
+  if (apply && count > 0) {
+    // Keeps as many entries as the config allows.
+    const uint32_t capacity = count < limit ? count : limit;
+    cache = layout.measurementCache;
+    if (cache == NULL) {
+      cache = YGNodeAllocColdBlock(node, YGMeasurementCacheSize(capacity));
+      cache->capacity = capacity;
+    } else if (cache->capacity < capacity) {
+      cache = YGNodeReallocColdBlock(node, cache,
+                                     YGMeasurementCacheSize(cache->capacity),
+                                     YGMeasurementCacheSize(capacity));
+      cache->capacity = capacity;
+    }
+    YGMeasurementCacheClear(cache);
+    layout.measurementCache = cache;
+  } else if (apply && layout.measurementCache != NULL) {
+    YGMeasurementCacheClear(layout.measurementCache);
+  }
+  for (uint32_t i = 0; i < count && !reader->failed; i++) {
+    YGCachedMeasurement entry;
+    YGSnapshotReadEntry(reader, &entry);
+    if (cache != NULL && i < cache->capacity) {
+      cache->cachedMeasurements[cache->count++] = entry;
+    }
+  }
+
+  const bool hasEdges = YGSnapshotReadU8(reader) != 0;
+  YGLayoutEdges edges = {{0}};
+  if (hasEdges) {
+    YGSnapshotRead(reader, &edges, sizeof(edges));
+  }
+  if (!apply) {
+    return;
+  }
+  if (hasEdges) {
+    if (layout.edges == NULL) {
+      layout.edges = YGNodeAllocColdBlock(node, sizeof(YGLayoutEdges));
+    }
+    *layout.edges = edges;
+  } else if (layout.edges != NULL) {
+    memset(layout.edges, 0, sizeof(YGLayoutEdges));
+  }
+
+  // The next layout starts from the restored caches.
+  layout.generationCount = 0;
+  layout.computedFlexBasisGeneration = 0;
+  layout.subtreeSizeHint = 0;
+  layout.history = YGHashMix(reader->history, (uint64_t)(uintptr_t)node);
+  node->layout = layout;
+  memcpy(YGPositionOf(node), position, sizeof(position));
+  memcpy(YGMeasuredDimensionsOf(node), measuredDimensions,
+         sizeof(measuredDimensions));
+  YGNodeForgetConstraints(node, layout.relayout);
+  node->lineIndex = lineIndex;
+  node->isDirty = false;
+  node->hasNewLayout = true;
+  YGResolveDimensions(node);
+}
+
+// Checks the shape of every node against that of the tree, then reads its
+// layout. `shape` is scratch space for the shape of one node.
+static bool YGSnapshotReadNode(YGSnapshotReader *const reader,
+                               YGSnapshotWriter *const shape,
+                               const YGNodeRef node, const bool apply) {
+  shape->size = 0;
+  YGSnapshotWriteShape(shape, node);
+  if (shape->size > reader->size - reader->offset ||
+      memcmp(reader->data + reader->offset, shape->data, shape->size) != 0) {
+    return false;
+  }
+  reader->offset += shape->size;
+  YGSnapshotReadLayout(reader, node, apply);
+  if (reader->failed) {
+    return false;
+  }
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    if (!YGSnapshotReadNode(reader, shape, YGChildAtCursor(node, cursor),
+                            apply)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool YGNodeRestoreSnapshot(const YGNodeRef root, FILE *file) {
+  YGSnapshotHeader header;
+  if (fread(&header, sizeof(header), 1, file) != 1 ||
+      header.magic != YG_SNAPSHOT_MAGIC ||
+      header.version != YG_SNAPSHOT_VERSION ||
+      header.byteOrder != YG_SNAPSHOT_BYTE_ORDER) {
+    return false;
+  }
+  const YGSnapshotWriter tree = YGSnapshotWriteTree(root, true);
+  gYGFree(tree.data);
+  if (header.nodeCount != tree.nodeCount ||
+      header.styleHash != tree.styleHash ||
+      header.payloadSize != (size_t)header.payloadSize) {
+    return false;
+  }
+
+  uint8_t *const data = gYGMalloc(header.payloadSize);
+  YGAssert(data != NULL, "Could not allocate memory for snapshot");
+  bool restored =
+      fread(data, 1, header.payloadSize, file) == header.payloadSize;
+  YGSnapshotWriter shape = {.hashOnly = false};
+  const uint64_t history =
+      YGHashMix(YG_HISTORY_RESTORED,
+                (uint32_t)YGAtomicAdd(&gRestoredSnapshotCount, 1));
+  for (uint32_t pass = 0; pass < 2 && restored; pass++) {
+    YGSnapshotReader reader = {
+        .data = data, .size = header.payloadSize, .history = history};
+    restored = YGSnapshotReadNode(&reader, &shape, root, pass == 1) &&
+               reader.offset == reader.size;
+  }
+  gYGFree(shape.data);
+  gYGFree(data);
+  if (restored && root->config->memoizeSubtrees && YGParentOf(root) != NULL) {
+    YGNodeRecordEdit(root, YG_HISTORY_RESTORED);
+  }
+  return restored;
+}
+
+// Rounds half away from zero, like lroundf, and clamps to +-limit.
+static inline int32_t YGFrameValue(const float value, const float limit) {
+  if (value >= limit) {
+    return (int32_t)limit;
+  } else if (value <= -limit) {
+    return -(int32_t)limit;
+  } else if (YGFloatIsUndefined(value)) {
+    return 0;
+  }
+  return value >= 0 ? (int32_t)(value + 0.5f) : -(int32_t)(0.5f - value);
+}
+
+// Fixed point frames are in 1/64 of a pixel.
+#define YG_FRAME_FIXED_POINT_SHIFT 6
+// The largest float below 2^31.
+#define YG_FRAME_INT32_LIMIT 2147483520.0f
+#define YG_FRAME_INT16_LIMIT 32767.0f
+
+static void YGNodeWriteFixedPointFrames(const YGNodeRef node,
+                                        const float scale, int32_t frames[],
+                                        const uint32_t capacity,
+                                        uint32_t *const count) {
+  if (*count < capacity) {
+    int32_t *const frame = frames + (size_t)*count * 4;
+    const YGLayout *const layout = &node->layout;
+    const float *const position = YGPositionOf(node);
+    frame[0] = YGFrameValue(position[YGEdgeLeft] * scale, YG_FRAME_INT32_LIMIT);
+    frame[1] = YGFrameValue(position[YGEdgeTop] * scale, YG_FRAME_INT32_LIMIT);
+    frame[2] = YGFrameValue(layout->dimensions[YGDimensionWidth] * scale,
+                            YG_FRAME_INT32_LIMIT);
+    frame[3] = YGFrameValue(layout->dimensions[YGDimensionHeight] * scale,
+                            YG_FRAME_INT32_LIMIT);
+  }
+  (*count)++;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    YGNodeWriteFixedPointFrames(YGChildAtCursor(node, cursor), scale, frames,
+                                capacity, count);
+  }
+}
+
+static void YGNodeWritePixelFrames(const YGNodeRef node, const float scale,
+                                   int16_t frames[], const uint32_t capacity,
+                                   uint32_t *const count) {
+  if (*count < capacity) {
+    int16_t *const frame = frames + (size_t)*count * 4;
+    const YGLayout *const layout = &node->layout;
+    const float *const position = YGPositionOf(node);
+    frame[0] = (int16_t)YGFrameValue(position[YGEdgeLeft] * scale,
+                                     YG_FRAME_INT16_LIMIT);
+    frame[1] = (int16_t)YGFrameValue(position[YGEdgeTop] * scale,
+                                     YG_FRAME_INT16_LIMIT);
+    frame[2] = (int16_t)YGFrameValue(
+        layout->dimensions[YGDimensionWidth] * scale, YG_FRAME_INT16_LIMIT);
+    frame[3] = (int16_t)YGFrameValue(
+        layout->dimensions[YGDimensionHeight] * scale, YG_FRAME_INT16_LIMIT);
+  }
+  (*count)++;
+  const uint32_t childEnd = YGChildCursorEnd(node);
+  for (uint32_t cursor = YGChildCursorFirst(node); cursor != childEnd;
+       cursor = YGChildCursorNext(node, cursor)) {
+    YGNodeWritePixelFrames(YGChildAtCursor(node, cursor), scale, frames,
+                           capacity, count);
+  }
+}
+
+// Frames are exported in device pixels, or in points when the config doesn't
+// round.
+static inline float YGFrameScale(const YGNodeRef root) {
+  const float scale = root->config->pointScaleFactor;
+  return scale != 0.0f ? scale : 1.0f;
+}
+
+uint32_t YGNodeGetFixedPointFrames(const YGNodeRef root, int32_t frames[],
+                                   const uint32_t capacity) {
+  uint32_t count = 0;
+  YGNodeWriteFixedPointFrames(
+      root, YGFrameScale(root) * (1 << YG_FRAME_FIXED_POINT_SHIFT), frames,
+      capacity, &count);
+  return count;
+}
+
+uint32_t YGNodeGetPixelFrames(const YGNodeRef root, int16_t frames[],
+                              const uint32_t capacity) {
+  uint32_t count = 0;
+  YGNodeWritePixelFrames(root, YGFrameScale(root), frames, capacity, &count);
+  return count;
+}
@@ -57,6 +57,16 @@ typedef YG_ENUM_BEGIN(YGAlign){
 } YG_ENUM_END(YGAlign);
 WIN_EXPORT const char *YGAlignToString(const YGAlign value);
 
+#define YGCacheOutcomeCount 5
+typedef YG_ENUM_BEGIN(YGCacheOutcome){
+    YGCacheOutcomeNone,
+    YGCacheOutcomeLayoutHit,
+    YGCacheOutcomeMeasurementHit,
+    YGCacheOutcomeMiss,
+    YGCacheOutcomeSubtreeHit,
+} YG_ENUM_END(YGCacheOutcome);
+WIN_EXPORT const char *YGCacheOutcomeToString(const YGCacheOutcome value);
+
 #define YGDimensionCount 2
 typedef YG_ENUM_BEGIN(YGDimension){
     YGDimensionWidth,
@@ -86,6 +96,19 @@ typedef YG_ENUM_BEGIN(YGEdge){
 } YG_ENUM_END(YGEdge);
 WIN_EXPORT const char *YGEdgeToString(const YGEdge value);
 
+#define YGEventTypeCount 8
+typedef YG_ENUM_BEGIN(YGEventType){
+    YGEventTypeLayoutBegin,
+    YGEventTypeLayoutEnd,
+    YGEventTypeNodeLayoutBegin,
+    YGEventTypeNodeLayoutEnd,
+    YGEventTypeMeasureBegin,
+    YGEventTypeMeasureEnd,
+    YGEventTypeBaselineBegin,
+    YGEventTypeBaselineEnd,
+} YG_ENUM_END(YGEventType);
+WIN_EXPORT const char *YGEventTypeToString(const YGEventType value);
+
 #define YGExperimentalFeatureCount 1
 typedef YG_ENUM_BEGIN(YGExperimentalFeature){
     YGExperimentalFeatureWebFlexBasis,
@@ -212,6 +235,13 @@ static const YGValue YGValueAuto = {YGUndefined, YGUnitAuto};
 
 typedef struct YGConfig *YGConfigRef;
 typedef struct YGNode *YGNodeRef;
+typedef struct YGArena *YGArenaRef;
+typedef struct YGTree *YGTreeRef;
+typedef uint32_t YGNodeHandle;
+#define YGNodeHandleNone UINT32_MAX
+typedef struct YGThreadPool *YGThreadPoolRef;
+typedef struct YGMeasureCache *YGMeasureCacheRef;
+typedef struct YGTraceSink *YGTraceSinkRef;
 typedef YGSize (*YGMeasureFunc)(YGNodeRef node, float width, YGMeasureMode widthMode, float height,
                                 YGMeasureMode heightMode);
 typedef float (*YGBaselineFunc)(YGNodeRef node, const float width, const float height);
@@ -220,6 +250,9 @@ typedef int (*YGLogger)(const YGConfigRef config, const YGNodeRef node, YGLogLev
                         const char *format, va_list args);
 typedef void (*YGNodeClonedFunc)(YGNodeRef oldNode, YGNodeRef newNode, YGNodeRef parent,
                                  int childIndex);
+typedef void (*YGNodesClonedFunc)(YGNodeRef parent, const YGNodeRef oldNodes[],
+                                  const YGNodeRef newNodes[], const uint32_t childIndices[],
+                                  uint32_t count);
 
 typedef void *(*YGMalloc)(size_t size);
 typedef void *(*YGCalloc)(size_t count, size_t size);
@@ -229,6 +262,12 @@ typedef void (*YGFree)(void *ptr);
 // YGNode
 WIN_EXPORT YGNodeRef YGNodeNew(void);
 WIN_EXPORT YGNodeRef YGNodeNewWithConfig(const YGConfigRef config);
+// Clones the node, sharing its children with the original. A shared child is
+// only cloned when the clone writes to it: when it is taken with
+// YGNodeGetMutableChild, or when its parent is laid out. Editing a node deep in
+// a cloned tree so clones the path to it, and the layout the children of the
+// nodes it lays out again. The rest of the tree stays shared.
+// The original owns the shared children, so free the clones first.
 WIN_EXPORT YGNodeRef YGNodeClone(const YGNodeRef node);
 WIN_EXPORT void YGNodeFree(const YGNodeRef node);
 WIN_EXPORT void YGNodeFreeRecursive(const YGNodeRef node);
@@ -239,7 +278,26 @@ WIN_EXPORT void YGNodeInsertChild(const YGNodeRef node, const YGNodeRef child,
                                   const uint32_t index);
 WIN_EXPORT void YGNodeRemoveChild(const YGNodeRef node, const YGNodeRef child);
 WIN_EXPORT void YGNodeRemoveAllChildren(const YGNodeRef node);
+
+// Bulk variants of the above. The node is marked dirty once per call rather than
+// once per child.
+WIN_EXPORT void YGNodeInsertChildren(const YGNodeRef node,
+                                     const YGNodeRef children[],
+                                     const uint32_t count,
+                                     const uint32_t index);
+WIN_EXPORT void YGNodeRemoveChildren(const YGNodeRef node,
+                                     const uint32_t index,
+                                     const uint32_t count);
+// Moves the child at fromIndex so that it ends up at toIndex. The child keeps
+// its layout.
+WIN_EXPORT void YGNodeMoveChild(const YGNodeRef node,
+                                const uint32_t fromIndex,
+                                const uint32_t toIndex);
+
 WIN_EXPORT YGNodeRef YGNodeGetChild(const YGNodeRef node, const uint32_t index);
+// Like YGNodeGetChild, but clones the child first if it is shared with the
+// tree the node was cloned from. Use it to walk down to the node to edit.
+WIN_EXPORT YGNodeRef YGNodeGetMutableChild(const YGNodeRef node, const uint32_t index);
 WIN_EXPORT YGNodeRef YGNodeGetParent(const YGNodeRef node);
 WIN_EXPORT uint32_t YGNodeGetChildCount(const YGNodeRef node);
 
@@ -247,6 +305,22 @@ WIN_EXPORT void YGNodeCalculateLayout(const YGNodeRef node, const float availabl
                                       const float availableHeight,
                                       const YGDirection parentDirection);
 
+// Lays out what was edited in the tree of root since its last layout, with the constraints of that
+// layout: the dirty roots of its config in the tree, each on its own (see
+// YGConfigSetUseRelayoutBoundaries), then root itself if an edit went up to it. YGNodeCalculateLayout
+// lays out the dirty roots in the tree too, after root.
+WIN_EXPORT void YGNodeCalculateDirtyLayouts(const YGNodeRef root);
+
+// Returns the size node would be laid out at within the given constraints, before it is rounded to
+// the pixel grid, in the direction of its style. Only measures the tree: nothing is positioned or
+// rounded, the layout of the tree is left as it was last laid out, and only the measurement caches
+// are filled, for the next layout or measurement to reuse.
+WIN_EXPORT YGSize YGNodeCalculateSize(const YGNodeRef node,
+                                      const float availableWidth,
+                                      const YGMeasureMode widthMeasureMode,
+                                      const float availableHeight,
+                                      const YGMeasureMode heightMeasureMode);
+
 // Mark a node as dirty. Only valid for nodes with a custom measure function
 // set.
 // YG knows when to mark all other nodes as dirty but because nodes with
@@ -315,6 +389,9 @@ YG_NODE_PROPERTY(YGBaselineFunc, BaselineFunc, baselineFunc)
 YG_NODE_PROPERTY(YGPrintFunc, PrintFunc, printFunc);
 YG_NODE_PROPERTY(bool, HasNewLayout, hasNewLayout);
 YG_NODE_PROPERTY(YGNodeType, NodeType, nodeType);
+// Identifies the content a node with a measure function measures, for the measure cache of its
+// config. 0, the default, means the node is always measured.
+YG_NODE_PROPERTY(uint64_t, MeasureFingerprint, measureFingerprint);
 
 YG_NODE_STYLE_PROPERTY(YGDirection, Direction, direction);
 YG_NODE_STYLE_PROPERTY(YGFlexDirection, FlexDirection, flexDirection);
@@ -389,6 +466,7 @@ WIN_EXPORT void YGAssertWithConfig(const YGConfigRef config, const bool conditio
 // Set this to number of pixels in 1 point to round calculation results
 // If you want to avoid rounding - set PointScaleFactor to 0
 WIN_EXPORT void YGConfigSetPointScaleFactor(const YGConfigRef config, const float pixelsInPoint);
+WIN_EXPORT float YGConfigGetPointScaleFactor(const YGConfigRef config);
 
 // Yoga previously had an error where containers would take the maximum space possible instead of
 // the minimum
@@ -399,6 +477,32 @@ WIN_EXPORT void YGConfigSetPointScaleFactor(const YGConfigRef config, const floa
 WIN_EXPORT void YGConfigSetUseLegacyStretchBehaviour(const YGConfigRef config,
                                                      const bool useLegacyStretchBehaviour);
 
+// Rounds to the pixel grid in fixed point, in 1/65536 of a pixel, rather than in float. The edges
+// of deep nodes are then exact sums instead of picking up float error, and negative positions round
+// to the nearest pixel like positive ones. The layout itself is still computed in float. Has no
+// effect when the point scale factor is 0. Off by default.
+WIN_EXPORT void YGConfigSetFixedPointRounding(const YGConfigRef config, const bool enabled);
+WIN_EXPORT bool YGConfigGetFixedPointRounding(const YGConfigRef config);
+
+// Lays out flex lines with the generic loops, which test the flex direction, the wrapping and the
+// absolute children of the container for every child, instead of the copies specialized for each
+// container. Simple stacks, whose children neither grow nor shrink and are packed at the start of a
+// single line, go through the flex lines too instead of their single pass. Both lay out the same;
+// this exists to compare them. Off by default.
+WIN_EXPORT void YGConfigSetUseGenericLayoutKernels(const YGConfigRef config, const bool enabled);
+WIN_EXPORT bool YGConfigGetUseGenericLayoutKernels(const YGConfigRef config);
+
+// Stops the dirtiness of an edit at the first ancestor whose size cannot depend on its content: a
+// node with a width and a height in points that its parent laid out at exactly that size, and whose
+// baseline no ancestor uses. That relayout boundary goes into the dirty roots of the config instead,
+// and is laid out again on its own, at the size and position it had, by YGNodeCalculateDirtyLayouts
+// or the next YGNodeCalculateLayout of its tree. Its parent is laid out again after all if the new
+// layout overflows differently. A boundary is rounded from where its ancestors were last rounded.
+// The trees of the config share the dirty roots, so they must be edited from one thread at a time.
+// Off by default.
+WIN_EXPORT void YGConfigSetUseRelayoutBoundaries(const YGConfigRef config, const bool enabled);
+WIN_EXPORT bool YGConfigGetUseRelayoutBoundaries(const YGConfigRef config);
+
 // YGConfig
 WIN_EXPORT YGConfigRef YGConfigNew(void);
 WIN_EXPORT void YGConfigFree(const YGConfigRef config);
@@ -418,10 +522,272 @@ WIN_EXPORT bool YGConfigGetUseWebDefaults(const YGConfigRef config);
 
 WIN_EXPORT void YGConfigSetNodeClonedFunc(const YGConfigRef config,
                                           const YGNodeClonedFunc callback);
+// Called once for the children of a parent that are cloned together, instead
+// of the callback above once for each of them.
+WIN_EXPORT void YGConfigSetNodesClonedFunc(const YGConfigRef config,
+                                           const YGNodesClonedFunc callback);
+
+// Debug output of YGNodeCalculateLayout, off by default. printTree prints the
+// laid out tree, printChanges every node that is visited and printSkips the
+// visits answered from the cache.
+WIN_EXPORT void YGConfigSetPrintTreeFlag(const YGConfigRef config, const bool enabled);
+WIN_EXPORT void YGConfigSetPrintChangesFlag(const YGConfigRef config, const bool enabled);
+WIN_EXPORT void YGConfigSetPrintSkipsFlag(const YGConfigRef config, const bool enabled);
+
+// Each node caches the sizes it was measured at during a layout, growing its cache up to count
+// entries (16 by default). Past that, new measurements replace the ones not used for the longest.
+WIN_EXPORT void YGConfigSetMaxCachedMeasurements(const YGConfigRef config, const uint32_t count);
+
+// Lists and grids often repeat the same subtree, such as placeholder rows or uniform cells. With
+// memoization enabled, a layout remembers the subtrees it lays out by their structure (styles,
+// children, measure and baseline functions and measure fingerprints) and constraints, and copies
+// the result into the identical subtrees that follow instead of laying them out. Subtrees with a
+// node that measures without a fingerprint, or that align on baselines, are always laid out.
+// Changing a measure function or fingerprint takes effect once the node is marked dirty. Enable it
+// before building the trees of the config. Off by default.
+WIN_EXPORT void YGConfigSetSubtreeMemoization(const YGConfigRef config, const bool enabled);
+
+// What a layout did. Every layout adds its counts to those of the config of its root, which keep
+// growing until they are reset. The counters are always on; they cost an increment per event.
+typedef struct YGLayoutStats {
+  // Nodes visited by the layout, either to lay them out or only to measure them.
+  uint64_t nodesVisited;
+  uint64_t layoutCalls;
+  uint64_t measureCalls;
+  // Visits answered by the layout cache of the node, and layouts that had to be computed.
+  uint64_t cachedLayoutHits;
+  uint64_t cachedLayoutMisses;
+  // Visits answered by the measurement cache of the node, measurements that had to be computed
+  // and were added to it, and those of them that replaced an entry.
+  uint64_t cachedMeasurementHits;
+  uint64_t cachedMeasurementMisses;
+  uint64_t cachedMeasurementEvictions;
+  // Calls of measure functions. Results found in a measure cache don't count.
+  uint64_t measureFuncCalls;
+  uint64_t nodesRounded;
+  // Visits answered by copying a memoized subtree, and the nodes copied below them.
+  uint64_t memoizedSubtrees;
+  uint64_t memoizedNodes;
+  // Deepest node visited, the root being at depth 1.
+  uint32_t maxDepth;
+} YGLayoutStats;
+
+WIN_EXPORT YGLayoutStats YGConfigGetLayoutStats(const YGConfigRef config);
+WIN_EXPORT void YGConfigResetLayoutStats(const YGConfigRef config);
+// YGNodeCalculateLayout that also returns the counts of this layout alone.
+WIN_EXPORT void YGNodeCalculateLayoutWithStats(const YGNodeRef node, const float availableWidth,
+                                               const float availableHeight,
+                                               const YGDirection parentDirection,
+                                               YGLayoutStats *const stats);
 
 // Export only for C#
 WIN_EXPORT YGConfigRef YGConfigGetDefault(void);
 
+// YGArena
+// An arena bump-allocates the nodes, child lists and configs of one hierarchy
+// from chunked slabs. Nothing allocated from an arena is returned to the system
+// until the arena itself is freed (or reset), so a whole tree can be dropped in
+// O(1) without walking it. YGNodeFree on an arena node only detaches it.
+// Nodes cloned from an arena node are allocated from the same arena. A node is
+// allocated in the arena of its config, or in any arena with a config outside
+// one; resetting or freeing the arena then takes its nodes out of the dirty
+// roots and the layout changes of that config.
+// Pass 0 as chunkSize to use the default slab size.
+WIN_EXPORT YGArenaRef YGArenaNew(const size_t chunkSize);
+WIN_EXPORT void YGArenaFree(const YGArenaRef arena);
+WIN_EXPORT void YGArenaReset(const YGArenaRef arena);
+WIN_EXPORT size_t YGArenaGetAllocatedBytes(const YGArenaRef arena);
+WIN_EXPORT YGConfigRef YGConfigNewInArena(const YGArenaRef arena);
+WIN_EXPORT YGNodeRef YGNodeNewInArena(const YGArenaRef arena, const YGConfigRef config);
+
+// YGTree
+// A tree keeps the style, measured dimensions, position, parent, first child
+// and next sibling of its nodes in columns indexed by 32-bit handles, which the
+// layout reads instead of walking pointers. Nodes are appended as the last
+// child of their parent, and the first node is the root. The config must not
+// be that of an arena and must outlive the tree.
+// YGTreeGetNode gives access to the regular style and layout API of a node. The
+// pointer stays valid until the tree is freed, but the node must not be freed,
+// reset, cloned, inserted, removed or moved with the YGNode functions.
+WIN_EXPORT YGTreeRef YGTreeNew(const YGConfigRef config);
+WIN_EXPORT void YGTreeFree(const YGTreeRef tree);
+// Copies every column with one memcpy, then gives the copied nodes their own
+// cold blocks.
+WIN_EXPORT YGTreeRef YGTreeCopy(const YGTreeRef tree);
+// Makes room for `capacity` nodes up front so that appending doesn't grow the
+// columns.
+WIN_EXPORT void YGTreeReserve(const YGTreeRef tree, const uint32_t capacity);
+WIN_EXPORT YGNodeHandle YGTreeAppendNode(const YGTreeRef tree, const YGNodeHandle parent);
+WIN_EXPORT uint32_t YGTreeGetNodeCount(const YGTreeRef tree);
+WIN_EXPORT YGNodeRef YGTreeGetNode(const YGTreeRef tree, const YGNodeHandle handle);
+WIN_EXPORT YGNodeHandle YGTreeGetNodeHandle(const YGTreeRef tree, const YGNodeRef node);
+// These return YGNodeHandleNone when there is no such node.
+WIN_EXPORT YGNodeHandle YGTreeGetParent(const YGTreeRef tree, const YGNodeHandle handle);
+WIN_EXPORT YGNodeHandle YGTreeGetFirstChild(const YGTreeRef tree, const YGNodeHandle handle);
+WIN_EXPORT YGNodeHandle YGTreeGetNextSibling(const YGTreeRef tree, const YGNodeHandle handle);
+WIN_EXPORT void YGTreeCalculateLayout(const YGTreeRef tree,
+                                      const float availableWidth,
+                                      const float availableHeight,
+                                      const YGDirection parentDirection);
+
+// YGThreadPool
+// A pool of worker threads that YGNodeCalculateLayout fans sibling subtrees out
+// to. With a pool set on its config, a layout hands the children it lays out at
+// an exact size and that have a large enough subtree to the pool, and waits for
+// them before it reads anything back from their subtrees. The results are
+// identical to those of a serial layout. Measure, baseline and clone callbacks
+// may then be called from the pool threads, and the memory funcs must be thread
+// safe. Trees allocated in an arena, and layouts printing changes, stay serial.
+// The thread calling YGNodeCalculateLayout takes part in the layout, so one
+// thread less than the number of cores keeps all of them busy. Returns NULL
+// where threads are not supported. A pool can be shared by configs and by
+// concurrent layouts, and must outlive them.
+WIN_EXPORT YGThreadPoolRef YGThreadPoolNew(const uint32_t threadCount);
+WIN_EXPORT void YGThreadPoolFree(const YGThreadPoolRef pool);
+WIN_EXPORT uint32_t YGThreadPoolGetThreadCount(const YGThreadPoolRef pool);
+WIN_EXPORT void YGConfigSetParallelism(const YGConfigRef config, const YGThreadPoolRef pool);
+
+// Lays out `count` independent roots, each within its constraints and in its own style direction,
+// spreading them over the threads of the pool, and returns once all are done. Roots are laid out
+// on the calling thread when pool is NULL. Each root still uses the pool of its own config, if
+// any, for its subtrees.
+WIN_EXPORT void YGNodeCalculateLayoutBatch(const YGNodeRef *roots,
+                                           const YGSize *constraints,
+                                           const size_t count,
+                                           const YGThreadPoolRef pool);
+
+// YGMeasureCache
+// A memo of measure function results that is shared by nodes, configs and layout threads. A node
+// takes part once it has a measure fingerprint: a hash of everything its measure function depends
+// on, such as the text, font and attributes of a label. Nodes with the same fingerprint must
+// measure the same under the same constraints. Before calling the measure function of such a node,
+// a layout looks the constraints, quantised to 1/64 point, and measure modes up in the cache of the
+// config, so that trees rebuilt with the same content don't measure it again. Once the cache holds
+// byteBudget bytes, the least recently used results make room for new ones. A cache must outlive
+// the configs it is set on.
+typedef struct YGMeasureCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint32_t count;
+  uint32_t capacity;
+  size_t bytes;
+} YGMeasureCacheStats;
+
+WIN_EXPORT YGMeasureCacheRef YGMeasureCacheNew(const size_t byteBudget);
+WIN_EXPORT void YGMeasureCacheFree(const YGMeasureCacheRef cache);
+// Drops every result, e.g. after the fonts changed. The counters are kept.
+WIN_EXPORT void YGMeasureCacheClear(const YGMeasureCacheRef cache);
+WIN_EXPORT YGMeasureCacheStats YGMeasureCacheGetStats(const YGMeasureCacheRef cache);
+WIN_EXPORT void YGConfigSetMeasureCache(const YGConfigRef config, const YGMeasureCacheRef cache);
+
+// YGEvent
+// Tracing of layouts. With an event handler set on the config of a root, YGNodeCalculateLayout
+// reports its own begin and end, those of every node it visits, and those of every measure and
+// baseline function it calls. Begin and end events of a thread nest. The handler in place when a
+// layout starts is used for all of it, and is called from the pool threads of parallel layouts.
+// Without a handler, each of these points costs a single branch.
+typedef struct YGEvent {
+  YGEventType type;
+  // Monotonic time in nanoseconds, from an arbitrary origin.
+  uint64_t timestamp;
+  // Small number of the reporting thread, 1 for the first one.
+  uint32_t thread;
+  // The root for layout events, otherwise the visited, measured or baseline node.
+  YGNodeRef node;
+  // Depth of the node, the root being at depth 1.
+  uint32_t depth;
+  // Node layouts: why the node is visited, such as "initial", "measure" or "stretch", and
+  // whether it is laid out or only measured. Layouts of subtrees deferred to a pool thread are
+  // reported again there as "deferred".
+  const char *reason;
+  bool performLayout;
+  // Begin events: the available size, or the constraints of the measure function. End events:
+  // the measured size, or the size returned by the measure function.
+  float width;
+  float height;
+  YGMeasureMode widthMeasureMode;
+  YGMeasureMode heightMeasureMode;
+  // End of node layouts: whether a cache of the node answered the visit.
+  YGCacheOutcome cacheOutcome;
+  // End of baselines: the baseline returned.
+  float baseline;
+} YGEvent;
+
+typedef void (*YGEventHandler)(const YGConfigRef config, const YGEvent *event, void *context);
+
+WIN_EXPORT void YGConfigSetEventHandler(const YGConfigRef config,
+                                        const YGEventHandler handler,
+                                        void *context);
+
+// An event handler writing Chrome trace_event JSON, to open in chrome://tracing or Perfetto. Pass
+// YGTraceSinkHandleEvent as the handler and the sink as its context. Events of concurrent layouts
+// are written whole, under a lock. YGTraceSinkFree completes the JSON; the file stays open.
+WIN_EXPORT YGTraceSinkRef YGTraceSinkNew(FILE *file);
+WIN_EXPORT void YGTraceSinkFree(const YGTraceSinkRef sink);
+WIN_EXPORT void YGTraceSinkHandleEvent(const YGConfigRef config,
+                                       const YGEvent *event,
+                                       void *sink);
+
+// YGSnapshot
+// A snapshot holds the computed layout of a tree along with the layout and measurement caches of
+// its nodes, so that the same tree built again, such as the first screen at the next launch, can
+// start from them. Laid out within the same constraints, the restored root is answered from its
+// cache. YGNodeSerializeSnapshot fails for a dirty tree or when the file can't be written.
+// YGNodeRestoreSnapshot only applies a snapshot of the current version, taken of a tree with the
+// same structure, styles, measure and baseline functions, measure fingerprints and config
+// settings: they are checked against the style hash of the snapshot, then node by node. Otherwise
+// it returns false and leaves the tree untouched. Set measure fingerprints on nodes that measure
+// content, so that changed content doesn't match. Snapshots are written in host byte order.
+WIN_EXPORT bool YGNodeSerializeSnapshot(const YGNodeRef root, FILE *file);
+WIN_EXPORT bool YGNodeRestoreSnapshot(const YGNodeRef root, FILE *file);
+
+// YGFrames
+// The frames of a laid out subtree for a renderer, as left, top, width and height relative to the
+// parent, node after node in preorder. Values are in device pixels, points times the point scale
+// factor of the config, or in points when it is 0. Both return the number of nodes in the subtree
+// and only write the frames of the first capacity ones, capacity being the number of frames the
+// array holds (4 values each). Values beyond the range of the type are clamped.
+// In 26.6 fixed point, 1/64 of a pixel.
+WIN_EXPORT uint32_t YGNodeGetFixedPointFrames(const YGNodeRef root, int32_t frames[],
+                                              const uint32_t capacity);
+// Rounded to whole pixels, in half the memory of float frames.
+WIN_EXPORT uint32_t YGNodeGetPixelFrames(const YGNodeRef root, int16_t frames[],
+                                         const uint32_t capacity);
+
+// YGLayoutChange
+// With changes recorded, a layout compares the frames of the nodes it reached, their left, top,
+// width and height once rounded, with those recorded for them last, and appends an entry to the
+// config of each node whose frame changed. A caller that owns the config of its trees, and is the
+// only one to set the frames of its views, can update the views of those entries instead of
+// walking the trees. YGLayout does not: its views share one config, and their frames may be set
+// outside of it, so it still compares the frame of every view with its node. The first entry
+// of a node has an old frame of 0. Entries accumulate in the order they were recorded until they
+// are cleared; a node laid out several times in between has an entry per change and the last one
+// holds its frame. Freeing or resetting a node, or the arena it is in, drops its entries. The trees
+// of a config share its entries, so they must be laid out from one thread at a time, except by
+// YGNodeCalculateLayoutBatch. Off by default.
+typedef struct YGFrame {
+  float left;
+  float top;
+  float width;
+  float height;
+} YGFrame;
+
+typedef struct YGLayoutChange {
+  YGNodeRef node;
+  YGFrame oldFrame;
+  YGFrame newFrame;
+} YGLayoutChange;
+
+WIN_EXPORT void YGConfigSetRecordLayoutChanges(const YGConfigRef config, const bool enabled);
+WIN_EXPORT bool YGConfigGetRecordLayoutChanges(const YGConfigRef config);
+// The entries recorded since they were last cleared, valid until the next layout of a tree of the
+// config. Their number is written to count.
+WIN_EXPORT const YGLayoutChange *YGConfigGetLayoutChanges(const YGConfigRef config,
+                                                          uint32_t *const count);
+WIN_EXPORT void YGConfigClearLayoutChanges(const YGConfigRef config);
+
 WIN_EXPORT void YGConfigSetContext(const YGConfigRef config, void *context);
 WIN_EXPORT void *YGConfigGetContext(const YGConfigRef config);
 
@@ -444,6 +810,12 @@ YG_EXTERN_C_END
 
 YG_EXTERN_C_BEGIN
 
+void *YGArenaAlloc(const YGArenaRef arena, const size_t size);
+void *YGArenaRealloc(const YGArenaRef arena, void *ptr, const size_t oldSize,
+                     const size_t newSize);
+
+// A growable list of nodes. Nodes no longer store their children in one; it is kept for code that
+// keeps lists of nodes of its own.
 typedef struct YGNodeList *YGNodeListRef;
 
 YGNodeListRef YGNodeListNew(const uint32_t initialCapacity);
@@ -116,6 +116,23 @@
   XCTAssertTrue(expectLeafNodeHasCoordinator);
 }
 
+- (void)testIntrinsicSizeOfFractionalContainerMatchesItsLayout {
+  const auto view = [[UIView alloc] init];
+  const auto child = [[UIView alloc] init];
+  [view addSubview:child];
+  view.yoga.isEnabled = YES;
+  child.yoga.isEnabled = YES;
+  child.yoga.width = 10.1;
+  child.yoga.height = 20.4;
+
+  const auto size = view.yoga.intrinsicSize;
+  [view.yoga applyLayoutPreservingOrigin:NO
+                    dimensionFlexibility:YGDimensionFlexibilityFlexibleWidth |
+                                         YGDimensionFlexibilityFlexibleHeigth];
+  XCTAssertEqual(size.width, view.frame.size.width);
+  XCTAssertEqual(size.height, view.frame.size.height);
+}
+
 - (CRCoordinatorDescriptor *)testDescriptor {
   return [[CRCoordinatorDescriptor alloc] initWithType:TestCoordinator.class key:@"test"];
 }